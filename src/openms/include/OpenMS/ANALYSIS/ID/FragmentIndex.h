@@ -0,0 +1,179 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/KERNEL/MSSpectrum.h>
+
+#include <utility>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Fragment ion index for spectrum-centric peptide candidate retrieval.
+
+    Stores the fragment ions of all (modified) peptides of a database in a single
+    array that is sorted by m/z and partitioned into buckets of fixed size.
+    Within each bucket, fragments are sorted by the index of their peptide and
+    peptides are sorted by mass. An experimental peak can thus be matched
+    against all fragments of peptides in a given precursor mass window using
+    two binary searches per bucket (the approach used by MSFragger).
+
+    Peptides are stored as unmodified sequence plus the enumeration index of the
+    modified variant (as returned by ModifiedPeptideGenerator) and the string
+    representation of the modified variant, so candidates can be scored without
+    enumerating the modified variants again.
+
+    Usage: call addPeptide() for every candidate, then build() once before
+    querying. Queries are const and can be run concurrently.
+
+    @ingroup Analysis_ID
+  */
+  class OPENMS_DLLAPI FragmentIndex
+  {
+public:
+    /// A peptide (unmodified sequence and index of its modified variant) with its monoisotopic mass
+    struct Peptide
+    {
+      String sequence;
+      Size modification_index = 0;
+      /// the modified variant (as AASequence::toString())
+      String modified_sequence;
+      double mass = 0.0;
+    };
+
+    /// A single fragment ion referencing the peptide it was generated from
+    struct Fragment
+    {
+      float mz = 0.0f;
+      UInt32 peptide_index = 0;
+    };
+
+    /// A peptide candidate for a spectrum and the number of its fragments matching experimental peaks
+    struct Candidate
+    {
+      Size peptide_index = 0;
+      Size matched_fragments = 0;
+    };
+
+    /// Constructor with the number of fragments per m/z bucket
+    explicit FragmentIndex(Size bucket_size = 512);
+
+    /// Removes all peptides and fragments
+    void clear();
+
+    /**
+      @brief Adds a peptide and the m/z values of its fragment ions
+
+      Invalidates a previously built index, i.e. build() needs to be called again.
+    */
+    void addPeptide(const String& sequence, Size modification_index, const String& modified_sequence, double mass, const std::vector<double>& fragment_mz);
+
+    /// Sorts peptides by mass and creates the fragment buckets
+    void build();
+
+    /// Returns whether build() was called after the last modification
+    bool isBuilt() const;
+
+    /// Number of peptides in the index
+    Size size() const;
+
+    /// Number of fragments in the index
+    Size fragmentCount() const;
+
+    /// Returns the peptide with index @p index (valid after build())
+    const Peptide& getPeptide(Size index) const;
+
+    /// Returns the range [first, last) of peptide indices with mass in [@p min_mass, @p max_mass]
+    std::pair<Size, Size> getPeptideRange(double min_mass, double max_mass) const;
+
+    /**
+      @brief Retrieves candidate peptides for a spectrum
+
+      Every peak of @p spectrum is matched against the fragments of all peptides with
+      mass in [@p min_mass, @p max_mass]. Peptides with at least @p min_matched matching
+      fragments are appended to @p candidates (sorted by peptide index).
+
+      @exception Exception::IllegalArgument is thrown if the index was not built
+    */
+    void query(const MSSpectrum& spectrum,
+               double min_mass,
+               double max_mass,
+               double fragment_mass_tolerance,
+               bool fragment_mass_tolerance_unit_ppm,
+               Size min_matched,
+               std::vector<Candidate>& candidates) const;
+
+    /**
+      @brief Stores the index in a binary file
+
+      @p settings is an arbitrary description of the database and search settings
+      that were used to create the index. It is checked on load().
+
+      @exception Exception::UnableToCreateFile is thrown if the file could not be created or written
+      @exception Exception::IllegalArgument is thrown if the index was not built
+    */
+    void store(const String& filename, const String& settings) const;
+
+    /**
+      @brief Loads an index from a binary file
+
+      @return false (and leaves the index empty) if the file was created with different @p settings
+
+      @exception Exception::FileNotFound is thrown if the file could not be opened
+      @exception Exception::ParseError is thrown if the file is not a fragment index file, or if it is truncated or corrupt
+    */
+    bool load(const String& filename, const String& settings);
+
+protected:
+    /// Fragments per bucket
+    Size bucket_size_;
+
+    /// Whether the buckets are up to date
+    bool built_;
+
+    /// All peptides (sorted by mass after build())
+    std::vector<Peptide> peptides_;
+
+    /// All fragments (bucketed after build())
+    std::vector<Fragment> fragments_;
+
+    /// Smallest fragment m/z of each bucket
+    std::vector<float> bucket_min_mz_;
+  };
+
+} // namespace OpenMS
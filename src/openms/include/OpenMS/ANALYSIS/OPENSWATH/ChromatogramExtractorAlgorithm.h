@@ -181,8 +181,81 @@ public:
                               const double im_extraction_window,
                               const bool ppm);
 
+    /**
+     * @brief Extract a set of m/z values from a single spectrum in one pass.
+     *
+     * Sums the same data points as calling extract_value_tophat() for each
+     * entry of @p mz in order, but walks the spectrum only once: the
+     * extraction windows are swept over the (sorted) spectrum with three
+     * monotonic cursors and intensities in each window are summed using
+     * SIMD instructions where available.
+     *
+     * @note The SIMD summation adds the intensities in a different order than
+     * extract_value_tophat(), so results may differ from it (and between
+     * builds with and without SSE2) by floating point rounding, i.e. a
+     * relative difference in the order of 1e-16 times the number of summed
+     * data points.
+     *
+     * @param mz_array m/z values of the spectrum (ascending)
+     * @param int_array Intensity values of the spectrum
+     * @param im_array Ion mobility values of the spectrum (may be empty if no ion mobility extraction is requested)
+     * @param mz Target m/z values (ascending)
+     * @param im Target ion mobility values (same length as @p mz, a negative
+     *   value disables ion mobility filtering for this target) or empty
+     * @param integrated_intensities Resulting intensities (one per target, will be overwritten)
+     * @param mz_extraction_window Extracts a window of this size in m/z
+     * dimension (e.g. a window of 50 ppm means an extraction of 25 ppm on
+     * either side)
+     * @param im_extraction_window Extracts a window of this size in ion mobility dimension.
+     * @param ppm Whether the parameter mz_extraction_window is given in ppm or Th
+     *
+     * @throw Exception::IllegalArgument if target m/z values are not sorted or array sizes do not match
+    */
+    void extract_values_tophat(const std::vector<double>& mz_array,
+                               const std::vector<double>& int_array,
+                               const std::vector<double>& im_array,
+                               const std::vector<double>& mz,
+                               const std::vector<double>& im,
+                               std::vector<double>& integrated_intensities,
+                               const double mz_extraction_window,
+                               const double im_extraction_window,
+                               const bool ppm);
+
 private:
 
+    /// Extraction windows (exclusive bounds), precomputed once for all spectra
+    struct TophatWindows_
+    {
+      std::vector<double> mz; ///< target m/z (ascending)
+      std::vector<double> left; ///< lower m/z bound
+      std::vector<double> right; ///< upper m/z bound
+      std::vector<double> im_left; ///< lower ion mobility bound
+      std::vector<double> im_right; ///< upper ion mobility bound
+      std::vector<char> use_im; ///< whether to filter by ion mobility
+    };
+
+    /// Computes the windows for targets @p mz (and @p im if non-empty)
+    static void prepareTophatWindows_(const std::vector<double>& mz,
+                                      const std::vector<double>& im,
+                                      const double mz_extraction_window,
+                                      const double im_extraction_window,
+                                      const bool ppm,
+                                      TophatWindows_& windows);
+
+    /**
+     * @brief Sweeps the windows with index in @p active (ascending) over a single spectrum
+     *
+     * @p im may be nullptr, in which case no ion mobility filtering is done.
+     * Results are written to @p integrated_intensities (one per entry of @p active).
+    */
+    static void extractTophat_(const double* mz,
+                               const double* intensity,
+                               const double* im,
+                               const Size n,
+                               const TophatWindows_& windows,
+                               const std::vector<Size>& active,
+                               std::vector<double>& integrated_intensities);
+
     int getFilterNr_(const String& filter);
 
   };
@@ -0,0 +1,109 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessTransforming.h>
+#include <OpenMS/CONCEPT/Types.h>
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace OpenMS
+{
+  /**
+   * @brief A caching wrapper around spectrum access.
+   *
+   * Keeps the most recently requested spectra (keyed by their index in the
+   * underlying map) in memory and evicts the least recently used spectrum
+   * once more than @p capacity spectra are cached. This avoids repeatedly
+   * decoding the same spectra from disk-backed maps (cached mzML, sqMass)
+   * when peptides with overlapping peak groups are scored.
+   *
+   * Cached spectra are shared with the caller and must not be modified.
+   *
+   * @note The cache is not thread-safe: use lightClone() to obtain a separate
+   * instance (with its own, initially empty cache) for each thread.
+   *
+   */
+  class OPENMS_DLLAPI SpectrumAccessLRUCache :
+    public SpectrumAccessTransforming
+  {
+public:
+
+    /** @brief Constructor
+     *
+     * @param sptr The underlying spectrum access
+     * @param capacity Maximal number of spectra to keep in memory
+     *
+    */
+    explicit SpectrumAccessLRUCache(OpenSwath::SpectrumAccessPtr sptr, Size capacity);
+
+    ~SpectrumAccessLRUCache() override;
+
+    /** @brief Wraps a spectrum access in a cache if this is beneficial
+     *
+     * Returns @p sptr unchanged if @p capacity is zero, if @p sptr is
+     * empty or if it already provides in-memory access to its spectra
+     * (SpectrumAccessOpenMSInMemory or SpectrumAccessLRUCache).
+     *
+    */
+    static OpenSwath::SpectrumAccessPtr create(OpenSwath::SpectrumAccessPtr sptr, Size capacity);
+
+    boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const override;
+
+    OpenSwath::SpectrumPtr getSpectrumById(int id) override;
+
+    /// Number of spectra that were served from the cache
+    Size getNrHits() const;
+
+    /// Number of spectra that had to be fetched from the underlying spectrum access
+    Size getNrMisses() const;
+
+private:
+
+    typedef std::list<std::pair<int, OpenSwath::SpectrumPtr> > CacheList_;
+
+    Size capacity_;
+    /// Cached spectra, most recently used first
+    CacheList_ cache_;
+    std::unordered_map<int, CacheList_::iterator> cache_index_;
+
+    Size hits_;
+    Size misses_;
+
+  };
+}
+
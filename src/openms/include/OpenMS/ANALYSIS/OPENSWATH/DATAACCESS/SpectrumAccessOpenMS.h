@@ -85,6 +85,8 @@ public:
 
     OpenSwath::SpectrumPtr getSpectrumById(int id) override;
 
+    void fillSpectrumById(int id, OpenSwath::Spectrum& spectrum) override;
+
     OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const override;
 
     std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const override;
@@ -0,0 +1,203 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/KERNEL/StandardTypes.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+#include <OpenMS/OPENSWATHALGO/DATAACCESS/ISpectrumAccess.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <cstring>
+
+namespace OpenMS
+{
+
+  /**
+    @brief An implementation of the Spectrum Access interface using a memory-mapped cached mzML file
+
+    This class implements the OpenSWATH Spectrum Access interface
+    (ISpectrumAccess) on top of a cached mzML file (see CachedmzML and
+    Internal::CachedMzMLHandler) which is mapped into the address space of
+    the process instead of being read through a file stream.
+
+    The file is indexed once on construction; afterwards all accesses are
+    read-only and do not move any shared file pointer. The memory mapping
+    and the index are shared between copies, thus lightClone() is a
+    constant-time operation and a single instance may be used concurrently
+    from multiple threads.
+
+    In addition to the ISpectrumAccess interface (which copies the data into
+    newly allocated OpenSwath::BinaryDataArray objects), the data can be
+    accessed without any copy or allocation through getSpectrumViewById() and
+    getChromatogramViewById(). The returned views point directly into the
+    mapped file and remain valid as long as any copy of this object exists.
+
+    @note Since the whole file is mapped into memory, this class is only
+    suitable for 64 bit architectures when large files are accessed.
+  */
+  class OPENMS_DLLAPI SpectrumAccessOpenMSCachedMapped :
+    public OpenSwath::ISpectrumAccess
+  {
+
+public:
+
+    /**
+      @brief A read-only view on a single binary data array in the mapped file
+
+      The data is stored as (possibly unaligned) doubles, individual values
+      are thus accessed through operator[] and not through a pointer.
+    */
+    struct OPENMS_DLLAPI BinaryDataView
+    {
+      /// Pointer to the first byte of the data
+      const char* data = nullptr;
+      /// Number of data points
+      Size size = 0;
+      /// Pointer to the (not null-terminated) array description
+      const char* description = nullptr;
+      /// Length of the description
+      Size description_size = 0;
+
+      /// Returns the data point at position @p i
+      double operator[](Size i) const
+      {
+        double value;
+        std::memcpy(&value, data + i * sizeof(double), sizeof(double));
+        return value;
+      }
+
+      /// Copies all data points into @p out (resizing it)
+      void copyTo(std::vector<double>& out) const
+      {
+        out.resize(size);
+        if (size > 0) std::memcpy(out.data(), data, size * sizeof(double));
+      }
+
+      /// Returns the array description
+      std::string getDescription() const
+      {
+        return std::string(description, description_size);
+      }
+    };
+
+    /**
+      @brief A read-only view on a spectrum or chromatogram in the mapped file
+
+      The first two arrays are m/z and intensity (spectra) or RT and
+      intensity (chromatograms), followed by any additional data arrays.
+    */
+    struct OPENMS_DLLAPI DataView
+    {
+      /// MS level of the spectrum (-1 for chromatograms)
+      int ms_level = -1;
+      /// Retention time of the spectrum (-1 for chromatograms)
+      double rt = -1.0;
+      /// Pointer to the first array
+      const BinaryDataView* arrays = nullptr;
+      /// Number of arrays (at least 2)
+      Size nr_arrays = 0;
+
+      /// Number of data points
+      Size size() const { return arrays[0].size; }
+      /// The m/z (spectra) or retention time (chromatograms) array
+      const BinaryDataView& getPositionArray() const { return arrays[0]; }
+      /// The intensity array
+      const BinaryDataView& getIntensityArray() const { return arrays[1]; }
+    };
+
+    /**
+      @brief Constructor, maps the cached file into memory and indexes it
+
+      @param filename The filename of the .mzML file (it is assumed a second
+      file .mzML.cached exists).
+
+      @throws Exception::FileNotFound is thrown if the file is not found
+      @throws Exception::FileNotReadable is thrown if the file cannot be mapped
+      @throws Exception::ParseError is thrown if the file cannot be parsed
+    */
+    explicit SpectrumAccessOpenMSCachedMapped(const String& filename);
+
+    /// Destructor
+    ~SpectrumAccessOpenMSCachedMapped() override;
+
+    /// Copy constructor (shares the mapping and the index)
+    SpectrumAccessOpenMSCachedMapped(const SpectrumAccessOpenMSCachedMapped& rhs);
+
+    /// Light clone operator (shares the mapping and the index)
+    boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const override;
+
+    OpenSwath::SpectrumPtr getSpectrumById(int id) override;
+
+    void fillSpectrumById(int id, OpenSwath::Spectrum& spectrum) override;
+
+    OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const override;
+
+    std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const override;
+
+    size_t getNrSpectra() const override;
+
+    SpectrumSettings getSpectraMetaInfo(int id) const;
+
+    OpenSwath::ChromatogramPtr getChromatogramById(int id) override;
+
+    size_t getNrChromatograms() const override;
+
+    ChromatogramSettings getChromatogramMetaInfo(int id) const;
+
+    std::string getChromatogramNativeID(int id) const override;
+
+    /// Returns a zero-copy view on the spectrum at the given id
+    DataView getSpectrumViewById(int id) const;
+
+    /// Returns a zero-copy view on the chromatogram at the given id
+    DataView getChromatogramViewById(int id) const;
+
+    /// Returns the meta data of all spectra and chromatograms
+    const PeakMap& getMetaData() const;
+
+protected:
+
+    /// Copies the data of a view into newly allocated arrays
+    static std::vector<OpenSwath::BinaryDataArrayPtr> copyArrays_(const DataView& view);
+
+    struct MappedFile_;
+
+    /// Memory mapping, index and meta data (shared between all copies)
+    boost::shared_ptr<const MappedFile_> mapped_;
+  };
+
+} //end namespace
+
@@ -92,6 +92,9 @@ public:
 
     OpenSwath::SpectrumPtr getSpectrumById(int id) override;
 
+    /// Returns true: getSpectrumById hands out the spectra held in memory
+    bool hasStableSpectra() const override;
+
     OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const override;
 
     std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const override;
@@ -8,10 +8,12 @@ MRMFeatureAccessOpenMS.h
 SimpleOpenMSSpectraAccessFactory.h
 SpectrumAccessOpenMS.h
 SpectrumAccessOpenMSCached.h
+SpectrumAccessOpenMSCachedMapped.h
 SpectrumAccessOpenMSInMemory.h
 SpectrumAccessSqMass.h
 SpectrumAccessTransforming.h
 SpectrumAccessQuadMZTransforming.h
+SpectrumAccessLRUCache.h
 )
 
 ### add path to the filenames
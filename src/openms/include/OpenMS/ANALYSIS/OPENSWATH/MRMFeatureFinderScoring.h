@@ -135,6 +135,10 @@ public:
                         const PeakMap& swath_map);
 
     /** @brief Pick and score features in a single experiment from chromatograms
+     *
+     * Transition groups are picked and scored in parallel (using a
+     * thread-local picker and scorer each). The features are reported in the
+     * order of @p transition_group_map, independent of the number of threads.
      *
      * @param input The input chromatograms
      * @param output The output features with corresponding scores
@@ -304,6 +308,7 @@ private:
     bool write_log_messages_;
 
     double im_extra_drift_;
+    Size spectrum_cache_size_;
 
     // members
     std::map<OpenMS::String, const PeptideType*> PeptideRefMap_;
@@ -42,6 +42,8 @@
 #include <OpenMS/KERNEL/FeatureMap.h>
 
 #include <fstream>
+#include <memory>
+#include <mutex>
 
 namespace OpenMS
 {
@@ -114,6 +116,8 @@ namespace OpenMS
    */
   class OPENMS_DLLAPI OpenSwathOSWWriter
   {
+    class BackgroundWriter_;
+
     String output_filename_;
     String input_filename_;
     OpenMS::UInt64 run_id_;
@@ -121,9 +125,42 @@ namespace OpenMS
     bool use_ms1_traces_;
     bool sonar_;
     bool enable_uis_scoring_;
+    /// Writer thread used by queueRows (started on first use, shared between copies)
+    std::shared_ptr<BackgroundWriter_> background_writer_;
+    /// Guards starting the writer thread (shared between copies, so that copies remain cheap)
+    std::shared_ptr<std::mutex> writer_mutex_;
 
   public:
 
+    /**
+      @brief Binary representation of the OSW rows generated from a set of features
+
+      Each table is stored row-major: every row consists of a fixed number of
+      integer columns followed by a fixed number of real columns. Real values
+      which are NaN are written as NULL. The rows are inserted using prepared
+      statements, avoiding formatting and parsing of SQL text.
+    */
+    struct FeatureRows
+    {
+      struct Table
+      {
+        std::vector<Int64> int_values;
+        std::vector<double> real_values;
+      };
+
+      Table feature;
+      Table feature_ms1;
+      Table feature_precursor;
+      Table feature_ms2;
+      Table feature_transition; ///< transition-level scores of the detecting transitions
+      Table feature_transition_uis; ///< transition-level scores of the identifying transitions (UIS scoring)
+
+      bool empty() const;
+
+      /// Append all rows of @p other
+      void append(const FeatureRows& other);
+    };
+
     OpenSwathOSWWriter(const String& output_filename,
                        const UInt64 run_id,
                        const String& input_filename = "inputfile",
@@ -198,6 +235,51 @@ namespace OpenMS
      */
     void writeLines(const std::vector<String>& to_osw_output);
 
+    /**
+     * @brief Prepare the rows of all features of a transition group for bulk insertion
+     *
+     * Produces the same rows as prepareLine, but keeps the values in binary
+     * form so they can be bound to prepared statements by writeRows or
+     * queueRows.
+     *
+     * @param output The feature map containing all features (each feature will generate one entry in the output)
+     * @param id The transition group identifier (peptide/metabolite id)
+     * @param rows The rows are appended here
+     *
+     * @throw Exception::ConversionError if an identifier is not an integer
+     *
+     */
+    void prepareRows(const FeatureMap& output, const String& id, FeatureRows& rows) const;
+
+    /**
+     * @brief Write rows to disk using prepared statements (in a single transaction)
+     *
+     * @note Only call inside an OpenMP critical section
+     *
+     */
+    void writeRows(const FeatureRows& rows);
+
+    /**
+     * @brief Hand rows over to a background thread which writes them to disk
+     *
+     * The writer thread keeps the database connection and the prepared
+     * statements open and inserts each batch in its own transaction, so
+     * scoring threads only have to wait if the writer falls behind by many
+     * batches. Can be called from multiple threads concurrently.
+     *
+     * @throw Exception::SqlOperationFailed if writing a previous batch failed
+     *
+     */
+    void queueRows(FeatureRows&& rows);
+
+    /**
+     * @brief Block until all rows passed to queueRows are written
+     *
+     * @throw Exception::SqlOperationFailed if writing failed
+     *
+     */
+    void flush();
+
   };
 
 }
@@ -120,13 +120,8 @@ protected:
     /** @brief Constructor
      *
      *  @param use_ms1_traces Whether to use MS1 data
-     *  @param threads_outer_loop How many threads should be used for the outer
-     *  loop (-1 will use all threads in the outer loop)
-     *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
-     *
+     *  @param threads_outer_loop How many SWATH windows should be processed
+     *  at once (-1 will not limit the number of windows)
      *
      **/
     OpenSwathWorkflowBase(bool use_ms1_traces, bool use_ms1_ion_mobility, bool prm, bool pasef, int threads_outer_loop) :
@@ -143,7 +138,7 @@ protected:
      *
      * @param swath_maps The raw data (swath maps)
      * @param ms1_chromatograms Output vector for MS1 chromatograms
-     * @param chromConsumer Chromatogram consumer object to store the extracted chromatograms
+     * @param chromConsumer Chromatogram consumer object to store the extracted chromatograms (may be nullptr if the caller writes them itself)
      * @param cp Parameter set for the chromatogram extraction
      * @param transition_exp The set of assays to be extracted and scored
      * @param trafo_inverse Inverse transformation function
@@ -222,13 +217,13 @@ protected:
     */
     bool pasef_;
 
-    /** @brief How many threads should be used for the outer loop
+    /** @brief How many SWATH windows should be processed at once
      *
-     *  @note A value of -1 will use all threads in the outer loop
+     *  OpenSwathWorkflow::performExtraction schedules all (window, batch)
+     *  pairs as tasks on a single team of threads; this limits the number of
+     *  windows in flight (and thus the memory used with load_into_memory).
      *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
+     *  @note A value of -1 will not limit the number of windows
      *
      **/
     int threads_outer_loop_;
@@ -414,15 +409,9 @@ protected:
      *
      *  @param use_ms1_traces Whether to use MS1 data
      *  @param use_ms1_ion_mobility Whether to use ion mobility extraction on MS1 traces
-     *  @param threads_outer_loop How many threads should be used for the outer
-     *  loop (-1 will use all threads in the outer loop)
+     *  @param threads_outer_loop How many SWATH windows should be processed at once (-1 will not limit the number of windows, see performExtraction)
      *  @param prm Whether data is acquired in targeted DIA (e.g. PRM mode) with potentially overlapping windows
      *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
-     *
-     *
      **/
     OpenSwathWorkflow(bool use_ms1_traces, bool use_ms1_ion_mobility, bool prm, bool pasef, int threads_outer_loop) :
     OpenSwathWorkflowBase(use_ms1_traces, use_ms1_ion_mobility, prm, pasef, threads_outer_loop)
@@ -453,6 +442,14 @@ protected:
      * potentially decrease the utility of parallelization while loading data
      * into memory will increase memory usage but decrease execution time.
      *
+     * @note Every (window, batch) pair is processed as an independent task
+     * and the tasks are distributed dynamically over all threads (no nested
+     * parallelism). Features, MS1 and MS2 chromatograms and tsv/osw rows are written in
+     * task order. Tasks are started in order and only while few enough earlier
+     * results are waiting to be written (and, if threads_outer_loop is set, while
+     * no more than threads_outer_loop windows are in flight). A summary of the
+     * time spent in extraction and scoring is printed at the end.
+     *
     */
     void performExtraction(const std::vector< OpenSwath::SwathMap > & swath_maps,
                            const TransformationDescription trafo,
@@ -526,6 +523,8 @@ protected:
      * @param tsv_writer TSV writer for storing output (on the fly)
      * @param osw_writer OSW Writer object to store identified features in SQLite format
      * @param ms1only If true, will only score on MS1 level and ignore MS2 level
+     * @param tsv_output If given, TSV lines are appended here instead of being written with @p tsv_writer
+     * @param osw_output If given, OSW rows are appended here instead of being queued on @p osw_writer
      *
     */
     void scoreAllChromatograms_(
@@ -540,7 +539,9 @@ protected:
         OpenSwathTSVWriter & tsv_writer,
         OpenSwathOSWWriter & osw_writer,
         int nr_ms1_isotopes = 0,
-        bool ms1only = false) const;
+        bool ms1only = false,
+        std::vector< String >* tsv_output = nullptr,
+        OpenSwathOSWWriter::FeatureRows* osw_output = nullptr) const;
 
     /** @brief Select which compounds to analyze in the next batch (and copy to output)
      *
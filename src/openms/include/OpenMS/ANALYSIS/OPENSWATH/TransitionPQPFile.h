@@ -36,6 +36,10 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/TransitionTSVFile.h>
 
+// forward declarations
+struct sqlite3;
+struct sqlite3_stmt;
+
 namespace OpenMS
 {
 
@@ -227,6 +231,39 @@ private:
     */
     void readPQPInput_(const char* filename, std::vector<TSVTransition>& transition_list, bool legacy_traml_id = false);
 
+    /** @brief Read PQP SQLite file directly into a LightTargetedExperiment
+     *
+     * Streams the rows of the SQLite result set into LightTransition objects
+     * without materializing the full list of TSVTransition first. Only one
+     * row per transition group is kept in the intermediate representation to
+     * construct the compound (peptide or metabolite). Transition group and
+     * protein identifiers are looked up in hash tables so that each compound
+     * and protein is created exactly once.
+     *
+     * @note Identifier strings are not shared: every LightTransition holds its
+     * own copy of its transition group identifier (peptide_ref), since the
+     * members of LightTransition are plain std::string.
+     *
+     * @param filename The input file
+     * @param targeted_exp The output targeted experiment
+     * @param legacy_traml_id Should legacy TraML IDs be used (boolean)?
+     *
+    */
+    void readPQPInput_(const char* filename, OpenSwath::LightTargetedExperiment& targeted_exp, bool legacy_traml_id = false);
+
+    /** @brief Build the SQL select statement to read all transitions from a PQP file
+     *
+     * @param db The open PQP database
+     * @param legacy_traml_id Should legacy TraML IDs be used (boolean)?
+     * @param drift_time_exists Set to true if the file contains precursor drift times
+     * @param gene_exists Set to true if the file contains gene information
+     *
+    */
+    String getSelectStatement_(sqlite3* db, bool legacy_traml_id, bool& drift_time_exists, bool& gene_exists) const;
+
+    /// Read the current row of a statement prepared from getSelectStatement_() into a TSVTransition
+    void readTransitionRow_(sqlite3_stmt* stmt, TSVTransition& mytransition, bool drift_time_exists, bool gene_exists) const;
+
     /** @brief Write a TargetedExperiment to a file
      *
      * @param filename Name of the output file
@@ -225,6 +225,51 @@ protected:
     TransitionTSVFile::TSVTransition convertTransition_(const ReactionMonitoringTransition* it, OpenMS::TargetedExperiment& targeted_exp);
     //@}
 
+    /** @name Conversion helper functions
+     *
+    */
+    //@{
+
+    /** @brief Resolve cases where the same peptide label group has different sequences.
+     *
+     * Since members in a peptide label group (MS:1000893) should only be
+     * isotopically modified forms of the same peptide, having different
+     * peptide sequences (different AA sequences) within the same group most likely
+     * constitutes an error. This function will fix the error by erasing the
+     * provided "peptide group label" for a peptide and replace it with the
+     * peptide identifier (transition group id).
+     *
+     * @param transition_list The list of transitions to be fixed.
+     *
+     */
+    void resolveMixedSequenceGroups_(std::vector<TSVTransition>& transition_list) const;
+
+    /// Populate a new ReactionMonitoringTransition object from a row in the csv
+    void createTransition_(std::vector<TSVTransition>::iterator& tr_it,
+                           OpenMS::ReactionMonitoringTransition& rm_trans);
+
+    /// Populate a new TargetedExperiment::Protein object from a row in the csv
+    void createProtein_(String protein_name, String uniprot_id,
+                        OpenMS::TargetedExperiment::Protein& protein);
+
+    /// Helper function to assign retention times to compounds and peptides
+    void interpretRetentionTime_(std::vector<TargetedExperiment::RetentionTime>& retention_times,
+                                 const OpenMS::DataValue rt_value);
+
+    /// Populate a new TargetedExperiment::Peptide object from a row in the csv
+    void createPeptide_(std::vector<TSVTransition>::const_iterator tr_it,
+                        OpenMS::TargetedExperiment::Peptide& peptide);
+
+    /// Populate a new TargetedExperiment::Compound object (a metabolite) from a row in the csv
+    void createCompound_(std::vector<TSVTransition>::const_iterator tr_it,
+                         OpenMS::TargetedExperiment::Compound& compound);
+
+    /// Add a modification at the specified location
+    void addModification_(std::vector<TargetedExperiment::Peptide::Modification>& mods,
+                          int location,
+                          const ResidueModification& rmod);
+    //@}
+
     /// Synchronize members with param class
     void updateMembers_() override;
 
@@ -278,51 +323,6 @@ private:
     void cleanupTransitions_(TSVTransition& mytransition);
     //@}
 
-    /** @name Conversion helper functions
-     *
-    */
-    //@{
-
-    /** @brief Resolve cases where the same peptide label group has different sequences.
-     *
-     * Since members in a peptide label group (MS:1000893) should only be
-     * isotopically modified forms of the same peptide, having different
-     * peptide sequences (different AA sequences) within the same group most likely
-     * constitutes an error. This function will fix the error by erasing the
-     * provided "peptide group label" for a peptide and replace it with the
-     * peptide identifier (transition group id).
-     *
-     * @param transition_list The list of transitions to be fixed.
-     *
-     */
-    void resolveMixedSequenceGroups_(std::vector<TSVTransition>& transition_list) const;
-
-    /// Populate a new ReactionMonitoringTransition object from a row in the csv
-    void createTransition_(std::vector<TSVTransition>::iterator& tr_it,
-                           OpenMS::ReactionMonitoringTransition& rm_trans);
-
-    /// Populate a new TargetedExperiment::Protein object from a row in the csv
-    void createProtein_(String protein_name, String uniprot_id,
-                        OpenMS::TargetedExperiment::Protein& protein);
-
-    /// Helper function to assign retention times to compounds and peptides
-    void interpretRetentionTime_(std::vector<TargetedExperiment::RetentionTime>& retention_times,
-                                 const OpenMS::DataValue rt_value);
-
-    /// Populate a new TargetedExperiment::Peptide object from a row in the csv
-    void createPeptide_(std::vector<TSVTransition>::const_iterator tr_it,
-                        OpenMS::TargetedExperiment::Peptide& peptide);
-
-    /// Populate a new TargetedExperiment::Compound object (a metabolite) from a row in the csv
-    void createCompound_(std::vector<TSVTransition>::const_iterator tr_it,
-                         OpenMS::TargetedExperiment::Compound& compound);
-
-    /// Add a modification at the specified location
-    void addModification_(std::vector<TargetedExperiment::Peptide::Modification>& mods,
-                          int location,
-                          const ResidueModification& rmod);
-    //@}
-
     /** @brief Write a TargetedExperiment to a file
      *
      * @param filename Name of the output file
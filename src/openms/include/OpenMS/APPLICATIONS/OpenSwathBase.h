@@ -257,12 +257,14 @@ protected:
    * @param transition_exp The spectral library
    * @param out_chrom The output file for the chromatograms
    * @param run_id Unique identifier which links the sqMass and OSW file
+   * @param chrom_block_size Number of chromatograms stored together in one sqMass data block (0 stores them individually)
    */
   void prepareChromOutput(Interfaces::IMSDataConsumer ** chromatogramConsumer,
                           const boost::shared_ptr<ExperimentalSettings>& exp_meta,
                           const OpenSwath::LightTargetedExperiment& transition_exp,
                           const String& out_chrom,
-                          const UInt64 run_id)
+                          const UInt64 run_id,
+                          const Size chrom_block_size = 0)
   {
     if (!out_chrom.empty())
     {
@@ -271,7 +273,7 @@ protected:
       {
         bool full_meta = false; // can lead to very large files in memory
         bool lossy_compression = true;
-        *chromatogramConsumer = new MSDataSqlConsumer(out_chrom, run_id, 500, full_meta, lossy_compression);
+        *chromatogramConsumer = new MSDataSqlConsumer(out_chrom, run_id, 500, full_meta, lossy_compression, 1e-4, chrom_block_size);
       }
       else
       {
@@ -632,6 +632,9 @@ protected:
       @param s Input string
       @param permissive If set, skip spaces and replace stop codon symbols ("*", "#", "+") by "X" (unknown amino acid) during parsing
 
+      Parsed sequences are kept in a bounded, thread-safe cache (see setParseCacheSize()), so parsing the
+      same string again (e.g. the same peptide in many PSMs) only copies the cached result.
+
       @throws Exception::ParseError if an invalid string representation of an AA sequence is passed
     */
     static AASequence fromString(const String& s,
@@ -648,6 +651,19 @@ protected:
     static AASequence fromString(const char* s,
                                  bool permissive = true);
 
+    /**
+      @brief Set the maximal number of parsed sequences kept by fromString() (default: 100000)
+
+      The least recently used sequences are evicted first. Use 0 to disable (and free) the cache.
+    */
+    static void setParseCacheSize(Size max_entries);
+
+    /// Maximal number of parsed sequences kept by fromString() (0 if the cache is disabled)
+    static Size getParseCacheSize();
+
+    /// Remove all sequences from the cache of fromString() (e.g. to free memory)
+    static void clearParseCache();
+
   protected:
 
     std::vector<const Residue*> peptide_;
@@ -38,6 +38,7 @@
 #include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/IsotopeDistribution.h>
 
 #include <set>
+#include <vector>
 
 namespace OpenMS
 {
@@ -146,6 +147,15 @@ namespace OpenMS
     */
     IsotopeDistribution estimateFromPeptideWeight(double average_weight);
 
+    /**
+       @brief Estimate peptide isotope distributions for a batch of average weights
+
+       Gives the same results as calling estimateFromPeptideWeight(double) for every weight. Averagine
+       formulas repeat a lot (every atom count covers a range of weights), so the distributions of previously
+       seen formulas are taken from a cache shared by all instances (see estimateFromWeightAndComp()).
+    */
+    std::vector<IsotopeDistribution> estimateFromPeptideWeight(const std::vector<double>& average_weights);
+
     /**
        @brief Estimate peptide IsotopeDistribution from average weight and exact number of sulfurs
 
@@ -367,6 +377,14 @@ namespace OpenMS
     /// fill a gapped isotope pattern (i.e. certain masses are missing), with zero probability masses
     IsotopeDistribution::ContainerType fillGaps_(const IsotopeDistribution::ContainerType& id) const;
 
+    /**
+       @brief Same as run(), but looks up / stores the distribution of @p formula in a (thread-safe) cache
+
+       Only used for estimated (averagine) formulas, which are few and recur for many weights.
+       The cache stores the normalized intensities per formula and maximal isotope; masses are recomputed.
+    */
+    IsotopeDistribution runCached_(const EmpiricalFormula& formula) const;
+
     /// maximal isotopes which is used to calculate the distribution
     Size max_isotope_;
     /// flag to determine whether masses should be rounded or not
@@ -38,6 +38,7 @@
 #include <OpenMS/DATASTRUCTURES/String.h>
 #include <OpenMS/CHEMISTRY/ResidueModification.h>
 
+#include <atomic>
 #include <set>
 #include <memory>  // unique_ptr
 #include <unordered_map>
@@ -71,6 +72,15 @@ namespace OpenMS
       databases. This can be done by providing a path through
       initializeModificationsDB(), however it is important that this is done
       *before* the first call to getInstance().
+
+      All lookups are thread-safe. Since modifications can be added at any
+      time (e.g. user-defined modifications encountered while parsing a
+      peptide sequence), lookups are guarded by a lock by default. Once all
+      modifications needed for a computation are registered, freeze() turns
+      the current content into an immutable snapshot which is searched
+      without locking. Modifications added after the first freeze() are
+      stored separately (also after unfreeze()); only lookups that may need
+      to consider them take the lock.
   */
   class OPENMS_DLLAPI ModificationsDB
   {
@@ -236,6 +246,47 @@ public:
     /// Writes tab separated entries: FullId,FullName,Origin,AA,TerminusSpecificity,DiffMonoMass (including header) to TSV file
     void writeTSV(const String& filename);
 
+    /**
+       @brief Freezes the modifications registered so far for lock-free lookups
+
+       After this call, the current content of the database is never modified
+       again (not even after unfreeze()) and all lookups on it proceed without
+       locking. Modifications can still be added, they are kept separately and
+       are found by all lookups.
+
+       Calls are counted, so independent computations may freeze the database
+       concurrently. Call this once all modifications of a computation are
+       known, e.g. before entering a parallel region which looks up
+       modifications, and call unfreeze() once the computation is done (see
+       FreezeGuard).
+    */
+    void freeze();
+
+    /**
+       @brief Releases one freeze() call
+
+       The snapshot itself stays immutable, so it is safe to call this while
+       other threads look up modifications.
+    */
+    void unfreeze();
+
+    /// Returns true if freeze() was called more often than unfreeze()
+    bool isFrozen() const;
+
+    /**
+       @brief Freezes ModificationsDB and ResidueDB for the lifetime of the guard
+
+       Guards may be nested or used from several threads at once.
+    */
+    class OPENMS_DLLAPI FreezeGuard
+    {
+    public:
+      FreezeGuard();
+      ~FreezeGuard();
+      FreezeGuard(const FreezeGuard&) = delete;
+      FreezeGuard& operator=(const FreezeGuard&) = delete;
+    };
+
   protected:
 
     /// Stores whether ModificationsDB was instantiated before
@@ -247,6 +298,42 @@ public:
     /// Stores the mappings of (unique) names to the modifications
     std::unordered_map<String, std::set<const ResidueModification*> > modification_names_;
 
+    /// Whether mods_ and modification_names_ are immutable (set by the first freeze(), never reset)
+    std::atomic<bool> frozen_{false};
+
+    /// Number of freeze() calls not yet released by unfreeze() (guarded by the lock)
+    Size freeze_count_{0};
+
+    /// Whether modifications were added after freezing
+    std::atomic<bool> has_added_{false};
+
+    /// Modifications added after the first freeze() (guarded by the lock)
+    std::vector<ResidueModification*> added_mods_;
+
+    /// Mappings of names to modifications added after the first freeze() (guarded by the lock)
+    std::unordered_map<String, std::set<const ResidueModification*> > added_names_;
+
+    /**
+       @brief Calls @p f for every modification registered under @p name
+
+       Takes the lock only if needed (i.e. if not frozen or if modifications
+       were added after freezing). Must not be called while holding the lock.
+
+       @return false if @p name is unknown
+    */
+    template <typename Function>
+    bool forEachNamed_(const String& name, Function&& f) const;
+
+    /// Calls @p f for every modification (in order of their index), takes the lock only if needed
+    template <typename Function>
+    void forEachModification_(Function&& f) const;
+
+    /// Returns the first modification registered under @p name (or nullptr), the lock must be held
+    const ResidueModification* findRegistered_(const String& name) const;
+
+    /// Registers the modification under all its names, the lock must be held
+    void registerModification_(ResidueModification* mod);
+
     /** @brief Helper function to check if a residue matches the origin for a modification
      *
      * Special cases are handled as follows:
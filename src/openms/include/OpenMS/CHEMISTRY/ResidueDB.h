@@ -41,6 +41,7 @@
 #include <map>
 #include <set>
 #include <array>
+#include <atomic>
 
 namespace OpenMS
 {
@@ -53,6 +54,11 @@ namespace OpenMS
       @brief OpenMS stores a central database of all residues in the ResidueDB.
       All (unmodified) residues are added to the database on construction.
       Modified residues get created and added if getModifiedResidue is called.
+
+      Unmodified residues never change after construction and are looked up
+      without locking. Lookups of modified residues are guarded by a lock,
+      unless freeze() was called: then all modified residues created so far
+      are found without locking (see also ModificationsDB::freeze()).
   */
   class OPENMS_DLLAPI ResidueDB
   {
@@ -142,6 +148,27 @@ public:
     bool hasResidue(const Residue* residue) const;
     //@}
 
+    /**
+       @brief Freezes the modified residues created so far for lock-free lookups
+
+       The snapshot is never modified again (not even after unfreeze()).
+       Modified residues created afterwards are kept separately and are
+       still found (using the lock). Calls are counted, see also
+       ModificationsDB::freeze() and ModificationsDB::FreezeGuard.
+    */
+    void freeze();
+
+    /**
+       @brief Releases one freeze() call
+
+       The snapshot itself stays immutable, so it is safe to call this while
+       other threads look up residues.
+    */
+    void unfreeze();
+
+    /// Returns true if freeze() was called more often than unfreeze()
+    bool isFrozen() const;
+
 protected:
     /// initializes all residues by building
     void initResidues_();
@@ -177,6 +204,13 @@ protected:
 
     /// adds names of single modified residue to the index
     void addModifiedResidueNames_(const Residue*);
+
+    /// looks up a modified residue by residue name and modification id in @p mod_names (nullptr if not present)
+    static const Residue* findModifiedResidue_(const std::map<String, std::map<String, const Residue*> >& mod_names,
+                                               const String& res_name, const ResidueModification* mod);
+
+    /// looks up (and creates if needed) a modified residue, the lock must be held
+    const Residue* getOrCreateModifiedResidue_(const String& res_name, const ResidueModification* mod);
     
     std::map<String, std::map<String, const Residue*> > residue_mod_names_;
 
@@ -195,5 +229,17 @@ protected:
     std::array<const Residue*, 256> residue_by_one_letter_code_ = {{nullptr}};
 
     std::map<String, std::set<const Residue*> > residues_by_set_;    
+
+    /// whether residue_mod_names_ and const_modified_residues_ are immutable (set by the first freeze(), never reset)
+    std::atomic<bool> frozen_{false};
+
+    /// number of freeze() calls not yet released by unfreeze() (guarded by the lock)
+    Size freeze_count_{0};
+
+    /// lookup of modified residues created after the first freeze() (guarded by the lock)
+    std::map<String, std::map<String, const Residue*> > added_residue_mod_names_;
+
+    /// modified residues created after the first freeze() (guarded by the lock)
+    std::set<const Residue*> added_modified_residues_;
   };
 }
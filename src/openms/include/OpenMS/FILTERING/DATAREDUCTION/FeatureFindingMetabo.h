@@ -309,7 +309,8 @@ private:
      * all combinations of charge and isotopic positions on the candidates. It
      * is assumed that candidates[0] is the monoisotopic trace.
      *
-     * The resulting possible groupings are appended to output_hypotheses.
+     * The resulting possible groupings are appended to output_hypotheses
+     * (without synchronization, concurrent calls need separate vectors).
     */
     void findLocalFeatures_(const std::vector<const MassTrace*>& candidates, double total_intensity, std::vector<FeatureHypothesis>& output_hypotheses) const;
 
@@ -40,6 +40,8 @@
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 
+#include <boost/dynamic_bitset_fwd.hpp>
+
 namespace OpenMS
 {
 
@@ -65,6 +67,13 @@ namespace OpenMS
       length as well as having the minimal sample rate criterion fulfilled) get
       added to the result.
 
+      Mass traces are extended from several apices concurrently (if OpenMP is
+      enabled). Traces are still accepted strictly in order of decreasing apex
+      intensity and a trace is re-extended whenever one of the peaks it
+      depends on was claimed by a more intense trace in the meantime, so the
+      result is identical to a serial run, independent of the number of
+      threads.
+
       @htmlinclude OpenMS_MassTraceDetection.parameters
 
       @ingroup Quantitation
@@ -110,6 +119,24 @@ namespace OpenMS
           Size peak_idx;
         };
 
+        /// A mass trace grown from a single apex (see extendTrace_)
+        struct TraceCandidate;
+
+        /**
+          @brief Extends a mass trace from @p apex in both RT directions
+
+          Only reads @p peak_visited, so several traces can be extended
+          concurrently. Records all peaks whose (unvisited) state influenced
+          the result, which allows to check later whether the trace is still
+          valid after other traces were accepted.
+        */
+        void extendTrace_(const Apex& apex,
+                          const PeakMap& work_exp,
+                          const std::vector<Size>& spec_offsets,
+                          const boost::dynamic_bitset<>& peak_visited,
+                          const int fwhm_meta_idx,
+                          TraceCandidate& candidate);
+
         /// The internal run method
         void run_(const std::vector<Apex>& chrom_apices,
                   const Size peak_count,
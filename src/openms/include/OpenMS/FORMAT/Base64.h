@@ -79,6 +79,14 @@ public:
       BYTEORDER_LITTLEENDIAN            ///< Little endian type
     };
 	
+    /// Instruction sets available for decoding uncompressed Base64 data
+    enum SIMDLevel
+    {
+      SIMD_NONE,                        ///< Scalar (table-based) decoding
+      SIMD_SSE41,                       ///< 16 characters per step using SSE4.1
+      SIMD_AVX2                         ///< 32 characters per step using AVX2
+    };
+
     /**
         @brief Encodes a vector of floating point numbers to a Base64 string
 
@@ -149,6 +157,28 @@ public:
     */
     static void decodeSingleString(const String& in, QByteArray& base64_uncompressed, bool zlib_compression);
 
+    /**
+        @brief Returns the most advanced instruction set usable for decoding
+
+        Determined once at runtime from the CPU capabilities. Always SIMD_NONE on non-x86-64 platforms.
+    */
+    static SIMDLevel getSupportedSIMDLevel();
+
+    /**
+        @brief Decodes Base64 characters (without padding) to raw bytes
+
+        Decoding stops when either all @p in_size characters are consumed or @p out_size bytes are written.
+        Used by decode() for uncompressed data with the level returned by getSupportedSIMDLevel().
+
+        @param in Base64 characters without trailing '=' padding
+        @param in_size Number of characters in @p in
+        @param out Output buffer
+        @param out_size Size of @p out in bytes
+        @param level Instruction set to use (must not exceed getSupportedSIMDLevel())
+        @return The number of bytes written
+    */
+    static Size decodeBytes(const char* in, Size in_size, Byte* out, Size out_size, SIMDLevel level);
+
 private:
 
     ///Internal class needed for type-punning
@@ -167,6 +197,13 @@ private:
 
     static const char encoder_[];
     static const char decoder_[];
+
+    /// Returns the 6 bit value of a Base64 character
+    static inline UInt32 sextet_(const char c)
+    {
+      return (UInt32)(decoder_[(int)c - 43] - 62) & 0x3F;
+    }
+
     /// Decodes a Base64 string to a vector of floating point numbers
     template <typename ToType>
     static void decodeUncompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out);
@@ -429,94 +466,44 @@ private:
 
     src_size -= padding;
 
-    UInt a;
-    UInt b;
-
-    UInt offset = 0;
-    int inc = 1;
-    UInt written = 0;
-
     const Size element_size = sizeof(ToType);
 
-    // enough for either float or double
-    char element[8] = "\x00\x00\x00\x00\x00\x00\x00";
-
-    // Parse little endian data in big endian OpenMS (or other way round)
-    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || 
-       (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
-    {
-      offset = (element_size - 1);              // other endian
-      inc = -1;
-    }
-    else
+    // decode directly into the output vector (an incomplete trailing element is dropped)
+    out.resize((src_size * 3 / 4) / element_size);
+    if (out.empty())
     {
-      offset = 0;
-      inc = 1;
+      return;
     }
 
-    //reserve enough space in the output vector
-    out.reserve((UInt)(std::ceil((4.0 * src_size) / 3.0) + 6.0));
-
-    // sort all read bytes correctly into a char[4] (double) or
-    // char[8] (float) and push_back when necessary.
-    for (Size i = 0; i < src_size; i += 4)
-    {
-      // decode 4 Base64-Chars to 3 Byte
-      // -------------------------------
-
-      // decode the first two chars
-      a = decoder_[(int)in[i] - 43] - 62;
-      b = decoder_[(int)in[i + 1] - 43] - 62;
-      if (i + 1 >= src_size)
-      {
-        b = 0;
-      }
-      // write first byte (6 bits from a and 2 highest bits from b)
-      element[offset] = (unsigned char) ((a << 2) | (b >> 4));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
-
-      // decode the third char
-      a = decoder_[(int)in[i + 2] - 43] - 62;
-      if (i + 2 >= src_size)
-      {
-        a = 0;
-      }
-      // write second byte (4 lowest bits from b and 4 highest bits from a)
-      element[offset] = (unsigned char) (((b & 15) << 4) | (a >> 2));
-      written++;
-      offset = (offset + inc) % element_size;
+    const bool swap_bytes = (OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) ||
+                            (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN);
+    const SIMDLevel level = getSupportedSIMDLevel();
 
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
+    Byte * dest = reinterpret_cast<Byte *>(&out[0]);
+    const Size dest_size = out.size() * element_size;
 
-      // decode the fourth char
-      b = decoder_[(int)in[i + 3] - 43] - 62;
-      if (i + 3 >= src_size)
-      {
-        b = 0;
-      }
-      // write third byte (2 lowest bits from a and 6 bits from b)
-      element[offset] = (unsigned char) (((a & 3) << 6) | b);
-      written++;
-      offset = (offset + inc) % element_size;
+    // Decode in blocks that fit into the L1 cache and change endianness (if
+    // necessary) while the block is still in cache. The block size is a
+    // multiple of 3 (4 characters) and of the element size.
+    const Size block_size = 3 * 1024;
+    for (Size block_start = 0; block_start < dest_size; block_start += block_size)
+    {
+      const Size char_start = block_start / 3 * 4;
+      const Size block_bytes = std::min(block_size, dest_size - block_start);
+      decodeBytes(in.c_str() + char_start, src_size - char_start, dest + block_start, block_bytes, level);
 
-      if (written % element_size == 0)
+      if (swap_bytes)
       {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
+        if (element_size == 4) // 32 bit
+        {
+          UInt32 * p = reinterpret_cast<UInt32 *>(dest + block_start);
+          std::transform(p, p + block_bytes / element_size, p, endianize32);
+        }
+        else // 64 bit
+        {
+          UInt64 * p = reinterpret_cast<UInt64 *>(dest + block_start);
+          std::transform(p, p + block_bytes / element_size, p, endianize64);
+        }
       }
     }
   }
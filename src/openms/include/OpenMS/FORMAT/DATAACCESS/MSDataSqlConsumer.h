@@ -77,8 +77,11 @@ namespace OpenMS
         @param full_meta Whether to write the full meta-data in the SQLite header
         @param lossy_compression Whether to use lossy compression (numpress)
         @param linear_mass_acc Desired mass accuracy for RT or m/z space (absolute value)
+        @param chrom_block_size Number of chromatograms compressed together into one CHROMATOGRAM_BLOCK (0 stores each chromatogram individually, see MzMLSqliteHandler::setChromatogramBlockSize)
+
+        @note Blocks never span two flushes, so @p buffer_size should be a multiple of @p chrom_block_size.
       */
-      MSDataSqlConsumer(const String& sql_filename, UInt64 run_id, int buffer_size = 500, bool full_meta = true, bool lossy_compression=false, double linear_mass_acc=1e-4);
+      MSDataSqlConsumer(const String& sql_filename, UInt64 run_id, int buffer_size = 500, bool full_meta = true, bool lossy_compression=false, double linear_mass_acc=1e-4, Size chrom_block_size = 0);
 
       /**
         @brief Destructor
@@ -52,6 +52,8 @@
 #include <OpenMS/FORMAT/HANDLERS/CachedMzMLHandler.h>
 #include <OpenMS/KERNEL/StandardTypes.h>
 
+#include <memory>
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -438,6 +440,9 @@ public:
 
     ~CachedSwathFileConsumer() override
     {
+      // Stop background writing before the consumers are deleted
+      background_writer_.reset();
+
       // Properly delete the MSDataCachedConsumer -> free memory and _close_ file stream
       while (!swath_consumers_.empty())
       {
@@ -451,7 +456,24 @@ public:
       }
     }
 
+    /**
+     * @brief Write the cached files on background threads
+     *
+     * By default, spectra are written to disk on the thread calling
+     * consumeSpectrum. If @p nr_threads is larger than zero, writing is handed
+     * off to @p nr_threads background threads and consumeSpectrum returns as
+     * soon as the spectrum is queued, which overlaps disk I/O with reading
+     * and decoding of the input. All spectra of one SWATH window are written
+     * by the same thread, so the order within each cached file is preserved.
+     *
+     * @note Has to be called before the first spectrum is consumed.
+     */
+    void setWriterThreads(Size nr_threads);
+
 protected:
+    /// Writes the data of @p s to @p consumer (possibly on a background thread) and leaves @p s with meta data only
+    void writeSpectrum_(MSDataCachedConsumer* consumer, Size lane, MapType::SpectrumType& s);
+
     void addNewSwathMap_()
     {
       String meta_file = cachedir_ + basename_ + "_" + String(swath_consumers_.size()) +  ".mzML";
@@ -471,7 +493,7 @@ protected:
       {
         addNewSwathMap_();
       }
-      swath_consumers_[swath_nr]->consumeSpectrum(s); // write data to cached file; clear data from spectrum s
+      writeSpectrum_(swath_consumers_[swath_nr], swath_nr + 1, s); // write data to cached file; clear data from spectrum s
       swath_maps_[swath_nr]->addSpectrum(s); // append for the metadata (actual data was deleted)
     }
 
@@ -491,12 +513,15 @@ protected:
       {
         addMS1Map_();
       }
-      ms1_consumer_->consumeSpectrum(s);
+      writeSpectrum_(ms1_consumer_, 0, s);
       ms1_map_->addSpectrum(s); // append for the metadata (actual data is deleted)
     }
 
     void ensureMapsAreFilled_() override
     {
+      // wait for all queued spectra to be written (throws if writing failed)
+      finishWriting_();
+
       size_t swath_consumers_size = swath_consumers_.size();
       bool have_ms1 = (ms1_consumer_ != nullptr);
 
@@ -543,6 +568,9 @@ protected:
       }
     }
 
+    /// Waits until all spectra handed to background threads are written
+    void finishWriting_();
+
     MSDataCachedConsumer* ms1_consumer_;
     std::vector<MSDataCachedConsumer*> swath_consumers_;
 
@@ -550,6 +578,10 @@ protected:
     String basename_;
     int nr_ms1_spectra_;
     std::vector<int> nr_ms2_spectra_;
+
+    /// Background threads writing the cached files (see setWriterThreads)
+    class BackgroundWriter_;
+    std::shared_ptr<BackgroundWriter_> background_writer_;
   };
 
   /**
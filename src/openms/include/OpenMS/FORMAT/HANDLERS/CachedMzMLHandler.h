@@ -159,6 +159,22 @@ public:
     */
     static std::vector<OpenSwath::BinaryDataArrayPtr> readSpectrumFast(std::ifstream& ifs, int& ms_level, double& rt);
 
+    /**
+      @brief Fast access to a spectrum, reusing existing data arrays
+
+      Same as above, but the spectrum is read into @p data whose arrays (and
+      their memory) are reused. Missing arrays are allocated and surplus
+      arrays are removed.
+
+      @param ifs Input file stream (moved to the correct position)
+      @param ms_level Output parameter to store the MS level of the spectrum (1, 2, 3 ...)
+      @param rt Output parameter to store the retention time of the spectrum
+      @param data Output data arrays (m/z, intensity and additional float arrays)
+
+      @throws Exception::ParseError is thrown if the spectrum cannot be read
+    */
+    static void readSpectrumFast(std::ifstream& ifs, int& ms_level, double& rt, std::vector<OpenSwath::BinaryDataArrayPtr>& data);
+
     /**
       @brief Fast access to a chromatogram
 
@@ -42,6 +42,8 @@
 #include <OpenMS/KERNEL/MSSpectrum.h>
 #include <OpenMS/KERNEL/MSChromatogram.h>
 
+#include <boost/shared_ptr.hpp>
+
 #include <string>
 #include <fstream>
 #include <unordered_map>
@@ -70,10 +72,11 @@ namespace Internal
     extracting all the offsets of the <chromatogram> and <spectrum> tags. These
     offsets are stored as members of this class as well as the offset to the <indexList> element
 
-    @note This implementation is @a not thread-safe since it keeps internally a
-    single file access pointer which it moves when accessing a specific
-    data item. The caller is responsible to ensure that access is performed
-    atomically.
+    Data is read using positional reads (pread on POSIX systems, ReadFile
+    with an explicit offset on Windows) which do not move a shared file
+    pointer. All data access functions are therefore const and may be called
+    concurrently from multiple threads on the same object. Copies of this
+    object share the underlying file handle.
 
   */
   class OPENMS_DLLAPI IndexedMzMLHandler
@@ -92,8 +95,9 @@ namespace Internal
     std::streampos index_offset_;
     /// Whether spectra are written before chromatograms in this file
     bool spectra_before_chroms_;
-    /// The current filestream (opened by openFile)
-    std::ifstream filestream_;
+    class PositionalFile_;
+    /// Shared read-only file handle for positional reads (opened by openFile)
+    boost::shared_ptr<const PositionalFile_> file_;
     /// Whether parsing the indexedmzML file was successful
     bool parsing_success_;
     /// Whether to skip XML checks
@@ -109,9 +113,12 @@ namespace Internal
     */
     void parseFooter_();
 
-    std::string getChromatogramById_helper_(int id);
+    std::string getChromatogramById_helper_(int id) const;
+
+    std::string getSpectrumById_helper_(int id) const;
 
-    std::string getSpectrumById_helper_(int id);
+    /// Reads the bytes in [start, end) from the file (thread-safe)
+    std::string readRange_(std::streampos start, std::streampos end) const;
 
     public:
 
@@ -165,7 +172,7 @@ namespace Internal
 
       @return The spectrum at position id
     */
-    OpenMS::Interfaces::SpectrumPtr getSpectrumById(int id);
+    OpenMS::Interfaces::SpectrumPtr getSpectrumById(int id) const;
 
     /**
       @brief Retrieve the raw data for the spectrum at position "id"
@@ -175,7 +182,7 @@ namespace Internal
 
       @return The spectrum at position id
     */
-    const OpenMS::MSSpectrum getMSSpectrumById(int id);
+    const OpenMS::MSSpectrum getMSSpectrumById(int id) const;
 
     /**
       @brief Retrieve the raw data for the spectrum with native id "id"
@@ -186,7 +193,7 @@ namespace Internal
       @param id The spectrum native id
       @param s The spectrum to be used and filled with data
     */
-    void getMSSpectrumByNativeId(std::string id, OpenMS::MSSpectrum& s);
+    void getMSSpectrumByNativeId(std::string id, OpenMS::MSSpectrum& s) const;
 
     /**
       @brief Retrieve the raw data for the spectrum at position "id"
@@ -197,7 +204,7 @@ namespace Internal
       @param id The spectrum id
       @param s The spectrum to be used and filled with data
     */
-    void getMSSpectrumById(int id, OpenMS::MSSpectrum& s);
+    void getMSSpectrumById(int id, OpenMS::MSSpectrum& s) const;
 
     /**
       @brief Retrieve the raw data for the chromatogram at position "id"
@@ -207,7 +214,7 @@ namespace Internal
 
       @return The chromatogram at position id
     */
-    OpenMS::Interfaces::ChromatogramPtr getChromatogramById(int id);
+    OpenMS::Interfaces::ChromatogramPtr getChromatogramById(int id) const;
 
     /**
       @brief Retrieve the raw data for the chromatogram at position "id"
@@ -217,7 +224,7 @@ namespace Internal
 
       @return The chromatogram at position id
     */
-    const OpenMS::MSChromatogram getMSChromatogramById(int id);
+    const OpenMS::MSChromatogram getMSChromatogramById(int id) const;
 
     /**
       @brief Retrieve the raw data for the chromatogram with native id "id"
@@ -228,7 +235,7 @@ namespace Internal
       @param id The chromatogram native id
       @param s The chromatogram to be used and filled with data
     */
-    void getMSChromatogramByNativeId(const std::string& id, OpenMS::MSChromatogram& c);
+    void getMSChromatogramByNativeId(const std::string& id, OpenMS::MSChromatogram& c) const;
 
     /**
       @brief Retrieve the raw data for the chromatogram at position "id"
@@ -239,7 +246,7 @@ namespace Internal
       @param id The chromatogram id
       @param c The chromatogram to be used and filled with data
     */
-    void getMSChromatogramById(int id, OpenMS::MSChromatogram& c);
+    void getMSChromatogramById(int id, OpenMS::MSChromatogram& c) const;
 
     /// Whether to skip some XML checks (removing whitespace from base64 arrays) and be fast instead
     void setSkipXMLChecks(bool skip)
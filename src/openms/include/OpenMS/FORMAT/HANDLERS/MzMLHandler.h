@@ -50,6 +50,7 @@
 #include <OpenMS/FORMAT/VALIDATORS/SemanticValidator.h>
 
 #include <map>
+#include <memory>
 
 
 //MISSING:
@@ -216,22 +217,6 @@ protected:
        */
       //@{
 
-      /**
-          @brief Populate all spectra on the stack with data from input
-
-          Will populate all spectra on the current work stack with data (using
-          multiple threads if available) and append them to the result.
-      */
-      void populateSpectraWithData_();
-
-      /**
-          @brief Populate all chromatograms on the stack with data from input
-
-          Will populate all chromatograms on the current work stack with data (using
-          multiple threads if available) and append them to the result.
-      */
-      void populateChromatogramsWithData_();
-
       /**
           @brief Add extra data arrays to a spectrum
 
@@ -462,8 +447,6 @@ protected:
         SpectrumType spectrum;
       };
 
-      /// Vector of spectrum data stored for later parallel processing
-      std::vector<SpectrumData> spectrum_data_;
 
       /**
           @brief Data necessary to generate a single chromatogram
@@ -479,8 +462,40 @@ protected:
         ChromatogramType chromatogram;
       };
 
-      /// Vector of chromatogram data stored for later parallel processing
-      std::vector<ChromatogramData> chromatogram_data_;
+      /**
+          @brief Queue a spectrum for decoding
+
+          The binary data is decoded by a pool of worker threads (if available)
+          while the XML parsing continues. Decoded spectra and chromatograms are
+          appended to the result in the order in which they were read.
+      */
+      void queueSpectrum_(SpectrumData&& spectrum_data);
+
+      /// Queue a chromatogram for decoding (see queueSpectrum_)
+      void queueChromatogram_(ChromatogramData&& chromatogram_data);
+
+      /// Create the decode queue unless only a single thread is available or we are inside an OpenMP parallel region, returns whether the queue exists
+      bool startDecodeQueue_();
+
+      /// Wait for all queued spectra and chromatograms and append them to the result
+      void flushDecodeQueue_();
+
+      /// Fill a single queued spectrum with data (thread-safe)
+      void decodeSpectrum_(SpectrumData& spectrum_data);
+
+      /// Fill a single queued chromatogram with data (thread-safe)
+      void decodeChromatogram_(ChromatogramData& chromatogram_data);
+
+      /// Append a decoded spectrum to the experiment and/or pass it to the consumer
+      void handOffSpectrum_(SpectrumType& spectrum);
+
+      /// Append a decoded chromatogram to the experiment and/or pass it to the consumer
+      void handOffChromatogram_(ChromatogramType& chromatogram);
+
+      class DecodeQueue_;
+
+      /// Bounded queue of spectra and chromatograms which are decoded by worker threads (created on demand)
+      std::unique_ptr<DecodeQueue_> decode_queue_;
 
       //@}
       
@@ -155,6 +155,26 @@ public:
         sql_batch_size_ = sql_batch_size; 
       }
 
+      /**
+          @brief Set the number of chromatograms stored together in one data block
+
+          If non-zero, chromatogram data is not written as two individual
+          blobs per chromatogram into the DATA table, but consecutive
+          chromatograms are grouped into blocks of @p block_size which are
+          compressed together and stored in the CHROMATOGRAM_BLOCK table.
+          Blocks compress considerably better than individual chromatograms
+          and allow reading many chromatograms with few SQL lookups.
+          Reading automatically detects which layout a file uses.
+
+          @note Has to be set before calling createTables()
+
+          @param block_size Number of chromatograms per block (0 disables blocks, default)
+      */
+      void setChromatogramBlockSize(Size block_size)
+      {
+        chrom_block_size_ = block_size;
+      }
+
       /**
           @brief Get spectral indices around a specific retention time
 
@@ -175,6 +195,9 @@ protected:
 
       void populateSpectraWithData_(sqlite3 *db, std::vector<MSSpectrum>& spectra, const std::vector<int> & indices) const;
 
+      /// Fill chromatograms with data stored in the CHROMATOGRAM_BLOCK table (decodes blocks in parallel)
+      void populateChromatogramsFromBlocks_(sqlite3 *db, std::vector<MSChromatogram>& chromatograms, const std::vector<int> & indices = {}) const;
+
       void prepareChroms_(sqlite3 *db, std::vector<MSChromatogram>& chromatograms, const std::vector<int> & indices = {}) const;
 
       void prepareSpectra_(sqlite3 *db, std::vector<MSSpectrum>& spectra, const std::vector<int> & indices = {}) const;
@@ -235,6 +258,9 @@ public:
 protected:
 
       void createIndices_();
+
+      /// Write the data of chromatograms in blocks of chrom_block_size_ (starting at SQL id @p first_chrom_id)
+      void writeChromatogramBlocks_(sqlite3 *db, const std::vector<MSChromatogram>& chroms, Int first_chrom_id);
       //@}
 
       String filename_;
@@ -249,12 +275,14 @@ protected:
       */
       Int spec_id_;
       Int chrom_id_;
+      Int chrom_block_id_;
       UInt64 run_id_;
 
       bool use_lossy_compression_;
       double linear_abs_mass_acc_; 
       double write_full_meta_; 
       int sql_batch_size_; 
+      Size chrom_block_size_;
     };
 
 
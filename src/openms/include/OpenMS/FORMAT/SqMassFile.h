@@ -67,6 +67,7 @@ public:
       bool write_full_meta{true}; ///< write full meta data
       bool use_lossy_numpress{false}; ///< use lossy numpress compression
       double linear_fp_mass_acc{-1}; ///< desired mass accuracy for numpress linear encoding (-1 no effect, use 0.0001 for 0.2 ppm accuracy @ 500 m/z)
+      Size chrom_block_size{0}; ///< number of chromatograms compressed together into one data block (0 stores each chromatogram individually)
     };
 
     typedef MSExperiment MapType;
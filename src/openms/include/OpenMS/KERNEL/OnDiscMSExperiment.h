@@ -54,9 +54,11 @@ namespace OpenMS
 
     @ingroup Kernel
 
-    @note This implementation is @a not thread-safe since it keeps internally a
-    single file access pointer which it moves when accessing a specific
-    data item. Please provide a separate copy to each thread, e.g. 
+    @note Access by index (getSpectrum, getChromatogram, getSpectrumById,
+    getChromatogramById) is thread-safe and the same object may be shared by
+    multiple threads, since the underlying IndexedMzMLHandler only uses
+    positional reads. Access by native id lazily builds a lookup table and is
+    @a not thread-safe; provide a separate copy to each thread in this case, e.g.
 
     @code
     #pragma omp parallel for firstprivate(ondisc_map) 
@@ -173,7 +175,7 @@ public:
     }
 
     /// alias for getSpectrum
-    inline MSSpectrum operator[](Size n)
+    inline MSSpectrum operator[](Size n) const
     {
       return getSpectrum(n);
     }
@@ -183,7 +185,7 @@ public:
 
       @param id The index of the spectrum
     */
-    MSSpectrum getSpectrum(Size id)
+    MSSpectrum getSpectrum(Size id) const
     {
       if (!meta_ms_experiment_) return indexed_mzml_file_.getMSSpectrumById(int(id));
 
@@ -195,7 +197,7 @@ public:
     /**
       @brief returns a single spectrum
     */
-    OpenMS::Interfaces::SpectrumPtr getSpectrumById(Size id)
+    OpenMS::Interfaces::SpectrumPtr getSpectrumById(Size id) const
     {
       return indexed_mzml_file_.getSpectrumById((int)id);
     }
@@ -205,7 +207,7 @@ public:
 
       @param id The index of the chromatogram
     */
-    MSChromatogram getChromatogram(Size id)
+    MSChromatogram getChromatogram(Size id) const
     {
       if (!meta_ms_experiment_) return indexed_mzml_file_.getMSChromatogramById(int(id));
 
@@ -231,7 +233,7 @@ public:
     /**
       @brief returns a single chromatogram
     */
-    OpenMS::Interfaces::ChromatogramPtr getChromatogramById(Size id);
+    OpenMS::Interfaces::ChromatogramPtr getChromatogramById(Size id) const;
 
     /// sets whether to skip some XML checks and be fast instead
     void setSkipXMLChecks(bool skip);
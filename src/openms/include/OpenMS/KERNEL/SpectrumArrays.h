@@ -0,0 +1,516 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/KERNEL/MSSpectrum.h>
+#include <OpenMS/KERNEL/Peak1D.h>
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief A spectrum stored as a structure of arrays (SoA).
+
+    In contrast to MSSpectrum, which stores a vector of Peak1D (16 bytes per
+    peak including padding), this class keeps m/z and intensity values in two
+    separate contiguous arrays. Algorithms that only scan one dimension (e.g.
+    a binary search on m/z or a sum over intensities) touch less memory and
+    the data can be handed to vectorized code directly.
+
+    The m/z type is a template parameter: with @p MZType = double, a peak uses
+    12 bytes, with @p MZType = float only 8 bytes (at the cost of about 7
+    significant digits, i.e. sub-ppm precision up to m/z ~ 10000).
+    Intensities are always stored as float, as in Peak1D.
+
+    Read access via operator[] and the const iterators returns lightweight
+    peak values (see ConstPeak) that provide getMZ() and getIntensity(), so
+    generic algorithms written for MSSpectrum (e.g. SignalToNoiseEstimatorMedian,
+    PeakPickerHiRes) can be applied to this container as well.
+
+    Only peak data and float data arrays (e.g. ion mobility) are stored. Use
+    SpectrumArrays(const MSSpectrum&) and toSpectrum() to convert from and to
+    MSSpectrum; meta data stays with the MSSpectrum.
+
+    @ingroup Kernel
+  */
+  template <typename MZType = double>
+  class SpectrumArrays
+  {
+public:
+
+    ///@name Type definitions
+    ///@{
+    /// Peak type used for insertion (compatible to MSSpectrum)
+    typedef Peak1D PeakType;
+    /// Coordinate type of the interface (values are stored as MZType)
+    typedef Peak1D::CoordinateType CoordinateType;
+    /// Intensity type
+    typedef Peak1D::IntensityType IntensityType;
+    /// Float data array type
+    typedef MSSpectrum::FloatDataArray FloatDataArray;
+    /// Float data arrays type
+    typedef MSSpectrum::FloatDataArrays FloatDataArrays;
+    ///@}
+
+    /**
+      @brief Read-only value of a single peak.
+
+      Returned by value from operator[] and the iterators.
+    */
+    class ConstPeak
+    {
+public:
+      typedef SpectrumArrays::CoordinateType CoordinateType;
+      typedef SpectrumArrays::IntensityType IntensityType;
+
+      ConstPeak(MZType mz, IntensityType intensity) :
+        mz_(mz),
+        intensity_(intensity)
+      {}
+
+      CoordinateType getMZ() const { return mz_; }
+      CoordinateType getPos() const { return mz_; }
+      IntensityType getIntensity() const { return intensity_; }
+
+      /// Conversion to a Peak1D
+      operator PeakType() const { return PeakType(mz_, intensity_); }
+
+private:
+      MZType mz_;
+      IntensityType intensity_;
+    };
+
+    /**
+      @brief Random access iterator over the peaks of a SpectrumArrays.
+
+      Dereferencing yields a ConstPeak by value.
+    */
+    class ConstIterator
+    {
+public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef ConstPeak value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef ConstPeak reference;
+
+      /// Helper to support operator-> on a temporary peak
+      struct pointer
+      {
+        ConstPeak peak;
+        const ConstPeak* operator->() const { return &peak; }
+      };
+
+      ConstIterator() = default;
+
+      ConstIterator(const SpectrumArrays* spectrum, Size index) :
+        spectrum_(spectrum),
+        index_(index)
+      {}
+
+      reference operator*() const { return (*spectrum_)[index_]; }
+      pointer operator->() const { return pointer{(*spectrum_)[index_]}; }
+      reference operator[](difference_type n) const { return (*spectrum_)[index_ + n]; }
+
+      ConstIterator& operator++() { ++index_; return *this; }
+      ConstIterator operator++(int) { ConstIterator tmp(*this); ++index_; return tmp; }
+      ConstIterator& operator--() { --index_; return *this; }
+      ConstIterator operator--(int) { ConstIterator tmp(*this); --index_; return tmp; }
+      ConstIterator& operator+=(difference_type n) { index_ += n; return *this; }
+      ConstIterator& operator-=(difference_type n) { index_ -= n; return *this; }
+      ConstIterator operator+(difference_type n) const { return ConstIterator(spectrum_, index_ + n); }
+      ConstIterator operator-(difference_type n) const { return ConstIterator(spectrum_, index_ - n); }
+      difference_type operator-(const ConstIterator& rhs) const { return difference_type(index_) - difference_type(rhs.index_); }
+
+      bool operator==(const ConstIterator& rhs) const { return index_ == rhs.index_; }
+      bool operator!=(const ConstIterator& rhs) const { return index_ != rhs.index_; }
+      bool operator<(const ConstIterator& rhs) const { return index_ < rhs.index_; }
+      bool operator>(const ConstIterator& rhs) const { return index_ > rhs.index_; }
+      bool operator<=(const ConstIterator& rhs) const { return index_ <= rhs.index_; }
+      bool operator>=(const ConstIterator& rhs) const { return index_ >= rhs.index_; }
+
+      /// Index of the peak this iterator points to
+      Size getIndex() const { return index_; }
+
+private:
+      const SpectrumArrays* spectrum_ = nullptr;
+      Size index_ = 0;
+    };
+    typedef ConstIterator const_iterator;
+
+    ///@name Constructors and assignment
+    ///@{
+    /// Default constructor
+    SpectrumArrays() = default;
+
+    /// Conversion from MSSpectrum (peaks and float data arrays)
+    explicit SpectrumArrays(const MSSpectrum& spectrum)
+    {
+      assign(spectrum);
+    }
+
+    /// Replace the content with the peaks and float data arrays of @p spectrum
+    void assign(const MSSpectrum& spectrum)
+    {
+      const Size n = spectrum.size();
+      mz_.resize(n);
+      intensity_.resize(n);
+      for (Size i = 0; i < n; ++i)
+      {
+        mz_[i] = MZType(spectrum[i].getMZ());
+        intensity_[i] = spectrum[i].getIntensity();
+      }
+      float_data_arrays_ = spectrum.getFloatDataArrays();
+    }
+    ///@}
+
+    /**
+      @brief Writes peaks and float data arrays into @p spectrum
+
+      Existing peaks and float data arrays of @p spectrum are replaced, all
+      other (meta) data is left untouched.
+    */
+    void toSpectrum(MSSpectrum& spectrum) const
+    {
+      const Size n = size();
+      spectrum.resize(n);
+      for (Size i = 0; i < n; ++i)
+      {
+        spectrum[i].setMZ(mz_[i]);
+        spectrum[i].setIntensity(intensity_[i]);
+      }
+      spectrum.setFloatDataArrays(float_data_arrays_);
+    }
+
+    ///@name Peak access
+    ///@{
+    Size size() const { return mz_.size(); }
+    bool empty() const { return mz_.empty(); }
+
+    void reserve(Size n)
+    {
+      mz_.reserve(n);
+      intensity_.reserve(n);
+    }
+
+    /// Removes all peaks and float data arrays
+    void clear()
+    {
+      mz_.clear();
+      intensity_.clear();
+      float_data_arrays_.clear();
+    }
+
+    void push_back(const PeakType& peak)
+    {
+      push_back(peak.getMZ(), peak.getIntensity());
+    }
+
+    void push_back(CoordinateType mz, IntensityType intensity)
+    {
+      mz_.push_back(MZType(mz));
+      intensity_.push_back(intensity);
+    }
+
+    ConstPeak operator[](Size i) const { return ConstPeak(mz_[i], intensity_[i]); }
+
+    ConstIterator begin() const { return ConstIterator(this, 0); }
+    ConstIterator end() const { return ConstIterator(this, size()); }
+
+    /// Contiguous m/z values
+    const std::vector<MZType>& getMZArray() const { return mz_; }
+    /// Contiguous m/z values (mutable, keep the same length as the intensity array)
+    std::vector<MZType>& getMZArray() { return mz_; }
+    /// Contiguous intensity values
+    const std::vector<IntensityType>& getIntensityArray() const { return intensity_; }
+    /// Contiguous intensity values (mutable, keep the same length as the m/z array)
+    std::vector<IntensityType>& getIntensityArray() { return intensity_; }
+
+    const FloatDataArrays& getFloatDataArrays() const { return float_data_arrays_; }
+    FloatDataArrays& getFloatDataArrays() { return float_data_arrays_; }
+    ///@}
+
+    /// Number of bytes needed to store a single peak (m/z and intensity)
+    static constexpr Size bytesPerPeak() { return sizeof(MZType) + sizeof(IntensityType); }
+
+    ///@name Sorting and searching
+    ///@{
+    /// Checks if all peaks are sorted with respect to ascending m/z
+    bool isSorted() const
+    {
+      return std::is_sorted(mz_.begin(), mz_.end());
+    }
+
+    /**
+      @brief Sorts the peaks by ascending m/z
+
+      Float data arrays of the same length as the peak arrays are permuted accordingly.
+    */
+    void sortByPosition()
+    {
+      if (isSorted())
+      {
+        return;
+      }
+      std::vector<Size> order(size());
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(), [this](Size a, Size b) { return mz_[a] < mz_[b]; });
+
+      permute_(mz_, order);
+      permute_(intensity_, order);
+      for (auto& fda : float_data_arrays_)
+      {
+        if (fda.size() == order.size())
+        {
+          std::vector<float> tmp(order.size());
+          for (Size i = 0; i < order.size(); ++i)
+          {
+            tmp[i] = fda[order[i]];
+          }
+          std::copy(tmp.begin(), tmp.end(), fda.begin());
+        }
+      }
+    }
+
+    /**
+      @brief Index of the first peak with m/z not smaller than @p mz
+
+      @note Peaks need to be sorted by m/z.
+    */
+    Size MZBegin(CoordinateType mz) const
+    {
+      return std::lower_bound(mz_.begin(), mz_.end(), mz) - mz_.begin();
+    }
+
+    /**
+      @brief Index of the first peak with m/z larger than @p mz
+
+      @note Peaks need to be sorted by m/z.
+    */
+    Size MZEnd(CoordinateType mz) const
+    {
+      return std::upper_bound(mz_.begin(), mz_.end(), mz) - mz_.begin();
+    }
+    ///@}
+
+    bool operator==(const SpectrumArrays& rhs) const
+    {
+      return mz_ == rhs.mz_ && intensity_ == rhs.intensity_ && float_data_arrays_ == rhs.float_data_arrays_;
+    }
+
+    bool operator!=(const SpectrumArrays& rhs) const
+    {
+      return !(operator==(rhs));
+    }
+
+protected:
+
+    template <typename T>
+    static void permute_(std::vector<T>& data, const std::vector<Size>& order)
+    {
+      std::vector<T> tmp(order.size());
+      for (Size i = 0; i < order.size(); ++i)
+      {
+        tmp[i] = data[order[i]];
+      }
+      data.swap(tmp);
+    }
+
+    std::vector<MZType> mz_;
+    std::vector<IntensityType> intensity_;
+    FloatDataArrays float_data_arrays_;
+  };
+
+  /**
+    @brief Peak data of a whole MSExperiment in a bulk structure-of-arrays layout.
+
+    All m/z and intensity values of all spectra are stored in two contiguous
+    arrays, spectrum @em i occupying the half-open range
+    [getOffset(i), getOffset(i + 1)). RT and MS level are kept per spectrum,
+    all other meta data (and float data arrays) stay with the MSExperiment.
+
+    Compared to an MSExperiment this layout needs one allocation per
+    dimension instead of one per spectrum and allows to sweep over the data
+    of consecutive spectra without pointer chasing.
+
+    @ingroup Kernel
+  */
+  template <typename MZType = double>
+  class ExperimentArrays
+  {
+public:
+    typedef Peak1D::IntensityType IntensityType;
+
+    /// Default constructor
+    ExperimentArrays() = default;
+
+    /// Conversion from MSExperiment (peaks, RT and MS level of all spectra)
+    explicit ExperimentArrays(const PeakMap& exp)
+    {
+      assign(exp);
+    }
+
+    /// Replace the content with the peak data of @p exp
+    void assign(const PeakMap& exp)
+    {
+      clear();
+      Size total(0);
+      for (const auto& s : exp)
+      {
+        total += s.size();
+      }
+      mz_.reserve(total);
+      intensity_.reserve(total);
+      offsets_.reserve(exp.size() + 1);
+      rt_.reserve(exp.size());
+      ms_level_.reserve(exp.size());
+      for (const auto& s : exp)
+      {
+        for (const auto& p : s)
+        {
+          mz_.push_back(MZType(p.getMZ()));
+          intensity_.push_back(p.getIntensity());
+        }
+        offsets_.push_back(mz_.size());
+        rt_.push_back(s.getRT());
+        ms_level_.push_back(s.getMSLevel());
+      }
+    }
+
+    /**
+      @brief Writes the peaks of all spectra into @p exp
+
+      Peaks of the spectra in @p exp are replaced, RT and MS level are set,
+      all other (meta) data is left untouched. If @p exp is empty, spectra
+      are created.
+
+      @exception Exception::IllegalArgument if @p exp is neither empty nor of the same size
+    */
+    void toExperiment(PeakMap& exp) const
+    {
+      if (exp.empty())
+      {
+        exp.resize(size());
+      }
+      else if (exp.size() != size())
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Number of spectra differs: " + String(exp.size()) + " vs. " + String(size()));
+      }
+      for (Size i = 0; i < size(); ++i)
+      {
+        MSSpectrum& s = exp[i];
+        s.resize(getSpectrumSize(i));
+        const MZType* mz = getMZ(i);
+        const IntensityType* intensity = getIntensity(i);
+        for (Size k = 0; k < s.size(); ++k)
+        {
+          s[k].setMZ(mz[k]);
+          s[k].setIntensity(intensity[k]);
+        }
+        s.setRT(rt_[i]);
+        s.setMSLevel(ms_level_[i]);
+      }
+      exp.updateRanges();
+    }
+
+    /// Number of spectra
+    Size size() const { return rt_.size(); }
+    bool empty() const { return rt_.empty(); }
+    /// Number of peaks of all spectra
+    Size getNrPeaks() const { return mz_.size(); }
+
+    void clear()
+    {
+      mz_.clear();
+      intensity_.clear();
+      offsets_.assign(1, 0);
+      rt_.clear();
+      ms_level_.clear();
+    }
+
+    /// Appends a spectrum (only peaks, RT and MS level are stored)
+    void push_back(const MSSpectrum& spectrum)
+    {
+      for (const auto& p : spectrum)
+      {
+        mz_.push_back(MZType(p.getMZ()));
+        intensity_.push_back(p.getIntensity());
+      }
+      offsets_.push_back(mz_.size());
+      rt_.push_back(spectrum.getRT());
+      ms_level_.push_back(spectrum.getMSLevel());
+    }
+
+    /// Position of the first peak of spectrum @p i in the bulk arrays (i may be equal to size())
+    Size getOffset(Size i) const { return offsets_[i]; }
+    Size getSpectrumSize(Size i) const { return offsets_[i + 1] - offsets_[i]; }
+    /// m/z values of spectrum @p i (getSpectrumSize(i) values)
+    const MZType* getMZ(Size i) const { return mz_.data() + offsets_[i]; }
+    /// Intensity values of spectrum @p i (getSpectrumSize(i) values)
+    const IntensityType* getIntensity(Size i) const { return intensity_.data() + offsets_[i]; }
+    double getRT(Size i) const { return rt_[i]; }
+    UInt getMSLevel(Size i) const { return ms_level_[i]; }
+
+    /// Copy of the peaks of spectrum @p i
+    SpectrumArrays<MZType> getSpectrum(Size i) const
+    {
+      SpectrumArrays<MZType> s;
+      s.getMZArray().assign(getMZ(i), getMZ(i) + getSpectrumSize(i));
+      s.getIntensityArray().assign(getIntensity(i), getIntensity(i) + getSpectrumSize(i));
+      return s;
+    }
+
+    /// Bulk m/z array of all spectra
+    const std::vector<MZType>& getMZArray() const { return mz_; }
+    /// Bulk intensity array of all spectra
+    const std::vector<IntensityType>& getIntensityArray() const { return intensity_; }
+
+    /// Number of bytes needed to store a single peak (m/z and intensity)
+    static constexpr Size bytesPerPeak() { return SpectrumArrays<MZType>::bytesPerPeak(); }
+
+protected:
+    std::vector<MZType> mz_;
+    std::vector<IntensityType> intensity_;
+    std::vector<Size> offsets_ = std::vector<Size>(1, 0);
+    std::vector<double> rt_;
+    std::vector<UInt> ms_level_;
+  };
+
+} // namespace OpenMS
@@ -34,6 +34,7 @@ RangeUtils.h
 RichPeak2D.h
 StandardTypes.h
 StandardDeclarations.h
+SpectrumArrays.h
 SpectrumHelper.h
 )
 
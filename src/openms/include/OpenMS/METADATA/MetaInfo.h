@@ -40,8 +40,6 @@
 #include <OpenMS/METADATA/MetaInfoRegistry.h>
 #include <OpenMS/DATASTRUCTURES/DataValue.h>
 
-#include <boost/container/flat_map.hpp>
-
 namespace OpenMS
 {
   class String;
@@ -63,6 +61,12 @@ namespace OpenMS
       member. MetaInfoInterface implements a full interface to a MetaInfo
       member and is more memory efficient if no meta info gets added.
 
+      To keep the footprint of large collections (e.g. millions of peptide
+      hits or features) small, the entries are stored compactly in a single
+      allocation: the sorted keys first (searched by binary search), followed
+      by the values. Up to eight entries the storage grows exactly, so the
+      typical object does not carry any unused capacity.
+
       @ingroup Metadata
   */
   class OPENMS_DLLAPI MetaInfo
@@ -72,18 +76,18 @@ public:
     MetaInfo() = default;
 
     /// Copy constructor
-    MetaInfo(const MetaInfo&) = default;
+    MetaInfo(const MetaInfo& rhs);
 
     /// Move constructor
-    MetaInfo(MetaInfo&&) = default;
+    MetaInfo(MetaInfo&& rhs) noexcept;
 
     /// Destructor
     ~MetaInfo();
 
     /// Assignment operator
-    MetaInfo& operator=(const MetaInfo&) = default;
+    MetaInfo& operator=(const MetaInfo& rhs);
     /// Move assignment operator
-    MetaInfo& operator=(MetaInfo&&) & = default;
+    MetaInfo& operator=(MetaInfo&& rhs) & noexcept;
 
     /// Equality operator
     bool operator==(const MetaInfo& rhs) const;
@@ -125,14 +129,48 @@ public:
     /// Removes all meta values
     void clear();
 
+    /// Returns the number of bytes allocated on the heap for the entries (excluding memory owned by the values, e.g. strings)
+    Size allocatedBytes() const;
+
 private:
-    using MapType = boost::container::flat_map<UInt, DataValue>;
+    /// Sorted keys (at the start of the allocation)
+    inline UInt* keys_() const
+    {
+      return static_cast<UInt*>(data_);
+    }
+
+    /// Values (following the keys, suitably aligned)
+    inline DataValue* values_() const
+    {
+      return reinterpret_cast<DataValue*>(static_cast<char*>(data_) + keyBytes_(capacity_));
+    }
+
+    /// Size of the key block for @p capacity entries (padded for the alignment of the values)
+    static Size keyBytes_(UInt capacity);
+
+    /// Returns the position of @p index (or of the first larger key) in the sorted keys
+    UInt lowerBound_(UInt index) const;
+
+    /// Returns the position of @p index or -1 if not present
+    Int find_(UInt index) const;
+
+    /// Inserts an entry at position @p pos (growing the allocation if needed)
+    void insertAt_(UInt pos, UInt index, DataValue&& value);
+
+    /// Destroys all values and frees the allocation
+    void release_() noexcept;
 
     /// Static MetaInfoRegistry
     static MetaInfoRegistry registry_;
 
-    /// The actual mapping of indexes to values
-    MapType index_to_value_;
+    /// Number of entries
+    UInt size_ = 0;
+
+    /// Number of entries that fit into the allocation
+    UInt capacity_ = 0;
+
+    /// Single allocation holding capacity_ keys followed by capacity_ values (nullptr if capacity_ is 0)
+    void* data_ = nullptr;
   };
 
 } // namespace OpenMS
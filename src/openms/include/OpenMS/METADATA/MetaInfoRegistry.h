@@ -34,15 +34,15 @@
 
 #pragma once
 
-#include <map>
+#include <atomic>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <OpenMS/CONCEPT/Exception.h>
 #include <OpenMS/CONCEPT/Types.h>
 #include <OpenMS/DATASTRUCTURES/String.h>
 
-#include <unordered_map>
-
 #ifdef OPENMS_COMPILER_MSVC
 #pragma warning( push )
 #pragma warning( disable : 4251 )     // disable MSVC dll-interface warning
@@ -69,12 +69,55 @@ namespace OpenMS
       11 - ID<BR>
       12 - low_quality<BR>
       13 - charge<BR>
+      14 and above - frequently used user parameter names of Constants::UserParam (see ReservedIndex)
+
+      The reserved indices are available as ReservedIndex constants. Using them with the
+      index-based accessors of MetaInfoInterface avoids any string hashing in hot loops.
+
+      Looking up names and indices (getIndex, getName and registerName of an already
+      registered name) is lock-free: the name table is append-only and a grown table is
+      published atomically, so concurrent readers never wait for each other. Registering
+      a new name and accessing descriptions or units is synchronized.
 
       @ingroup Metadata
   */
   class OPENMS_DLLAPI MetaInfoRegistry
   {
 public:
+    /// Indices of the names registered at construction (these never change)
+    enum ReservedIndex : UInt
+    {
+      ISOTOPIC_RANGE = 1,
+      CLUSTER_ID,
+      LABEL,
+      ICON,
+      COLOR,
+      RT,
+      MZ,
+      PREDICTED_RT,
+      PREDICTED_RT_P_VALUE,
+      SPECTRUM_REFERENCE,
+      ID,
+      LOW_QUALITY,
+      CHARGE,
+      // Constants::UserParam names
+      CONCAT_PEPTIDE,
+      LOCALIZED_MODIFICATIONS_USERPARAM,
+      MERGED_CHROMATOGRAM_MZS,
+      PRECURSOR_ERROR_PPM_USERPARAM,
+      FRAGMENT_ERROR_MEDIAN_PPM_USERPARAM,
+      FRAGMENT_ERROR_PPM_USERPARAM,
+      FRAGMENT_ERROR_DA_USERPARAM,
+      FRAGMENT_ANNOTATION_USERPARAM,
+      PSM_EXPLAINED_ION_CURRENT_USERPARAM,
+      MATCHED_PREFIX_IONS_FRACTION,
+      MATCHED_SUFFIX_IONS_FRACTION,
+      TARGET_DECOY,
+      DELTA_SCORE,
+      ISOTOPE_ERROR,
+      SIZE_OF_RESERVEDINDEX
+    };
+
     /// Default constructor
     MetaInfoRegistry();
 
@@ -161,19 +204,32 @@ public:
     String getUnit(const String& name) const;
 
 private:
+    struct Entry_;
+    struct Table_;
+
+    /// inserts a new name (lock must be held)
+    UInt insert_(UInt index, const std::string& name, const std::string& description, const std::string& unit);
+
+    /// adds an entry to the current table, publishing a grown copy if it is full (lock must be held)
+    void add_(Entry_* e);
+
+    /// returns the entry of an index or nullptr (lock-free)
+    const Entry_* find_(UInt index) const;
+
+    /// returns the entry of a name or nullptr (lock-free)
+    const Entry_* find_(const std::string& name) const;
+
     /// internal counter, that stores the next index to assign
     UInt next_index_;
-    using MapString2IndexType = std::unordered_map<std::string, UInt>;
-    using MapIndex2StringType = std::unordered_map<UInt, std::string>;
-    
-    /// map from name to index
-    MapString2IndexType name_to_index_;
-    /// map from index to name
-    MapIndex2StringType index_to_name_;
-    /// map from index to description
-    MapIndex2StringType index_to_description_;
-    /// map from index to unit
-    MapIndex2StringType index_to_unit_;
+
+    /// owns all registered entries
+    std::vector<std::unique_ptr<Entry_> > entries_;
+
+    /// owns all tables, including outgrown ones (which concurrent readers may still access)
+    std::vector<std::unique_ptr<Table_> > tables_;
+
+    /// current table, published with release semantics
+    std::atomic<const Table_*> table_;
   };
 
 } // namespace OpenMS
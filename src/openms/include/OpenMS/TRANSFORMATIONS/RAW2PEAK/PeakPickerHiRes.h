@@ -46,6 +46,7 @@ namespace OpenMS
 {
   class MSChromatogram;
   class OnDiscMSExperiment;
+  template <typename MZType> class SpectrumArrays;
 
   /**
     @brief This class implements a fast peak-picking algorithm best suited for
@@ -137,6 +138,22 @@ public:
      */
     void pick(const MSChromatogram& input, MSChromatogram& output, std::vector<PeakBoundary>& boundaries, bool check_spacings = false) const;
 
+    /**
+      @brief Applies the peak-picking algorithm to a single spectrum in
+      structure-of-arrays layout (SpectrumArrays). The resulting picked peaks
+      (and, if requested, ion mobility and FWHM float data arrays) are written
+      to the output spectrum.
+
+      @param input  input spectrum in profile mode
+      @param output  output spectrum with picked peaks
+      @param boundaries  boundaries of the picked peaks
+      @param check_spacings  check spacing constraints?
+     */
+    void pick(const SpectrumArrays<double>& input, SpectrumArrays<double>& output, std::vector<PeakBoundary>& boundaries, bool check_spacings = true) const;
+
+    /// Same as above, for m/z values stored in single precision
+    void pick(const SpectrumArrays<float>& input, SpectrumArrays<float>& output, std::vector<PeakBoundary>& boundaries, bool check_spacings = true) const;
+
     /**
       @brief Applies the peak-picking algorithm to a map (MSExperiment). This
       method picks peaks for each scan in the map consecutively. The resulting
@@ -166,13 +183,17 @@ public:
                         const bool check_spectrum_type = true) const;
 
     /**
-      @brief Applies the peak-picking algorithm to a map (MSExperiment). This
-      method picks peaks for each scan in the map consecutively. The resulting
-      picked peaks are written to the output map.
+      @brief Applies the peak-picking algorithm to a map on disk (OnDiscMSExperiment).
 
-      Currently we have to give up const-correctness but we know that everything on disc is constant
+      Spectra and chromatograms are read, decoded and picked in parallel,
+      only the picked data is kept in memory. The resulting picked peaks are
+      written to the output map in the same order as in the input.
+
+      @param input  input map in profile mode
+      @param output  output map with picked peaks
+      @param check_spectrum_type  if set, checks spectrum type and throws an exception if a centroided spectrum is passed
     */
-    void pickExperiment(/* const */ OnDiscMSExperiment& input, PeakMap& output, const bool check_spectrum_type = true) const;
+    void pickExperiment(const OnDiscMSExperiment& input, PeakMap& output, const bool check_spectrum_type = true) const;
 
 protected:
 
@@ -55,6 +55,21 @@ using namespace OpenMS::Internal;
 namespace OpenMS
 {
 
+  namespace
+  {
+    /// A node of a connected component together with its incoming neighbors (i.e. the ones of a "lower" type)
+    struct CCNode
+    {
+      IDBoostGraph::vertex_t vertex;
+      int type;
+      vector<IDBoostGraph::vertex_t> in;
+    };
+
+    /// The structure of all connected components (indexed like the CCs), built once and reused for every
+    /// parameter combination of the grid search
+    typedef vector<vector<CCNode>> CCStructureCache;
+  }
+
   /// A functor that specifies what to do on a connected component (IDBoostGraph::FilteredGraph)
   class BayesianProteinInferenceAlgorithm::GraphInferenceFunctor
       //: public std::function<unsigned long(IDBoostGraph::Graph&)>
@@ -64,13 +79,41 @@ namespace OpenMS
     const Param& param_;
     unsigned int debug_lvl_;
     unsigned long cnt_;
+    /// optional cache for the CC structures (each CC index is only accessed by one thread at a time)
+    CCStructureCache* structure_cache_;
 
-    explicit GraphInferenceFunctor(const Param& param, unsigned int debug_lvl):
+    explicit GraphInferenceFunctor(const Param& param, unsigned int debug_lvl, CCStructureCache* structure_cache = nullptr):
         param_(param),
         debug_lvl_(debug_lvl),
-        cnt_(0)
+        cnt_(0),
+        structure_cache_(structure_cache)
     {}
 
+    /// collects the nodes of @p fg with their incoming neighbors into @p nodes
+    static void getStructure_(IDBoostGraph::Graph& fg, vector<CCNode>& nodes)
+    {
+      nodes.clear();
+      nodes.reserve(boost::num_vertices(fg));
+      IDBoostGraph::Graph::vertex_iterator ui, ui_end;
+      boost::tie(ui,ui_end) = boost::vertices(fg);
+      for (; ui != ui_end; ++ui)
+      {
+        // direct neighbors are proteins on the "left" side and peptides on the "right" side
+        // TODO Can be sped up using directed graph. Needs some restructuring in IDBoostGraph class first tho.
+        CCNode node{*ui, fg[*ui].which(), {}};
+        IDBoostGraph::Graph::adjacency_iterator nbIt, nbIt_end;
+        boost::tie(nbIt, nbIt_end) = boost::adjacent_vertices(*ui, fg);
+        for (; nbIt != nbIt_end; ++nbIt)
+        {
+          if (fg[*nbIt].which() < node.type)
+          {
+            node.in.push_back(*nbIt);
+          }
+        }
+        nodes.push_back(std::move(node));
+      }
+    }
+
     unsigned long operator() (IDBoostGraph::Graph& fg, unsigned int idx) {
       //TODO do quick brute-force calculation if the cc is really small?
 
@@ -106,91 +149,80 @@ namespace OpenMS
                                                  param_.getValue("model_parameters:pep_prior")); // the p used for marginalization: 1 = sum product, inf = max product
         evergreen::BetheInferenceGraphBuilder<IDBoostGraph::vertex_t> bigb;
 
-        IDBoostGraph::Graph::vertex_iterator ui, ui_end;
-        boost::tie(ui,ui_end) = boost::vertices(fg);
-
         // Store the IDs of the nodes for which you want the posteriors in the end
         vector<vector<IDBoostGraph::vertex_t>> posteriorVars;
 
-        // direct neighbors are proteins on the "left" side and peptides on the "right" side
-        // TODO Can be sped up using directed graph. Needs some restructuring in IDBoostGraph class first tho.
-        vector<IDBoostGraph::vertex_t> in{};
-        //std::vector<IDBoostGraph::vertex_t> out{};
+        // the structure of the CC does not depend on the parameters, so reuse it if cached
+        vector<CCNode> local_nodes;
+        vector<CCNode>* nodes = &local_nodes;
+        if (structure_cache_ != nullptr && idx < structure_cache_->size())
+        {
+          nodes = &(*structure_cache_)[idx];
+        }
+        if (nodes->empty())
+        {
+          getStructure_(fg, *nodes);
+        }
 
         //TODO the try section could in theory be slimmed down a little bit. Start at first use of insertDependency maybe.
         // check performance impact.
         try
         {
-          for (; ui != ui_end; ++ui)
+          for (const CCNode& node : *nodes)
           {
-            IDBoostGraph::Graph::adjacency_iterator nbIt, nbIt_end;
-            boost::tie(nbIt, nbIt_end) = boost::adjacent_vertices(*ui, fg);
-
-            in.clear();
-            //out.clear(); // we don't need out edges currently
-
-            for (; nbIt != nbIt_end; ++nbIt)
-            {
-              if (fg[*nbIt].which() < fg[*ui].which())
-              {
-                in.push_back(*nbIt);
-              }
-              /*else
-              {
-                out.push_back(*nbIt);
-              }*/
-            }
+            const IDBoostGraph::vertex_t ui = node.vertex;
+            const vector<IDBoostGraph::vertex_t>& in = node.in;
 
             //TODO introduce an enum for the types to make it more clear.
             //Or use the static_visitor pattern: You have to pass the vertex with its neighbors as a second arg though.
 
-            if (fg[*ui].which() == 6) // pep hit = psm
+            if (node.type == 6) // pep hit = psm
             {
               if (regularize)
               {
-                bigb.insert_dependency(mpf.createRegularizingSumEvidenceFactor(boost::get<PeptideHit *>(fg[*ui])
-                                                                                   ->getPeptideEvidences().size(), in[0], *ui));
+                bigb.insert_dependency(mpf.createRegularizingSumEvidenceFactor(boost::get<PeptideHit *>(fg[ui])
+                                                                                   ->getPeptideEvidences().size(), in[0], ui));
               }
               else
               {
-                bigb.insert_dependency(mpf.createSumEvidenceFactor(boost::get<PeptideHit *>(fg[*ui])
-                                                                                   ->getPeptideEvidences().size(), in[0], *ui));
+                bigb.insert_dependency(mpf.createSumEvidenceFactor(boost::get<PeptideHit *>(fg[ui])
+                                                                                   ->getPeptideEvidences().size(), in[0], ui));
               }
 
-              bigb.insert_dependency(mpf.createPeptideEvidenceFactor(*ui,
-                                                                     boost::get<PeptideHit *>(fg[*ui])->getScore()));
+              bigb.insert_dependency(mpf.createPeptideEvidenceFactor(ui,
+                                                                     boost::get<PeptideHit *>(fg[ui])->getScore()));
               if (update_PSM_probabilities)
               {
-                posteriorVars.push_back({*ui});
+                posteriorVars.push_back({ui});
               }
             }
-            else if (fg[*ui].which() == 2) // pep group
+            else if (node.type == 2) // pep group
             {
-              bigb.insert_dependency(mpf.createPeptideProbabilisticAdderFactor(in, *ui));
+              bigb.insert_dependency(mpf.createPeptideProbabilisticAdderFactor(in, ui));
             }
-            else if (fg[*ui].which() == 1) // prot group
+            else if (node.type == 1) // prot group
             {
-              bigb.insert_dependency(mpf.createPeptideProbabilisticAdderFactor(in, *ui));
+              bigb.insert_dependency(mpf.createPeptideProbabilisticAdderFactor(in, ui));
               if (annotate_group_posterior)
               {
-                posteriorVars.push_back({*ui});
+                posteriorVars.push_back({ui});
               }
             }
-            else if (fg[*ui].which() == 0) // prot
+            else if (node.type == 0) // prot
             {
               //TODO modify createProteinFactor to start with a modified prior based on the number of missing
               // peptides (later tweak to include conditional prob. for that peptide
               if (user_defined_priors)
               {
-                bigb.insert_dependency(mpf.createProteinFactor(*ui,
-                                                               (double) boost::get<ProteinHit *>(fg[*ui])
+                bigb.insert_dependency(mpf.createProteinFactor(ui,
+                                                               (double) boost::get<ProteinHit *>(fg[ui])
                                                                    ->getMetaValue("Prior")));
               }
               else
               {
-                bigb.insert_dependency(mpf.createProteinFactor(*ui));
+                bigb.insert_dependency(mpf.createProteinFactor(ui));
               }
-              posteriorVars.push_back({*ui});
+              posteriorVars.push_back({ui});
             }
           }
 
@@ -488,11 +520,13 @@ namespace OpenMS
     Param& param_;
     IDBoostGraph& ibg_;
     const unsigned int debug_lvl_;
+    CCStructureCache* structure_cache_;
 
-    explicit GridSearchEvaluator(Param& param, IDBoostGraph& ibg, unsigned int debug_lvl):
+    explicit GridSearchEvaluator(Param& param, IDBoostGraph& ibg, unsigned int debug_lvl, CCStructureCache* structure_cache = nullptr):
         param_(param),
         ibg_(ibg),
-        debug_lvl_(debug_lvl)
+        debug_lvl_(debug_lvl),
+        structure_cache_(structure_cache)
     {}
 
     double operator() (double alpha, double beta, double gamma)
@@ -506,7 +540,7 @@ namespace OpenMS
       param_.setValue("model_parameters:prot_prior", gamma);
       param_.setValue("model_parameters:pep_emission", alpha);
       param_.setValue("model_parameters:pep_spurious_emission", beta);
-      GraphInferenceFunctor gif {param_, debug_lvl_};
+      GraphInferenceFunctor gif {param_, debug_lvl_, structure_cache_};
       ibg_.applyFunctorOnCCs(gif);
 
       FalseDiscoveryRate fdr;
@@ -904,6 +938,9 @@ namespace OpenMS
     ibg.computeConnectedComponents();
     ibg.clusterIndistProteinsAndPeptides();
 
+    // the CC structures are collected during the first inference run and reused afterwards
+    CCStructureCache structure_cache(ibg.getNrConnectedComponents());
+
     vector<double> gamma_search;
     vector<double> beta_search;
     vector<double> alpha_search;
@@ -927,7 +964,7 @@ namespace OpenMS
     if (gs.getNrCombos() > 1)
     {
      OPENMS_LOG_INFO << "Testing " << gs.getNrCombos() << " param combinations." << std::endl;
-      /*double res =*/ gs.evaluate(GridSearchEvaluator(param_, ibg, debug_lvl_), -1.0, bestParams);
+      /*double res =*/ gs.evaluate(GridSearchEvaluator(param_, ibg, debug_lvl_, &structure_cache), -1.0, bestParams);
     }
     else
     {
@@ -948,7 +985,7 @@ namespace OpenMS
 
     if (!use_run_info)
     {
-      GraphInferenceFunctor gif {param_, debug_lvl_};
+      GraphInferenceFunctor gif {param_, debug_lvl_, &structure_cache};
       ibg.applyFunctorOnCCs(gif);
     }
     else
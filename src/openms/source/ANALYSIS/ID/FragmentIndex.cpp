@@ -0,0 +1,374 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+namespace OpenMS
+{
+  namespace
+  {
+    const int FRAGMENT_INDEX_FILE_IDENTIFIER = 8095;
+    const int FRAGMENT_INDEX_FILE_VERSION = 2;
+
+    void throwCorrupt(const String& filename, const String& reason)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Fragment index file is truncated or corrupt (" + reason + "). Aborting!", filename);
+    }
+  }
+
+  FragmentIndex::FragmentIndex(Size bucket_size) :
+    bucket_size_(std::max(bucket_size, Size(1))),
+    built_(false)
+  {
+  }
+
+  void FragmentIndex::clear()
+  {
+    peptides_.clear();
+    fragments_.clear();
+    bucket_min_mz_.clear();
+    built_ = false;
+  }
+
+  void FragmentIndex::addPeptide(const String& sequence, Size modification_index, const String& modified_sequence, double mass, const std::vector<double>& fragment_mz)
+  {
+    const UInt32 peptide_index = static_cast<UInt32>(peptides_.size());
+    peptides_.push_back({sequence, modification_index, modified_sequence, mass});
+    for (double mz : fragment_mz)
+    {
+      fragments_.push_back({static_cast<float>(mz), peptide_index});
+    }
+    built_ = false;
+  }
+
+  void FragmentIndex::build()
+  {
+    // sort peptides by mass (ties are broken by sequence and modification index to get a deterministic order)
+    std::vector<UInt32> order(peptides_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](UInt32 a, UInt32 b)
+    {
+      const Peptide& pa = peptides_[a];
+      const Peptide& pb = peptides_[b];
+      return std::tie(pa.mass, pa.sequence, pa.modification_index) < std::tie(pb.mass, pb.sequence, pb.modification_index);
+    });
+
+    std::vector<UInt32> new_index(peptides_.size());
+    std::vector<Peptide> sorted_peptides;
+    sorted_peptides.reserve(peptides_.size());
+    for (Size i = 0; i != order.size(); ++i)
+    {
+      new_index[order[i]] = static_cast<UInt32>(i);
+      sorted_peptides.push_back(std::move(peptides_[order[i]]));
+    }
+    peptides_.swap(sorted_peptides);
+
+    for (Fragment& f : fragments_)
+    {
+      f.peptide_index = new_index[f.peptide_index];
+    }
+
+    // partition m/z sorted fragments into buckets, then sort each bucket by peptide (i.e., by mass)
+    std::sort(fragments_.begin(), fragments_.end(), [](const Fragment& a, const Fragment& b)
+    {
+      return std::tie(a.mz, a.peptide_index) < std::tie(b.mz, b.peptide_index);
+    });
+
+    bucket_min_mz_.clear();
+    for (Size first = 0; first < fragments_.size(); first += bucket_size_)
+    {
+      auto bucket_begin = fragments_.begin() + first;
+      auto bucket_end = fragments_.begin() + std::min(first + bucket_size_, fragments_.size());
+      bucket_min_mz_.push_back(bucket_begin->mz);
+      std::sort(bucket_begin, bucket_end, [](const Fragment& a, const Fragment& b)
+      {
+        return std::tie(a.peptide_index, a.mz) < std::tie(b.peptide_index, b.mz);
+      });
+    }
+    built_ = true;
+  }
+
+  bool FragmentIndex::isBuilt() const
+  {
+    return built_;
+  }
+
+  Size FragmentIndex::size() const
+  {
+    return peptides_.size();
+  }
+
+  Size FragmentIndex::fragmentCount() const
+  {
+    return fragments_.size();
+  }
+
+  const FragmentIndex::Peptide& FragmentIndex::getPeptide(Size index) const
+  {
+    return peptides_[index];
+  }
+
+  std::pair<Size, Size> FragmentIndex::getPeptideRange(double min_mass, double max_mass) const
+  {
+    auto first = std::lower_bound(peptides_.begin(), peptides_.end(), min_mass, [](const Peptide& p, double m) { return p.mass < m; });
+    auto last = std::upper_bound(first, peptides_.end(), max_mass, [](double m, const Peptide& p) { return m < p.mass; });
+    return {Size(first - peptides_.begin()), Size(last - peptides_.begin())};
+  }
+
+  void FragmentIndex::query(const MSSpectrum& spectrum,
+                            double min_mass,
+                            double max_mass,
+                            double fragment_mass_tolerance,
+                            bool fragment_mass_tolerance_unit_ppm,
+                            Size min_matched,
+                            std::vector<Candidate>& candidates) const
+  {
+    if (!built_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Fragment index needs to be built before it can be queried.");
+    }
+
+    const std::pair<Size, Size> range = getPeptideRange(min_mass, max_mass);
+    if (range.first == range.second) { return; }
+
+    std::vector<UInt32> matched(range.second - range.first, 0);
+    for (const Peak1D& p : spectrum)
+    {
+      const double tolerance = fragment_mass_tolerance_unit_ppm ? p.getMZ() * fragment_mass_tolerance * 1e-6 : fragment_mass_tolerance;
+      const float lower_mz = static_cast<float>(p.getMZ() - tolerance);
+      const float upper_mz = static_cast<float>(p.getMZ() + tolerance);
+
+      // the first bucket that can contain lower_mz is the last one starting before it (fragments with
+      // m/z equal to lower_mz may end the previous bucket if equal values straddle a bucket boundary)
+      Size bucket = std::lower_bound(bucket_min_mz_.begin(), bucket_min_mz_.end(), lower_mz) - bucket_min_mz_.begin();
+      if (bucket != 0) { --bucket; }
+
+      for (; bucket < bucket_min_mz_.size() && bucket_min_mz_[bucket] <= upper_mz; ++bucket)
+      {
+        auto bucket_begin = fragments_.begin() + bucket * bucket_size_;
+        auto bucket_end = fragments_.begin() + std::min((bucket + 1) * bucket_size_, fragments_.size());
+        auto it = std::lower_bound(bucket_begin, bucket_end, range.first, [](const Fragment& f, Size idx) { return f.peptide_index < idx; });
+        for (; it != bucket_end && it->peptide_index < range.second; ++it)
+        {
+          if (it->mz >= lower_mz && it->mz <= upper_mz)
+          {
+            ++matched[it->peptide_index - range.first];
+          }
+        }
+      }
+    }
+
+    for (Size i = 0; i != matched.size(); ++i)
+    {
+      if (matched[i] != 0 && matched[i] >= min_matched)
+      {
+        candidates.push_back({range.first + i, matched[i]});
+      }
+    }
+  }
+
+  void FragmentIndex::store(const String& filename, const String& settings) const
+  {
+    if (!built_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Fragment index needs to be built before it can be stored.");
+    }
+
+    std::ofstream ofs(filename.c_str(), std::ios::binary);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+
+    int file_identifier = FRAGMENT_INDEX_FILE_IDENTIFIER;
+    int file_version = FRAGMENT_INDEX_FILE_VERSION;
+    ofs.write((char*)&file_identifier, sizeof(file_identifier));
+    ofs.write((char*)&file_version, sizeof(file_version));
+
+    Size len = settings.size();
+    ofs.write((char*)&len, sizeof(len));
+    ofs.write(settings.c_str(), len);
+
+    ofs.write((char*)&bucket_size_, sizeof(bucket_size_));
+
+    Size nr_peptides = peptides_.size();
+    ofs.write((char*)&nr_peptides, sizeof(nr_peptides));
+    for (const Peptide& p : peptides_)
+    {
+      len = p.sequence.size();
+      ofs.write((char*)&len, sizeof(len));
+      ofs.write(p.sequence.c_str(), len);
+      ofs.write((char*)&p.modification_index, sizeof(p.modification_index));
+      len = p.modified_sequence.size();
+      ofs.write((char*)&len, sizeof(len));
+      ofs.write(p.modified_sequence.c_str(), len);
+      ofs.write((char*)&p.mass, sizeof(p.mass));
+    }
+
+    Size nr_fragments = fragments_.size();
+    ofs.write((char*)&nr_fragments, sizeof(nr_fragments));
+    ofs.write((char*)fragments_.data(), nr_fragments * sizeof(Fragment));
+
+    Size nr_buckets = bucket_min_mz_.size();
+    ofs.write((char*)&nr_buckets, sizeof(nr_buckets));
+    ofs.write((char*)bucket_min_mz_.data(), nr_buckets * sizeof(float));
+
+    ofs.close();
+    if (ofs.fail())
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Error while writing the fragment index.");
+    }
+  }
+
+  bool FragmentIndex::load(const String& filename, const String& settings)
+  {
+    std::ifstream ifs(filename.c_str(), std::ios::binary);
+    if (ifs.fail())
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    clear();
+
+    ifs.seekg(0, std::ios::end);
+    const std::streamoff file_size = ifs.tellg();
+    ifs.seekg(0, std::ios::beg);
+    // number of bytes left to read (counts read from the file are checked against it before allocating)
+    auto remaining = [&ifs, file_size]() -> Size
+    {
+      const std::streamoff pos = ifs.tellg();
+      return (pos < 0 || pos > file_size) ? 0 : Size(file_size - pos);
+    };
+
+    int file_identifier = 0;
+    int file_version = 0;
+    ifs.read((char*)&file_identifier, sizeof(file_identifier));
+    ifs.read((char*)&file_version, sizeof(file_version));
+    if (file_identifier != FRAGMENT_INDEX_FILE_IDENTIFIER || file_version != FRAGMENT_INDEX_FILE_VERSION)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "File might not be a fragment index file (wrong file magic number or version). Aborting!", filename);
+    }
+
+    Size len = 0;
+    ifs.read((char*)&len, sizeof(len));
+    if (!ifs || len > remaining()) { throwCorrupt(filename, "settings"); }
+    String stored_settings(len, '\0');
+    ifs.read(&stored_settings[0], len);
+    if (!ifs || stored_settings != settings)
+    {
+      return false;
+    }
+
+    try
+    {
+      ifs.read((char*)&bucket_size_, sizeof(bucket_size_));
+      if (!ifs || bucket_size_ == 0) { throwCorrupt(filename, "bucket size"); }
+
+      Size nr_peptides = 0;
+      ifs.read((char*)&nr_peptides, sizeof(nr_peptides));
+      const Size min_peptide_bytes = 3 * sizeof(Size) + sizeof(double);
+      if (!ifs || nr_peptides > remaining() / min_peptide_bytes || nr_peptides > std::numeric_limits<UInt32>::max())
+      {
+        throwCorrupt(filename, "number of peptides");
+      }
+      peptides_.resize(nr_peptides);
+      for (Size i = 0; i != nr_peptides; ++i)
+      {
+        Peptide& p = peptides_[i];
+        ifs.read((char*)&len, sizeof(len));
+        if (!ifs || len > remaining()) { throwCorrupt(filename, "peptide sequence"); }
+        p.sequence.resize(len);
+        ifs.read(&p.sequence[0], len);
+        ifs.read((char*)&p.modification_index, sizeof(p.modification_index));
+        ifs.read((char*)&len, sizeof(len));
+        if (!ifs || len > remaining()) { throwCorrupt(filename, "modified peptide sequence"); }
+        p.modified_sequence.resize(len);
+        ifs.read(&p.modified_sequence[0], len);
+        ifs.read((char*)&p.mass, sizeof(p.mass));
+        // peptides need to be sorted by mass (see getPeptideRange())
+        if (!ifs || !(i == 0 || peptides_[i - 1].mass <= p.mass)) { throwCorrupt(filename, "peptide masses"); }
+      }
+
+      Size nr_fragments = 0;
+      ifs.read((char*)&nr_fragments, sizeof(nr_fragments));
+      if (!ifs || nr_fragments > remaining() / sizeof(Fragment)) { throwCorrupt(filename, "number of fragments"); }
+      fragments_.resize(nr_fragments);
+      ifs.read((char*)fragments_.data(), nr_fragments * sizeof(Fragment));
+
+      Size nr_buckets = 0;
+      ifs.read((char*)&nr_buckets, sizeof(nr_buckets));
+      if (!ifs || nr_buckets != (nr_fragments + bucket_size_ - 1) / bucket_size_ || nr_buckets > remaining() / sizeof(float))
+      {
+        throwCorrupt(filename, "number of buckets");
+      }
+      bucket_min_mz_.resize(nr_buckets);
+      ifs.read((char*)bucket_min_mz_.data(), nr_buckets * sizeof(float));
+      if (!ifs) { throwCorrupt(filename, "buckets"); }
+
+      // query() relies on valid peptide references, m/z sorted buckets and peptide sorted fragments within each bucket
+      for (Size bucket = 0; bucket != nr_buckets; ++bucket)
+      {
+        if (bucket != 0 && !(bucket_min_mz_[bucket - 1] <= bucket_min_mz_[bucket])) { throwCorrupt(filename, "bucket order"); }
+        const Size first = bucket * bucket_size_;
+        const Size last = std::min(first + bucket_size_, nr_fragments);
+        for (Size i = first; i != last; ++i)
+        {
+          const Fragment& f = fragments_[i];
+          if (f.peptide_index >= nr_peptides || !(f.mz >= bucket_min_mz_[bucket]) ||
+              (i != first && fragments_[i - 1].peptide_index > f.peptide_index))
+          {
+            throwCorrupt(filename, "fragments");
+          }
+        }
+      }
+    }
+    catch (...)
+    {
+      clear();
+      throw;
+    }
+    built_ = true;
+    return true;
+  }
+
+} // namespace OpenMS
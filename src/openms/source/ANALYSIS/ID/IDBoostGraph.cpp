@@ -46,6 +46,8 @@
 #include <boost/graph/graph_utility.hpp>
 #include <boost/graph/connected_components.hpp>
 
+#include <algorithm>
+#include <numeric>
 #include <ostream>
 #ifdef _OPENMP
 #include <omp.h>
@@ -618,10 +620,22 @@ namespace OpenMS
       throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "No connected components annotated. Run computeConnectedComponents first!");
     }
 
+    // Process the largest CCs first (longest-processing-time-first ordering): a few giant CCs usually
+    // dominate the runtime and would otherwise end up as the last tasks of a single thread.
+    // The functor gets the original CC index, so results do not depend on the order.
+    vector<int> cc_order(ccs_.size());
+    std::iota(cc_order.begin(), cc_order.end(), 0);
+    std::stable_sort(cc_order.begin(), cc_order.end(), [this](int a, int b)
+    {
+      return boost::num_edges(ccs_[a]) + boost::num_vertices(ccs_[a]) >
+             boost::num_edges(ccs_[b]) + boost::num_vertices(ccs_[b]);
+    });
+
     // Use dynamic schedule because big CCs take much longer!
-    #pragma omp parallel for schedule(dynamic) default(none) shared(functor)
-    for (int i = 0; i < static_cast<int>(ccs_.size()); i += 1)
+    #pragma omp parallel for schedule(dynamic, 1) default(none) shared(functor, cc_order)
+    for (int k = 0; k < static_cast<int>(cc_order.size()); k += 1)
     {
+      const int i = cc_order[k];
       #ifdef INFERENCE_BENCH
       StopWatch sw;
       sw.start();
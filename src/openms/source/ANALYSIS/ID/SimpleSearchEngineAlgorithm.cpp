@@ -34,11 +34,13 @@
 
 #include <OpenMS/ANALYSIS/ID/SimpleSearchEngineAlgorithm.h>
 
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
 #include <OpenMS/ANALYSIS/ID/PeptideIndexing.h>
 #include <OpenMS/ANALYSIS/RNPXL/HyperScore.h>
 #include <OpenMS/CHEMISTRY/DecoyGenerator.h>
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
 #include <OpenMS/CHEMISTRY/ProteaseDB.h>
+#include <OpenMS/CHEMISTRY/ResidueDB.h>
 #include <OpenMS/CHEMISTRY/ResidueModification.h>
 #include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
 #include <OpenMS/COMPARISON/SPECTRA/SpectrumAlignment.h>
@@ -54,12 +56,14 @@
 #include <OpenMS/FILTERING/TRANSFORMERS/WindowMower.h>
 #include <OpenMS/FORMAT/FASTAFile.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/SYSTEM/File.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/KERNEL/MSSpectrum.h>
 #include <OpenMS/KERNEL/Peak1D.h>
 #include <OpenMS/KERNEL/StandardTypes.h>
 #include <OpenMS/MATH/MISC/MathFunctions.h>
 #include <OpenMS/MATH/STATISTICS/StatisticFunctions.h>
+#include <OpenMS/METADATA/MetaInfoRegistry.h>
 #include <OpenMS/METADATA/SpectrumSettings.h>
 
 #include <algorithm>
@@ -146,6 +150,15 @@ namespace OpenMS
     defaults_.setValue("report:top_hits", 1, "Maximum number of top scoring hits per spectrum that are reported.");
     defaults_.setSectionDescription("report", "Reporting Options");
 
+    defaults_.setValue("fragment_index:enabled", "false", "Retrieve candidate peptides per spectrum from a fragment ion index instead of scoring every peptide against all spectra with matching precursor mass.");
+    defaults_.setValidStrings("fragment_index:enabled", {"true","false"} );
+    defaults_.setValue("fragment_index:file", "", "Optional file the fragment index is stored in. If the file exists and was created from the same database and settings, it is loaded instead of building the index.");
+    defaults_.setValue("fragment_index:candidates", 50, "Number of candidate peptides (with most matching fragments) per spectrum that are scored.");
+    defaults_.setMinInt("fragment_index:candidates", 1);
+    defaults_.setValue("fragment_index:min_matched_peaks", 3, "Minimum number of matching fragment ions for a peptide to become a candidate.");
+    defaults_.setMinInt("fragment_index:min_matched_peaks", 1);
+    defaults_.setSectionDescription("fragment_index", "Fragment Index Options");
+
     defaultsToParam_();
   }
 
@@ -191,6 +204,12 @@ namespace OpenMS
     report_top_hits_ = param_.getValue("report:top_hits");
 
     decoys_ = param_.getValue("decoys") == "true";
+
+    fragment_index_enabled_ = param_.getValue("fragment_index:enabled") == "true";
+    fragment_index_file_ = param_.getValue("fragment_index:file").toString();
+    fragment_index_candidates_ = param_.getValue("fragment_index:candidates");
+    fragment_index_min_matched_ = param_.getValue("fragment_index:min_matched_peaks");
+
     annotate_psm_ = ListUtils::toStringList<std::string>(param_.getValue("annotate:PSM"));
   }
 
@@ -292,9 +311,9 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
       if (!annotated_hits[scan_index].empty())
       {
         const MSSpectrum& spec = exp[scan_index];
-        // create empty PeptideIdentification object and fill meta data
+        // create empty PeptideIdentification object and fill meta data (reserved registry indices avoid name lookups in this parallel loop)
         PeptideIdentification pi{};
-        pi.setMetaValue("spectrum_reference", spec.getNativeID());
+        pi.setMetaValue(MetaInfoRegistry::SPECTRUM_REFERENCE, spec.getNativeID());
         pi.setMetaValue("scan_index", static_cast<unsigned int>(scan_index));
         pi.setScoreType("hyperscore");
         pi.setHigherScoreBetter(true);
@@ -340,24 +359,24 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
             }
             double median_ppm_error(0);
             if (!err.empty()) { median_ppm_error = Math::median(err.begin(), err.end(), false); }
-            ph.setMetaValue(Constants::UserParam::FRAGMENT_ERROR_MEDIAN_PPM_USERPARAM, median_ppm_error);
+            ph.setMetaValue(MetaInfoRegistry::FRAGMENT_ERROR_MEDIAN_PPM_USERPARAM, median_ppm_error);
           }
 
           if (annotation_precursor_error_ppm)
           {
             double theo_mz = fixed_and_variable_modified_peptide.getMZ(charge);
             double ppm_difference = Math::getPPM(mz, theo_mz);
-            ph.setMetaValue(Constants::UserParam::PRECURSOR_ERROR_PPM_USERPARAM, ppm_difference);
+            ph.setMetaValue(MetaInfoRegistry::PRECURSOR_ERROR_PPM_USERPARAM, ppm_difference);
           }
 
           if (annotation_prefix_fraction)
           {
-            ph.setMetaValue(Constants::UserParam::MATCHED_PREFIX_IONS_FRACTION, ah.prefix_fraction);
+            ph.setMetaValue(MetaInfoRegistry::MATCHED_PREFIX_IONS_FRACTION, ah.prefix_fraction);
           }
 
           if (annotation_suffix_fraction)
           {
-            ph.setMetaValue(Constants::UserParam::MATCHED_SUFFIX_IONS_FRACTION, ah.suffix_fraction);
+            ph.setMetaValue(MetaInfoRegistry::MATCHED_SUFFIX_IONS_FRACTION, ah.suffix_fraction);
           }
 
           // store PSM
@@ -418,6 +437,125 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
     protein_ids[0].setSearchParameters(std::move(search_parameters));
   }
 
+  String SimpleSearchEngineAlgorithm::getFragmentIndexSettings_(const vector<FASTAFile::FASTAEntry>& fasta_db, const ProteaseDigestion& digestor) const
+  {
+    // FNV-1a hash over all protein sequences (in search order, i.e. including the shuffled decoys)
+    UInt64 sequence_hash = 14695981039346656037ULL;
+    for (const auto& entry : fasta_db)
+    {
+      for (const char c : entry.sequence)
+      {
+        sequence_hash ^= static_cast<unsigned char>(c);
+        sequence_hash *= 1099511628211ULL;
+      }
+      sequence_hash ^= static_cast<unsigned char>('|');
+      sequence_hash *= 1099511628211ULL;
+    }
+
+    return "proteins=" + String(fasta_db.size())
+      + ";sequence_hash=" + String(sequence_hash)
+      + ";enzyme=" + enzyme_
+      + ";missed_cleavages=" + String(digestor.getMissedCleavages())
+      + ";min_size=" + String(peptide_min_size_)
+      + ";max_size=" + String(peptide_max_size_)
+      + ";motif=" + peptide_motif_
+      + ";fixed=" + ListUtils::concatenate(modifications_fixed_, ",")
+      + ";variable=" + ListUtils::concatenate(modifications_variable_, ",")
+      + ";max_variable_mods=" + String(modifications_max_variable_mods_per_peptide_);
+  }
+
+  void SimpleSearchEngineAlgorithm::buildFragmentIndex_(const vector<FASTAFile::FASTAEntry>& fasta_db,
+    const ProteaseDigestion& digestor,
+    const ModifiedPeptideGenerator::MapToResidueType& fixed_modifications,
+    const ModifiedPeptideGenerator::MapToResidueType& variable_modifications,
+    FragmentIndex& fragment_index) const
+  {
+    boost::regex peptide_motif_regex(peptide_motif_);
+
+    // only fragment positions are needed, so skip the meta data
+    TheoreticalSpectrumGenerator spectrum_generator;
+    Param param(spectrum_generator.getParameters());
+    param.setValue("add_first_prefix_ion", "true");
+    spectrum_generator.setParameters(param);
+
+    fragment_index.clear();
+
+    // lookup for processed peptides. must be defined outside of omp section and synchronized
+    set<StringView> processed_peptides;
+
+    Size count_proteins(0);
+
+    startProgress(0, fasta_db.size(), "Building fragment index...");
+#pragma omp parallel for schedule(static) default(none) shared(fasta_db, digestor, fixed_modifications, variable_modifications, spectrum_generator, peptide_motif_regex, processed_peptides, count_proteins, fragment_index)
+    for (SignedSize fasta_index = 0; fasta_index < (SignedSize)fasta_db.size(); ++fasta_index)
+    {
+      #pragma omp atomic
+      ++count_proteins;
+
+      IF_MASTERTHREAD
+      {
+        setProgress(count_proteins);
+      }
+
+      vector<StringView> current_digest;
+      digestor.digestUnmodified(fasta_db[fasta_index].sequence, current_digest, peptide_min_size_, peptide_max_size_);
+
+      for (auto const & c : current_digest)
+      {
+        const String current_peptide = c.getString();
+        if (current_peptide.find_first_of("XBZ") != std::string::npos)
+        {
+          continue;
+        }
+
+        // if a peptide motif is provided skip all peptides without match
+        if (!peptide_motif_.empty() && !boost::regex_match(current_peptide, peptide_motif_regex))
+        {
+          continue;
+        }
+
+        bool already_processed = false;
+        #pragma omp critical (processed_peptides_access)
+        {
+          already_processed = !processed_peptides.insert(c).second;
+        }
+
+        // skip peptides that have already been processed
+        if (already_processed) { continue; }
+
+        vector<AASequence> all_modified_peptides;
+
+        // ResidueDB and ModificationsDB are thread-safe (and lock-free for known residues once frozen)
+        AASequence aas = AASequence::fromString(current_peptide);
+        ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications, aas);
+        ModifiedPeptideGenerator::applyVariableModifications(variable_modifications, aas, modifications_max_variable_mods_per_peptide_, all_modified_peptides);
+
+        for (Size mod_pep_idx = 0; mod_pep_idx < all_modified_peptides.size(); ++mod_pep_idx)
+        {
+          const AASequence& candidate = all_modified_peptides[mod_pep_idx];
+
+          // add peaks for b and y ions with charge 1
+          PeakSpectrum theo_spectrum;
+          spectrum_generator.getSpectrum(theo_spectrum, candidate, 1, 1);
+
+          vector<double> fragment_mz;
+          fragment_mz.reserve(theo_spectrum.size());
+          for (const Peak1D& p : theo_spectrum) { fragment_mz.push_back(p.getMZ()); }
+
+          #pragma omp critical (fragment_index_access)
+          {
+            fragment_index.addPeptide(current_peptide, mod_pep_idx, candidate.toString(), candidate.getMonoWeight(), fragment_mz);
+          }
+        }
+      }
+    }
+    endProgress();
+
+    startProgress(0, 1, "Sorting fragment index...");
+    fragment_index.build();
+    endProgress();
+  }
+
   SimpleSearchEngineAlgorithm::ExitCodes SimpleSearchEngineAlgorithm::search(const String& in_mzML, const String& in_db, vector<ProteinIdentification>& protein_ids, vector<PeptideIdentification>& peptide_ids) const
   {
     boost::regex peptide_motif_regex(peptide_motif_);
@@ -428,6 +566,10 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
     ModifiedPeptideGenerator::MapToResidueType fixed_modifications = ModifiedPeptideGenerator::getModifications(modifications_fixed_);
     ModifiedPeptideGenerator::MapToResidueType variable_modifications = ModifiedPeptideGenerator::getModifications(modifications_variable_);
 
+    // all search modifications and their residues are registered now: freeze the databases (for the
+    // duration of the search) so that the (parallel) peptide modification below does not contend on their locks
+    ModificationsDB::FreezeGuard freeze_guard;
+
     // load MS2 map
     PeakMap spectra;
     MzMLFile f;
@@ -526,153 +668,291 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
       endProgress();
       digestor.setMissedCleavages(peptide_missed_cleavages_);
     }
-    startProgress(0, fasta_db.size(), "Scoring peptide models against spectra...");
+    // the fragment index owns the peptide sequences referenced by the annotated hits, so it needs to outlive post-processing
+    FragmentIndex fragment_index;
 
-    // lookup for processed peptides. must be defined outside of omp section and synchronized
-    set<StringView> processed_petides;
-
-    Size count_proteins(0), count_peptides(0);
+    if (fragment_index_enabled_)
+    {
+      const String fragment_index_settings = getFragmentIndexSettings_(fasta_db, digestor);
+      bool fragment_index_loaded = false;
+      if (!fragment_index_file_.empty() && File::exists(fragment_index_file_))
+      {
+        fragment_index_loaded = fragment_index.load(fragment_index_file_, fragment_index_settings);
+        if (!fragment_index_loaded)
+        {
+          OPENMS_LOG_INFO << "Fragment index '" << fragment_index_file_ << "' was created with different database or settings. Rebuilding it." << endl;
+        }
+      }
 
-#pragma omp parallel for schedule(static) default(none) shared(annotated_hits, spectrum_generator, multimap_mass_2_scan_index, fixed_modifications, variable_modifications, fasta_db, digestor, processed_petides, count_proteins, count_peptides, precursor_mass_tolerance_unit_ppm, fragment_mass_tolerance_unit_ppm, peptide_motif_regex, spectra, annotated_hits_lock)
-      for (SignedSize fasta_index = 0; fasta_index < (SignedSize)fasta_db.size(); ++fasta_index)
+      if (!fragment_index_loaded)
       {
+        buildFragmentIndex_(fasta_db, digestor, fixed_modifications, variable_modifications, fragment_index);
+        if (!fragment_index_file_.empty())
+        {
+          fragment_index.store(fragment_index_file_, fragment_index_settings);
+        }
+      }
 
-      #pragma omp atomic
-      ++count_proteins;
+      OPENMS_LOG_INFO << "Fragment index: " << fragment_index.size() << " peptides, " << fragment_index.fragmentCount() << " fragments." << endl;
 
-      IF_MASTERTHREAD
+      startProgress(0, spectra.size(), "Scoring spectra against fragment index...");
+      Size count_spectra(0);
+
+      // spectrum-centric: each thread owns the hits of the spectra it scores, so no locking is required
+#pragma omp parallel for schedule(dynamic) default(none) shared(annotated_hits, spectrum_generator, fragment_index, count_spectra, precursor_mass_tolerance_unit_ppm, fragment_mass_tolerance_unit_ppm, spectra)
+      for (SignedSize scan_index = 0; scan_index < (SignedSize)spectra.size(); ++scan_index)
       {
-        setProgress(count_proteins);
-      }
+        #pragma omp atomic
+        ++count_spectra;
 
-      vector<StringView> current_digest;
-      digestor.digestUnmodified(fasta_db[fasta_index].sequence, current_digest, peptide_min_size_, peptide_max_size_);
+        IF_MASTERTHREAD
+        {
+          setProgress(count_spectra);
+        }
 
-      for (auto const & c : current_digest)
-      { 
-        const String current_peptide = c.getString();
-        if (current_peptide.find_first_of("XBZ") != std::string::npos)
+        const PeakSpectrum& exp_spectrum = spectra[scan_index];
+        const vector<Precursor>& precursor = exp_spectrum.getPrecursors();
+
+        // same requirements as for the precursor mass lookup
+        if (precursor.size() != 1 || exp_spectrum.size() < peptide_min_size_) { continue; }
+
+        Size precursor_charge = precursor[0].getCharge();
+        if (precursor_charge < precursor_min_charge_
+         || precursor_charge > precursor_max_charge_)
         {
           continue;
         }
 
-        // if a peptide motif is provided skip all peptides without match
-        if (!peptide_motif_.empty() && !boost::regex_match(current_peptide, peptide_motif_regex))
+        double precursor_mz = precursor[0].getMZ();
+
+        vector<FragmentIndex::Candidate> candidates;
+        for (int isotope_number : precursor_isotopes_)
         {
-          continue;
-        }          
-      
-        bool already_processed = false;
-        #pragma omp critical (processed_peptides_access)
+          double precursor_mass = (double) precursor_charge * precursor_mz - (double) precursor_charge * Constants::PROTON_MASS_U;
+
+          // correct for monoisotopic misassignments of the precursor annotation
+          if (isotope_number != 0) { precursor_mass -= isotope_number * Constants::C13C12_MASSDIFF_U; }
+
+          const double tolerance = precursor_mass_tolerance_unit_ppm ? precursor_mass * precursor_mass_tolerance_ * 1e-6 : precursor_mass_tolerance_;
+          fragment_index.query(exp_spectrum, precursor_mass - tolerance, precursor_mass + tolerance,
+            fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm, fragment_index_min_matched_, candidates);
+        }
+
+        if (candidates.empty()) { continue; }
+
+        // remove peptides found for several isotopes (keep the entry with most matches)
+        std::sort(candidates.begin(), candidates.end(), [](const FragmentIndex::Candidate& a, const FragmentIndex::Candidate& b)
+        {
+          if (a.peptide_index != b.peptide_index) return a.peptide_index < b.peptide_index;
+          return a.matched_fragments > b.matched_fragments;
+        });
+        candidates.erase(std::unique(candidates.begin(), candidates.end(), [](const FragmentIndex::Candidate& a, const FragmentIndex::Candidate& b)
+        {
+          return a.peptide_index == b.peptide_index;
+        }), candidates.end());
+
+        // only score the candidates with most matching fragments
+        Size top_candidates = std::min(fragment_index_candidates_, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + top_candidates, candidates.end(), [](const FragmentIndex::Candidate& a, const FragmentIndex::Candidate& b)
+        {
+          if (a.matched_fragments != b.matched_fragments) return a.matched_fragments > b.matched_fragments;
+          return a.peptide_index < b.peptide_index;
+        });
+        candidates.resize(top_candidates);
+
+        for (const FragmentIndex::Candidate& cand : candidates)
         {
-          // peptide (and all modified variants) already processed so skip it
-          if (processed_petides.find(c) != processed_petides.end())
+          const FragmentIndex::Peptide& peptide = fragment_index.getPeptide(cand.peptide_index);
+
+          // the index stores the modified variant, so there is no need to enumerate the modifications again
+          // (parsing is cheap for repeated candidates, see AASequence::setParseCacheSize())
+          const AASequence candidate = AASequence::fromString(peptide.modified_sequence);
+
+          // create theoretical spectrum
+          PeakSpectrum theo_spectrum;
+
+          // add peaks for b and y ions with charge 1
+          spectrum_generator.getSpectrum(theo_spectrum, candidate, 1, 1);
+
+          // sort by mz
+          theo_spectrum.sortByPosition();
+
+          HyperScore::PSMDetail detail;
+          const double& score = HyperScore::computeWithDetail(fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectrum, detail);
+
+          if (score == 0)
           {
-            already_processed = true;
+            continue; // no hit?
           }
-          else
+
+          // add peptide hit
+          AnnotatedHit_ ah;
+          ah.sequence = StringView(peptide.sequence);
+          ah.peptide_mod_index = peptide.modification_index;
+          ah.score = score;
+          ah.prefix_fraction = (double)detail.matched_b_ions/(double)peptide.sequence.size();
+          ah.suffix_fraction = (double)detail.matched_y_ions/(double)peptide.sequence.size();
+          ah.mean_error = detail.mean_error;
+
+          annotated_hits[scan_index].push_back(ah);
+
+          // prevent vector from growing indefinitely (memory) but don't shrink the vector every time
+          if (annotated_hits[scan_index].size() >= 2 * report_top_hits_)
           {
-            processed_petides.insert(c);
+            std::partial_sort(annotated_hits[scan_index].begin(), annotated_hits[scan_index].begin() + report_top_hits_, annotated_hits[scan_index].end(), AnnotatedHit_::hasBetterScore);
+            annotated_hits[scan_index].resize(report_top_hits_);
           }
         }
+      }
+      endProgress();
+    }
+    else
+    {
+      startProgress(0, fasta_db.size(), "Scoring peptide models against spectra...");
 
-        // skip peptides that have already been processed
-        if (already_processed) { continue; }
-
-        #pragma omp atomic
-        ++count_peptides;
+      // lookup for processed peptides. must be defined outside of omp section and synchronized
+      set<StringView> processed_petides;
 
-        vector<AASequence> all_modified_peptides;
+      Size count_proteins(0), count_peptides(0);
 
-        // this critical section is because ResidueDB is not thread safe and new residues are created based on the PTMs
-        #pragma omp critical (residuedb_access)
+  #pragma omp parallel for schedule(static) default(none) shared(annotated_hits, spectrum_generator, multimap_mass_2_scan_index, fixed_modifications, variable_modifications, fasta_db, digestor, processed_petides, count_proteins, count_peptides, precursor_mass_tolerance_unit_ppm, fragment_mass_tolerance_unit_ppm, peptide_motif_regex, spectra, annotated_hits_lock)
+        for (SignedSize fasta_index = 0; fasta_index < (SignedSize)fasta_db.size(); ++fasta_index)
         {
-          AASequence aas = AASequence::fromString(current_peptide);
-          ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications, aas);
-          ModifiedPeptideGenerator::applyVariableModifications(variable_modifications, aas, modifications_max_variable_mods_per_peptide_, all_modified_peptides);
-        }
 
-        for (SignedSize mod_pep_idx = 0; mod_pep_idx < (SignedSize)all_modified_peptides.size(); ++mod_pep_idx)
+        #pragma omp atomic
+        ++count_proteins;
+
+        IF_MASTERTHREAD
         {
-          const AASequence& candidate = all_modified_peptides[mod_pep_idx];
-          double current_peptide_mass = candidate.getMonoWeight();
+          setProgress(count_proteins);
+        }
 
-          // determine MS2 precursors that match to the current peptide mass
-          multimap<double, Size>::const_iterator low_it;
-          multimap<double, Size>::const_iterator up_it;
+        vector<StringView> current_digest;
+        digestor.digestUnmodified(fasta_db[fasta_index].sequence, current_digest, peptide_min_size_, peptide_max_size_);
 
-          if (precursor_mass_tolerance_unit_ppm) // ppm
+        for (auto const & c : current_digest)
+        { 
+          const String current_peptide = c.getString();
+          if (current_peptide.find_first_of("XBZ") != std::string::npos)
           {
-            low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - current_peptide_mass * precursor_mass_tolerance_ * 1e-6);
-            up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + current_peptide_mass * precursor_mass_tolerance_ * 1e-6);
-          }
-          else // Dalton
-          {
-            low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - precursor_mass_tolerance_);
-            up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + precursor_mass_tolerance_);
+            continue;
           }
 
-          // no matching precursor in data
-          if (low_it == up_it)
-          { 
+          // if a peptide motif is provided skip all peptides without match
+          if (!peptide_motif_.empty() && !boost::regex_match(current_peptide, peptide_motif_regex))
+          {
             continue;
+          }          
+      
+          bool already_processed = false;
+          #pragma omp critical (processed_peptides_access)
+          {
+            // peptide (and all modified variants) already processed so skip it
+            if (processed_petides.find(c) != processed_petides.end())
+            {
+              already_processed = true;
+            }
+            else
+            {
+              processed_petides.insert(c);
+            }
           }
 
-          // create theoretical spectrum
-          PeakSpectrum theo_spectrum;
+          // skip peptides that have already been processed
+          if (already_processed) { continue; }
 
-          // add peaks for b and y ions with charge 1
-          spectrum_generator.getSpectrum(theo_spectrum, candidate, 1, 1);
+          #pragma omp atomic
+          ++count_peptides;
 
-          // sort by mz
-          theo_spectrum.sortByPosition();
+          vector<AASequence> all_modified_peptides;
 
-          for (; low_it != up_it; ++low_it)
+          // ResidueDB and ModificationsDB are thread-safe (and lock-free for known residues once frozen)
+          AASequence aas = AASequence::fromString(current_peptide);
+          ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications, aas);
+          ModifiedPeptideGenerator::applyVariableModifications(variable_modifications, aas, modifications_max_variable_mods_per_peptide_, all_modified_peptides);
+
+          for (SignedSize mod_pep_idx = 0; mod_pep_idx < (SignedSize)all_modified_peptides.size(); ++mod_pep_idx)
           {
-            const Size& scan_index = low_it->second;
-            const PeakSpectrum& exp_spectrum = spectra[scan_index];
-            // const int& charge = exp_spectrum.getPrecursors()[0].getCharge();
-            HyperScore::PSMDetail detail;
-            const double& score = HyperScore::computeWithDetail(fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectrum, detail);
+            const AASequence& candidate = all_modified_peptides[mod_pep_idx];
+            double current_peptide_mass = candidate.getMonoWeight();
+
+            // determine MS2 precursors that match to the current peptide mass
+            multimap<double, Size>::const_iterator low_it;
+            multimap<double, Size>::const_iterator up_it;
 
-            if (score == 0)
+            if (precursor_mass_tolerance_unit_ppm) // ppm
+            {
+              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - current_peptide_mass * precursor_mass_tolerance_ * 1e-6);
+              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + current_peptide_mass * precursor_mass_tolerance_ * 1e-6);
+            }
+            else // Dalton
+            {
+              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - precursor_mass_tolerance_);
+              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + precursor_mass_tolerance_);
+            }
+
+            // no matching precursor in data
+            if (low_it == up_it)
             { 
-              continue; // no hit?
+              continue;
             }
-            // add peptide hit
-            AnnotatedHit_ ah;
-            ah.sequence = c;
-            ah.peptide_mod_index = mod_pep_idx;
-            ah.score = score;
-            ah.prefix_fraction = (double)detail.matched_b_ions/(double)c.size();
-            ah.suffix_fraction = (double)detail.matched_y_ions/(double)c.size();
-            ah.mean_error = detail.mean_error;            
 
-#ifdef _OPENMP
-            omp_set_lock(&(annotated_hits_lock[scan_index]));
-            {
-#endif
-              annotated_hits[scan_index].push_back(ah);
+            // create theoretical spectrum
+            PeakSpectrum theo_spectrum;
+
+            // add peaks for b and y ions with charge 1
+            spectrum_generator.getSpectrum(theo_spectrum, candidate, 1, 1);
 
-              // prevent vector from growing indefinitely (memory) but don't shrink the vector every time
-              if (annotated_hits[scan_index].size() >= 2 * report_top_hits_)
+            // sort by mz
+            theo_spectrum.sortByPosition();
+
+            for (; low_it != up_it; ++low_it)
+            {
+              const Size& scan_index = low_it->second;
+              const PeakSpectrum& exp_spectrum = spectra[scan_index];
+              // const int& charge = exp_spectrum.getPrecursors()[0].getCharge();
+              HyperScore::PSMDetail detail;
+              const double& score = HyperScore::computeWithDetail(fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectrum, detail);
+
+              if (score == 0)
+              { 
+                continue; // no hit?
+              }
+              // add peptide hit
+              AnnotatedHit_ ah;
+              ah.sequence = c;
+              ah.peptide_mod_index = mod_pep_idx;
+              ah.score = score;
+              ah.prefix_fraction = (double)detail.matched_b_ions/(double)c.size();
+              ah.suffix_fraction = (double)detail.matched_y_ions/(double)c.size();
+              ah.mean_error = detail.mean_error;            
+
+  #ifdef _OPENMP
+              omp_set_lock(&(annotated_hits_lock[scan_index]));
               {
-                std::partial_sort(annotated_hits[scan_index].begin(), annotated_hits[scan_index].begin() + report_top_hits_, annotated_hits[scan_index].end(), AnnotatedHit_::hasBetterScore);
-                annotated_hits[scan_index].resize(report_top_hits_); 
+  #endif
+                annotated_hits[scan_index].push_back(ah);
+
+                // prevent vector from growing indefinitely (memory) but don't shrink the vector every time
+                if (annotated_hits[scan_index].size() >= 2 * report_top_hits_)
+                {
+                  std::partial_sort(annotated_hits[scan_index].begin(), annotated_hits[scan_index].begin() + report_top_hits_, annotated_hits[scan_index].end(), AnnotatedHit_::hasBetterScore);
+                  annotated_hits[scan_index].resize(report_top_hits_); 
+                }
+  #ifdef _OPENMP
               }
-#ifdef _OPENMP
+              omp_unset_lock(&(annotated_hits_lock[scan_index]));
+  #endif
             }
-            omp_unset_lock(&(annotated_hits_lock[scan_index]));
-#endif
           }
         }
       }
-    }
-    endProgress();
+      endProgress();
 
-    OPENMS_LOG_INFO << "Proteins: " << count_proteins << endl;
-    OPENMS_LOG_INFO << "Peptides: " << count_peptides << endl;
-    OPENMS_LOG_INFO << "Processed peptides: " << processed_petides.size() << endl;
+      OPENMS_LOG_INFO << "Proteins: " << count_proteins << endl;
+      OPENMS_LOG_INFO << "Peptides: " << count_peptides << endl;
+      OPENMS_LOG_INFO << "Processed peptides: " << processed_petides.size() << endl;
+    }
 
     startProgress(0, 1, "Post-processing PSMs...");
     SimpleSearchEngineAlgorithm::postProcessHits_(spectra, 
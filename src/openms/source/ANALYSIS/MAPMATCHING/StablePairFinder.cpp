@@ -37,6 +37,11 @@
 #include <OpenMS/KERNEL/FeatureMap.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
 
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <numeric>
+
 #ifdef Debug_StablePairFinder
 #define V_(bla) std::cout << __FILE__ ":" << __LINE__ << ": " << bla << std::endl;
 #else
@@ -106,94 +111,245 @@ namespace OpenMS
     DoublePair init = make_pair(FeatureDistance::infinity,
                                 FeatureDistance::infinity);
 
-    // for every element in map 0:
-    // - index of nearest neighbor in map 1:
-    vector<UInt> nn_index_0(input_maps[0].size(), UInt(-1));
-    // - distances to nearest and second-nearest neighbors in map 1:
-    vector<DoublePair> nn_distance_0(input_maps[0].size(), init);
-
-    // for every element in map 1:
-    // - index of nearest neighbor in map 0:
-    vector<UInt> nn_index_1(input_maps[1].size(), UInt(-1));
-    // - distances to nearest and second-nearest neighbors in map 0:
-    vector<DoublePair> nn_distance_1(input_maps[1].size(), init);
-
-    // iterate over all feature pairs, find nearest neighbors:
-    // TODO: iterate over SENSIBLE RT (and m/z) window -- sort the maps beforehand
-    //       to save a lot of processing time...
-    //       Once done, remove the warning in the description of the 'use_identifications' parameter
-    for (UInt fi0 = 0; fi0 < input_maps[0].size(); ++fi0)
+    // for every element in map 0 (1):
+    // - index of nearest neighbor in map 1 (0):
+    vector<UInt> nn_index[2];
+    // - distances to nearest and second-nearest neighbors in map 1 (0):
+    vector<DoublePair> nn_distance[2];
+    // - indices of the elements, sorted by m/z:
+    vector<UInt> mz_order[2];
+    // - corresponding m/z values:
+    vector<double> sorted_mz[2];
+    for (UInt input = 0; input <= 1; ++input)
     {
-      const ConsensusFeature& feat0 = input_maps[0][fi0];
-
-      for (UInt fi1 = 0; fi1 < input_maps[1].size(); ++fi1)
+      nn_index[input].resize(input_maps[input].size(), UInt(-1));
+      nn_distance[input].resize(input_maps[input].size(), init);
+      mz_order[input].resize(input_maps[input].size());
+      std::iota(mz_order[input].begin(), mz_order[input].end(), 0);
+      const ConsensusMap& map = input_maps[input];
+      std::stable_sort(mz_order[input].begin(), mz_order[input].end(),
+                       [&map](UInt i, UInt j) { return map[i].getMZ() < map[j].getMZ(); });
+      sorted_mz[input].reserve(map.size());
+      for (UInt index : mz_order[input])
       {
-        const ConsensusFeature& feat1 = input_maps[1][fi1];
+        sorted_mz[input].push_back(map[index].getMZ());
+      }
+    }
 
-        if (use_IDs_ && !compatibleIDs_(feat0, feat1)) // check peptide IDs
+    // Instead of comparing all pairs of features, the neighbors of a feature
+    // are searched for by m/z in the other map: the distance of a pair is at
+    // least its m/z distance alone (computed via a "probe" feature that
+    // differs from the query only in m/z). The search is restricted to
+    // features that may be closer than the largest distance of any valid pair
+    // ('max_valid_distance'). Features further away can never become nearest
+    // neighbors or prevent a nearer feature from becoming one, they only
+    // matter as second-nearest neighbors if no closer feature follows the
+    // nearest neighbor (in the order of indices), which is checked in a second
+    // sweep. Candidates are processed in the order of their indices, as when
+    // comparing all pairs, so the result is exactly the same.
+    double max_valid_distance = FeatureDistance::infinity;
+    if (!input_maps[0].empty() && !input_maps[1].empty())
+    {
+      float min_intensity = numeric_limits<float>::max(), max_intensity_all = numeric_limits<float>::lowest();
+      for (UInt input = 0; input <= 1; ++input)
+      {
+        for (const ConsensusFeature& feat : input_maps[input])
         {
-          continue; // mismatch
+          min_intensity = min(min_intensity, feat.getIntensity());
+          max_intensity_all = max(max_intensity_all, feat.getIntensity());
         }
+      }
+      // a pair at the maximum allowed RT and m/z differences:
+      BaseFeature left, right;
+      double mz = sorted_mz[0].back();
+      double max_diff_mz = distance_params.getValue("distance_MZ:max_difference");
+      if (distance_params.getValue("distance_MZ:unit") == "ppm")
+      {
+        max_diff_mz *= mz * 1e-6;
+      }
+      left.setMZ(mz);
+      right.setMZ(mz + max_diff_mz);
+      left.setRT(0.0);
+      right.setRT(distance_params.getValue("distance_RT:max_difference"));
+      left.setIntensity(min_intensity);
+      right.setIntensity(max_intensity_all);
+      // leave a margin for rounding errors (a larger bound only reduces the pruning):
+      max_valid_distance = feature_distance(left, right).second * (1.0 + 1e-6) + 1e-12;
+    }
 
-        pair<bool, double> result = feature_distance(feat0, feat1);
-        double distance = result.second;
-        // we only care if distance constraints are satisfied for "best
-        // matches", not for second-best; this means that second-best distances
-        // can become smaller than best distances
-        // (e.g. the RT is larger than allowed (->invalid pair), but m/z is perfect and has the most weight --> better score!)
-        bool valid = result.first;
+    std::exception_ptr first_error;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      // the distance functor is not thread-safe (for m/z tolerances in ppm):
+      FeatureDistance thread_distance(max_intensity, false);
+      thread_distance.setParameters(distance_params);
+      BaseFeature probe;
+      vector<UInt> candidates;
+
+      // the distance is always computed as "d(feature in map 0, feature in map 1)":
+      auto pair_distance = [&thread_distance](UInt query_map, const BaseFeature& query, const BaseFeature& other)
+      {
+        return (query_map == 0) ? thread_distance(query, other) : thread_distance(other, query);
+      };
 
-        // update entries for map 0:
-        if (distance < nn_distance_0[fi0].second)
+      const SignedSize n_queries = input_maps[0].size() + input_maps[1].size();
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 256)
+#endif
+      for (SignedSize query_pos = 0; query_pos < n_queries; ++query_pos)
+      {
+        try
         {
-          if (valid && (distance < nn_distance_0[fi0].first))
+          const UInt query_map = (query_pos < SignedSize(input_maps[0].size())) ? 0 : 1;
+          const UInt query_index = UInt(query_map == 0 ? query_pos : query_pos - input_maps[0].size());
+          const ConsensusFeature& query = input_maps[query_map][query_index];
+          const ConsensusMap& other_map = input_maps[1 - query_map];
+          const vector<UInt>& order = mz_order[1 - query_map];
+          const vector<double>& mzs = sorted_mz[1 - query_map];
+          UInt& nn_index_query = nn_index[query_map][query_index];
+          DoublePair& nn_distance_query = nn_distance[query_map][query_index];
+
+          probe.setRT(query.getRT());
+          probe.setIntensity(query.getIntensity());
+          probe.setCharge(query.getCharge());
+          auto min_distance = [&](Size pos)
+          {
+            probe.setMZ(mzs[pos]);
+            return pair_distance(query_map, query, probe).second;
+          };
+
+          // collect candidates that may be closer than a valid pair:
+          candidates.clear();
+          const SignedSize start = std::lower_bound(mzs.begin(), mzs.end(), query.getMZ()) - mzs.begin();
+          SignedSize down = start - 1;
+          for (; (down >= 0) && !(min_distance(down) > max_valid_distance); --down)
           {
-            nn_distance_0[fi0].second = nn_distance_0[fi0].first;
-            nn_distance_0[fi0].first = distance;
-            nn_index_0[fi0] = fi1;
+            candidates.push_back(order[down]);
           }
-          else
+          SignedSize up = start;
+          for (; (up < SignedSize(mzs.size())) && !(min_distance(up) > max_valid_distance); ++up)
           {
-            nn_distance_0[fi0].second = distance;
+            candidates.push_back(order[up]);
           }
-        }
-        // update entries for map 1:
-        if (distance < nn_distance_1[fi1].second)
-        {
-          if (valid && (distance < nn_distance_1[fi1].first))
+          std::sort(candidates.begin(), candidates.end());
+
+          SignedSize last_nn_update = -1;
+          for (UInt other_index : candidates)
           {
-            nn_distance_1[fi1].second = nn_distance_1[fi1].first;
-            nn_distance_1[fi1].first = distance;
-            nn_index_1[fi1] = fi0;
+            const ConsensusFeature& other = other_map[other_index];
+
+            if (use_IDs_ && !compatibleIDs_(query, other)) // check peptide IDs
+            {
+              continue; // mismatch
+            }
+
+            pair<bool, double> result = pair_distance(query_map, query, other);
+            double distance = result.second;
+            // we only care if distance constraints are satisfied for "best
+            // matches", not for second-best; this means that second-best distances
+            // can become smaller than best distances
+            // (e.g. the RT is larger than allowed (->invalid pair), but m/z is perfect and has the most weight --> better score!)
+            bool valid = result.first;
+
+            if (distance < nn_distance_query.second)
+            {
+              if (valid && (distance < nn_distance_query.first))
+              {
+                nn_distance_query.second = nn_distance_query.first;
+                nn_distance_query.first = distance;
+                nn_index_query = other_index;
+                last_nn_update = other_index;
+              }
+              else
+              {
+                nn_distance_query.second = distance;
+              }
+            }
           }
-          else
+
+          // second-nearest neighbor among the remaining features (only needed
+          // if there is a nearest neighbor); search outwards in m/z until the
+          // lower bound exceeds the current second-nearest distance:
+          if ((nn_distance_query.first < FeatureDistance::infinity) &&
+              (nn_distance_query.second > max_valid_distance))
           {
-            nn_distance_1[fi1].second = distance;
+            const double slack = 1.0 + 1e-9; // for rounding errors in the lower bound
+            double bound_down = (down >= 0) ? min_distance(down) : FeatureDistance::infinity;
+            double bound_up = (up < SignedSize(mzs.size())) ? min_distance(up) : FeatureDistance::infinity;
+            while (true)
+            {
+              bool go_down = (down >= 0) && !(bound_down > bound_up);
+              bool go_up = !go_down && (up < SignedSize(mzs.size()));
+              if (!go_down && !go_up)
+              {
+                break;
+              }
+              if ((go_down ? bound_down : bound_up) > nn_distance_query.second * slack)
+              {
+                break;
+              }
+              UInt other_index = order[go_down ? down : up];
+              if (go_down)
+              {
+                --down;
+                bound_down = (down >= 0) ? min_distance(down) : FeatureDistance::infinity;
+              }
+              else
+              {
+                ++up;
+                bound_up = (up < SignedSize(mzs.size())) ? min_distance(up) : FeatureDistance::infinity;
+              }
+              // features before the nearest neighbor were superseded by it:
+              if (SignedSize(other_index) <= last_nn_update)
+              {
+                continue;
+              }
+              const ConsensusFeature& other = other_map[other_index];
+              if (use_IDs_ && !compatibleIDs_(query, other))
+              {
+                continue;
+              }
+              nn_distance_query.second = min(nn_distance_query.second,
+                                             pair_distance(query_map, query, other).second);
+            }
           }
         }
+        catch (...)
+        {
+#ifdef _OPENMP
+#pragma omp critical (StablePairFinder_error)
+#endif
+          if (!first_error) first_error = std::current_exception();
+        }
       }
     }
+    if (first_error)
+    {
+      std::rethrow_exception(first_error);
+    }
 
     // if features from the two maps are nearest neighbors of each other, they
     // can become a pair:
     for (UInt fi0 = 0; fi0 < input_maps[0].size(); ++fi0)
     {
-      UInt fi1 = nn_index_0[fi0]; // nearest neighbor of "fi0" in map 1
+      UInt fi1 = nn_index[0][fi0]; // nearest neighbor of "fi0" in map 1
       // cout << "index: " << fi0 << ", RT: " << input_maps[0][fi0].getRT()
       //         << ", MZ: " << input_maps[0][fi0].getMZ() << endl
       //         << "neighbor: " << fi1 << ", RT: " << input_maps[1][fi1].getRT()
       //         << ", MZ: " << input_maps[1][fi1].getMZ() << endl
-      //         << "d(i,j): " << nn_distance_0[fi0].first << endl
-      //         << "d2(i): " << nn_distance_0[fi0].second << endl
-      //         << "d2(j): " << nn_distance_1[fi1].second << endl;
+      //         << "d(i,j): " << nn_distance[0][fi0].first << endl
+      //         << "d2(i): " << nn_distance[0][fi0].second << endl
+      //         << "d2(j): " << nn_distance[1][fi1].second << endl;
 
       // criteria set by the parameters must be fulfilled:
-      if ((nn_distance_0[fi0].first < FeatureDistance::infinity) &&
-          (nn_distance_0[fi0].first * second_nearest_gap_ <= nn_distance_0[fi0].second))
+      if ((nn_distance[0][fi0].first < FeatureDistance::infinity) &&
+          (nn_distance[0][fi0].first * second_nearest_gap_ <= nn_distance[0][fi0].second))
       {
         // "fi0" satisfies constraints...
-        if ((nn_index_1[fi1] == fi0) &&
-            (nn_distance_1[fi1].first * second_nearest_gap_ <= nn_distance_1[fi1].second))
+        if ((nn_index[1][fi1] == fi0) &&
+            (nn_distance[1][fi1].first * second_nearest_gap_ <= nn_distance[1][fi1].second))
         {
           // ...nearest neighbor of "fi0" also satisfies constraints (yay!)
           // cout << "match!" << endl;
@@ -204,9 +360,9 @@ namespace OpenMS
           f.insert(input_maps[1][fi1]);
 
           f.computeConsensus();
-          double quality = 1.0 - nn_distance_0[fi0].first;
-          double quality0 = 1.0 - nn_distance_0[fi0].first * second_nearest_gap_ / nn_distance_0[fi0].second;
-          double quality1 = 1.0 - nn_distance_1[fi1].first * second_nearest_gap_ / nn_distance_1[fi1].second;
+          double quality = 1.0 - nn_distance[0][fi0].first;
+          double quality0 = 1.0 - nn_distance[0][fi0].first * second_nearest_gap_ / nn_distance[0][fi0].second;
+          double quality1 = 1.0 - nn_distance[1][fi1].first * second_nearest_gap_ / nn_distance[1][fi1].second;
           quality = quality * quality0 * quality1; // TODO other formula?
 
           // incorporate existing quality values:
@@ -37,11 +37,71 @@
 #include <OpenMS/DATASTRUCTURES/String.h>
 
 #include <OpenMS/CONCEPT/Exception.h>
+#include <algorithm>
 #include <iostream>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OPENMS_EXTRACTOR_SSE2
+#endif
+
 namespace OpenMS
 {
 
+  namespace
+  {
+    /// sum of x[lo, hi) (with SSE2 in a different order than a sequential loop, i.e. not bit-identical to it)
+    inline double sumRange(const double* x, Size lo, const Size hi)
+    {
+      double sum = 0;
+#ifdef OPENMS_EXTRACTOR_SSE2
+      __m128d acc0 = _mm_setzero_pd();
+      __m128d acc1 = _mm_setzero_pd();
+      for (; lo + 4 <= hi; lo += 4)
+      {
+        acc0 = _mm_add_pd(acc0, _mm_loadu_pd(x + lo));
+        acc1 = _mm_add_pd(acc1, _mm_loadu_pd(x + lo + 2));
+      }
+      double tmp[2];
+      _mm_storeu_pd(tmp, _mm_add_pd(acc0, acc1));
+      sum = tmp[0] + tmp[1];
+#endif
+      for (; lo < hi; ++lo)
+      {
+        sum += x[lo];
+      }
+      return sum;
+    }
+
+    /// sum of x[i] for i in [lo, hi) with im_left < im[i] < im_right (summation order as in sumRange())
+    inline double sumRangeIM(const double* x, const double* im, Size lo, const Size hi, const double im_left, const double im_right)
+    {
+      double sum = 0;
+#ifdef OPENMS_EXTRACTOR_SSE2
+      const __m128d left = _mm_set1_pd(im_left);
+      const __m128d right = _mm_set1_pd(im_right);
+      __m128d acc = _mm_setzero_pd();
+      for (; lo + 2 <= hi; lo += 2)
+      {
+        const __m128d v = _mm_loadu_pd(im + lo);
+        const __m128d mask = _mm_and_pd(_mm_cmpgt_pd(v, left), _mm_cmplt_pd(v, right));
+        acc = _mm_add_pd(acc, _mm_and_pd(mask, _mm_loadu_pd(x + lo)));
+      }
+      double tmp[2];
+      _mm_storeu_pd(tmp, acc);
+      sum = tmp[0] + tmp[1];
+#endif
+      for (; lo < hi; ++lo)
+      {
+        if (im[lo] > im_left && im[lo] < im_right)
+        {
+          sum += x[lo];
+        }
+      }
+      return sum;
+    }
+  }
+
   void ChromatogramExtractorAlgorithm::extract_value_tophat(
       const std::vector<double>::const_iterator& mz_start,
             std::vector<double>::const_iterator& mz_it,
@@ -296,36 +356,67 @@ namespace OpenMS
         "Input to extractChromatogram needs to be sorted by m/z");
     }
 
+    if (used_filter == 2)
+    {
+      throw Exception::NotImplemented(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION);
+    }
+
+    // compute all extraction windows once, they are swept over each spectrum below
+    const bool has_im = (im_extraction_window > 0.0);
+    std::vector<double> target_mz, target_im;
+    target_mz.reserve(extraction_coordinates.size());
+    target_im.reserve(extraction_coordinates.size());
+    for (const auto& coord : extraction_coordinates)
+    {
+      target_mz.push_back(coord.mz);
+      target_im.push_back(has_im ? coord.ion_mobility : -1.0);
+    }
+    TophatWindows_ windows;
+    prepareTophatWindows_(target_mz, target_im, mz_extraction_window, im_extraction_window, ppm, windows);
+
+    std::vector<Size> active;
+    std::vector<double> integrated_intensities;
+    active.reserve(extraction_coordinates.size());
+
+    // all spectra are read into the same buffer to avoid allocations (spectra
+    // held by the access are used directly, filling the buffer would copy them)
+    const bool in_memory = input->hasStableSpectra();
+    OpenSwath::Spectrum buffer;
+    OpenSwath::SpectrumPtr in_memory_spectrum;
+
     //go through all spectra
     startProgress(0, input_size, "Extracting chromatograms");
     for (Size scan_idx = 0; scan_idx < input_size; ++scan_idx)
     {
       setProgress(scan_idx);
 
-      OpenSwath::SpectrumPtr sptr = input->getSpectrumById(scan_idx);
+      if (in_memory)
+      {
+        in_memory_spectrum = input->getSpectrumById(scan_idx);
+      }
+      else
+      {
+        input->fillSpectrumById(scan_idx, buffer);
+      }
+      const OpenSwath::Spectrum& spectrum = in_memory ? *in_memory_spectrum : buffer;
       OpenSwath::SpectrumMeta s_meta = input->getSpectrumMetaById(scan_idx);
 
-      OpenSwath::BinaryDataArrayPtr mz_arr = sptr->getMZArray();
-      OpenSwath::BinaryDataArrayPtr int_arr = sptr->getIntensityArray();
-      std::vector<double>::const_iterator mz_start = mz_arr->data.begin();
-      std::vector<double>::const_iterator mz_end = mz_arr->data.end();
-      std::vector<double>::const_iterator mz_it = mz_arr->data.begin();
-      std::vector<double>::const_iterator int_it = int_arr->data.begin();
-      std::vector<double>::const_iterator im_it;
+      const OpenSwath::BinaryDataArrayPtr& mz_arr = spectrum.getDataArrays()[0];
+      const OpenSwath::BinaryDataArrayPtr& int_arr = spectrum.getDataArrays()[1];
 
-      if (sptr->getMZArray()->data.empty())
+      if (mz_arr->data.empty())
       {
         continue;
       }
 
       // Look for ion mobility array
-      bool has_im = (im_extraction_window > 0.0);
+      const double* im_ptr = nullptr;
       if (has_im)
       {
-        OpenSwath::BinaryDataArrayPtr im_arr = sptr->getDriftTimeArray();
+        OpenSwath::BinaryDataArrayPtr im_arr = spectrum.getDriftTimeArray();
         if (im_arr != nullptr)
         {
-          im_it = im_arr->data.begin();
+          im_ptr = im_arr->data.data();
         }
         else
         {
@@ -334,49 +425,159 @@ namespace OpenMS
         }
       }
 
-      // go through all transitions / chromatograms which are sorted by
-      // ProductMZ. We can use this to step through the spectrum and at the
-      // same time step through the transitions. We increase the peak counter
-      // until we hit the next transition and then extract the signal.
+      // select all coordinates whose RT window contains the current spectrum
+      // (they remain sorted by m/z)
+      const double current_rt = s_meta.RT;
+      active.clear();
       for (Size k = 0; k < extraction_coordinates.size(); ++k)
       {
-        double integrated_intensity = 0;
-        double current_rt = s_meta.RT;
         if (extraction_coordinates[k].rt_end - extraction_coordinates[k].rt_start > 0 &&
              (current_rt < extraction_coordinates[k].rt_start ||
               current_rt > extraction_coordinates[k].rt_end) )
         {
           continue;
         }
+        active.push_back(k);
+      }
 
-        const bool use_im = (extraction_coordinates[k].ion_mobility >= 0.0 && has_im);
-        if (!use_im && used_filter == 1)
-        {
-          extract_value_tophat(mz_start, mz_it, mz_end, int_it,
-                               extraction_coordinates[k].mz, integrated_intensity, mz_extraction_window, ppm);
-        }
-        else if (use_im && used_filter == 1)
-        {
-          if (extraction_coordinates[k].ion_mobility < 0)
-          {
-            std::cerr << "WARNING : Drift time of ion is negative!" << std::endl;
-          }
-          extract_value_tophat(mz_start, mz_it, mz_end, int_it, im_it,
-                               extraction_coordinates[k].mz, extraction_coordinates[k].ion_mobility,
-                               integrated_intensity, mz_extraction_window, im_extraction_window, ppm);
-        }
-        else if (used_filter == 2)
-        {
-          throw Exception::NotImplemented(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION);
-        }
+      extractTophat_(mz_arr->data.data(), int_arr->data.data(), im_ptr, mz_arr->data.size(),
+                     windows, active, integrated_intensities);
 
-        output[k]->getTimeArray()->data.push_back(current_rt);
-        output[k]->getIntensityArray()->data.push_back(integrated_intensity);
+      for (Size i = 0; i < active.size(); ++i)
+      {
+        output[active[i]]->getTimeArray()->data.push_back(current_rt);
+        output[active[i]]->getIntensityArray()->data.push_back(integrated_intensities[i]);
       }
     }
     endProgress();
   }
 
+  void ChromatogramExtractorAlgorithm::extract_values_tophat(
+      const std::vector<double>& mz_array,
+      const std::vector<double>& int_array,
+      const std::vector<double>& im_array,
+      const std::vector<double>& mz,
+      const std::vector<double>& im,
+      std::vector<double>& integrated_intensities,
+      const double mz_extraction_window,
+      const double im_extraction_window,
+      const bool ppm)
+  {
+    if (mz_array.size() != int_array.size() || (!im_array.empty() && im_array.size() != mz_array.size()) ||
+        (!im.empty() && im.size() != mz.size()))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Spectrum arrays and target arrays need to have matching sizes.");
+    }
+    if (!std::is_sorted(mz.begin(), mz.end()))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Target m/z values need to be sorted.");
+    }
+
+    TophatWindows_ windows;
+    prepareTophatWindows_(mz, im, mz_extraction_window, im_extraction_window, ppm, windows);
+
+    std::vector<Size> active(mz.size());
+    for (Size k = 0; k < active.size(); ++k)
+    {
+      active[k] = k;
+    }
+    const double* im_ptr = (im_array.empty() || im.empty()) ? nullptr : im_array.data();
+    extractTophat_(mz_array.data(), int_array.data(), im_ptr, mz_array.size(), windows, active, integrated_intensities);
+  }
+
+  void ChromatogramExtractorAlgorithm::prepareTophatWindows_(const std::vector<double>& mz,
+      const std::vector<double>& im,
+      const double mz_extraction_window,
+      const double im_extraction_window,
+      const bool ppm,
+      TophatWindows_& windows)
+  {
+    const Size n = mz.size();
+    windows.mz = mz;
+    windows.left.resize(n);
+    windows.right.resize(n);
+    windows.im_left.resize(n);
+    windows.im_right.resize(n);
+    windows.use_im.resize(n);
+    for (Size k = 0; k < n; ++k)
+    {
+      // same window computation as in extract_value_tophat
+      if (ppm)
+      {
+        windows.left[k]  = mz[k] - mz[k] * mz_extraction_window / 2.0 * 1.0e-6;
+        windows.right[k] = mz[k] + mz[k] * mz_extraction_window / 2.0 * 1.0e-6;
+      }
+      else
+      {
+        windows.left[k]  = mz[k] - mz_extraction_window / 2.0;
+        windows.right[k] = mz[k] + mz_extraction_window / 2.0;
+      }
+      windows.use_im[k] = !im.empty() && im[k] >= 0.0;
+      if (windows.use_im[k])
+      {
+        windows.im_left[k]  = im[k] - im_extraction_window / 2.0;
+        windows.im_right[k] = im[k] + im_extraction_window / 2.0;
+      }
+    }
+  }
+
+  void ChromatogramExtractorAlgorithm::extractTophat_(const double* mz,
+      const double* intensity,
+      const double* im,
+      const Size n,
+      const TophatWindows_& windows,
+      const std::vector<Size>& active,
+      std::vector<double>& integrated_intensities)
+  {
+    integrated_intensities.assign(active.size(), 0.0);
+    if (n == 0)
+    {
+      return;
+    }
+
+    // Since the targets are sorted by m/z, all window bounds are ascending
+    // as well and three cursors suffice, each of which only moves forward:
+    //  - pos: first data point with m/z >= target m/z
+    //  - lo:  first data point with m/z > left bound
+    //  - hi:  first data point with m/z >= right bound
+    // The data points in [lo, hi) are exactly the ones within the window.
+    Size pos = 0, lo = 0, hi = 0;
+    for (Size i = 0; i < active.size(); ++i)
+    {
+      const Size k = active[i];
+      while (pos < n && mz[pos] < windows.mz[k]) ++pos;
+      while (lo < n && mz[lo] <= windows.left[k]) ++lo;
+      hi = std::max(hi, lo);
+      while (hi < n && mz[hi] < windows.right[k]) ++hi;
+
+      // Reproduce the boundary handling of extract_value_tophat exactly:
+      // walking left from the target position, the very first data point is
+      // only reached if the target position is the first or second data
+      // point; if the target is beyond the last data point, the last data
+      // point is visited twice.
+      const Size from = (lo == 0 && pos >= 2) ? 1 : lo;
+      const bool use_im = (im != nullptr && windows.use_im[k]);
+
+      double sum;
+      if (use_im)
+      {
+        sum = sumRangeIM(intensity, im, from, hi, windows.im_left[k], windows.im_right[k]);
+      }
+      else
+      {
+        sum = sumRange(intensity, from, hi);
+      }
+      if (pos == n && lo < n && hi == n &&
+          (!use_im || (im[n - 1] > windows.im_left[k] && im[n - 1] < windows.im_right[k])))
+      {
+        sum += intensity[n - 1];
+      }
+      integrated_intensities[i] = sum;
+    }
+  }
+
   int ChromatogramExtractorAlgorithm::getFilterNr_(const String& filter)
   {
     if (filter == "tophat")
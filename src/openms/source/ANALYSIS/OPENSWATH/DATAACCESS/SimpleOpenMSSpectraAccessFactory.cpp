@@ -35,6 +35,9 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMS.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCached.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedMapped.h>
+
+#include <OpenMS/config.h>
 
 namespace OpenMS
 {
@@ -69,7 +72,13 @@ namespace OpenMS
     bool is_cached = SimpleOpenMSSpectraFactory::isExperimentCached(exp);
     if (is_cached)
     {
+#ifdef OPENMS_64BIT_ARCHITECTURE
+      // map the cached file into memory: no file pointer is shared and
+      // lightClone() does not need to re-open the file for each thread
+      OpenSwath::SpectrumAccessPtr experiment(new OpenMS::SpectrumAccessOpenMSCachedMapped(exp->getLoadedFilePath()));
+#else
       OpenSwath::SpectrumAccessPtr experiment(new OpenMS::SpectrumAccessOpenMSCached(exp->getLoadedFilePath()));
+#endif
       return experiment;
     }
     else
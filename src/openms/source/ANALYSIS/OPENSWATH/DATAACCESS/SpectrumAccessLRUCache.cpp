@@ -0,0 +1,109 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessLRUCache.h>
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSInMemory.h>
+
+namespace OpenMS
+{
+
+  SpectrumAccessLRUCache::SpectrumAccessLRUCache(OpenSwath::SpectrumAccessPtr sptr, Size capacity) :
+    SpectrumAccessTransforming(sptr),
+    capacity_(capacity),
+    hits_(0),
+    misses_(0)
+  {
+    cache_index_.reserve(capacity_);
+  }
+
+  SpectrumAccessLRUCache::~SpectrumAccessLRUCache() {}
+
+  OpenSwath::SpectrumAccessPtr SpectrumAccessLRUCache::create(OpenSwath::SpectrumAccessPtr sptr, Size capacity)
+  {
+    if (capacity == 0 || !sptr ||
+        dynamic_cast<SpectrumAccessOpenMSInMemory*>(sptr.get()) != nullptr ||
+        dynamic_cast<SpectrumAccessLRUCache*>(sptr.get()) != nullptr)
+    {
+      return sptr;
+    }
+    return boost::shared_ptr<SpectrumAccessLRUCache>(new SpectrumAccessLRUCache(sptr, capacity));
+  }
+
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> SpectrumAccessLRUCache::lightClone() const
+  {
+    // The cache itself is not shared: each clone starts out empty
+    return boost::shared_ptr<SpectrumAccessLRUCache>(
+        new SpectrumAccessLRUCache(sptr_->lightClone(), capacity_));
+  }
+
+  OpenSwath::SpectrumPtr SpectrumAccessLRUCache::getSpectrumById(int id)
+  {
+    auto it = cache_index_.find(id);
+    if (it != cache_index_.end())
+    {
+      ++hits_;
+      // move to the front (most recently used)
+      cache_.splice(cache_.begin(), cache_, it->second);
+      return it->second->second;
+    }
+
+    ++misses_;
+    OpenSwath::SpectrumPtr s = sptr_->getSpectrumById(id);
+    if (capacity_ == 0)
+    {
+      return s;
+    }
+
+    if (cache_.size() >= capacity_)
+    {
+      cache_index_.erase(cache_.back().first);
+      cache_.pop_back();
+    }
+    cache_.emplace_front(id, s);
+    cache_index_[id] = cache_.begin();
+    return s;
+  }
+
+  Size SpectrumAccessLRUCache::getNrHits() const
+  {
+    return hits_;
+  }
+
+  Size SpectrumAccessLRUCache::getNrMisses() const
+  {
+    return misses_;
+  }
+
+}
@@ -59,50 +59,46 @@ namespace OpenMS
   }
 
   OpenSwath::SpectrumPtr SpectrumAccessOpenMS::getSpectrumById(int id)
+  {
+    OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
+    fillSpectrumById(id, *sptr);
+    return sptr;
+  }
+
+  void SpectrumAccessOpenMS::fillSpectrumById(int id, OpenSwath::Spectrum& s)
   {
     OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
     OPENMS_PRECONDITION(id < (int)getNrSpectra(), "Id cannot be larger than number of spectra");
 
     const MSSpectrumType& spectrum = (*ms_experiment_)[id];
-    OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
-    OpenSwath::BinaryDataArrayPtr mz_array(new OpenSwath::BinaryDataArray);
-    mz_array->data.reserve(spectrum.size());
-    intensity_array->data.reserve(spectrum.size());
-    for (const auto& it : spectrum)
+    prepareDataArrays_(s, 2 + spectrum.getFloatDataArrays().size() + spectrum.getIntegerDataArrays().size());
+    std::vector<OpenSwath::BinaryDataArrayPtr>& arrays = s.getDataArrays();
+
+    std::vector<double>& mz = arrays[0]->data;
+    std::vector<double>& intensity = arrays[1]->data;
+    arrays[0]->description.clear();
+    arrays[1]->description.clear();
+    mz.resize(spectrum.size());
+    intensity.resize(spectrum.size());
+    for (Size i = 0; i < spectrum.size(); ++i)
     {
-      mz_array->data.push_back(it.getMZ());
-      intensity_array->data.push_back(it.getIntensity());
+      mz[i] = spectrum[i].getMZ();
+      intensity[i] = spectrum[i].getIntensity();
     }
 
-    OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
-    sptr->setMZArray(mz_array);
-    sptr->setIntensityArray(intensity_array);
-
-    for (const auto& fda : spectrum.getFloatDataArrays() )
+    Size k = 2;
+    for (const auto& fda : spectrum.getFloatDataArrays())
     {
-      OpenSwath::BinaryDataArrayPtr tmp(new OpenSwath::BinaryDataArray);
-      tmp->data.reserve(fda.size());
-      for (const auto& val : fda)
-      {
-        tmp->data.push_back(val);
-      }
-      tmp->description = fda.getName();
-      sptr->getDataArrays().push_back(tmp);
+      arrays[k]->data.assign(fda.begin(), fda.end());
+      arrays[k]->description = fda.getName();
+      ++k;
     }
-
-    for (const auto& ida : spectrum.getIntegerDataArrays() )
+    for (const auto& ida : spectrum.getIntegerDataArrays())
     {
-      OpenSwath::BinaryDataArrayPtr tmp(new OpenSwath::BinaryDataArray);
-      tmp->data.reserve(ida.size());
-      for (const auto& val : ida)
-      {
-        tmp->data.push_back(val);
-      }
-      tmp->description = ida.getName();
-      sptr->getDataArrays().push_back(tmp);
+      arrays[k]->data.assign(ida.begin(), ida.end());
+      arrays[k]->description = ida.getName();
+      ++k;
     }
-
-    return sptr;
   }
 
   OpenSwath::SpectrumMeta SpectrumAccessOpenMS::getSpectrumMetaById(int id) const
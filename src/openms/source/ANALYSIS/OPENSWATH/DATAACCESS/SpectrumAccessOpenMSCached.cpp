@@ -61,6 +61,13 @@ namespace OpenMS
   }
 
   OpenSwath::SpectrumPtr SpectrumAccessOpenMSCached::getSpectrumById(int id)
+  {
+    OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
+    fillSpectrumById(id, *sptr);
+    return sptr;
+  }
+
+  void SpectrumAccessOpenMSCached::fillSpectrumById(int id, OpenSwath::Spectrum& spectrum)
   {
     OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
     OPENMS_PRECONDITION(id < (int)getNrSpectra(), "Id cannot be larger than number of spectra");
@@ -76,10 +83,7 @@ namespace OpenMS
         "Error while changing position of input stream pointer.", filename_cached_);
     }
 
-    OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
-    sptr->getDataArrays() = Internal::CachedMzMLHandler::readSpectrumFast(ifs_, ms_level, rt);
-
-    return sptr;
+    Internal::CachedMzMLHandler::readSpectrumFast(ifs_, ms_level, rt, spectrum.getDataArrays());
   }
 
   OpenSwath::SpectrumMeta SpectrumAccessOpenMSCached::getSpectrumMetaById(int id) const
@@ -0,0 +1,381 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedMapped.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/Macros.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/HANDLERS/CachedMzMLHandler.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace OpenMS
+{
+
+  struct SpectrumAccessOpenMSCachedMapped::MappedFile_
+  {
+    boost::iostreams::mapped_file_source file;
+    PeakMap meta;
+    String filename_cached;
+
+    /// all binary data arrays of all spectra followed by all chromatograms
+    std::vector<BinaryDataView> arrays;
+    /// index into arrays for each spectrum (with one past-the-end entry)
+    std::vector<Size> spectra_arrays;
+    /// index into arrays for each chromatogram (with one past-the-end entry)
+    std::vector<Size> chrom_arrays;
+    std::vector<int> ms_levels;
+    std::vector<double> rts;
+  };
+
+  namespace
+  {
+    /// Bounds-checked sequential reader on the mapped file
+    class MappedReader
+    {
+    public:
+      MappedReader(const char* begin, Size size, const String& filename) :
+        begin_(begin),
+        size_(size),
+        pos_(0),
+        filename_(filename)
+      {
+      }
+
+      template <typename T>
+      T read()
+      {
+        T value;
+        std::memcpy(&value, skip(sizeof(T)), sizeof(T));
+        return value;
+      }
+
+      const char* skip(Size bytes)
+      {
+        if (bytes > size_ - pos_)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+            "Unexpected end of file, the cached file may be truncated or corrupt.", filename_);
+        }
+        const char* ptr = begin_ + pos_;
+        pos_ += bytes;
+        return ptr;
+      }
+
+      const char* skipArray(Size nr_elements)
+      {
+        // guard against overflow in the multiplication for corrupt sizes
+        if (nr_elements > (size_ - pos_) / sizeof(double))
+        {
+          return skip(size_ - pos_ + 1);
+        }
+        return skip(nr_elements * sizeof(double));
+      }
+
+      Size position() const
+      {
+        return pos_;
+      }
+
+      void seek(Size pos)
+      {
+        pos_ = pos;
+      }
+
+    private:
+      const char* begin_;
+      Size size_;
+      Size pos_;
+      const String& filename_;
+    };
+
+    /// Indexes the data arrays of one spectrum or chromatogram (data layout as written by Internal::CachedMzMLHandler)
+    void indexArrays(MappedReader& reader, Size data_size, Size nr_extra_arrays,
+                     std::vector<SpectrumAccessOpenMSCachedMapped::BinaryDataView>& arrays)
+    {
+      SpectrumAccessOpenMSCachedMapped::BinaryDataView position, intensity;
+      position.size = data_size;
+      intensity.size = data_size;
+      position.data = reader.skipArray(data_size);
+      intensity.data = reader.skipArray(data_size);
+      arrays.push_back(position);
+      arrays.push_back(intensity);
+
+      // empty spectra and chromatograms are written without any data arrays
+      if (data_size == 0)
+      {
+        return;
+      }
+
+      for (Size k = 0; k < nr_extra_arrays; ++k)
+      {
+        SpectrumAccessOpenMSCachedMapped::BinaryDataView extra;
+        extra.size = reader.read<Size>();
+        extra.description_size = reader.read<Size>();
+        extra.description = reader.skip(extra.description_size);
+        extra.data = reader.skipArray(extra.size);
+        arrays.push_back(extra);
+      }
+    }
+  }
+
+  SpectrumAccessOpenMSCachedMapped::SpectrumAccessOpenMSCachedMapped(const String& filename)
+  {
+    boost::shared_ptr<MappedFile_> mapped(new MappedFile_);
+    mapped->filename_cached = filename + ".cached";
+
+    if (!File::exists(mapped->filename_cached))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, mapped->filename_cached);
+    }
+
+    try
+    {
+      mapped->file.open(mapped->filename_cached);
+    }
+    catch (std::exception&)
+    {
+      throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, mapped->filename_cached);
+    }
+
+    MappedReader reader(mapped->file.data(), mapped->file.size(), mapped->filename_cached);
+
+    // read the trailer (number of spectra and chromatograms) first
+    if (mapped->file.size() < sizeof(int) + 2 * sizeof(Size))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "File is too small to be a cached mzML file. Aborting!", mapped->filename_cached);
+    }
+    if (reader.read<int>() != CACHED_MZML_FILE_IDENTIFIER)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "File might not be a cached mzML file (wrong file magic number). Aborting!", mapped->filename_cached);
+    }
+    reader.seek(mapped->file.size() - 2 * sizeof(Size));
+    Size nr_spectra = reader.read<Size>();
+    Size nr_chromatograms = reader.read<Size>();
+    reader.seek(sizeof(int));
+
+    // go through the file once and record the location of each data array
+    mapped->ms_levels.reserve(nr_spectra);
+    mapped->rts.reserve(nr_spectra);
+    mapped->spectra_arrays.reserve(nr_spectra + 1);
+    mapped->chrom_arrays.reserve(nr_chromatograms + 1);
+    for (Size i = 0; i < nr_spectra; ++i)
+    {
+      mapped->spectra_arrays.push_back(mapped->arrays.size());
+      Size spec_size = reader.read<Size>();
+      Size nr_extra_arrays = reader.read<Size>();
+      mapped->ms_levels.push_back(reader.read<int>());
+      mapped->rts.push_back(reader.read<double>());
+      indexArrays(reader, spec_size, nr_extra_arrays, mapped->arrays);
+    }
+    mapped->spectra_arrays.push_back(mapped->arrays.size());
+
+    for (Size i = 0; i < nr_chromatograms; ++i)
+    {
+      mapped->chrom_arrays.push_back(mapped->arrays.size());
+      Size chrom_size = reader.read<Size>();
+      Size nr_extra_arrays = reader.read<Size>();
+      indexArrays(reader, chrom_size, nr_extra_arrays, mapped->arrays);
+    }
+    mapped->chrom_arrays.push_back(mapped->arrays.size());
+
+    if (reader.position() != mapped->file.size() - 2 * sizeof(Size))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Cached mzML file has unexpected trailing data. Aborting!", mapped->filename_cached);
+    }
+
+    // load the meta data from disk
+    MzMLFile().load(filename, mapped->meta);
+    if (mapped->meta.size() != nr_spectra || mapped->meta.getChromatograms().size() != nr_chromatograms)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Number of spectra or chromatograms in the meta data does not match the cached file.", filename);
+    }
+
+    mapped_ = mapped;
+  }
+
+  SpectrumAccessOpenMSCachedMapped::~SpectrumAccessOpenMSCachedMapped() = default;
+
+  SpectrumAccessOpenMSCachedMapped::SpectrumAccessOpenMSCachedMapped(const SpectrumAccessOpenMSCachedMapped& rhs) = default;
+
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> SpectrumAccessOpenMSCachedMapped::lightClone() const
+  {
+    return boost::shared_ptr<SpectrumAccessOpenMSCachedMapped>(new SpectrumAccessOpenMSCachedMapped(*this));
+  }
+
+  SpectrumAccessOpenMSCachedMapped::DataView SpectrumAccessOpenMSCachedMapped::getSpectrumViewById(int id) const
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrSpectra(), "Id cannot be larger than number of spectra");
+
+    DataView view;
+    view.ms_level = mapped_->ms_levels[id];
+    view.rt = mapped_->rts[id];
+    view.arrays = &mapped_->arrays[mapped_->spectra_arrays[id]];
+    view.nr_arrays = mapped_->spectra_arrays[id + 1] - mapped_->spectra_arrays[id];
+    return view;
+  }
+
+  SpectrumAccessOpenMSCachedMapped::DataView SpectrumAccessOpenMSCachedMapped::getChromatogramViewById(int id) const
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+
+    DataView view;
+    view.arrays = &mapped_->arrays[mapped_->chrom_arrays[id]];
+    view.nr_arrays = mapped_->chrom_arrays[id + 1] - mapped_->chrom_arrays[id];
+    return view;
+  }
+
+  std::vector<OpenSwath::BinaryDataArrayPtr> SpectrumAccessOpenMSCachedMapped::copyArrays_(const DataView& view)
+  {
+    std::vector<OpenSwath::BinaryDataArrayPtr> data;
+    data.reserve(view.nr_arrays);
+    for (Size k = 0; k < view.nr_arrays; ++k)
+    {
+      OpenSwath::BinaryDataArrayPtr array(new OpenSwath::BinaryDataArray);
+      view.arrays[k].copyTo(array->data);
+      array->description = view.arrays[k].getDescription();
+      data.push_back(array);
+    }
+    return data;
+  }
+
+  OpenSwath::SpectrumPtr SpectrumAccessOpenMSCachedMapped::getSpectrumById(int id)
+  {
+    OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
+    sptr->getDataArrays() = copyArrays_(getSpectrumViewById(id));
+    return sptr;
+  }
+
+  void SpectrumAccessOpenMSCachedMapped::fillSpectrumById(int id, OpenSwath::Spectrum& spectrum)
+  {
+    const DataView view = getSpectrumViewById(id);
+    prepareDataArrays_(spectrum, view.nr_arrays);
+    for (Size k = 0; k < view.nr_arrays; ++k)
+    {
+      OpenSwath::BinaryDataArray& array = *spectrum.getDataArrays()[k];
+      view.arrays[k].copyTo(array.data);
+      if (view.arrays[k].description_size > 0)
+      {
+        array.description.assign(view.arrays[k].description, view.arrays[k].description_size);
+      }
+      else
+      {
+        array.description.clear();
+      }
+    }
+  }
+
+  OpenSwath::SpectrumMeta SpectrumAccessOpenMSCachedMapped::getSpectrumMetaById(int id) const
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrSpectra(), "Id cannot be larger than number of spectra");
+
+    OpenSwath::SpectrumMeta meta;
+    meta.RT = mapped_->meta[id].getRT();
+    meta.ms_level = mapped_->meta[id].getMSLevel();
+    return meta;
+  }
+
+  OpenSwath::ChromatogramPtr SpectrumAccessOpenMSCachedMapped::getChromatogramById(int id)
+  {
+    OpenSwath::ChromatogramPtr cptr(new OpenSwath::Chromatogram);
+    cptr->getDataArrays() = copyArrays_(getChromatogramViewById(id));
+    return cptr;
+  }
+
+  std::vector<std::size_t> SpectrumAccessOpenMSCachedMapped::getSpectraByRT(double RT, double deltaRT) const
+  {
+    OPENMS_PRECONDITION(deltaRT >= 0, "Delta RT needs to be a positive number");
+
+    // we first perform a search for the spectrum that is past the
+    // beginning of the RT domain. Then we add this spectrum and try to add
+    // further spectra as long as they are below RT + deltaRT.
+    const PeakMap& meta = mapped_->meta;
+    std::vector<std::size_t> result;
+    auto spectrum = meta.RTBegin(RT - deltaRT);
+    if (spectrum == meta.end()) return result;
+
+    result.push_back(std::distance(meta.begin(), spectrum));
+    spectrum++;
+
+    while (spectrum != meta.end() && spectrum->getRT() < RT + deltaRT)
+    {
+      result.push_back(spectrum - meta.begin());
+      spectrum++;
+    }
+    return result;
+  }
+
+  size_t SpectrumAccessOpenMSCachedMapped::getNrSpectra() const
+  {
+    return mapped_->meta.size();
+  }
+
+  SpectrumSettings SpectrumAccessOpenMSCachedMapped::getSpectraMetaInfo(int id) const
+  {
+    return mapped_->meta[id];
+  }
+
+  size_t SpectrumAccessOpenMSCachedMapped::getNrChromatograms() const
+  {
+    return mapped_->meta.getChromatograms().size();
+  }
+
+  ChromatogramSettings SpectrumAccessOpenMSCachedMapped::getChromatogramMetaInfo(int id) const
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+    return mapped_->meta.getChromatograms()[id];
+  }
+
+  std::string SpectrumAccessOpenMSCachedMapped::getChromatogramNativeID(int id) const
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+    return mapped_->meta.getChromatograms()[id].getNativeID();
+  }
+
+  const PeakMap& SpectrumAccessOpenMSCachedMapped::getMetaData() const
+  {
+    return mapped_->meta;
+  }
+
+} //end namespace OpenMS
@@ -89,6 +89,11 @@ namespace OpenMS
     return spectra_[id];
   }
 
+  bool SpectrumAccessOpenMSInMemory::hasStableSpectra() const
+  {
+    return true;
+  }
+
   OpenSwath::SpectrumMeta SpectrumAccessOpenMSInMemory::getSpectrumMetaById(int id) const
   {
     OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
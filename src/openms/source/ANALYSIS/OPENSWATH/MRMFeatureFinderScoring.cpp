@@ -38,6 +38,7 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/MRMFeatureAccessOpenMS.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessLRUCache.h>
 
 // peak picking & noise estimation
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMScoring.h>
@@ -52,6 +53,8 @@
 #include <boost/make_shared.hpp>
 #include <boost/foreach.hpp>
 
+#include <exception>
+
 #define run_identifier "unique_run_identifier"
 
 bool SortDoubleDoublePairFirst(const std::pair<double, double>& left, const std::pair<double, double>& right)
@@ -102,6 +105,8 @@ namespace OpenMS
     defaults_.setMinInt("add_up_spectra", 1);
     defaults_.setValue("spacing_for_spectra_resampling", 0.005, "If spectra are to be added, use this spacing to add them up", {"advanced"});
     defaults_.setMinFloat("spacing_for_spectra_resampling", 0.0);
+    defaults_.setValue("spectrum_cache_size", 32, "Number of recently used spectra to keep in memory per SWATH map (and thread) for scoring, avoids decoding the same spectra repeatedly for on-disk data (0 disables the cache)", {"advanced"});
+    defaults_.setMinInt("spectrum_cache_size", 0);
     defaults_.setValue("uis_threshold_sn", -1, "S/N threshold to consider identification transition (set to -1 to consider all)");
     defaults_.setValue("uis_threshold_peak_area", 0, "Peak area threshold to consider identification transition (set to -1 to consider all)");
     defaults_.setValue("scoring_model", "default", "Scoring model to use", {"advanced"});
@@ -231,38 +236,152 @@ namespace OpenMS
     {
       if (!trgroup.second.getChromatograms().empty()) {counter++; }
     }
+    // pickExperiment may be called from several threads (e.g. by FeatureFinderIdentificationAlgorithm)
+#ifdef _OPENMP
+#pragma omp critical (LOG_DEBUG_access)
+#endif
     OPENMS_LOG_INFO << "Will analyse " << counter << " peptides with a total of " << transition_exp.getTransitions().size() << " transitions " << std::endl;
 
     //
     // Step 3
     //
     // Go through all transition groups: first create consensus features, then score them
-    MRMTransitionGroupPicker trgroup_picker;
     Param trgroup_picker_param = param_.copy("TransitionGroupPicker:", true);
     // If use_total_mi_score is defined, we need to instruct MRMTransitionGroupPicker to compute the score
     if (su_.use_total_mi_score_)
     {
       trgroup_picker_param.setValue("compute_total_mi", "true");
     }
-    trgroup_picker.setParameters(trgroup_picker_param);
+
+    // Transition groups are independent of each other and are picked and
+    // scored in parallel. Each group stores its features separately so that
+    // they can be appended to the output in map order afterwards, which makes
+    // the output independent of the number of threads.
+    std::vector<MRMTransitionGroupType*> transition_groups;
+    transition_groups.reserve(transition_group_map.size());
+    for (auto& trgroup : transition_group_map)
+    {
+      transition_groups.push_back(&trgroup.second);
+    }
+    std::vector<FeatureMap> group_features(transition_groups.size());
+    std::exception_ptr first_error;
+
+    // Process the groups in order of their expected retention time: peak
+    // groups of consecutive transition groups then tend to be scored on the
+    // same spectra, which can be served from the spectrum cache.
+    std::vector<Size> processing_order(transition_groups.size());
+    std::vector<double> expected_rt(transition_groups.size(), 0.0);
+    for (Size i = 0; i < transition_groups.size(); ++i)
+    {
+      processing_order[i] = i;
+      auto pep_it = PeptideRefMap_.find(transition_groups[i]->getTransitionGroupID());
+      if (pep_it != PeptideRefMap_.end()) expected_rt[i] = pep_it->second->rt;
+    }
+    std::stable_sort(processing_order.begin(), processing_order.end(),
+                     [&expected_rt](Size a, Size b) { return expected_rt[a] < expected_rt[b]; });
+    Size cache_hits = 0, cache_misses = 0;
 
     Size progress = 0;
-    startProgress(0, transition_group_map.size(), "picking peaks");
-    for (TransitionGroupMapType::iterator trgroup_it = transition_group_map.begin(); trgroup_it != transition_group_map.end(); ++trgroup_it)
+    startProgress(0, transition_groups.size(), "picking peaks");
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
     {
+      MRMTransitionGroupPicker trgroup_picker;
+      trgroup_picker.setParameters(trgroup_picker_param);
+
+      // Thread-local scorer: to ensure multi-threading safe access to the
+      // individual spectra, each thread uses a light clone of the spectrum
+      // access (if multiple threads share a single filestream and call seek
+      // on it, chaos will ensue).
+      MRMFeatureFinderScoring thread_scorer;
+      thread_scorer.setParameters(param_);
+      thread_scorer.setStrictFlag(strict_);
+      thread_scorer.prepareProteinPeptideMaps_(transition_exp);
+      std::vector<OpenSwath::SpectrumAccessPtr> thread_maps;
+      if (ms1_map_)
+      {
+        thread_maps.push_back(SpectrumAccessLRUCache::create(ms1_map_->lightClone(), spectrum_cache_size_));
+        thread_scorer.setMS1Map(thread_maps.back());
+      }
+      std::vector<OpenSwath::SwathMap> thread_swath_maps = swath_maps;
+      for (auto& m : thread_swath_maps)
+      {
+        if (!m.sptr) continue;
+        m.sptr = SpectrumAccessLRUCache::create(m.sptr->lightClone(), spectrum_cache_size_);
+        thread_maps.push_back(m.sptr);
+      }
 
-      setProgress(++progress);
-      MRMTransitionGroupType& transition_group = trgroup_it->second;
-      if (transition_group.getChromatograms().empty() || transition_group.getTransitions().empty())
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1) nowait
+#endif
+      for (SignedSize k = 0; k < (SignedSize)processing_order.size(); ++k)
       {
-        continue;
+#ifdef _OPENMP
+#pragma omp critical (progress)
+#endif
+        setProgress(++progress);
+
+        const Size i = processing_order[k];
+
+        MRMTransitionGroupType& transition_group = *transition_groups[i];
+        if (transition_group.getChromatograms().empty() || transition_group.getTransitions().empty())
+        {
+          continue;
+        }
+
+        try
+        {
+          trgroup_picker.pickTransitionGroup(transition_group);
+          thread_scorer.scorePeakgroups(transition_group, trafo, thread_swath_maps, group_features[i]);
+        }
+        catch (...)
+        {
+#ifdef _OPENMP
+#pragma omp critical (MRMFeatureFinderScoring_error)
+#endif
+          if (!first_error) first_error = std::current_exception();
+        }
       }
 
-      trgroup_picker.pickTransitionGroup(transition_group);
-      scorePeakgroups(trgroup_it->second, trafo, swath_maps, output);
+      for (const auto& m : thread_maps)
+      {
+        const SpectrumAccessLRUCache* cache = dynamic_cast<const SpectrumAccessLRUCache*>(m.get());
+        if (cache == nullptr) continue;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        cache_hits += cache->getNrHits();
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        cache_misses += cache->getNrMisses();
+      }
     }
     endProgress();
 
+    if (first_error)
+    {
+      std::rethrow_exception(first_error);
+    }
+
+    if (cache_hits + cache_misses > 0)
+    {
+#ifdef _OPENMP
+#pragma omp critical (LOG_DEBUG_access)
+#endif
+      OPENMS_LOG_INFO << "Spectrum cache: " << cache_hits << " of " << cache_hits + cache_misses << " spectra served from cache ("
+                      << 100.0 * cache_hits / (cache_hits + cache_misses) << " % hit rate)" << std::endl;
+    }
+
+    for (FeatureMap& features : group_features)
+    {
+      for (Feature& f : features)
+      {
+        output.push_back(std::move(f));
+      }
+    }
+
     //output.sortByPosition(); // if the exact same order is needed
     return;
   }
@@ -1040,6 +1159,7 @@ namespace OpenMS
     spectrum_addition_method_ = param_.getValue("spectrum_addition_method").toString();
     spacing_for_spectra_resampling_ = param_.getValue("spacing_for_spectra_resampling");
     im_extra_drift_ = (double)param_.getValue("im_extra_drift");
+    spectrum_cache_size_ = (int)param_.getValue("spectrum_cache_size");
     uis_threshold_sn_ = param_.getValue("uis_threshold_sn");
     uis_threshold_peak_area_ = param_.getValue("uis_threshold_peak_area");
     scoring_model_ = param_.getValue("scoring_model").toString();
@@ -34,12 +34,423 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathOSWWriter.h>
 
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
 #include <OpenMS/FORMAT/SqliteConnector.h>
 
 #include <sqlite3.h>
 
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+
 namespace OpenMS
 {
+  namespace
+  {
+    /// Maximal number of batches waiting for the background writer before queueRows blocks
+    const Size background_queue_size = 64;
+
+    /// Column name and the feature meta value it is filled from
+    typedef std::pair<const char*, const char*> ScoreColumn;
+
+    /// FEATURE_MS2 columns following FEATURE_ID and AREA_INTENSITY
+    const std::vector<ScoreColumn> ms2_score_columns = {
+      {"TOTAL_AREA_INTENSITY", "total_xic"},
+      {"APEX_INTENSITY", "peak_apices_sum"},
+      {"TOTAL_MI", "total_mi"},
+      {"VAR_BSERIES_SCORE", "var_bseries_score"},
+      {"VAR_DOTPROD_SCORE", "var_dotprod_score"},
+      {"VAR_INTENSITY_SCORE", "var_intensity_score"},
+      {"VAR_ISOTOPE_CORRELATION_SCORE", "var_isotope_correlation_score"},
+      {"VAR_ISOTOPE_OVERLAP_SCORE", "var_isotope_overlap_score"},
+      {"VAR_LIBRARY_CORR", "var_library_corr"},
+      {"VAR_LIBRARY_DOTPROD", "var_library_dotprod"},
+      {"VAR_LIBRARY_MANHATTAN", "var_library_manhattan"},
+      {"VAR_LIBRARY_RMSD", "var_library_rmsd"},
+      {"VAR_LIBRARY_ROOTMEANSQUARE", "var_library_rootmeansquare"},
+      {"VAR_LIBRARY_SANGLE", "var_library_sangle"},
+      {"VAR_LOG_SN_SCORE", "var_log_sn_score"},
+      {"VAR_MANHATTAN_SCORE", "var_manhatt_score"},
+      {"VAR_MASSDEV_SCORE", "var_massdev_score"},
+      {"VAR_MASSDEV_SCORE_WEIGHTED", "var_massdev_score_weighted"},
+      {"VAR_MI_SCORE", "var_mi_score"},
+      {"VAR_MI_WEIGHTED_SCORE", "var_mi_weighted_score"},
+      {"VAR_MI_RATIO_SCORE", "var_mi_ratio_score"},
+      {"VAR_NORM_RT_SCORE", "var_norm_rt_score"},
+      {"VAR_XCORR_COELUTION", "var_xcorr_coelution"},
+      {"VAR_XCORR_COELUTION_WEIGHTED", "var_xcorr_coelution_weighted"},
+      {"VAR_XCORR_SHAPE", "var_xcorr_shape"},
+      {"VAR_XCORR_SHAPE_WEIGHTED", "var_xcorr_shape_weighted"},
+      {"VAR_YSERIES_SCORE", "var_yseries_score"},
+      {"VAR_ELUTION_MODEL_FIT_SCORE", "var_elution_model_fit_score"},
+      {"VAR_IM_XCORR_SHAPE", "var_im_xcorr_shape"},
+      {"VAR_IM_XCORR_COELUTION", "var_im_xcorr_coelution"},
+      {"VAR_IM_DELTA_SCORE", "var_im_delta_score"}
+    };
+
+    /// Additional FEATURE_MS2 columns for SONAR scoring
+    const std::vector<ScoreColumn> sonar_score_columns = {
+      {"VAR_SONAR_LAG", "var_sonar_lag"},
+      {"VAR_SONAR_SHAPE", "var_sonar_shape"},
+      {"VAR_SONAR_LOG_SN", "var_sonar_log_sn"},
+      {"VAR_SONAR_LOG_DIFF", "var_sonar_log_diff"},
+      {"VAR_SONAR_LOG_TREND", "var_sonar_log_trend"},
+      {"VAR_SONAR_RSQ", "var_sonar_rsq"}
+    };
+
+    /// FEATURE_MS1 columns following FEATURE_ID
+    const std::vector<ScoreColumn> ms1_score_columns = {
+      {"AREA_INTENSITY", "ms1_area_intensity"},
+      {"APEX_INTENSITY", "ms1_apex_intensity"},
+      {"VAR_MASSDEV_SCORE", "var_ms1_ppm_diff"},
+      {"VAR_IM_MS1_DELTA_SCORE", "var_im_ms1_delta_score"},
+      {"VAR_MI_SCORE", "var_ms1_mi_score"},
+      {"VAR_MI_CONTRAST_SCORE", "var_ms1_mi_contrast_score"},
+      {"VAR_MI_COMBINED_SCORE", "var_ms1_mi_combined_score"},
+      {"VAR_ISOTOPE_CORRELATION_SCORE", "var_ms1_isotope_correlation"},
+      {"VAR_ISOTOPE_OVERLAP_SCORE", "var_ms1_isotope_overlap"},
+      {"VAR_XCORR_COELUTION", "var_ms1_xcorr_coelution"},
+      {"VAR_XCORR_COELUTION_CONTRAST", "var_ms1_xcorr_coelution_contrast"},
+      {"VAR_XCORR_COELUTION_COMBINED", "var_ms1_xcorr_coelution_combined"},
+      {"VAR_XCORR_SHAPE", "var_ms1_xcorr_shape"},
+      {"VAR_XCORR_SHAPE_CONTRAST", "var_ms1_xcorr_shape_contrast"},
+      {"VAR_XCORR_SHAPE_COMBINED", "var_ms1_xcorr_shape_combined"}
+    };
+
+    /// FEATURE_TRANSITION columns of UIS scoring following FEATURE_ID and TRANSITION_ID (meta values are prefixed by "id_target_" or "id_decoy_")
+    const std::vector<ScoreColumn> uis_score_columns = {
+      {"AREA_INTENSITY", "area_intensity"},
+      {"TOTAL_AREA_INTENSITY", "total_area_intensity"},
+      {"APEX_INTENSITY", "apex_intensity"},
+      {"TOTAL_MI", "total_mi"},
+      {"VAR_INTENSITY_SCORE", "intensity_score"},
+      {"VAR_INTENSITY_RATIO_SCORE", "intensity_ratio_score"},
+      {"VAR_LOG_INTENSITY", "ind_log_intensity"},
+      {"VAR_XCORR_COELUTION", "ind_xcorr_coelution"},
+      {"VAR_XCORR_SHAPE", "ind_xcorr_shape"},
+      {"VAR_LOG_SN_SCORE", "ind_log_sn_score"},
+      {"VAR_MASSDEV_SCORE", "ind_massdev_score"},
+      {"VAR_MI_SCORE", "ind_mi_score"},
+      {"VAR_MI_RATIO_SCORE", "ind_mi_ratio_score"},
+      {"VAR_ISOTOPE_CORRELATION_SCORE", "ind_isotope_correlation"},
+      {"VAR_ISOTOPE_OVERLAP_SCORE", "ind_isotope_overlap"}
+    };
+
+    /// Numeric value of a meta value (NaN if it is not set)
+    double getScoreValue(const MetaInfoInterface& feature, const std::string& score_name)
+    {
+      const DataValue& value = feature.getMetaValue(score_name);
+      if (value.isEmpty())
+      {
+        return std::numeric_limits<double>::quiet_NaN();
+      }
+      if (value.valueType() == DataValue::STRING_VALUE)
+      {
+        const String& str = value;
+        return std::strtod(str.c_str(), nullptr);
+      }
+      return value;
+    }
+
+    /// Integer identifier stored as text
+    Int64 toInt64(const String& str)
+    {
+      char* end = nullptr;
+      Int64 value = std::strtoll(str.c_str(), &end, 10);
+      if (str.empty() || *end != '\0')
+      {
+        throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Could not convert identifier '" + str + "' to an integer.");
+      }
+      return value;
+    }
+
+    /// Score at position @p i of a list of scores (NaN if not available)
+    double getListValue(const std::vector<String>& scores, Size i)
+    {
+      if (i >= scores.size())
+      {
+        return std::numeric_limits<double>::quiet_NaN();
+      }
+      return std::strtod(scores[i].c_str(), nullptr);
+    }
+
+    /**
+      @brief Inserts FeatureRows into an open OSW database using prepared statements
+
+      The statements are prepared once and re-used for all subsequent calls of insert().
+    */
+    class RowInserter
+    {
+public:
+      RowInserter(sqlite3* db, bool sonar) :
+        db_(db)
+      {
+        std::vector<String> ms2_columns = {"AREA_INTENSITY"};
+        for (const auto& c : ms2_score_columns) ms2_columns.push_back(c.first);
+        if (sonar)
+        {
+          for (const auto& c : sonar_score_columns) ms2_columns.push_back(c.first);
+        }
+        std::vector<String> ms1_columns, uis_columns;
+        for (const auto& c : ms1_score_columns) ms1_columns.push_back(c.first);
+        for (const auto& c : uis_score_columns) uis_columns.push_back(c.first);
+
+        feature_ = prepare_("FEATURE", {"ID", "RUN_ID", "PRECURSOR_ID"},
+                            {"EXP_RT", "EXP_IM", "NORM_RT", "DELTA_RT", "LEFT_WIDTH", "RIGHT_WIDTH"});
+        feature_ms1_ = prepare_("FEATURE_MS1", {"FEATURE_ID"}, ms1_columns);
+        feature_precursor_ = prepare_("FEATURE_PRECURSOR", {"FEATURE_ID", "ISOTOPE"}, {"AREA_INTENSITY", "APEX_INTENSITY"});
+        feature_ms2_ = prepare_("FEATURE_MS2", {"FEATURE_ID"}, ms2_columns);
+        feature_transition_ = prepare_("FEATURE_TRANSITION", {"FEATURE_ID", "TRANSITION_ID"},
+                                       {"AREA_INTENSITY", "TOTAL_AREA_INTENSITY", "APEX_INTENSITY", "TOTAL_MI"});
+        feature_transition_uis_ = prepare_("FEATURE_TRANSITION", {"FEATURE_ID", "TRANSITION_ID"}, uis_columns);
+      }
+
+      ~RowInserter()
+      {
+        for (Statement_* st : {&feature_, &feature_ms1_, &feature_precursor_, &feature_ms2_, &feature_transition_, &feature_transition_uis_})
+        {
+          sqlite3_finalize(st->stmt);
+        }
+      }
+
+      RowInserter(const RowInserter&) = delete;
+      RowInserter& operator=(const RowInserter&) = delete;
+
+      /// Insert all rows in a single transaction
+      void insert(const OpenSwathOSWWriter::FeatureRows& rows)
+      {
+        SqliteConnector::executeStatement(db_, "BEGIN TRANSACTION");
+        try
+        {
+          insert_(feature_, rows.feature);
+          insert_(feature_ms1_, rows.feature_ms1);
+          insert_(feature_precursor_, rows.feature_precursor);
+          insert_(feature_ms2_, rows.feature_ms2);
+          insert_(feature_transition_, rows.feature_transition);
+          insert_(feature_transition_uis_, rows.feature_transition_uis);
+        }
+        catch (...)
+        {
+          SqliteConnector::executeStatement(db_, "ROLLBACK TRANSACTION");
+          throw;
+        }
+        SqliteConnector::executeStatement(db_, "END TRANSACTION");
+      }
+
+private:
+      struct Statement_
+      {
+        sqlite3_stmt* stmt = nullptr;
+        Size nr_int = 0;
+        Size nr_real = 0;
+      };
+
+      Statement_ prepare_(const String& table, const std::vector<String>& int_columns, const std::vector<String>& real_columns)
+      {
+        std::vector<String> columns(int_columns);
+        columns.insert(columns.end(), real_columns.begin(), real_columns.end());
+        std::vector<String> placeholders(columns.size(), "?");
+
+        Statement_ st;
+        st.nr_int = int_columns.size();
+        st.nr_real = real_columns.size();
+        SqliteConnector::prepareStatement(db_, &st.stmt, "INSERT INTO " + table + " (" + ListUtils::concatenate(columns, ", ") +
+                                                         ") VALUES (" + ListUtils::concatenate(placeholders, ", ") + ");");
+        return st;
+      }
+
+      void insert_(const Statement_& st, const OpenSwathOSWWriter::FeatureRows::Table& table)
+      {
+        if (table.int_values.empty()) return;
+
+        OPENMS_PRECONDITION(table.int_values.size() * st.nr_real == table.real_values.size() * st.nr_int, "Inconsistent number of columns")
+        const Size nr_rows = table.int_values.size() / st.nr_int;
+        const Int64* int_values = table.int_values.data();
+        const double* real_values = table.real_values.data();
+        for (Size row = 0; row < nr_rows; ++row)
+        {
+          int pos = 1;
+          for (Size i = 0; i < st.nr_int; ++i)
+          {
+            sqlite3_bind_int64(st.stmt, pos++, *int_values++);
+          }
+          for (Size i = 0; i < st.nr_real; ++i, ++real_values)
+          {
+            if (std::isnan(*real_values))
+            {
+              sqlite3_bind_null(st.stmt, pos++);
+            }
+            else
+            {
+              sqlite3_bind_double(st.stmt, pos++, *real_values);
+            }
+          }
+          if (sqlite3_step(st.stmt) != SQLITE_DONE)
+          {
+            String error = sqlite3_errmsg(db_);
+            sqlite3_reset(st.stmt);
+            throw Exception::SqlOperationFailed(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, error);
+          }
+          sqlite3_reset(st.stmt);
+        }
+      }
+
+      sqlite3* db_;
+      Statement_ feature_;
+      Statement_ feature_ms1_;
+      Statement_ feature_precursor_;
+      Statement_ feature_ms2_;
+      Statement_ feature_transition_;
+      Statement_ feature_transition_uis_;
+    };
+  }
+
+  /**
+    @brief Thread which writes FeatureRows to the OSW file in the background
+
+    The thread holds its own database connection and prepared statements
+    for its whole lifetime. Errors are stored and reported to the caller of
+    the next push() or flush().
+  */
+  class OpenSwathOSWWriter::BackgroundWriter_
+  {
+public:
+    BackgroundWriter_(const String& filename, bool sonar) :
+      filename_(filename),
+      sonar_(sonar),
+      thread_(&BackgroundWriter_::work_, this)
+    {
+    }
+
+    ~BackgroundWriter_()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+      }
+      work_available_.notify_all();
+      thread_.join();
+      if (failed_)
+      {
+        OPENMS_LOG_ERROR << "Error while writing to OSW file " << filename_ << ": " << error_message_ << std::endl;
+      }
+    }
+
+    void push(FeatureRows&& rows)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      space_available_.wait(lock, [this] { return failed_ || queue_.size() < background_queue_size; });
+      throwIfFailed_();
+      queue_.push_back(std::move(rows));
+      lock.unlock();
+      work_available_.notify_one();
+    }
+
+    void flush()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      idle_.wait(lock, [this] { return failed_ || (queue_.empty() && !busy_); });
+      throwIfFailed_();
+    }
+
+private:
+    void throwIfFailed_() const
+    {
+      if (failed_)
+      {
+        throw Exception::SqlOperationFailed(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Error while writing to OSW file " + filename_ + ": " + error_message_);
+      }
+    }
+
+    void work_()
+    {
+      String error_message;
+      try
+      {
+        SqliteConnector conn(filename_);
+        RowInserter inserter(conn.getDB(), sonar_);
+        while (true)
+        {
+          FeatureRows rows;
+          {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            // write out everything before stopping
+            if (queue_.empty()) return;
+            rows = std::move(queue_.front());
+            queue_.pop_front();
+            busy_ = true;
+          }
+          space_available_.notify_one();
+
+          inserter.insert(rows);
+
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_ = false;
+          }
+          idle_.notify_all();
+        }
+      }
+      catch (Exception::BaseException& e)
+      {
+        error_message = e.what();
+      }
+      catch (std::exception& e)
+      {
+        error_message = e.what();
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        failed_ = true;
+        error_message_ = error_message;
+        busy_ = false;
+      }
+      space_available_.notify_all();
+      idle_.notify_all();
+    }
+
+    const String filename_;
+    const bool sonar_;
+    std::deque<FeatureRows> queue_;
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable space_available_;
+    std::condition_variable idle_;
+    bool stop_ = false;
+    bool busy_ = false;
+    bool failed_ = false;
+    String error_message_;
+    // started last, after all other members are initialized
+    std::thread thread_;
+  };
+
+  bool OpenSwathOSWWriter::FeatureRows::empty() const
+  {
+    return feature.int_values.empty();
+  }
+
+  void OpenSwathOSWWriter::FeatureRows::append(const FeatureRows& other)
+  {
+    auto append_table = [](Table& table, const Table& other_table)
+    {
+      table.int_values.insert(table.int_values.end(), other_table.int_values.begin(), other_table.int_values.end());
+      table.real_values.insert(table.real_values.end(), other_table.real_values.begin(), other_table.real_values.end());
+    };
+    append_table(feature, other.feature);
+    append_table(feature_ms1, other.feature_ms1);
+    append_table(feature_precursor, other.feature_precursor);
+    append_table(feature_ms2, other.feature_ms2);
+    append_table(feature_transition, other.feature_transition);
+    append_table(feature_transition_uis, other.feature_transition_uis);
+  }
   OpenSwathOSWWriter::OpenSwathOSWWriter(const String& output_filename, const UInt64 run_id, const String& input_filename, bool ms1_scores, bool sonar, bool uis_scores) :
     output_filename_(output_filename),
     input_filename_(input_filename),
@@ -47,7 +458,8 @@ namespace OpenMS
     doWrite_(!output_filename.empty()),
     use_ms1_traces_(ms1_scores),
     sonar_(sonar),
-    enable_uis_scoring_(uis_scores)
+    enable_uis_scoring_(uis_scores),
+    writer_mutex_(std::make_shared<std::mutex>())
   {}
 
   bool OpenSwathOSWWriter::isActive() const
@@ -487,5 +899,144 @@ namespace OpenMS
     }
     conn.executeStatement("END TRANSACTION");
   }
-}
 
+  void OpenSwathOSWWriter::prepareRows(const FeatureMap& output, const String& id, FeatureRows& rows) const
+  {
+    const Int64 precursor_id = toInt64(id);
+    FeatureRows::Table uis_transition, ms2_transition;
+
+    for (const auto& feature_it : output)
+    {
+      Int64 feature_id = Internal::SqliteHelper::clearSignBit(feature_it.getUniqueId()); // clear sign bit
+
+      for (const auto& sub_it : feature_it.getSubordinates())
+      {
+        if (sub_it.metaValueExists("FeatureLevel") && sub_it.getMetaValue("FeatureLevel") == "MS2")
+        {
+          ms2_transition.int_values.push_back(feature_id);
+          ms2_transition.int_values.push_back(toInt64(sub_it.getMetaValue("native_id")));
+          ms2_transition.real_values.push_back(sub_it.getIntensity());
+          ms2_transition.real_values.push_back(getScoreValue(sub_it, "total_xic"));
+          ms2_transition.real_values.push_back(getScoreValue(sub_it, "peak_apex_int"));
+          ms2_transition.real_values.push_back(getScoreValue(sub_it, "total_mi")); // total_mi is not guaranteed to be set
+        }
+        else if (sub_it.metaValueExists("FeatureLevel") && sub_it.getMetaValue("FeatureLevel") == "MS1" && sub_it.getIntensity() > 0.0)
+        {
+          std::vector<String> precursor_id;
+          OpenMS::String(sub_it.getMetaValue("native_id")).split(OpenMS::String("Precursor_i"), precursor_id);
+          rows.feature_precursor.int_values.push_back(feature_id);
+          rows.feature_precursor.int_values.push_back(toInt64(precursor_id[1]));
+          rows.feature_precursor.real_values.push_back(sub_it.getIntensity());
+          rows.feature_precursor.real_values.push_back(getScoreValue(sub_it, "peak_apex_int"));
+        }
+      }
+
+      // these will be missing if RT scoring is disabled
+      double norm_rt = -1, delta_rt = -1;
+      if (feature_it.metaValueExists("norm_RT") ) norm_rt = feature_it.getMetaValue("norm_RT");
+      if (feature_it.metaValueExists("delta_rt") ) delta_rt = feature_it.getMetaValue("delta_rt");
+
+      rows.feature.int_values.insert(rows.feature.int_values.end(), {feature_id, Int64(run_id_), precursor_id});
+      rows.feature.real_values.insert(rows.feature.real_values.end(),
+        {feature_it.getRT(), getScoreValue(feature_it, "im_drift"), norm_rt, delta_rt,
+         getScoreValue(feature_it, "leftWidth"), getScoreValue(feature_it, "rightWidth")});
+
+      rows.feature_ms2.int_values.push_back(feature_id);
+      rows.feature_ms2.real_values.push_back(feature_it.getIntensity());
+      for (const auto& c : ms2_score_columns)
+      {
+        rows.feature_ms2.real_values.push_back(getScoreValue(feature_it, c.second));
+      }
+      if (sonar_)
+      {
+        for (const auto& c : sonar_score_columns)
+        {
+          rows.feature_ms2.real_values.push_back(getScoreValue(feature_it, c.second));
+        }
+      }
+
+      if (use_ms1_traces_)
+      {
+        rows.feature_ms1.int_values.push_back(feature_id);
+        for (const auto& c : ms1_score_columns)
+        {
+          rows.feature_ms1.real_values.push_back(getScoreValue(feature_it, c.second));
+        }
+      }
+
+      if (enable_uis_scoring_)
+      {
+        for (const String prefix : {"id_target_", "id_decoy_"})
+        {
+          if (!feature_it.metaValueExists(prefix + "num_transitions")) continue;
+
+          std::vector<String> transition_names = getSeparateScore(feature_it, prefix + "transition_names");
+          std::vector<std::vector<String> > scores;
+          for (const auto& c : uis_score_columns)
+          {
+            String score_name = prefix + c.second;
+            // same as in prepareLine: the total MI of target transitions is filled from the apex intensity
+            if (prefix == "id_target_" && String(c.second) == "total_mi") score_name = "id_target_apex_intensity";
+            scores.push_back(getSeparateScore(feature_it, score_name));
+          }
+
+          int num_transitions = feature_it.getMetaValue(prefix + "num_transitions");
+          for (int i = 0; i < num_transitions; ++i)
+          {
+            uis_transition.int_values.push_back(feature_id);
+            uis_transition.int_values.push_back(toInt64(transition_names.at(i)));
+            for (const auto& score : scores)
+            {
+              uis_transition.real_values.push_back(getListValue(score, i));
+            }
+          }
+        }
+      }
+    }
+
+    // as in prepareLine, UIS transition scores replace the detecting transition scores if present
+    FeatureRows::Table& transitions = uis_transition.int_values.empty() ? ms2_transition : uis_transition;
+    FeatureRows::Table& target = uis_transition.int_values.empty() ? rows.feature_transition : rows.feature_transition_uis;
+    target.int_values.insert(target.int_values.end(), transitions.int_values.begin(), transitions.int_values.end());
+    target.real_values.insert(target.real_values.end(), transitions.real_values.begin(), transitions.real_values.end());
+  }
+
+  void OpenSwathOSWWriter::writeRows(const FeatureRows& rows)
+  {
+    if (rows.empty()) return;
+
+    SqliteConnector conn(output_filename_);
+    RowInserter inserter(conn.getDB(), sonar_);
+    inserter.insert(rows);
+  }
+
+  void OpenSwathOSWWriter::queueRows(FeatureRows&& rows)
+  {
+    if (rows.empty()) return;
+
+    std::shared_ptr<BackgroundWriter_> writer;
+    {
+      // start the writer thread on first use
+      std::lock_guard<std::mutex> lock(*writer_mutex_);
+      if (!background_writer_)
+      {
+        background_writer_ = std::make_shared<BackgroundWriter_>(output_filename_, sonar_);
+      }
+      writer = background_writer_;
+    }
+    writer->push(std::move(rows));
+  }
+
+  void OpenSwathOSWWriter::flush()
+  {
+    std::shared_ptr<BackgroundWriter_> writer;
+    {
+      std::lock_guard<std::mutex> lock(*writer_mutex_);
+      writer = background_writer_;
+    }
+    if (writer)
+    {
+      writer->flush();
+    }
+  }
+}
@@ -34,6 +34,17 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathWorkflow.h>
 
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessLRUCache.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // OpenSwathCalibrationWorkflow
 namespace OpenMS
 {
@@ -500,6 +511,7 @@ namespace OpenMS
       // write features to output if so desired
       std::vector< OpenMS::MSChromatogram > chromatograms;
       writeOutFeaturesAndChroms_(chromatograms, featureFile, out_featureFile, store_features, chromConsumer);
+      osw_writer.flush();
     }
 
     // (iii) map transitions to individual DIA windows for cases where this is
@@ -586,207 +598,316 @@ namespace OpenMS
     };
 
     // (iv) Perform extraction and scoring of fragment ion chromatograms (MS2)
-    // We set dynamic scheduling such that the maps are worked on in the order
-    // in which they were given to the program / acquired. This gives much
-    // better load balancing than static allocation.
+    //
+    // Each (window, batch) pair is scheduled as an independent task on a
+    // single (non-nested) team of threads. With dynamic scheduling, a thread
+    // that finishes its task immediately picks up the next one -- which may be
+    // a batch of another window -- so that windows with very different
+    // library sizes no longer leave cores idle at the end of the run.
+    //
+    // With threads_outer_loop_ > 0, at most that many SWATH windows are
+    // processed at once (which bounds the memory used with load_into_memory).
+
+    // Step 1: select which transitions to extract from each window
+    std::vector< OpenSwath::LightTargetedExperiment > window_transitions(swath_maps.size());
 #ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-    int total_nr_threads = omp_get_max_threads(); // store total number of threads we are allowed to use
-    if (threads_outer_loop_ > -1)
-    {
-      std::cout << "Setting up nested loop with " << std::min(threads_outer_loop_, omp_get_max_threads()) << " threads out of "<< omp_get_max_threads() << std::endl;
-      omp_set_nested(1);
-      omp_set_dynamic(0);
-      omp_set_num_threads(std::min(threads_outer_loop_, omp_get_max_threads()) ); // use at most threads_outer_loop_ threads here
-    }
-    else
-    {
-      std::cout << "Use non-nested loop with " << total_nr_threads << " threads." << std::endl;
-    }
-#endif
 #pragma omp parallel for schedule(dynamic,1)
 #endif
     for (SignedSize i = 0; i < boost::numeric_cast<SignedSize>(swath_maps.size()); ++i)
     {
-      if (!swath_maps[i].ms1) // skip MS1
-      {
+      if (swath_maps[i].ms1) continue; // skip MS1
 
-        // Step 1: select which transitions to extract (proceed in batches)
-        OpenSwath::LightTargetedExperiment transition_exp_used_all;
-        if (!(prm_ || pasef_))
-        {
-          // Step 1.1: select transitions matching the window
-          OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used_all,
-              cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
-        }
-        else
+      OpenSwath::LightTargetedExperiment& transition_exp_used_all = window_transitions[i];
+      if (!(prm_ || pasef_))
+      {
+        // Step 1.1: select transitions matching the window
+        OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used_all,
+            cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
+      }
+      else
+      {
+        // Step 1.2: select transitions based on matching PRM/PASEF window (best window)
+        std::set<std::string> matching_compounds;
+        for (Size k = 0; k < tr_win_map.size(); k++)
         {
-          // Step 1.2: select transitions based on matching PRM/PASEF window (best window)
-          std::set<std::string> matching_compounds;
-          for (Size k = 0; k < tr_win_map.size(); k++)
+          if (tr_win_map[k] == i)
           {
-            if (tr_win_map[k] == i)
-            {
-               const OpenSwath::LightTransition& tr = transition_exp.transitions[k];
-               transition_exp_used_all.transitions.push_back(tr);
-               matching_compounds.insert(tr.getPeptideRef());
-               OPENMS_LOG_DEBUG << "Adding Precursor with m/z " << tr.getPrecursorMZ() << " and IM of " << tr.getPrecursorIM() <<  " to swath with mz upper of " << swath_maps[i].upper << " im lower of " << swath_maps[i].imLower << " and im upper of " << swath_maps[i].imUpper << std::endl;
-            }
+             const OpenSwath::LightTransition& tr = transition_exp.transitions[k];
+             transition_exp_used_all.transitions.push_back(tr);
+             matching_compounds.insert(tr.getPeptideRef());
+             OPENMS_LOG_DEBUG << "Adding Precursor with m/z " << tr.getPrecursorMZ() << " and IM of " << tr.getPrecursorIM() <<  " to swath with mz upper of " << swath_maps[i].upper << " im lower of " << swath_maps[i].imLower << " and im upper of " << swath_maps[i].imUpper << std::endl;
           }
+        }
 
-          std::set<std::string> matching_proteins;
-          for (Size i = 0; i < transition_exp.compounds.size(); i++)
-          {
-            if (matching_compounds.find(transition_exp.compounds[i].id) != matching_compounds.end())
-            {
-              transition_exp_used_all.compounds.push_back( transition_exp.compounds[i] );
-              for (Size j = 0; j < transition_exp.compounds[i].protein_refs.size(); j++)
-              {
-                matching_proteins.insert(transition_exp.compounds[i].protein_refs[j]);
-              }
-            }
-          }
-          for (Size i = 0; i < transition_exp.proteins.size(); i++)
+        std::set<std::string> matching_proteins;
+        for (Size c = 0; c < transition_exp.compounds.size(); c++)
+        {
+          if (matching_compounds.find(transition_exp.compounds[c].id) != matching_compounds.end())
           {
-            if (matching_proteins.find(transition_exp.proteins[i].id) != matching_proteins.end())
+            transition_exp_used_all.compounds.push_back( transition_exp.compounds[c] );
+            for (Size j = 0; j < transition_exp.compounds[c].protein_refs.size(); j++)
             {
-              transition_exp_used_all.proteins.push_back( transition_exp.proteins[i] );
+              matching_proteins.insert(transition_exp.compounds[c].protein_refs[j]);
             }
           }
         }
-
-        if (!transition_exp_used_all.getTransitions().empty()) // skip if no transitions found
+        for (Size p = 0; p < transition_exp.proteins.size(); p++)
         {
-
-          OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[i].sptr;
-          if (load_into_memory)
+          if (matching_proteins.find(transition_exp.proteins[p].id) != matching_proteins.end())
           {
-            // This creates an InMemory object that keeps all data in memory
-            current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
+            transition_exp_used_all.proteins.push_back( transition_exp.proteins[p] );
           }
+        }
+      }
+    }
 
-          int batch_size;
-          if (batchSize <= 0 || batchSize >= (int)transition_exp_used_all.getCompounds().size())
-          {
-            batch_size = transition_exp_used_all.getCompounds().size();
-          }
-          else
-          {
-            batch_size = batchSize;
-          }
+    // Step 2: create the tasks, in the order in which the windows were given
+    // to the program / acquired (this keeps the number of windows in flight,
+    // and thus the memory used with load_into_memory, small)
+    struct ExtractionTask
+    {
+      Size window;
+      Size batch;
+      Size nr_batches;
+      Size batch_size;
+    };
+    struct WindowState
+    {
+      std::mutex load_mutex;
+      OpenSwath::SpectrumAccessPtr in_memory_map; ///< created by the first task of this window (if load_into_memory)
+      std::atomic<Size> batches_left{0};
+    };
+    std::vector< ExtractionTask > tasks;
+    std::vector< Size > task_window_rank; // rank of the task's window among the windows with tasks
+    std::vector< WindowState > windows(swath_maps.size());
+    Size nr_windows_with_tasks = 0;
+    for (Size i = 0; i < swath_maps.size(); ++i)
+    {
+      Size nr_compounds = window_transitions[i].getCompounds().size();
+      if (swath_maps[i].ms1 || window_transitions[i].getTransitions().empty() || nr_compounds == 0)
+      {
+        this->setProgress(++progress); // nothing to do for this window
+        continue;
+      }
+      Size batch_size = (batchSize <= 0 || batchSize >= (int)nr_compounds) ? nr_compounds : Size(batchSize);
+      Size nr_batches = (nr_compounds + batch_size - 1) / batch_size;
+      windows[i].batches_left = nr_batches;
+      for (Size b = 0; b < nr_batches; ++b)
+      {
+        tasks.push_back({i, b, nr_batches, batch_size});
+        task_window_rank.push_back(nr_windows_with_tasks);
+      }
+      ++nr_windows_with_tasks;
+    }
 
-          SignedSize nr_batches = (transition_exp_used_all.getCompounds().size() / batch_size);
+    // Results (chromatograms, features and tsv/osw rows) are merged into the
+    // output in task order: a finished task is written out as soon as all
+    // tasks before it are written.
+    struct TaskOutput
+    {
+      std::vector< MSChromatogram > chromatograms;
+      FeatureMap features;
+      std::vector< String > tsv_lines;
+      OpenSwathOSWWriter::FeatureRows osw_rows;
+      bool done = false;
+    };
+    std::vector< TaskOutput > task_outputs(tasks.size());
+    Size next_output = 0;
 
+    // Tasks are started in order, and a task is only started if the results
+    // of at most max_pending_tasks tasks (and, with threads_outer_loop_ > 0,
+    // of at most threads_outer_loop_ windows) are not yet written. This bounds
+    // the memory held by finished tasks waiting for a slow predecessor.
 #ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-          // If we have a multiple of threads_outer_loop_ here, then use nested
-          // parallelization here. E.g. if we use 8 threads for the outer loop,
-          // but we have a total of 24 cores available, each of the 8 threads
-          // will then create a team of 3 threads to work on the batches
-          // individually.
-          //
-          // We should avoid oversubscribing the CPUs, therefore we use integer division.
-          // -- see https://docs.oracle.com/cd/E19059-01/stud.10/819-0501/2_nested.html
-          int outer_thread_nr = omp_get_thread_num();
-          omp_set_num_threads(std::max(1, total_nr_threads / threads_outer_loop_) );
-#pragma omp parallel for schedule(dynamic, 1)
-#endif
+    const Size nr_threads = omp_get_max_threads();
+#else
+    const Size nr_threads = 1;
 #endif
-          for (SignedSize pep_idx = 0; pep_idx <= nr_batches; pep_idx++)
-          {
-            OpenSwath::SpectrumAccessPtr current_swath_map_inner = current_swath_map;
+    const Size max_pending_tasks = 2 * nr_threads;
+    std::mutex task_mutex;
+    std::condition_variable task_cv;
+    Size next_task = 0;
+    Size written_tasks = 0; // copy of next_output, guarded by task_mutex
+    auto can_start = [&]()
+    {
+      if (next_task >= tasks.size()) return true; // nothing left, let the thread finish
+      if (next_task >= written_tasks + max_pending_tasks) return false;
+      return threads_outer_loop_ <= 0 ||
+        task_window_rank[next_task] < task_window_rank[written_tasks] + Size(threads_outer_loop_);
+    };
 
+    // per-task timing (seconds spent in extraction and in scoring)
+    std::vector< double > task_extraction_time(tasks.size(), 0.0);
+    std::vector< double > task_scoring_time(tasks.size(), 0.0);
+    const auto run_start = std::chrono::steady_clock::now();
+
+    // Step 3: run the tasks (each thread takes the next task as soon as it may be started)
 #ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-            // To ensure multi-threading safe access to the individual spectra, we
-            // need to use a light clone of the spectrum access (if multiple threads
-            // share a single filestream and call seek on it, chaos will ensue).
-            if (total_nr_threads / threads_outer_loop_ > 1)
-            {
-              current_swath_map_inner = current_swath_map->lightClone();
-            }
+#pragma omp parallel
 #endif
+    while (true)
+    {
+      Size t;
+      {
+        std::unique_lock<std::mutex> lock(task_mutex);
+        task_cv.wait(lock, can_start);
+        if (next_task >= tasks.size()) break;
+        t = next_task++;
+      }
+
+      const ExtractionTask& task = tasks[t];
+      const Size i = task.window;
+      const OpenSwath::LightTargetedExperiment& transition_exp_used_all = window_transitions[i];
+      const auto task_start = std::chrono::steady_clock::now();
+
+      OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[i].sptr;
+      if (load_into_memory)
+      {
+        // This creates an InMemory object that keeps all data in memory
+        // (shared by all tasks of this window and released after the last one)
+        std::lock_guard<std::mutex> lock(windows[i].load_mutex);
+        if (windows[i].in_memory_map == nullptr)
+        {
+          windows[i].in_memory_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
+        }
+        current_swath_map = windows[i].in_memory_map;
+      }
+
+      // To ensure multi-threading safe access to the individual spectra, we
+      // need to use a light clone of the spectrum access (if multiple threads
+      // share a single filestream and call seek on it, chaos will ensue).
+      OpenSwath::SpectrumAccessPtr current_swath_map_inner = current_swath_map->lightClone();
+
+#ifdef _OPENMP
 #pragma omp critical (osw_write_stdout)
 #endif
-            {
-              std::cout << "Thread " <<
+      {
+        std::cout << "Thread " <<
 #ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-              outer_thread_nr << "_" << omp_get_thread_num() << " " <<
-#else
-              omp_get_thread_num() << "_0 " <<
-#endif
+        omp_get_thread_num() << " " <<
 #else
-              "0" <<
+        "0 " <<
 #endif
-              "will analyze " << transition_exp_used_all.getCompounds().size() <<  " compounds and "
-              << transition_exp_used_all.getTransitions().size() <<  " transitions "
-              "from SWATH " << i << " (batch " << pep_idx << " out of " << nr_batches << ")" << std::endl;
-            }
-
-            // Create the new, batch-size transition experiment
-            OpenSwath::LightTargetedExperiment transition_exp_used;
-            selectCompoundsForBatch_(transition_exp_used_all, transition_exp_used, batch_size, pep_idx);
-
-            // Extract MS1 chromatograms for this batch
-            std::vector< MSChromatogram > ms1_chromatograms;
-            if (ms1_map_ != nullptr)
-            {
-              OpenSwath::SpectrumAccessPtr threadsafe_ms1 = ms1_map_->lightClone();
-              MS1Extraction_(threadsafe_ms1, swath_maps, ms1_chromatograms, chromConsumer, ms1_cp,
-                  transition_exp_used, trafo_inverse, ms1_only, ms1_isotopes);
-            }
-
-            // Step 2.1: extract these transitions
-            ChromatogramExtractor extractor;
-            std::vector< OpenSwath::ChromatogramPtr > chrom_list;
-            std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
-
-            // Step 2.2: prepare the extraction coordinates and extract chromatograms
-            // chrom_list contains one entry for each fragment ion (transition) in transition_exp_used
-            prepareExtractionCoordinates_(chrom_list, coordinates, transition_exp_used, trafo_inverse, cp);
-            extractor.extractChromatograms(current_swath_map_inner, chrom_list, coordinates, cp.mz_extraction_window,
-                cp.ppm, cp.im_extraction_window, cp.extraction_function);
-
-            // Step 2.3: convert chromatograms back to OpenMS::MSChromatogram and write to output
-            PeakMap chrom_exp;
-            extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(),
-                                          chrom_exp.getChromatograms(), false, cp.im_extraction_window);
-
+        "will analyze " << transition_exp_used_all.getCompounds().size() <<  " compounds and "
+        << transition_exp_used_all.getTransitions().size() <<  " transitions "
+        "from SWATH " << i << " (batch " << task.batch << " out of " << task.nr_batches << ")" << std::endl;
+      }
 
-            // Step 3: score these extracted transitions
-            FeatureMap featureFile;
-            std::vector< OpenSwath::SwathMap > tmp = {swath_maps[i]};
-            tmp.back().sptr = current_swath_map_inner;
-            scoreAllChromatograms_(chrom_exp.getChromatograms(), ms1_chromatograms, tmp, transition_exp_used,
-                feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, ms1_isotopes);
+      // Create the new, batch-size transition experiment
+      OpenSwath::LightTargetedExperiment transition_exp_used;
+      selectCompoundsForBatch_(transition_exp_used_all, transition_exp_used, task.batch_size, task.batch);
 
-            // Step 4: write all chromatograms and features out into an output object / file
-            // (this needs to be done in a critical section since we only have one
-            // output file and one output map).
-            #pragma omp critical (osw_write_out)
-            {
-              writeOutFeaturesAndChroms_(chrom_exp.getChromatograms(), featureFile, out_featureFile, store_features, chromConsumer);
-            }
-          }
+      // Extract MS1 chromatograms for this batch (they are written in the ordered merge below)
+      std::vector< MSChromatogram > ms1_chromatograms;
+      if (ms1_map_ != nullptr)
+      {
+        OpenSwath::SpectrumAccessPtr threadsafe_ms1 = ms1_map_->lightClone();
+        MS1Extraction_(threadsafe_ms1, swath_maps, ms1_chromatograms, nullptr, ms1_cp,
+            transition_exp_used, trafo_inverse, ms1_only, ms1_isotopes);
+      }
 
-        } // continue 2 (no continue due to OpenMP)
-      } // continue 1 (no continue due to OpenMP)
+      // Step 3.1: extract these transitions
+      ChromatogramExtractor extractor;
+      std::vector< OpenSwath::ChromatogramPtr > chrom_list;
+      std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
+
+      // Step 3.2: prepare the extraction coordinates and extract chromatograms
+      // chrom_list contains one entry for each fragment ion (transition) in transition_exp_used
+      prepareExtractionCoordinates_(chrom_list, coordinates, transition_exp_used, trafo_inverse, cp);
+      extractor.extractChromatograms(current_swath_map_inner, chrom_list, coordinates, cp.mz_extraction_window,
+          cp.ppm, cp.im_extraction_window, cp.extraction_function);
+
+      // Step 3.3: convert chromatograms back to OpenMS::MSChromatogram
+      PeakMap chrom_exp;
+      extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(),
+                                    chrom_exp.getChromatograms(), false, cp.im_extraction_window);
+      const auto extraction_end = std::chrono::steady_clock::now();
+
+      // Step 4: score these extracted transitions
+      FeatureMap featureFile;
+      std::vector< String > tsv_lines;
+      OpenSwathOSWWriter::FeatureRows osw_rows;
+      std::vector< OpenSwath::SwathMap > tmp = {swath_maps[i]};
+      tmp.back().sptr = current_swath_map_inner;
+      scoreAllChromatograms_(chrom_exp.getChromatograms(), ms1_chromatograms, tmp, transition_exp_used,
+          feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, ms1_isotopes,
+          false, &tsv_lines, &osw_rows);
+      const auto scoring_end = std::chrono::steady_clock::now();
+      task_extraction_time[t] = std::chrono::duration<double>(extraction_end - task_start).count();
+      task_scoring_time[t] = std::chrono::duration<double>(scoring_end - extraction_end).count();
+
+      // the last task of a window releases the in-memory copy of its data
+      bool window_done = (--windows[i].batches_left == 0);
+      if (window_done && load_into_memory)
+      {
+        std::lock_guard<std::mutex> lock(windows[i].load_mutex);
+        windows[i].in_memory_map.reset();
+      }
 
-      #pragma omp critical (progress)
-      this->setProgress(++progress);
+      // Step 5: write all chromatograms and features out into an output object / file
+      // (this needs to be done in a critical section since we only have one
+      // output file and one output map).
+      #pragma omp critical (osw_write_out)
+      {
+        // MS1 chromatograms of the batch precede its MS2 chromatograms
+        task_outputs[t].chromatograms.swap(ms1_chromatograms);
+        task_outputs[t].chromatograms.insert(task_outputs[t].chromatograms.end(),
+            std::make_move_iterator(chrom_exp.getChromatograms().begin()),
+            std::make_move_iterator(chrom_exp.getChromatograms().end()));
+        task_outputs[t].features = std::move(featureFile);
+        task_outputs[t].tsv_lines.swap(tsv_lines);
+        task_outputs[t].osw_rows = std::move(osw_rows);
+        task_outputs[t].done = true;
+        while (next_output < task_outputs.size() && task_outputs[next_output].done)
+        {
+          TaskOutput& out = task_outputs[next_output];
+          writeOutFeaturesAndChroms_(out.chromatograms, out.features, out_featureFile, store_features, chromConsumer);
+          if (tsv_writer.isActive()) tsv_writer.writeLines(out.tsv_lines);
+          if (osw_writer.isActive()) osw_writer.queueRows(std::move(out.osw_rows));
+          out = TaskOutput();
+          out.done = true;
+          ++next_output;
+        }
+      }
+      {
+        std::lock_guard<std::mutex> lock(task_mutex);
+        written_tasks = next_output;
+      }
+      task_cv.notify_all();
 
+      if (window_done)
+      {
+        #pragma omp critical (progress)
+        this->setProgress(++progress);
+      }
     }
     this->endProgress();
 
-#ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-    if (threads_outer_loop_ > -1)
+    // wait until the writer thread has stored all features
+    osw_writer.flush();
+
+    // Report how well the tasks kept the threads busy
+    if (!tasks.empty())
     {
-      omp_set_num_threads(total_nr_threads); // set number of available threads back to initial value
+      const double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+      double extraction_time = 0.0, scoring_time = 0.0, slowest_time = -1.0;
+      Size slowest_task = 0;
+      for (Size t = 0; t < tasks.size(); ++t)
+      {
+        extraction_time += task_extraction_time[t];
+        scoring_time += task_scoring_time[t];
+        if (task_extraction_time[t] + task_scoring_time[t] > slowest_time)
+        {
+          slowest_time = task_extraction_time[t] + task_scoring_time[t];
+          slowest_task = t;
+        }
+      }
+      std::cout << "Processed " << tasks.size() << " extraction tasks in " << wall_time << " s using " << nr_threads << " threads: "
+                << extraction_time << " s extraction, " << scoring_time << " s scoring, thread utilization "
+                << (wall_time > 0.0 ? 100.0 * (extraction_time + scoring_time) / (wall_time * nr_threads) : 100.0) << " %. "
+                << "Slowest task: SWATH " << tasks[slowest_task].window << " batch " << tasks[slowest_task].batch
+                << " (" << slowest_time << " s)." << std::endl;
     }
-#endif
-#endif
   }
 
   void OpenSwathWorkflow::writeOutFeaturesAndChroms_(
@@ -845,6 +966,8 @@ namespace OpenMS
     extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,
         SpectrumSettings(), ms1_chromatograms, true, cp.im_extraction_window);
 
+    if (chromConsumer == nullptr) return;
+
     for (Size j = 0; j < coordinates.size(); j++)
     {
       if (ms1_chromatograms[j].empty()) continue; // skip empty chromatograms
@@ -872,7 +995,9 @@ namespace OpenMS
     OpenSwathTSVWriter & tsv_writer,
     OpenSwathOSWWriter & osw_writer,
     int nr_ms1_isotopes,
-    bool ms1only) const
+    bool ms1only,
+    std::vector< String >* tsv_output,
+    OpenSwathOSWWriter::FeatureRows* osw_output) const
   {
     TransformationDescription trafo_inv = trafo;
     trafo_inv.invert();
@@ -883,15 +1008,27 @@ namespace OpenMS
     // To ensure multi-threading safe access to the individual spectra, we
     // need to use a light clone of the spectrum access (if multiple threads
     // share a single filestream and call seek on it, chaos will ensue).
+    //
+    // Spectra around the peak group apices are kept in a small cache since
+    // the same spectra are used to score many peptides of the batch.
+    const Size spectrum_cache_size = (int)feature_finder_param.getValue("spectrum_cache_size");
+    std::vector<OpenSwath::SpectrumAccessPtr> cached_maps;
     if (use_ms1_traces_ && ms1_map_)
     {
-      OpenSwath::SpectrumAccessPtr threadsafe_ms1 = ms1_map_->lightClone();
+      OpenSwath::SpectrumAccessPtr threadsafe_ms1 = SpectrumAccessLRUCache::create(ms1_map_->lightClone(), spectrum_cache_size);
       featureFinder.setMS1Map( threadsafe_ms1 );
+      cached_maps.push_back(threadsafe_ms1);
     }
     else if (use_ms1_traces_ && !ms1_map_)
     {
       OPENMS_LOG_WARN << "WARNING: Attempted to use MS1 traces but no MS1 map was provided: Will not use MS1 signal!" << std::endl;
     }
+    std::vector<OpenSwath::SwathMap> used_swath_maps = swath_maps;
+    for (auto& m : used_swath_maps)
+    {
+      m.sptr = SpectrumAccessLRUCache::create(m.sptr, spectrum_cache_size);
+      cached_maps.push_back(m.sptr);
+    }
 
     // If use_total_mi_score is defined, we need to instruct MRMTransitionGroupPicker to compute the score
     Param trgroup_picker_param = feature_finder_param.copy("TransitionGroupPicker:", true);
@@ -938,13 +1075,35 @@ namespace OpenMS
       assay_map[transition_exp.getTransitions()[i].getPeptideRef()].push_back(&transition_exp.getTransitions()[i]);
     }
 
-    std::vector<String> to_tsv_output, to_osw_output;
+    // Process the assays in order of their expected retention time (so that
+    // consecutive assays are scored on the same spectra), but report them in
+    // the order of the assay map.
+    std::vector<AssayMapT::iterator> assays;
+    assays.reserve(assay_map.size());
+    for (AssayMapT::iterator assay_it = assay_map.begin(); assay_it != assay_map.end(); ++assay_it)
+    {
+      assays.push_back(assay_it);
+    }
+    std::vector<Size> processing_order(assays.size());
+    for (Size i = 0; i < assays.size(); ++i) processing_order[i] = i;
+    std::stable_sort(processing_order.begin(), processing_order.end(),
+                     [&](Size a, Size b)
+                     {
+                       return transition_exp.getCompounds()[ assay_peptide_map[assays[a]->first] ].rt <
+                              transition_exp.getCompounds()[ assay_peptide_map[assays[b]->first] ].rt;
+                     });
+
+    const bool store_features = !tsv_writer.isActive() && !osw_writer.isActive();
+    std::vector<String> to_tsv_output(assays.size());
+    std::vector<OpenSwathOSWWriter::FeatureRows> to_osw_output(assays.size());
+    std::vector<FeatureMap> assay_features(store_features ? assays.size() : 0);
     ///////////////////////////////////
     // Start of main function
     // Iterating over all the assays
     ///////////////////////////////////
-    for (AssayMapT::iterator assay_it = assay_map.begin(); assay_it != assay_map.end(); ++assay_it)
+    for (Size assay_idx : processing_order)
     {
+      AssayMapT::iterator assay_it = assays[assay_idx];
       // Create new MRMTransitionGroup
       String id = assay_it->first;
       MRMTransitionGroupType transition_group;
@@ -991,7 +1150,7 @@ namespace OpenMS
       }
 
       // currently .tsv, .osw and .featureXML are mutually exclusive
-      if (tsv_writer.isActive() || osw_writer.isActive()) { output.clear(); }
+      FeatureMap assay_output;
 
       // 2. Set the MS1 chromatograms for the different isotopes, if available
       // (note that for 3 isotopes, we include the monoisotopic peak plus three
@@ -1008,54 +1167,94 @@ namespace OpenMS
 
       // 3. / 4. Process the MRMTransitionGroup: find peakgroups and score them
       trgroup_picker.pickTransitionGroup(transition_group);
-      featureFinder.scorePeakgroups(transition_group, trafo, swath_maps, output, ms1only);
+      featureFinder.scorePeakgroups(transition_group, trafo, used_swath_maps, assay_output, ms1only);
 
       // Ensure that a detection transition is used to derive features for output
-      if (detection_assay_it == nullptr && !output.empty())
+      if (detection_assay_it == nullptr && !assay_output.empty())
       {
           throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
               "Error, did not find any detection transition for feature " + id );
       }
 
       // 5. Add to the output tsv if given
-      if (tsv_writer.isActive() && !output.empty()) // implies that detection_assay_it was set
+      if (tsv_writer.isActive() && !assay_output.empty()) // implies that detection_assay_it was set
       {
         const OpenSwath::LightCompound pep = transition_exp.getCompounds()[ assay_peptide_map[id] ];
-        to_tsv_output.push_back(tsv_writer.prepareLine(pep, detection_assay_it, output, id));
+        to_tsv_output[assay_idx] = tsv_writer.prepareLine(pep, detection_assay_it, assay_output, id);
       }
 
       // 6. Add to the output osw if given
-      if (osw_writer.isActive() && !output.empty()) // implies that detection_assay_it was set
+      if (osw_writer.isActive() && !assay_output.empty()) // implies that detection_assay_it was set
+      {
+        osw_writer.prepareRows(assay_output, id, to_osw_output[assay_idx]);
+      }
+
+      if (store_features)
       {
-        const OpenSwath::LightCompound pep;
-        to_osw_output.push_back(osw_writer.prepareLine(OpenSwath::LightCompound(), // not used currently: transition_exp.getCompounds()[ assay_peptide_map[id] ],
-                                                       nullptr, // not used currently: detection_assay_it,
-                                                       output,
-                                                       id));
+        assay_features[assay_idx] = std::move(assay_output);
       }
     }
 
-    // Only write at the very end since this is a step that needs a barrier
-    if (tsv_writer.isActive())
+    for (FeatureMap& features : assay_features)
+    {
+      for (Feature& f : features)
+      {
+        output.push_back(std::move(f));
+      }
+    }
+    to_tsv_output.erase(std::remove(to_tsv_output.begin(), to_tsv_output.end(), String()), to_tsv_output.end());
+
+    Size cache_hits = 0, cache_misses = 0;
+    for (const auto& m : cached_maps)
+    {
+      const SpectrumAccessLRUCache* cache = dynamic_cast<const SpectrumAccessLRUCache*>(m.get());
+      if (cache == nullptr) continue;
+      cache_hits += cache->getNrHits();
+      cache_misses += cache->getNrMisses();
+    }
+    if (cache_hits + cache_misses > 0)
     {
 #ifdef _OPENMP
-#pragma omp critical (osw_write_tsv)
+#pragma omp critical (LOG_DEBUG_access)
 #endif
+      OPENMS_LOG_INFO << "Spectrum cache: " << cache_hits << " of " << cache_hits + cache_misses << " spectra served from cache ("
+                      << 100.0 * cache_hits / (cache_hits + cache_misses) << " % hit rate)" << std::endl;
+    }
+
+    // Hand the results to the caller, who writes them in a deterministic order
+    if (tsv_output != nullptr)
+    {
+      tsv_output->insert(tsv_output->end(), to_tsv_output.begin(), to_tsv_output.end());
+    }
+    if (osw_output != nullptr)
+    {
+      for (const auto& rows : to_osw_output)
       {
-        tsv_writer.writeLines(to_tsv_output);
+        osw_output->append(rows);
       }
     }
 
     // Only write at the very end since this is a step that needs a barrier
-    if (osw_writer.isActive())
+    if (tsv_writer.isActive() && tsv_output == nullptr)
     {
 #ifdef _OPENMP
 #pragma omp critical (osw_write_tsv)
 #endif
       {
-        osw_writer.writeLines(to_osw_output);
+        tsv_writer.writeLines(to_tsv_output);
       }
     }
+
+    // Hand the rows over to the writer thread (no need to wait for other threads here)
+    if (osw_writer.isActive() && osw_output == nullptr)
+    {
+      OpenSwathOSWWriter::FeatureRows osw_rows;
+      for (const auto& rows : to_osw_output)
+      {
+        osw_rows.append(rows);
+      }
+      osw_writer.queueRows(std::move(osw_rows));
+    }
   }
 
 
@@ -1305,6 +1504,9 @@ namespace OpenMS
         this->setProgress(++progress);
       }
       this->endProgress();
+
+      // wait until the writer thread has stored all features
+      osw_writer.flush();
     }
 
 
@@ -35,13 +35,18 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/TransitionPQPFile.h>
 
 #include <sqlite3.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
+#include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/FORMAT/SqliteConnector.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
 
 #include <boost/range/algorithm.hpp>
 #include <boost/range/algorithm_ext/erase.hpp>
 
 #include <sstream>
+#include <functional>
 #include <unordered_map>
+#include <unordered_set>
 #include <iostream>
 
 namespace OpenMS
@@ -49,6 +54,19 @@ namespace OpenMS
 
   namespace Sql = Internal::SqliteHelper;
 
+  namespace
+  {
+    /// Heap memory owned by a string (zero if the string fits into its small string buffer)
+    Size stringHeapSize(const std::string& s)
+    {
+      const char* data = s.data();
+      const char* object = reinterpret_cast<const char*>(&s);
+      std::less<const char*> less;
+      bool is_inline = !less(data, object) && less(data, object + sizeof(std::string));
+      return is_inline ? 0 : s.capacity() + 1;
+    }
+  }
+
   TransitionPQPFile::TransitionPQPFile() :
     TransitionTSVFile()
   {
@@ -58,13 +76,8 @@ namespace OpenMS
   {
   }
 
-  void TransitionPQPFile::readPQPInput_(const char* filename, std::vector<TSVTransition>& transition_list, bool legacy_traml_id)
+  String TransitionPQPFile::getSelectStatement_(sqlite3* db, bool legacy_traml_id, bool& drift_time_exists, bool& gene_exists) const
   {
-    sqlite3 *db;
-    sqlite3_stmt * cntstmt;
-    sqlite3_stmt * stmt;
-    std::string select_sql;
-
     // Use legacy TraML identifiers for precursors (transition_group_id) and transitions (transition_name)?
     std::string traml_id = "ID";
     if (legacy_traml_id)
@@ -72,20 +85,8 @@ namespace OpenMS
       traml_id = "TRAML_ID";
     }
 
-    startProgress(0, 1, "reading PQP file (SQL warmup)");
-
-    // Open database
-    SqliteConnector conn(filename);
-    db = conn.getDB();
-
-    // Count transitions
-    SqliteConnector::prepareStatement(db, &cntstmt, "SELECT COUNT(*) FROM TRANSITION;");
-    sqlite3_step( cntstmt );
-    int num_transitions = sqlite3_column_int(cntstmt, 0);
-    sqlite3_finalize(cntstmt);
-
     String select_drift_time = "";
-    bool drift_time_exists = SqliteConnector::columnExists(db, "PRECURSOR", "LIBRARY_DRIFT_TIME");
+    drift_time_exists = SqliteConnector::columnExists(db, "PRECURSOR", "LIBRARY_DRIFT_TIME");
     if (drift_time_exists)
     {
       select_drift_time = ", PRECURSOR.LIBRARY_DRIFT_TIME AS drift_time ";
@@ -94,7 +95,7 @@ namespace OpenMS
     String select_gene = "";
     String select_gene_null = "";
     String join_gene = "";
-    bool gene_exists = SqliteConnector::tableExists(db, "GENE");
+    gene_exists = SqliteConnector::tableExists(db, "GENE");
     if (gene_exists)
     {
       select_gene = ", GENE_AGGREGATED.GENE_NAME AS gene_name ";
@@ -117,7 +118,7 @@ namespace OpenMS
     if (adducts_exists) select_adducts = "COMPOUND.ADDUCTS AS Adducts, ";
 
     // Get peptides
-    select_sql = "SELECT " \
+    String select_sql = "SELECT " \
                   "PRECURSOR.PRECURSOR_MZ AS precursor, " \
                   "TRANSITION.PRODUCT_MZ AS product, " \
                   "PRECURSOR.LIBRARY_RT AS rt_calibrated, " \
@@ -206,7 +207,68 @@ namespace OpenMS
                   "INNER JOIN TRANSITION ON TRANSITION_PRECURSOR_MAPPING.TRANSITION_ID = TRANSITION.ID " \
                   "INNER JOIN PRECURSOR_COMPOUND_MAPPING ON PRECURSOR.ID = PRECURSOR_COMPOUND_MAPPING.PRECURSOR_ID " \
                   "INNER JOIN COMPOUND ON PRECURSOR_COMPOUND_MAPPING.COMPOUND_ID = COMPOUND.ID; ";
+    return select_sql;
+  }
 
+  void TransitionPQPFile::readTransitionRow_(sqlite3_stmt* stmt, TSVTransition& mytransition, bool drift_time_exists, bool gene_exists) const
+  {
+    Sql::extractValue<double>(&mytransition.precursor, stmt, 0);
+    Sql::extractValue<double>(&mytransition.product, stmt, 1);
+    Sql::extractValue<double>(&mytransition.rt_calibrated, stmt, 2);
+    Sql::extractValue<std::string>(&mytransition.transition_name, stmt, 3);
+    Sql::extractValue<double>(&mytransition.CE, stmt, 4);
+    Sql::extractValue<double>(&mytransition.library_intensity, stmt, 5);
+    Sql::extractValue<std::string>(&mytransition.group_id, stmt, 6);
+    Sql::extractValue<int>((int*)&mytransition.decoy, stmt, 7);
+    Sql::extractValue<std::string>(&mytransition.PeptideSequence, stmt, 8);
+    String tmp_field;
+    if (Sql::extractValue<std::string>(&tmp_field, stmt, 9)) tmp_field.split(';', mytransition.ProteinName);
+    Sql::extractValue<std::string>(&mytransition.Annotation, stmt, 10);
+    Sql::extractValue<std::string>(&mytransition.FullPeptideName, stmt, 11);
+    Sql::extractValue<std::string>(&mytransition.CompoundName, stmt, 12);
+    Sql::extractValue<std::string>(&mytransition.SMILES, stmt, 13);
+    Sql::extractValue<std::string>(&mytransition.SumFormula, stmt, 14);
+    Sql::extractValue<std::string>(&mytransition.Adducts, stmt, 15);
+    Sql::extractValueIntStr(&mytransition.precursor_charge, stmt, 16);
+    Sql::extractValue<std::string>(&mytransition.peptide_group_label, stmt, 17);
+    Sql::extractValue<std::string>(&mytransition.label_type, stmt, 18);
+    Sql::extractValueIntStr(&mytransition.fragment_charge, stmt, 19);
+    Sql::extractValue<int>(&mytransition.fragment_nr, stmt, 20);
+    Sql::extractValue<double>(&mytransition.fragment_mzdelta, stmt, 21);
+    Sql::extractValue<int>(&mytransition.fragment_modification, stmt, 22);
+    Sql::extractValue<std::string>(&mytransition.fragment_type, stmt, 23);
+    if (Sql::extractValue<std::string>(&tmp_field, stmt, 24)) tmp_field.split(';', mytransition.uniprot_id);
+    Sql::extractValue<int>((int*)&mytransition.detecting_transition, stmt, 25);
+    Sql::extractValue<int>((int*)&mytransition.identifying_transition, stmt, 26);
+    Sql::extractValue<int>((int*)&mytransition.quantifying_transition, stmt, 27);
+    if (Sql::extractValue<std::string>(&tmp_field, stmt, 28)) tmp_field.split('|', mytransition.peptidoforms);
+    // optional attributes only present in newer file versions
+    if (drift_time_exists) Sql::extractValue<double>(&mytransition.drift_time, stmt, 29);
+    if (gene_exists) Sql::extractValue<std::string>(&mytransition.GeneName, stmt, 30);
+
+    if (mytransition.GeneName == "NA") mytransition.GeneName = "";
+  }
+
+  void TransitionPQPFile::readPQPInput_(const char* filename, std::vector<TSVTransition>& transition_list, bool legacy_traml_id)
+  {
+    sqlite3 *db;
+    sqlite3_stmt * cntstmt;
+    sqlite3_stmt * stmt;
+
+    startProgress(0, 1, "reading PQP file (SQL warmup)");
+
+    // Open database
+    SqliteConnector conn(filename);
+    db = conn.getDB();
+
+    // Count transitions
+    SqliteConnector::prepareStatement(db, &cntstmt, "SELECT COUNT(*) FROM TRANSITION;");
+    sqlite3_step( cntstmt );
+    int num_transitions = sqlite3_column_int(cntstmt, 0);
+    sqlite3_finalize(cntstmt);
+
+    bool drift_time_exists, gene_exists;
+    String select_sql = getSelectStatement_(db, legacy_traml_id, drift_time_exists, gene_exists);
 
     // Execute SQL select statement
     SqliteConnector::prepareStatement(db, &stmt, select_sql);
@@ -220,49 +282,152 @@ namespace OpenMS
     {
       setProgress(progress++);
       TSVTransition mytransition;
+      readTransitionRow_(stmt, mytransition, drift_time_exists, gene_exists);
+      transition_list.push_back(mytransition);
+      sqlite3_step( stmt );
+    }
+    endProgress();
 
-      Sql::extractValue<double>(&mytransition.precursor, stmt, 0);
-      Sql::extractValue<double>(&mytransition.product, stmt, 1);
-      Sql::extractValue<double>(&mytransition.rt_calibrated, stmt, 2);
-      Sql::extractValue<std::string>(&mytransition.transition_name, stmt, 3);
-      Sql::extractValue<double>(&mytransition.CE, stmt, 4);
-      Sql::extractValue<double>(&mytransition.library_intensity, stmt, 5);
-      Sql::extractValue<std::string>(&mytransition.group_id, stmt, 6);
-      Sql::extractValue<int>((int*)&mytransition.decoy, stmt, 7);
-      Sql::extractValue<std::string>(&mytransition.PeptideSequence, stmt, 8);
-      String tmp_field;
-      if (Sql::extractValue<std::string>(&tmp_field, stmt, 9)) tmp_field.split(';', mytransition.ProteinName);
-      Sql::extractValue<std::string>(&mytransition.Annotation, stmt, 10);
-      Sql::extractValue<std::string>(&mytransition.FullPeptideName, stmt, 11);
-      Sql::extractValue<std::string>(&mytransition.CompoundName, stmt, 12);
-      Sql::extractValue<std::string>(&mytransition.SMILES, stmt, 13);
-      Sql::extractValue<std::string>(&mytransition.SumFormula, stmt, 14);
-      Sql::extractValue<std::string>(&mytransition.Adducts, stmt, 15);
-      Sql::extractValueIntStr(&mytransition.precursor_charge, stmt, 16);
-      Sql::extractValue<std::string>(&mytransition.peptide_group_label, stmt, 17);
-      Sql::extractValue<std::string>(&mytransition.label_type, stmt, 18);
-      Sql::extractValueIntStr(&mytransition.fragment_charge, stmt, 19);
-      Sql::extractValue<int>(&mytransition.fragment_nr, stmt, 20);
-      Sql::extractValue<double>(&mytransition.fragment_mzdelta, stmt, 21);
-      Sql::extractValue<int>(&mytransition.fragment_modification, stmt, 22);
-      Sql::extractValue<std::string>(&mytransition.fragment_type, stmt, 23);
-      if (Sql::extractValue<std::string>(&tmp_field, stmt, 24)) tmp_field.split(';', mytransition.uniprot_id);
-      Sql::extractValue<int>((int*)&mytransition.detecting_transition, stmt, 25);
-      Sql::extractValue<int>((int*)&mytransition.identifying_transition, stmt, 26);
-      Sql::extractValue<int>((int*)&mytransition.quantifying_transition, stmt, 27);
-      if (Sql::extractValue<std::string>(&tmp_field, stmt, 28)) tmp_field.split('|', mytransition.peptidoforms);
-      // optional attributes only present in newer file versions
-      if (drift_time_exists) Sql::extractValue<double>(&mytransition.drift_time, stmt, 29);
-      if (gene_exists) Sql::extractValue<std::string>(&mytransition.GeneName, stmt, 30);
-
-      if (mytransition.GeneName == "NA") mytransition.GeneName = "";
+    sqlite3_finalize(stmt);
+  }
+
+  void TransitionPQPFile::readPQPInput_(const char* filename, OpenSwath::LightTargetedExperiment& targeted_exp, bool legacy_traml_id)
+  {
+    sqlite3 *db;
+    sqlite3_stmt * cntstmt;
+    sqlite3_stmt * stmt;
+
+    StopWatch timer;
+    timer.start();
+
+    startProgress(0, 1, "reading PQP file (SQL warmup)");
+
+    // Open database
+    SqliteConnector conn(filename);
+    db = conn.getDB();
+
+    // Count transitions
+    SqliteConnector::prepareStatement(db, &cntstmt, "SELECT COUNT(*) FROM TRANSITION;");
+    sqlite3_step( cntstmt );
+    int num_transitions = sqlite3_column_int(cntstmt, 0);
+    sqlite3_finalize(cntstmt);
+
+    bool drift_time_exists, gene_exists;
+    String select_sql = getSelectStatement_(db, legacy_traml_id, drift_time_exists, gene_exists);
+
+    // Execute SQL select statement
+    SqliteConnector::prepareStatement(db, &stmt, select_sql);
+    sqlite3_step(stmt);
+    endProgress();
+
+    targeted_exp.transitions.reserve(targeted_exp.transitions.size() + num_transitions);
+
+    // Only the first row of each transition group is fully parsed, it carries
+    // all precursor-level information needed to create the compound.
+    std::vector<TSVTransition> group_rows;
+    std::unordered_map<std::string, Size> group_index;
+    std::unordered_set<std::string> protein_ids;
+    std::string group_id;
+
+    Size progress = 0;
+    startProgress(0, num_transitions, "reading PQP file");
+    // Convert SQLite data directly to LightTransition data structure
+    while (sqlite3_column_type(stmt, 0) != SQLITE_NULL)
+    {
+      setProgress(progress++);
+
+      group_id.clear();
+      Sql::extractValue<std::string>(&group_id, stmt, 6);
+      auto group_it = group_index.find(group_id);
+      if (group_it == group_index.end())
+      {
+        group_it = group_index.emplace(group_id, group_rows.size()).first;
+        group_rows.emplace_back();
+        TSVTransition& group_row = group_rows.back();
+        readTransitionRow_(stmt, group_row, drift_time_exists, gene_exists);
+
+        // check whether we need new proteins
+        if (group_row.isPeptide())
+        {
+          for (const auto& protein_name : group_row.ProteinName)
+          {
+            if (protein_ids.insert(protein_name).second)
+            {
+              OpenSwath::LightProtein protein;
+              protein.id = protein_name;
+              protein.sequence = "";
+              targeted_exp.proteins.push_back(protein);
+            }
+          }
+        }
+      }
+
+      targeted_exp.transitions.emplace_back();
+      OpenSwath::LightTransition& transition = targeted_exp.transitions.back();
+      Sql::extractValue<std::string>(&transition.transition_name, stmt, 3);
+      transition.peptide_ref = group_it->first; // a copy per transition (included in the memory estimate below)
+      transition.precursor_mz = -1;
+      transition.product_mz = -1;
+      transition.library_intensity = -1;
+      Sql::extractValue<double>(&transition.precursor_mz, stmt, 0);
+      Sql::extractValue<double>(&transition.product_mz, stmt, 1);
+      Sql::extractValue<double>(&transition.library_intensity, stmt, 5);
+      if (drift_time_exists) Sql::extractValue<double>(&transition.precursor_im, stmt, 29);
+      // use zero for charge that is not set
+      if (sqlite3_column_type(stmt, 19) == SQLITE_INTEGER) transition.fragment_charge = sqlite3_column_int(stmt, 19);
+
+      int flag = 0;
+      transition.decoy = Sql::extractValue<int>(&flag, stmt, 7) && flag;
+      flag = 1;
+      Sql::extractValue<int>(&flag, stmt, 25);
+      transition.detecting_transition = flag;
+      flag = 0;
+      Sql::extractValue<int>(&flag, stmt, 26);
+      transition.identifying_transition = flag;
+      flag = 1;
+      Sql::extractValue<int>(&flag, stmt, 27);
+      transition.quantifying_transition = flag;
 
-      transition_list.push_back(mytransition);
       sqlite3_step( stmt );
     }
     endProgress();
 
     sqlite3_finalize(stmt);
+
+    resolveMixedSequenceGroups_(group_rows);
+
+    targeted_exp.compounds.reserve(targeted_exp.compounds.size() + group_rows.size());
+    for (auto tr_it = group_rows.cbegin(); tr_it != group_rows.cend(); ++tr_it)
+    {
+      OpenSwath::LightCompound compound;
+      if (tr_it->isPeptide())
+      {
+        OpenMS::TargetedExperiment::Peptide tramlpeptide;
+        createPeptide_(tr_it, tramlpeptide);
+        OpenSwathDataAccessHelper::convertTargetedCompound(tramlpeptide, compound);
+      }
+      else
+      {
+        OpenMS::TargetedExperiment::Compound tramlcompound;
+        createCompound_(tr_it, tramlcompound);
+        OpenSwathDataAccessHelper::convertTargetedCompound(tramlcompound, compound);
+      }
+      targeted_exp.compounds.push_back(compound);
+    }
+
+    timer.stop();
+    if (!targeted_exp.transitions.empty())
+    {
+      Size transition_bytes = targeted_exp.transitions.capacity() * sizeof(OpenSwath::LightTransition);
+      for (const auto& tr : targeted_exp.transitions)
+      {
+        transition_bytes += stringHeapSize(tr.transition_name) + stringHeapSize(tr.peptide_ref);
+      }
+      OPENMS_LOG_INFO << "Read " << targeted_exp.transitions.size() << " transitions, " << targeted_exp.compounds.size()
+                      << " compounds and " << targeted_exp.proteins.size() << " proteins from " << filename << " in "
+                      << timer.getClockTime() << " s (" << transition_bytes / targeted_exp.transitions.size()
+                      << " bytes per transition)." << std::endl;
+    }
   }
 
   void TransitionPQPFile::writePQPOutput_(const char* filename, OpenMS::TargetedExperiment& targeted_exp)
@@ -721,9 +886,7 @@ namespace OpenMS
                                                          OpenSwath::LightTargetedExperiment& targeted_exp,
                                                          bool legacy_traml_id)
   {
-    std::vector<TSVTransition> transition_list;
-    readPQPInput_(filename, transition_list, legacy_traml_id);
-    TSVToTargetedExperiment_(transition_list, targeted_exp);
+    readPQPInput_(filename, targeted_exp, legacy_traml_id);
   }
 
 }
@@ -47,11 +47,155 @@
 #include <cmath>
 #include <algorithm>
 #include <map>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 using namespace std;
 
 namespace OpenMS
 {
+  namespace
+  {
+    /**
+      @brief Bounded cache of parsed sequences, shared by all threads (see AASequence::fromString)
+
+      The cache is split into shards (by hash of the string), each with its own lock and least recently
+      used eviction, so concurrent parsing threads rarely contend. Parsing of modifications depends on the
+      content of ModificationsDB (e.g. mass-based modifications). Entries of sequences with modifications
+      therefore remember the number of modifications they were parsed with and are re-parsed individually
+      when that number changed; entries of unmodified sequences never become invalid.
+    */
+    class AASequenceParseCache
+    {
+public:
+      static const Size nr_shards = 16;
+
+      /// default upper bound on the number of entries (see AASequence::setParseCacheSize)
+      static const Size default_capacity = 100000;
+
+      Size getCapacity() const
+      {
+        return capacity_.load(std::memory_order_relaxed);
+      }
+
+      void setCapacity(Size capacity)
+      {
+        capacity_.store(capacity, std::memory_order_relaxed);
+        for (auto& shards : shards_)
+        {
+          for (Shard_& shard : shards)
+          {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.evict(shardCapacity_(capacity));
+          }
+        }
+      }
+
+      void clear()
+      {
+        for (auto& shards : shards_)
+        {
+          for (Shard_& shard : shards)
+          {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.evict(0);
+          }
+        }
+      }
+
+      /// copies the cached sequence to @p result (if present and parsed with @p mod_count modifications)
+      bool lookup(const String& s, bool permissive, Size mod_count, AASequence& result)
+      {
+        Shard_& shard = getShard_(s, permissive);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(s);
+        if (it == shard.index.end())
+        {
+          return false;
+        }
+        if (it->second->mod_count != mod_count)
+        {
+          // ModificationsDB changed since parsing: drop only this entry
+          shard.lru.erase(it->second);
+          shard.index.erase(it);
+          return false;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        result = it->second->sequence;
+        return true;
+      }
+
+      void insert(const String& s, bool permissive, Size mod_count, const AASequence& sequence)
+      {
+        const Size capacity = shardCapacity_(getCapacity());
+        if (capacity == 0) return;
+
+        Shard_& shard = getShard_(s, permissive);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(s);
+        if (it != shard.index.end())
+        {
+          // parsed concurrently by another thread
+          it->second->mod_count = mod_count;
+          it->second->sequence = sequence;
+          shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+          return;
+        }
+        shard.lru.push_front(Entry_{s, mod_count, sequence});
+        shard.index.emplace(s, shard.lru.begin());
+        shard.evict(capacity);
+      }
+
+private:
+      struct Entry_
+      {
+        String key;
+        /// number of modifications in ModificationsDB at parse time (0 for sequences without modifications)
+        Size mod_count;
+        AASequence sequence;
+      };
+
+      struct Shard_
+      {
+        std::mutex mutex;
+        /// most recently used entries first
+        std::list<Entry_> lru;
+        std::unordered_map<String, std::list<Entry_>::iterator> index;
+
+        /// removes least recently used entries until at most @p capacity are left (lock must be held)
+        void evict(Size capacity)
+        {
+          while (lru.size() > capacity)
+          {
+            index.erase(lru.back().key);
+            lru.pop_back();
+          }
+        }
+      };
+
+      static Size shardCapacity_(Size capacity)
+      {
+        return (capacity + nr_shards - 1) / nr_shards;
+      }
+
+      Shard_& getShard_(const String& s, bool permissive)
+      {
+        return shards_[permissive ? 1 : 0][std::hash<std::string>()(s) % nr_shards];
+      }
+
+      std::atomic<Size> capacity_{default_capacity};
+      /// shards, indexed by the 'permissive' flag
+      Shard_ shards_[2][nr_shards];
+    };
+
+    AASequenceParseCache& getParseCache()
+    {
+      static AASequenceParseCache cache;
+      return cache;
+    }
+  }
 
   const ResidueModification* proteinTerminalResidueHelper( ModificationsDB* mod_db,
       const char term,
@@ -1708,15 +1852,46 @@ namespace OpenMS
   AASequence AASequence::fromString(const String& s, bool permissive)
   {
     AASequence aas;
+    AASequenceParseCache& cache = getParseCache();
+    if (cache.getCapacity() == 0)
+    {
+      parseString_(s, aas, permissive);
+      return aas;
+    }
+
+    // only modifications depend on the content of ModificationsDB (read before parsing, so that
+    // modifications added concurrently invalidate the new entry)
+    const bool has_modifications = s.find_first_of("([") != std::string::npos;
+    const Size mod_count = has_modifications ? ModificationsDB::getInstance()->getNumberOfModifications() : 0;
+    if (cache.lookup(s, permissive, mod_count, aas))
+    {
+      return aas;
+    }
+
+    // parse outside of the lock (throws on invalid input, which is not cached)
     parseString_(s, aas, permissive);
+    cache.insert(s, permissive, mod_count, aas);
     return aas;
   }
 
   AASequence AASequence::fromString(const char* s, bool permissive)
   {
-    AASequence aas;
-    parseString_(String(s), aas, permissive);
-    return aas;
+    return fromString(String(s), permissive);
+  }
+
+  void AASequence::setParseCacheSize(Size max_entries)
+  {
+    getParseCache().setCapacity(max_entries);
+  }
+
+  Size AASequence::getParseCacheSize()
+  {
+    return getParseCache().getCapacity();
+  }
+
+  void AASequence::clearParseCache()
+  {
+    getParseCache().clear();
   }
 
 }
@@ -46,11 +46,83 @@
 #include <limits>
 #include <functional>
 #include <numeric>
+#include <map>
+#include <mutex>
+#include <vector>
 
 using namespace std;
 
 namespace OpenMS
 {
+  namespace
+  {
+    typedef Peak1D::IntensityType Intensity;
+
+    /**
+      @brief Adds the convolution of @p left and @p right to @p result (which must be zero-initialized), truncated after @p n_result entries
+
+      Works on plain contiguous intensity arrays, so the compiler can vectorize the inner loop.
+      Every result entry receives its products in the same order as in the original Peak1D-based loops
+      (outer index descending, since the small products tend to come first), i.e. results are identical.
+    */
+    void convolveIntensities(const Intensity* left, Size n_left, const Intensity* right, Size n_right, Intensity* result, Size n_result)
+    {
+      for (Size i = n_left; i-- > 0; )
+      {
+        if (i >= n_result) continue;
+        const Size n_j = std::min(n_result - i, n_right);
+        const Intensity l = left[i];
+        Intensity* out = result + i;
+        for (Size j = 0; j < n_j; ++j)
+        {
+          out[j] += l * right[j];
+        }
+      }
+    }
+
+    void extractIntensities(const IsotopeDistribution::ContainerType& input, std::vector<Intensity>& intensities)
+    {
+      intensities.resize(input.size());
+      for (Size i = 0; i < input.size(); ++i)
+      {
+        intensities[i] = input[i].getIntensity();
+      }
+    }
+
+    /// scratch buffers of the convolution kernels, reused by all calls on the same thread
+    struct ConvolutionBuffers
+    {
+      std::vector<Intensity> left;
+      std::vector<Intensity> right;
+      std::vector<Intensity> result;
+    };
+
+    ConvolutionBuffers& getConvolutionBuffers()
+    {
+      thread_local ConvolutionBuffers buffers;
+      return buffers;
+    }
+
+    /// key of the averagine cache: maximal isotope and element composition of the formula
+    typedef std::pair<Size, std::vector<std::pair<const Element*, SignedSize> > > AveragineKey;
+
+    /// normalized intensities of already computed (estimated) formulas, shared by all generators
+    struct AveragineCache
+    {
+      /// upper bound on the number of entries; the cache is cleared when exceeded
+      static const Size max_size = 100000;
+
+      std::mutex mutex;
+      std::map<AveragineKey, std::vector<Intensity> > intensities;
+    };
+
+    AveragineCache& getAveragineCache()
+    {
+      static AveragineCache cache;
+      return cache;
+    }
+  }
+
   CoarseIsotopePatternGenerator::CoarseIsotopePatternGenerator(const Size max_isotope, const bool round_masses) :
     IsotopePatternGenerator(),
     max_isotope_(max_isotope),
@@ -102,12 +174,60 @@ namespace OpenMS
     return result;
   }
 
+  IsotopeDistribution CoarseIsotopePatternGenerator::runCached_(const EmpiricalFormula& formula) const
+  {
+    AveragineKey key(max_isotope_, std::vector<std::pair<const Element*, SignedSize> >(formula.begin(), formula.end()));
+    AveragineCache& cache = getAveragineCache();
+    {
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      auto it = cache.intensities.find(key);
+      if (it != cache.intensities.end())
+      {
+        IsotopeDistribution::ContainerType container(it->second.size());
+        for (Size i = 0; i < container.size(); ++i)
+        {
+          container[i].setIntensity(it->second[i]);
+        }
+        IsotopeDistribution result;
+        result.set(correctMass_(container, formula.getMonoWeight()));
+        return result;
+      }
+    }
+
+    // compute outside of the lock; concurrent misses for the same formula yield the same values
+    IsotopeDistribution result = run(formula);
+    std::vector<Intensity> intensities;
+    extractIntensities(result.getContainer(), intensities);
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (cache.intensities.size() >= AveragineCache::max_size)
+    {
+      cache.intensities.clear();
+    }
+    cache.intensities.emplace(std::move(key), std::move(intensities));
+    return result;
+  }
+
   IsotopeDistribution CoarseIsotopePatternGenerator::estimateFromPeptideWeight(double average_weight)
   {
     // Element counts are from Senko's Averagine model
     return estimateFromWeightAndComp(average_weight, 4.9384, 7.7583, 1.3577, 1.4773, 0.0417, 0);
   }
 
+  std::vector<IsotopeDistribution> CoarseIsotopePatternGenerator::estimateFromPeptideWeight(const std::vector<double>& average_weights)
+  {
+    std::vector<IsotopeDistribution> result;
+    result.reserve(average_weights.size());
+    EmpiricalFormula ef;
+    for (double average_weight : average_weights)
+    {
+      // Element counts are from Senko's Averagine model (see estimateFromPeptideWeight(double))
+      ef.estimateFromWeightAndComp(average_weight, 4.9384, 7.7583, 1.3577, 1.4773, 0.0417, 0);
+      result.push_back(runCached_(ef));
+    }
+    return result;
+  }
+
   IsotopeDistribution CoarseIsotopePatternGenerator::estimateFromPeptideWeightAndS(double average_weight, UInt S)
   {
     // Element counts are from Senko's Averagine model, excluding sulfur.
@@ -128,14 +248,14 @@ namespace OpenMS
   {
     EmpiricalFormula ef;
     ef.estimateFromWeightAndComp(average_weight, C, H, N, O, S, P);
-    return ef.getIsotopeDistribution(*this);
+    return runCached_(ef);
   }
 
   IsotopeDistribution CoarseIsotopePatternGenerator::estimateFromWeightAndCompAndS(double average_weight, UInt S, double C, double H, double N, double O, double P)
   {
     EmpiricalFormula ef;
     ef.estimateFromWeightAndCompAndS(average_weight, S, C, H, N, O, P);
-    return ef.getIsotopeDistribution(*this);
+    return runCached_(ef);
   }
 
   IsotopeDistribution CoarseIsotopePatternGenerator::estimateForFragmentFromPeptideWeight(double average_weight_precursor, double average_weight_fragment, const std::set<UInt>& precursor_isotopes)
@@ -281,23 +401,18 @@ namespace OpenMS
       r_max = (IsotopeDistribution::ContainerType::size_type)max_isotope_;
     }
 
-    // pre-fill result with masses
+    // compute probabilities on contiguous intensity buffers (reused across calls)
+    ConvolutionBuffers& buffers = getConvolutionBuffers();
+    extractIntensities(left_l, buffers.left);
+    extractIntensities(right_l, buffers.right);
+    buffers.result.assign(r_max, 0);
+    convolveIntensities(buffers.left.data(), buffers.left.size(), buffers.right.data(), buffers.right.size(), buffers.result.data(), r_max);
+
+    // fill result with masses and probabilities
     result.resize(r_max);
     for (IsotopeDistribution::ContainerType::size_type i = 0; i != r_max; ++i)
     {
-      result[i] = Peak1D(left_l[0].getMZ() + right_l[0].getMZ() + i, 0);
-    }
-
-    // fill result with probabilities
-    // (we loop backwards because then the small products tend to come first, for better numerics)
-    for (SignedSize i = left_l.size() - 1; i >= 0; --i)
-    {
-      for (SignedSize j = min<SignedSize>(r_max - i, right_l.size()) - 1; j >= 0; --j)
-      {
-        Peak1D& peak = result[i + j];
-        Peak1D::IntensityType p_intensity = peak.getIntensity();
-        peak.setIntensity( p_intensity + left_l[i].getIntensity() * right_l[j].getIntensity());
-      }
+      result[i] = Peak1D(left_l[0].getMZ() + right_l[0].getMZ() + i, buffers.result[i]);
     }
     return result;
   }
@@ -374,20 +489,15 @@ namespace OpenMS
       r_max = (IsotopeDistribution::ContainerType::size_type)(max_isotope_ + 1);
     }
 
+    ConvolutionBuffers& buffers = getConvolutionBuffers();
+    extractIntensities(input, buffers.left);
+    buffers.result.assign(r_max, 0);
+    convolveIntensities(buffers.left.data(), buffers.left.size(), buffers.left.data(), buffers.left.size(), buffers.result.data(), r_max);
+
     result.resize(r_max);
     for (IsotopeDistribution::ContainerType::size_type i = 0; i != r_max; ++i)
     {
-      result[i] = Peak1D(2 * input[0].getMZ() + i, 0);
-    }
-
-    // we loop backwards because then the small products tend to come first
-    // (for better numerics)
-    for (SignedSize i = input.size() - 1; i >= 0; --i)
-    {
-      for (SignedSize j = min<SignedSize>(r_max - i, input.size()) - 1; j >= 0; --j)
-      {
-        result[i + j].setIntensity( result[i + j].getIntensity() + input[i].getIntensity() * input[j].getIntensity());
-      }
+      result[i] = Peak1D(2 * input[0].getMZ() + i, buffers.result[i]);
     }
 
     return result;
@@ -39,6 +39,7 @@
 #include <OpenMS/FORMAT/UnimodXMLFile.h>
 #include <OpenMS/SYSTEM/File.h>
 #include <OpenMS/CHEMISTRY/Residue.h>
+#include <OpenMS/CHEMISTRY/ResidueDB.h>
 #include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/CONCEPT/Macros.h>
 
@@ -118,10 +119,15 @@ namespace OpenMS
   ModificationsDB::~ModificationsDB()
   {
     modification_names_.clear();
+    added_names_.clear();
     for (auto it = mods_.begin(); it != mods_.end(); ++it)
     {
       delete *it;
     }
+    for (auto it = added_mods_.begin(); it != added_mods_.end(); ++it)
+    {
+      delete *it;
+    }
   }
 
   bool ModificationsDB::isInstantiated()
@@ -129,12 +135,176 @@ namespace OpenMS
     return is_instantiated_;
   }
 
+  void ModificationsDB::freeze()
+  {
+    // taking the lock ensures that no modification is registered concurrently
+    #pragma omp critical(OpenMS_ModificationsDB)
+    {
+      ++freeze_count_;
+      frozen_.store(true, std::memory_order_release);
+    }
+  }
+
+  void ModificationsDB::unfreeze()
+  {
+    // mods_ and modification_names_ stay untouched (and modifications added
+    // in the meantime stay in added_mods_), since other threads may still
+    // read them without the lock
+    #pragma omp critical(OpenMS_ModificationsDB)
+    {
+      if (freeze_count_ > 0) --freeze_count_;
+    }
+  }
+
+  bool ModificationsDB::isFrozen() const
+  {
+    bool frozen;
+    #pragma omp critical(OpenMS_ModificationsDB)
+    {
+      frozen = freeze_count_ > 0;
+    }
+    return frozen;
+  }
+
+  ModificationsDB::FreezeGuard::FreezeGuard()
+  {
+    ModificationsDB::getInstance()->freeze();
+    ResidueDB::getInstance()->freeze();
+  }
+
+  ModificationsDB::FreezeGuard::~FreezeGuard()
+  {
+    ResidueDB::getInstance()->unfreeze();
+    ModificationsDB::getInstance()->unfreeze();
+  }
+
+  template <typename Function>
+  bool ModificationsDB::forEachNamed_(const String& name, Function&& f) const
+  {
+    bool found = false;
+    if (frozen_.load(std::memory_order_acquire))
+    {
+      // immutable snapshot, no lock required
+      auto modifications = modification_names_.find(name);
+      if (modifications != modification_names_.end())
+      {
+        found = true;
+        for (const ResidueModification* m : modifications->second)
+        {
+          f(m);
+        }
+      }
+      if (!has_added_.load(std::memory_order_acquire))
+      {
+        return found;
+      }
+      #pragma omp critical(OpenMS_ModificationsDB)
+      {
+        auto added = added_names_.find(name);
+        if (added != added_names_.end())
+        {
+          found = true;
+          for (const ResidueModification* m : added->second)
+          {
+            f(m);
+          }
+        }
+      }
+      return found;
+    }
+
+    #pragma omp critical(OpenMS_ModificationsDB)
+    {
+      auto modifications = modification_names_.find(name);
+      if (modifications != modification_names_.end())
+      {
+        found = true;
+        for (const ResidueModification* m : modifications->second)
+        {
+          f(m);
+        }
+      }
+    }
+    return found;
+  }
+
+  template <typename Function>
+  void ModificationsDB::forEachModification_(Function&& f) const
+  {
+    if (frozen_.load(std::memory_order_acquire))
+    {
+      // immutable snapshot, no lock required
+      for (const ResidueModification* m : mods_)
+      {
+        f(m);
+      }
+      if (has_added_.load(std::memory_order_acquire))
+      {
+        #pragma omp critical(OpenMS_ModificationsDB)
+        {
+          for (const ResidueModification* m : added_mods_)
+          {
+            f(m);
+          }
+        }
+      }
+      return;
+    }
+
+    #pragma omp critical(OpenMS_ModificationsDB)
+    {
+      for (const ResidueModification* m : mods_)
+      {
+        f(m);
+      }
+    }
+  }
+
+  const ResidueModification* ModificationsDB::findRegistered_(const String& name) const
+  {
+    auto it = modification_names_.find(name);
+    if (it != modification_names_.end())
+    {
+      return *(it->second.begin());
+    }
+    it = added_names_.find(name);
+    if (it != added_names_.end())
+    {
+      return *(it->second.begin());
+    }
+    return nullptr;
+  }
+
+  void ModificationsDB::registerModification_(ResidueModification* mod)
+  {
+    // after freezing, the snapshot must not change anymore
+    const bool frozen = frozen_.load(std::memory_order_relaxed);
+    auto& names = frozen ? added_names_ : modification_names_;
+    names[mod->getFullId()].insert(mod);
+    names[mod->getId()].insert(mod);
+    names[mod->getFullName()].insert(mod);
+    names[mod->getUniModAccession()].insert(mod);
+    if (frozen)
+    {
+      added_mods_.push_back(mod);
+      has_added_.store(true, std::memory_order_release);
+    }
+    else
+    {
+      mods_.push_back(mod);
+    }
+  }
+
   Size ModificationsDB::getNumberOfModifications() const
   {
     Size s;
+    if (frozen_.load(std::memory_order_acquire) && !has_added_.load(std::memory_order_acquire))
+    {
+      return mods_.size();
+    }
     #pragma omp critical (OpenMS_ModificationsDB)
     {
-      s = mods_.size();
+      s = mods_.size() + added_mods_.size();
     }
     return s;
   }
@@ -153,42 +323,32 @@ namespace OpenMS
     char res = '?'; // empty
     if (!residue.empty()) res = residue[0];
 
-    #pragma omp critical(OpenMS_ModificationsDB)
+    int nr_mods = 0;
+    auto match = [&](const ResidueModification* it)
     {
-      bool found = true;
-      auto modifications = modification_names_.find(mod_name);
-      if (modifications == modification_names_.end())
+      if ( residuesMatch_(res, it) &&
+           (term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY ||
+           (term_spec == it->getTermSpecificity())))
       {
-        // Try to fix things, Skyline for example uses unimod:10 and not UniMod:10 syntax
-        if (mod_name.size() > 6 && mod_name.prefix(6).toLower() == "unimod")
-        {
-          mod_name = "UniMod" + mod_name.substr(6, mod_name.size() - 6);
-        }
+        mod = it;
+        nr_mods++;
+      }
+    };
 
-        modifications = modification_names_.find(mod_name);
-        if (modifications == modification_names_.end())
-        {
-          OPENMS_LOG_WARN << OPENMS_PRETTY_FUNCTION << "Modification not found: " << mod_name << endl;
-          found = false; 
-        }
+    if (!forEachNamed_(mod_name, match))
+    {
+      // Try to fix things, Skyline for example uses unimod:10 and not UniMod:10 syntax
+      if (mod_name.size() > 6 && mod_name.prefix(6).toLower() == "unimod")
+      {
+        mod_name = "UniMod" + mod_name.substr(6, mod_name.size() - 6);
       }
 
-      int nr_mods = 0;
-      if (found)
+      if (!forEachNamed_(mod_name, match))
       {
-        for (const auto& it : modifications->second)
-        {
-          if ( residuesMatch_(res, it) &&
-               (term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY ||
-               (term_spec == it->getTermSpecificity())))
-          {
-            mod = it;
-            nr_mods++;
-          }
-        }
+        OPENMS_LOG_WARN << OPENMS_PRETTY_FUNCTION << "Modification not found: " << mod_name << endl;
       }
-      if (nr_mods > 1) multiple_matches = true;
     }
+    if (nr_mods > 1) multiple_matches = true;
     return mod;
   }
 
@@ -198,34 +358,36 @@ namespace OpenMS
 
     String mod_name = mod_in.getFullId();
 
-    #pragma omp critical(OpenMS_ModificationsDB)
+    bool found = forEachNamed_(mod_name, [&](const ResidueModification* mod_indb)
     {
-      bool found = true;
-      auto modifications = modification_names_.find(mod_name);
-
-      if (modifications == modification_names_.end())
+      if (mod == nullptr && mod_in == *mod_indb)
       {
-        OPENMS_LOG_WARN << OPENMS_PRETTY_FUNCTION << "Modification not found: " << mod_name << endl;
-        found = false; 
+        mod = mod_indb;
       }
+    });
 
-      if (found)
-      {
-        for (const auto& mod_indb : modifications->second)
-        {
-          if (mod_in == *mod_indb)
-          {
-            mod = mod_indb;
-            break;
-          }
-        }
-      }
+    if (!found)
+    {
+      OPENMS_LOG_WARN << OPENMS_PRETTY_FUNCTION << "Modification not found: " << mod_name << endl;
     }
     return mod;
   }
 
   const ResidueModification* ModificationsDB::getModification(Size index) const
   {
+    if (frozen_.load(std::memory_order_acquire) && index >= mods_.size())
+    {
+      const ResidueModification* mod(nullptr);
+      #pragma omp critical(OpenMS_ModificationsDB)
+      {
+        if (index - mods_.size() < added_mods_.size())
+        {
+          mod = added_mods_[index - mods_.size()];
+        }
+      }
+      OPENMS_PRECONDITION(mod != nullptr, "Index out of bounds in ModificationsDB::getModification(Size index)." );
+      return mod;
+    }
     OPENMS_PRECONDITION(index < mods_.size(), "Index out of bounds in ModificationsDB::getModification(Size index)." );
     return mods_[index];
   }
@@ -242,39 +404,29 @@ namespace OpenMS
     char res = '?'; // empty
     if (!residue.empty()) res = residue[0];
 
-    #pragma omp critical(OpenMS_ModificationsDB)
+    auto match = [&](const ResidueModification* it)
     {
-      bool found = true;
-      auto modifications = modification_names_.find(mod_name);
-      if (modifications == modification_names_.end())
+      if ( residuesMatch_(res, it) &&
+           (term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY ||
+           (term_spec == it->getTermSpecificity())))
       {
-        // Try to fix things, Skyline for example uses unimod:10 and not UniMod:10 syntax
-        if (mod_name.size() > 6 && mod_name.prefix(6).toLower() == "unimod")
-        {
-          mod_name = "UniMod" + mod_name.substr(6, mod_name.size() - 6);
-        }
+        mods.insert(it);
+      }
+    };
 
-        modifications = modification_names_.find(mod_name);
-        if (modifications == modification_names_.end())
-        {
-          OPENMS_LOG_WARN << OPENMS_PRETTY_FUNCTION << "Modification not found: " << mod_name << endl;
-          found = false; 
-        }
+    if (!forEachNamed_(mod_name, match))
+    {
+      // Try to fix things, Skyline for example uses unimod:10 and not UniMod:10 syntax
+      if (mod_name.size() > 6 && mod_name.prefix(6).toLower() == "unimod")
+      {
+        mod_name = "UniMod" + mod_name.substr(6, mod_name.size() - 6);
       }
 
-      if (found)
+      if (!forEachNamed_(mod_name, match))
       {
-        for (const auto& it : modifications->second)
-        {
-          if ( residuesMatch_(res, it) &&
-               (term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY ||
-               (term_spec == it->getTermSpecificity())))
-          {
-            mods.insert(it);
-          }
-        }
+        OPENMS_LOG_WARN << OPENMS_PRETTY_FUNCTION << "Modification not found: " << mod_name << endl;
       }
-    } 
+    }
   }
 
   const ResidueModification* ModificationsDB::getModification(const String& mod_name, const String& residue, ResidueModification::TermSpecificity term_spec) const
@@ -311,47 +463,32 @@ namespace OpenMS
 
   bool ModificationsDB::has(const String & modification) const
   {
-    bool has_mod;
-    #pragma omp critical(OpenMS_ModificationsDB)
-    {
-      has_mod = (modification_names_.find(modification) != modification_names_.end());
-    }
-    return has_mod;
+    return forEachNamed_(modification, [](const ResidueModification*) {});
   }
 
   Size ModificationsDB::findModificationIndex(const String & mod_name) const
   {
-    if (!has(mod_name))
+    vector<const ResidueModification*> named;
+    if (!forEachNamed_(mod_name, [&named](const ResidueModification* m) { named.push_back(m); }))
     {
       throw Exception::ElementNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Modification not found: " + mod_name);
     }
 
-    bool one_mod(true);
-    #pragma omp critical(OpenMS_ModificationsDB)
-    {
-      if (modification_names_.find(mod_name)->second.size() > 1)
-      {
-        one_mod = false;
-      }
-    }
-    if (!one_mod) 
+    if (named.size() > 1)
     {
       throw Exception::ElementNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "More than one modification with name: " + mod_name);
     }
 
     Size index(numeric_limits<Size>::max());
-    #pragma omp critical(OpenMS_ModificationsDB)
+    Size i(0);
+    forEachModification_([&](const ResidueModification* m)
     {
-      const ResidueModification* mod = *(modification_names_.find(mod_name)->second.begin());
-      for (Size i = 0; i != mods_.size(); ++i)
+      if (index == numeric_limits<Size>::max() && m == named[0])
       {
-        if (mods_[i] == mod)
-        {
-          index = i;
-          break;
-        }
+        index = i;
       }
-    }
+      ++i;
+    });
 
     if (index == numeric_limits<Size>::max())
     {
@@ -365,19 +502,16 @@ namespace OpenMS
     mods.clear();
     char res = '?'; // empty
     if (!residue.empty()) res = residue[0];
-    #pragma omp critical(OpenMS_ModificationsDB)
+    forEachModification_([&](const ResidueModification* m)
     {
-      for (auto const & m : mods_)
+      if ((fabs(m->getDiffMonoMass() - mass) <= max_error) &&
+          residuesMatch_(res, m) &&
+          ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
+           (term_spec == m->getTermSpecificity())))
       {
-        if ((fabs(m->getDiffMonoMass() - mass) <= max_error) &&
-            residuesMatch_(res, m) &&
-            ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
-             (term_spec == m->getTermSpecificity())))
-        {
-          mods.push_back(m->getFullId());
-        }
+        mods.push_back(m->getFullId());
       }
-    }
+    });
   }
 
   void ModificationsDB::searchModificationsByDiffMonoMass(vector<const ResidueModification*>& mods, double mass, double max_error, const String& residue, ResidueModification::TermSpecificity term_spec)
@@ -385,19 +519,16 @@ namespace OpenMS
     mods.clear();
     char res = '?'; // empty
     if (!residue.empty()) res = residue[0];
-    #pragma omp critical(OpenMS_ModificationsDB)
+    forEachModification_([&](const ResidueModification* m)
     {
-      for (auto const & m : mods_)
+      if ((fabs(m->getDiffMonoMass() - mass) <= max_error) &&
+          residuesMatch_(res, m) &&
+          ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
+           (term_spec == m->getTermSpecificity())))
       {
-        if ((fabs(m->getDiffMonoMass() - mass) <= max_error) &&
-            residuesMatch_(res, m) &&
-            ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
-             (term_spec == m->getTermSpecificity())))
-        {
-          mods.push_back(m);
-        }
+        mods.push_back(m);
       }
-    }
+    });
   }
 
   void ModificationsDB::searchModificationsByDiffMonoMassSorted(vector<String>& mods, double mass, double max_error, const String& residue, ResidueModification::TermSpecificity term_spec)
@@ -408,20 +539,17 @@ namespace OpenMS
     if (!residue.empty()) res = residue[0];
     double diff = 0;
     Size cnt = 0;
-    #pragma omp critical(OpenMS_ModificationsDB)
+    forEachModification_([&](const ResidueModification* m)
     {
-      for (auto const & m : mods_)
+      diff = fabs(m->getDiffMonoMass() - mass);
+      if ((diff <= max_error) &&
+          residuesMatch_(res, m) &&
+          ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
+           (term_spec == m->getTermSpecificity())))
       {
-        diff = fabs(m->getDiffMonoMass() - mass);
-        if ((diff <= max_error) &&
-            residuesMatch_(res, m) &&
-            ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
-             (term_spec == m->getTermSpecificity())))
-        {
-          diff_idx2mods.emplace(make_pair(diff, cnt++), m->getFullId());
-        }
+        diff_idx2mods.emplace(make_pair(diff, cnt++), m->getFullId());
       }
-    }
+    });
     for (const auto& foo_mod : diff_idx2mods)
     {
       mods.push_back(foo_mod.second);
@@ -436,20 +564,17 @@ namespace OpenMS
     if (!residue.empty()) res = residue[0];
     double diff = 0;
     Size cnt = 0;
-    #pragma omp critical(OpenMS_ModificationsDB)
+    forEachModification_([&](const ResidueModification* m)
     {
-      for (auto const & m : mods_)
+      diff = fabs(m->getDiffMonoMass() - mass);
+      if ((diff <= max_error) &&
+          residuesMatch_(res, m) &&
+          ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
+           (term_spec == m->getTermSpecificity())))
       {
-        diff = fabs(m->getDiffMonoMass() - mass);
-        if ((diff <= max_error) &&
-            residuesMatch_(res, m) &&
-            ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
-             (term_spec == m->getTermSpecificity())))
-        {
-          diff_idx2mods.emplace(make_pair(diff, cnt++), m);
-        }
+        diff_idx2mods.emplace(make_pair(diff, cnt++), m);
       }
-    }
+    });
     for (const auto& foo_mod : diff_idx2mods)
     {
       mods.push_back(foo_mod.second);
@@ -466,24 +591,21 @@ namespace OpenMS
     {
       res = residue[0];
     }
-    #pragma omp critical(OpenMS_ModificationsDB)
+    forEachModification_([&](const ResidueModification* m)
     {
-      for (auto const & m : mods_)
+      // using less instead of less-or-equal will pick the first matching
+      // modification of equally heavy modifications (in our case this is the
+      // first matching UniMod entry)
+      double mass_error = fabs(m->getDiffMonoMass() - mass);
+      if ((mass_error < min_error) &&
+          residuesMatch_(res, m) &&
+          ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
+           (term_spec == m->getTermSpecificity())))
       {
-        // using less instead of less-or-equal will pick the first matching
-        // modification of equally heavy modifications (in our case this is the
-        // first matching UniMod entry)
-        double mass_error = fabs(m->getDiffMonoMass() - mass);
-        if ((mass_error < min_error) &&
-            residuesMatch_(res, m) &&
-            ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
-             (term_spec == m->getTermSpecificity())))
-        {
-          min_error = mass_error;
-          mod = m;
-        }
+        min_error = mass_error;
+        mod = m;
       }
-    }
+    });
     return mod;
   }
 
@@ -499,15 +621,8 @@ namespace OpenMS
 
       #pragma omp critical(OpenMS_ModificationsDB)
       {
-        // e.g. Oxidation (M)
-        modification_names_[m->getFullId()].insert(m);
-        // e.g. Oxidation
-        modification_names_[m->getId()].insert(m);
-        // e.g. Oxidized
-        modification_names_[m->getFullName()].insert(m);
-        // e.g. UniMod:312
-        modification_names_[m->getUniModAccession()].insert(m);
-        mods_.push_back(m);
+        // e.g. Oxidation (M), Oxidation, Oxidized, UniMod:312
+        registerModification_(m);
       }
     }
   }
@@ -517,21 +632,15 @@ namespace OpenMS
     const ResidueModification* ret;
     #pragma omp critical(OpenMS_ModificationsDB)
     {
-      auto it = modification_names_.find(new_mod->getFullId());
-      if (it != modification_names_.end())
+      ret = findRegistered_(new_mod->getFullId());
+      if (ret != nullptr)
       {
         OPENMS_LOG_WARN << "Modification already exists in ModificationsDB. Skipping." << new_mod->getFullId() << endl;
-        ret = *(it->second.begin()); // returning from omp critical is not allowed
       }
       else
       {
-        modification_names_[new_mod->getFullId()].insert(new_mod.get());
-        modification_names_[new_mod->getId()].insert(new_mod.get());
-        modification_names_[new_mod->getFullName()].insert(new_mod.get());
-        modification_names_[new_mod->getUniModAccession()].insert(new_mod.get());
-        mods_.push_back(new_mod.get());
-        new_mod.release(); // do not delete the object;
-        ret = mods_.back();
+        ret = new_mod.get();
+        registerModification_(new_mod.release()); // do not delete the object
       }
     }
     return ret;
@@ -539,23 +648,19 @@ namespace OpenMS
 
   const ResidueModification* ModificationsDB::addModification(const ResidueModification& new_mod)
   {
-    const ResidueModification* ret = new ResidueModification(new_mod);
+    const ResidueModification* ret;
     #pragma omp critical(OpenMS_ModificationsDB)
     {
-      auto it = modification_names_.find(new_mod.getFullId());
-      if (it != modification_names_.end())
+      ret = findRegistered_(new_mod.getFullId());
+      if (ret != nullptr)
       {
         OPENMS_LOG_WARN << "Modification already exists in ModificationsDB. Skipping." << new_mod.getFullId() << endl;
-        ret = *(it->second.begin()); // returning from omp critical is not allowed
       }
       else
       {
-        modification_names_[ret->getFullId()].insert(ret);
-        modification_names_[ret->getId()].insert(ret);
-        modification_names_[ret->getFullName()].insert(ret);
-        modification_names_[ret->getUniModAccession()].insert(ret);
-        mods_.push_back(const_cast<ResidueModification*>(ret));
-        ret = mods_.back();
+        ResidueModification* copy = new ResidueModification(new_mod);
+        registerModification_(copy);
+        ret = copy;
       }
     }
     return ret;
@@ -563,15 +668,10 @@ namespace OpenMS
 
   const ResidueModification* ModificationsDB::addNewModification_(const ResidueModification& new_mod)
   {
-    const ResidueModification* ret = new ResidueModification(new_mod);
+    ResidueModification* ret = new ResidueModification(new_mod);
     #pragma omp critical(OpenMS_ModificationsDB)
     {
-      modification_names_[ret->getFullId()].insert(ret);
-      modification_names_[ret->getId()].insert(ret);
-      modification_names_[ret->getFullName()].insert(ret);
-      modification_names_[ret->getUniModAccession()].insert(ret);
-      mods_.push_back(const_cast<ResidueModification*>(ret));
-      ret = mods_.back();
+      registerModification_(ret);
     }
     return ret;
   }
@@ -882,16 +982,13 @@ namespace OpenMS
   {
     modifications.clear();
 
-    #pragma omp critical(OpenMS_ModificationsDB)
+    forEachModification_([&modifications](const ResidueModification* m)
     {
-      for (auto const & m : mods_)
+      if (m->getUniModRecordId() > 0)
       {
-        if (m->getUniModRecordId() > 0)
-        {
-          modifications.push_back(m->getFullId());
-        }
+        modifications.push_back(m->getFullId());
       }
-    }
+    });
 
     // sort by name (case INsensitive)
     sort(modifications.begin(), modifications.end(), [&](const String& a, const String& b) {
@@ -916,11 +1013,12 @@ namespace OpenMS
     std::ofstream ofs(filename, std::ofstream::out);
     ofs << "FullId\tFullName\tUnimodAccession\tOrigin/AA\tTerminusSpecificity\tDiffMonoMass\n";
     ResidueModification tmp;
-    for (const auto& mod : mods_)
+    // includes modifications added after freeze()
+    forEachModification_([&](const ResidueModification* mod)
     {
       ofs << mod->getFullId() << "\t" << mod->getFullName() << "\t" << mod->getUniModAccession() << "\t" << mod->getOrigin() << "\t"
       << tmp.getTermSpecificityName(mod->getTermSpecificity()) << "\t"
       << mod->getDiffMonoMass() << "\n";
-    }
+    });
   }
 } // namespace OpenMS
@@ -61,6 +61,36 @@ namespace OpenMS
     // free memory
     for (auto& r : const_residues_) { delete r; }
     for (auto& r : const_modified_residues_) { delete r; }
+    for (auto& r : added_modified_residues_) { delete r; }
+  }
+
+  void ResidueDB::freeze()
+  {
+    // taking the lock ensures that no modified residue is added concurrently
+    #pragma omp critical (ResidueDB)
+    {
+      ++freeze_count_;
+      frozen_.store(true, std::memory_order_release);
+    }
+  }
+
+  void ResidueDB::unfreeze()
+  {
+    // the snapshot stays untouched since other threads may still read it without the lock
+    #pragma omp critical (ResidueDB)
+    {
+      if (freeze_count_ > 0) --freeze_count_;
+    }
+  }
+
+  bool ResidueDB::isFrozen() const
+  {
+    bool frozen;
+    #pragma omp critical (ResidueDB)
+    {
+      frozen = freeze_count_ > 0;
+    }
+    return frozen;
   }
 
   const Residue* ResidueDB::getResidue(const String& name) const
@@ -71,13 +101,11 @@ namespace OpenMS
     }
 
     const Residue* r{};
-    #pragma omp critical (ResidueDB)
-    {   
-      auto it = residue_names_.find(name);
-      if (it != residue_names_.end()) 
-      { 
-        r = it->second; 
-      }
+    // no lock required: residue_names_ is only modified in the (thread-safe) constructor
+    auto it = residue_names_.find(name);
+    if (it != residue_names_.end()) 
+    { 
+      r = it->second; 
     }
     if (r == nullptr)
     {
@@ -95,12 +123,8 @@ namespace OpenMS
 
   Size ResidueDB::getNumberOfResidues() const
   {
-    Size s;
-    #pragma omp critical (ResidueDB)
-    {
-      s = const_residues_.size();
-    } 
-    return s;
+    // no lock required: unmodified residues are only added in the constructor
+    return const_residues_.size();
   }
 
   Size ResidueDB::getNumberOfModifiedResidues() const
@@ -108,7 +132,7 @@ namespace OpenMS
     Size s;
     #pragma omp critical (ResidueDB)
     {
-      s = const_modified_residues_.size();
+      s = const_modified_residues_.size() + added_modified_residues_.size();
     } 
     return s;
   }
@@ -116,14 +140,12 @@ namespace OpenMS
   const set<const Residue*> ResidueDB::getResidues(const String& residue_set) const
   {
     set<const Residue*> s;
-    #pragma omp critical (ResidueDB)
+    // no lock required: residue sets are only modified in the constructor
+    auto it = residues_by_set_.find(residue_set);
+    if (it != residues_by_set_.end())
     {
-      auto it = residues_by_set_.find(residue_set);
-      if (it != residues_by_set_.end())
-      {
-        s = it->second;
-      }
-    } 
+      s = it->second;
+    }
 
     if (s.empty()) 
     {
@@ -145,8 +167,15 @@ namespace OpenMS
       addResidueNames_(r);
     }
     else
-    { // add modified residue to const_modified_residues_, and residue_mod_names_
-      const_modified_residues_.insert(r);
+    { // add modified residue to const_modified_residues_, and residue_mod_names_ (or the separate containers after freezing)
+      if (frozen_.load(std::memory_order_relaxed))
+      {
+        added_modified_residues_.insert(r);
+      }
+      else
+      {
+        const_modified_residues_.insert(r);
+      }
       addModifiedResidueNames_(r);
     }    
     return;
@@ -154,21 +183,26 @@ namespace OpenMS
 
   bool ResidueDB::hasResidue(const String& res_name) const
   {
-    bool found = false;
-    #pragma omp critical (ResidueDB)
-    {
-      found = residue_names_.find(res_name) != residue_names_.end();
-    }  
-    return found;
+    // no lock required: residue_names_ is only modified in the constructor
+    return residue_names_.find(res_name) != residue_names_.end();
   }
 
   bool ResidueDB::hasResidue(const Residue* residue) const
   {
+    if (const_residues_.find(residue) != const_residues_.end())
+    {
+      return true;
+    }
+    if (frozen_.load(std::memory_order_acquire) &&
+        const_modified_residues_.find(residue) != const_modified_residues_.end())
+    {
+      return true;
+    }
     bool found = false;
     #pragma omp critical (ResidueDB)
     {
-      found = (const_residues_.find(residue) != const_residues_.end() ||
-          const_modified_residues_.find(residue) != const_modified_residues_.end());
+      found = (const_modified_residues_.find(residue) != const_modified_residues_.end() ||
+          added_modified_residues_.find(residue) != added_modified_residues_.end());
     } 
     return found;
   }
@@ -299,12 +333,8 @@ namespace OpenMS
 
   const set<String> ResidueDB::getResidueSets() const
   {
-    set<String> rs;
-    #pragma omp critical (ResidueDB)
-    {
-      rs = residue_sets_; 
-    }
-    return rs;
+    // no lock required: residue sets are only modified in the constructor
+    return residue_sets_;
   }
 
   void ResidueDB::addModifiedResidueNames_(const Residue* r)
@@ -334,13 +364,14 @@ namespace OpenMS
       names.push_back(s);
     }
 
+    auto& lookup = frozen_.load(std::memory_order_relaxed) ? added_residue_mod_names_ : residue_mod_names_;
     for (const String& n : names)
     {
       if (n.empty()) continue;
       for (const String& m : mod_names)
       {
         if (m.empty()) continue;
-        residue_mod_names_[n][m] = r;
+        lookup[n][m] = r;
       }
     }
   }
@@ -380,81 +411,65 @@ namespace OpenMS
     return getModifiedResidue(r, mod->getFullId());
   }
 
+  const Residue* ResidueDB::findModifiedResidue_(const std::map<String, std::map<String, const Residue*> >& mod_names,
+                                                  const String& res_name, const ResidueModification* mod)
+  {
+    const auto& rm_entry = mod_names.find(res_name);
+    if (rm_entry == mod_names.end())
+    {
+      return nullptr;
+    }
+    const String& id = mod->getId().empty() ? mod->getFullId() : mod->getId();
+    const auto& inner = rm_entry->second.find(id);
+    if (inner == rm_entry->second.end())
+    {
+      return nullptr;
+    }
+    return inner->second;
+  }
+
+  const Residue* ResidueDB::getOrCreateModifiedResidue_(const String& res_name, const ResidueModification* mod)
+  {
+    // check if modified residue is already present in ResidueDB
+    const Residue* res = findModifiedResidue_(residue_mod_names_, res_name, mod);
+    if (res == nullptr && frozen_.load(std::memory_order_relaxed))
+    {
+      res = findModifiedResidue_(added_residue_mod_names_, res_name, mod);
+    }
+    if (res == nullptr)
+    {
+      // create and register this modified residue
+      Residue* new_res = new Residue(*residue_names_.at(res_name));
+      new_res->setModification(mod);
+      addResidue_(new_res);
+      res = new_res;
+    }
+    return res;
+  }
+
   const Residue* ResidueDB::getModifiedResidue(const Residue* residue, const String& modification)
   {
     OPENMS_PRECONDITION(!modification.empty(), "Modification cannot be empty")
-    // search if the mod already exists
     const String & res_name = residue->getName();
-    Residue* res{};
-    bool residue_found(true), mod_found(true);
-    #pragma omp critical (ResidueDB)
+    // no lock required: residue_names_ is only modified in the constructor
+    if (residue_names_.find(res_name) == residue_names_.end())
     {
-      // Perform a single lookup of the residue name in our database, we assume
-      // that if it is present in residue_mod_names_ then we have seen it
-      // before and can directly grab it. If its not present, we may have as
-      // unmodified residue in residue_names_ but need to create a new entry as
-      // modified residue. If the residue itself is unknown, we will throw (see
-      // below).
-      const auto& rm_entry = residue_mod_names_.find(res_name);
-      if (rm_entry == residue_mod_names_.end())
-      {
-        if (residue_names_.find(res_name) == residue_names_.end())
-        {
-          residue_found = false;
-        }
-      }
-
-      if (residue_found)
-      {
-        const ResidueModification* mod{};
-        try
-        {
-          // terminal modifications don't apply to residues (side chain), so only consider internal ones
-          static const ModificationsDB* mdb = ModificationsDB::getInstance();
-          mod = mdb->getModification(modification, residue->getOneLetterCode(), ResidueModification::ANYWHERE);
-        }
-        catch (...)
-        {
-          mod_found = false;
-        }
-
-        // check if modification in ResidueDB
-        if (mod_found)
-        {
-          // check if modified residue is already present in ResidueDB
-          bool found = false;
-          if (rm_entry != residue_mod_names_.end())
-          {
-            const String& id = mod->getId().empty() ? mod->getFullId() : mod->getId();
-            const auto& inner = rm_entry->second.find(id);
-            if (inner != rm_entry->second.end())
-            {
-              res = const_cast<Residue*>(inner->second);
-              found = true;
-            }
-          }
-          if (!found)
-          {
-            // create and register this modified residue
-            res = new Residue(*residue_names_.at(res_name));
-            res->setModification(mod);
-            addResidue_(res);            
-          }
-        }
-      }
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Residue not found: ", res_name);
     }
 
-    // throwing (uncaught) exceptions needs to happen outside of critical section (see OpenMP reference manual)
-    if (!residue_found)
+    const ResidueModification* mod{};
+    try
     {
-      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Residue not found: ", res_name);
+      // terminal modifications don't apply to residues (side chain), so only consider internal ones
+      static const ModificationsDB* mdb = ModificationsDB::getInstance();
+      mod = mdb->getModification(modification, residue->getOneLetterCode(), ResidueModification::ANYWHERE);
     }
-    else if (!mod_found)
+    catch (...)
     {
       throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Modification not found: ", modification);
     }
-    
-    return res;
+
+    return getModifiedResidue(residue, mod);
   }
 
   const Residue* ResidueDB::getModifiedResidue(const Residue* residue, const ResidueModification* mod)
@@ -462,62 +477,32 @@ namespace OpenMS
     OPENMS_PRECONDITION(mod != nullptr, "Mod cannot be nullptr")
     OPENMS_PRECONDITION(mod->getTermSpecificity() == ResidueModification::ANYWHERE, "Mod's term specificity needs to be ANYWHERE to attach it to Residues");
     OPENMS_PRECONDITION(mod->getOrigin() == residue->getOneLetterCode()[0], "Mod's AA origin needs to match residues one-letter-code");
-    // search if the mod already exists
     const String & res_name = residue->getName();
-    Residue* res{};
-    bool residue_found(true);
-    #pragma omp critical (ResidueDB)
+    // no lock required: residue_names_ is only modified in the constructor
+    if (residue_names_.find(res_name) == residue_names_.end())
     {
-      // Perform a single lookup of the residue name in our database, we assume
-      // that if it is present in residue_mod_names_ then we have seen it
-      // before and can directly grab it. If its not present, we may have as
-      // unmodified residue in residue_names_ but need to create a new entry as
-      // modified residue. If the residue itself is unknown, we will throw (see
-      // below).
-      const auto& rm_entry = residue_mod_names_.find(res_name);
-      if (rm_entry == residue_mod_names_.end())
-      {
-        if (residue_names_.find(res_name) == residue_names_.end())
-        {
-          residue_found = false;
-        }
-      }
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Residue not found: ", res_name);
+    }
+    if (mod == nullptr)
+    {
+      return nullptr;
+    }
 
-      if (residue_found)
+    // lock-free fast path: modified residue is part of the frozen snapshot
+    if (frozen_.load(std::memory_order_acquire))
+    {
+      const Residue* res = findModifiedResidue_(residue_mod_names_, res_name, mod);
+      if (res != nullptr)
       {
-
-        // check if modification in ResidueDB
-        if (mod != nullptr)
-        {
-          // check if modified residue is already present in ResidueDB
-          bool found = false;
-          if (rm_entry != residue_mod_names_.end())
-          {
-            const String& id = mod->getId().empty() ? mod->getFullId() : mod->getId();
-            const auto& inner = rm_entry->second.find(id);
-            if (inner != rm_entry->second.end())
-            {
-              res = const_cast<Residue*>(inner->second);
-              found = true;
-            }
-          }
-          if (!found)
-          {
-            // create and register this modified residue
-            res = new Residue(*residue_names_.at(res_name));
-            res->setModification(mod);
-            addResidue_(res);            
-          }
-        }
+        return res;
       }
     }
 
-    // throwing (uncaught) exceptions needs to happen outside of critical section (see OpenMP reference manual)
-    if (!residue_found)
+    const Residue* res{};
+    #pragma omp critical (ResidueDB)
     {
-      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Residue not found: ", res_name);
+      res = getOrCreateModifiedResidue_(res_name, mod);
     }
-    
     return res;
   }
 }
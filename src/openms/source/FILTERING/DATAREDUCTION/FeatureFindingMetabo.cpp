@@ -42,6 +42,7 @@
 #include <OpenMS/SYSTEM/File.h>
 
 #include <fstream>
+#include <iterator>
 
 #include <boost/dynamic_bitset.hpp>
 
@@ -756,14 +757,7 @@ namespace OpenMS
     FeatureHypothesis tmp_hypo;
     tmp_hypo.addMassTrace(*candidates[0]);
     tmp_hypo.setScore((candidates[0]->getIntensity(use_smoothed_intensities_)) / total_intensity);
-
-#ifdef _OPENMP
-#pragma omp critical (OPENMS_FFMetabo_output_hypos)
-#endif
-    {
-      // pushing back to shared vector needs to be synchronized
-      output_hypotheses.push_back(tmp_hypo);
-    }
+    output_hypotheses.push_back(tmp_hypo);
 
     for (Size charge = charge_lower_bound_; charge <= charge_upper_bound_; ++charge)
     {
@@ -839,14 +833,7 @@ namespace OpenMS
           fh_tmp.setScore(fh_tmp.getScore() + weighted_score);
           fh_tmp.setCharge(charge);
           last_iso_idx = best_idx;
-
-#ifdef _OPENMP
-#pragma omp critical (OPENMS_FFMetabo_output_hypos)
-#endif
-          {
-            // pushing back to shared vector needs to be synchronized
-            output_hypotheses.push_back(fh_tmp);
-          }
+          output_hypotheses.push_back(fh_tmp);
         }
         else
         {
@@ -909,46 +896,69 @@ namespace OpenMS
     // and generate isotopic / charge hypotheses
     // *********************************************************** //
 
-    std::vector<FeatureHypothesis> feat_hypos;
+    // Traces are processed in blocks of consecutive m/z, each block collects
+    // its hypotheses separately. Concatenating the blocks in order gives the
+    // same hypotheses in the same order as a serial run.
+    const Size block_size(64);
+    const Size nr_blocks((input_mtraces.size() + block_size - 1) / block_size);
+    std::vector<std::vector<FeatureHypothesis> > block_hypos(nr_blocks);
     Size progress(0);
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic)
 #endif
-    for (SignedSize i = 0; i < (SignedSize)input_mtraces.size(); ++i)
+    for (SignedSize block_idx = 0; block_idx < (SignedSize)nr_blocks; ++block_idx)
     {
       IF_MASTERTHREAD this->setProgress(progress);
-#ifdef _OPENMP
-#pragma omp atomic
-#endif
-      ++progress;
 
+      const Size block_end = std::min((block_idx + 1) * block_size, input_mtraces.size());
       std::vector<const MassTrace*> local_traces;
-      double ref_trace_mz(input_mtraces[i].getCentroidMZ());
-      double ref_trace_rt(input_mtraces[i].getCentroidRT());
+      for (Size i = block_idx * block_size; i < block_end; ++i)
+      {
+        local_traces.clear();
+        double ref_trace_mz(input_mtraces[i].getCentroidMZ());
+        double ref_trace_rt(input_mtraces[i].getCentroidRT());
 
-      local_traces.push_back(&input_mtraces[i]);
+        local_traces.push_back(&input_mtraces[i]);
 
-      for (Size ext_idx = i + 1; ext_idx < input_mtraces.size(); ++ext_idx)
-      {
-        // traces are sorted by m/z, so we can break when we leave the allowed window
-        double diff_mz = std::fabs(input_mtraces[ext_idx].getCentroidMZ() - ref_trace_mz);
-        if (diff_mz > local_mz_range_)
+        for (Size ext_idx = i + 1; ext_idx < input_mtraces.size(); ++ext_idx)
         {
-          break;
-        }
-        double diff_rt = std::fabs(input_mtraces[ext_idx].getCentroidRT() - ref_trace_rt);
-        if (diff_rt <= local_rt_range_)
-        {
-          // std::cout << " accepted!" << std::endl;
-          local_traces.push_back(&input_mtraces[ext_idx]);
+          // traces are sorted by m/z, so we can break when we leave the allowed window
+          double diff_mz = std::fabs(input_mtraces[ext_idx].getCentroidMZ() - ref_trace_mz);
+          if (diff_mz > local_mz_range_)
+          {
+            break;
+          }
+          double diff_rt = std::fabs(input_mtraces[ext_idx].getCentroidRT() - ref_trace_rt);
+          if (diff_rt <= local_rt_range_)
+          {
+            // std::cout << " accepted!" << std::endl;
+            local_traces.push_back(&input_mtraces[ext_idx]);
+          }
         }
+        findLocalFeatures_(local_traces, total_intensity, block_hypos[block_idx]);
       }
-      findLocalFeatures_(local_traces, total_intensity, feat_hypos);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+      progress += block_end - block_idx * block_size;
     }
     this->endProgress();
 
-    // sort feature candidates by their score
-    std::sort(feat_hypos.begin(), feat_hypos.end(), CmpHypothesesByScore());
+    Size nr_hypos(0);
+    for (const auto& hypos : block_hypos)
+    {
+      nr_hypos += hypos.size();
+    }
+    std::vector<FeatureHypothesis> feat_hypos;
+    feat_hypos.reserve(nr_hypos);
+    for (auto& hypos : block_hypos)
+    {
+      std::move(hypos.begin(), hypos.end(), std::back_inserter(feat_hypos));
+      std::vector<FeatureHypothesis>().swap(hypos);
+    }
+
+    // sort feature candidates by their score (stable, so ties keep the m/z order)
+    std::stable_sort(feat_hypos.begin(), feat_hypos.end(), CmpHypothesesByScore());
 
 #ifdef FFM_DEBUG
     std::cout << "size of hypotheses: " << feat_hypos.size() << std::endl;
@@ -967,20 +977,48 @@ namespace OpenMS
     // already been used by a higher scoring hypothesis.
     // *********************************************************** //
     std::map<String, bool> trace_excl_map;
+    auto has_collision = [&trace_excl_map](const FeatureHypothesis& hypo)
+    {
+      for (const String& label : hypo.getLabels())
+      {
+        if (trace_excl_map.find(label) != trace_excl_map.end())
+        {
+          return true;
+        }
+      }
+      return false;
+    };
+
+    // The isotope filter (SVM prediction) is evaluated in parallel for the
+    // next batch of hypotheses which are not yet excluded, acceptance itself
+    // stays sequential.
+    const bool use_isotope_filter = (isotope_filtering_model_ != "none" && isotope_filtering_model_ != "peptides");
+    const bool batch_isotope_filter = use_isotope_filter && !svm_feat_centers_.empty() && !svm_feat_scales_.empty();
+    const Size filter_batch_size(256);
+    std::vector<int> isotope_filter_results(batch_isotope_filter ? feat_hypos.size() : 0, -1);
+    Size filter_evaluated_until(0);
+
     for (Size hypo_idx = 0; hypo_idx < feat_hypos.size(); ++hypo_idx)
     {
-      // std::cout << "score now: " <<  feat_hypos[hypo_idx].getScore() << std::endl;
-      std::vector<String> labels(feat_hypos[hypo_idx].getLabels());
-      bool trace_coll = false;   // trace collision?
-      for (Size lab_idx = 0; lab_idx < labels.size(); ++lab_idx)
+      if (batch_isotope_filter && hypo_idx >= filter_evaluated_until)
       {
-        if (trace_excl_map.find(labels[lab_idx]) != trace_excl_map.end())
+        filter_evaluated_until = std::min(hypo_idx + filter_batch_size, feat_hypos.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (SignedSize k = hypo_idx; k < (SignedSize)filter_evaluated_until; ++k)
         {
-          trace_coll = true;
-          break;
+          if (!has_collision(feat_hypos[k]))
+          {
+            isotope_filter_results[k] = isLegalIsotopePattern_(feat_hypos[k]);
+          }
         }
       }
 
+      // std::cout << "score now: " <<  feat_hypos[hypo_idx].getScore() << std::endl;
+      std::vector<String> labels(feat_hypos[hypo_idx].getLabels());
+      bool trace_coll = has_collision(feat_hypos[hypo_idx]);   // trace collision?
+
 #ifdef FFM_DEBUG
       if (feat_hypos[hypo_idx].getSize() > 1)
       {
@@ -1000,7 +1038,11 @@ namespace OpenMS
       // only). This is based on a pre-trained SVM model of isotopic
       // intensities.
       int pass_isotope_filter = -1; // -1 == 'did not test'; 0 = no pass; 1 = pass
-      if (isotope_filtering_model_ != "none" && isotope_filtering_model_ != "peptides")
+      if (batch_isotope_filter)
+      {
+        pass_isotope_filter = isotope_filter_results[hypo_idx];
+      }
+      else if (use_isotope_filter)
       {
         pass_isotope_filter = isLegalIsotopePattern_(feat_hypos[hypo_idx]);
       }
@@ -38,6 +38,10 @@
 
 #include <boost/dynamic_bitset.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
     MassTraceDetection::MassTraceDetection() :
@@ -168,11 +172,11 @@ namespace OpenMS
       last_weights_sum = weights_sum;
     }
 
-    void computeWeightedSDEstimate(std::list<PeakType> tmp, const double& mean_t, double& sd_t, const double& /* lower_sd_bound */)
+    void computeWeightedSDEstimate(const std::vector<PeakType>& tmp, const double& mean_t, double& sd_t, const double& /* lower_sd_bound */)
     {
       double denom(0.0), weights_sum(0.0);
 
-      for (std::list<PeakType>::const_iterator l_it = tmp.begin(); l_it != tmp.end(); ++l_it)
+      for (std::vector<PeakType>::const_iterator l_it = tmp.begin(); l_it != tmp.end(); ++l_it)
       {
         denom += l_it->getIntensity() * (l_it->getMZ() - mean_t) * (l_it->getMZ() - mean_t);
         weights_sum += l_it->getIntensity();
@@ -267,300 +271,395 @@ namespace OpenMS
       return;
     } // end of MassTraceDetection::run
 
-    void MassTraceDetection::run_(const std::vector<Apex>& chrom_apices,
-                                  const Size total_peak_count,
-                                  const PeakMap& work_exp,
-                                  const std::vector<Size>& spec_offsets,
-                                  std::vector<MassTrace>& found_masstraces,
-                                  const Size max_traces)
+    struct MassTraceDetection::TraceCandidate
     {
-      boost::dynamic_bitset<> peak_visited(total_peak_count);
-      Size trace_number(1);
-
-      // check presence of FWHM meta data
-      int fwhm_meta_idx(-1);
-      Size fwhm_meta_count(0);
-      for (Size i = 0; i < work_exp.size(); ++i)
-      {
-        if (!work_exp[i].getFloatDataArrays().empty() &&
-            work_exp[i].getFloatDataArrays()[0].getName() == "FWHM_ppm")
-        {
-          if (work_exp[i].getFloatDataArrays()[0].size() != work_exp[i].size())
-          { // float data should always have the same size as the corresponding array
-            throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, work_exp[i].size());
-          }
-          fwhm_meta_idx = 0;
-          ++fwhm_meta_count;
-        }
-      }
-      if (fwhm_meta_count > 0 && fwhm_meta_count != work_exp.size())
-      {
-        throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
-                                      String("FWHM meta arrays are expected to be missing or present for all MS spectra [") + fwhm_meta_count + "/" + work_exp.size() + "].");
-      }
-
-
-      this->startProgress(0, total_peak_count, "mass trace detection");
-      Size peaks_detected(0);
-
-      for (auto m_it = chrom_apices.crbegin(); m_it != chrom_apices.crend(); ++m_it)
-      {
-        Size apex_scan_idx(m_it->scan_idx);
-        Size apex_peak_idx(m_it->peak_idx);
+      bool extended = false; ///< whether the trace was extended (false if the apex was already part of another trace)
+      bool accepted = false; ///< whether the trace passed the length and quality criteria
+      MassTrace trace; ///< the resulting mass trace (only if accepted)
+      std::vector<Size> gathered_idx; ///< positions of all collected peaks in peak_visited
+      std::vector<Size> queried_idx; ///< positions of all unvisited peaks which were considered during extension
+    };
+
+    void MassTraceDetection::extendTrace_(const Apex& apex,
+                                          const PeakMap& work_exp,
+                                          const std::vector<Size>& spec_offsets,
+                                          const boost::dynamic_bitset<>& peak_visited,
+                                          const int fwhm_meta_idx,
+                                          TraceCandidate& candidate)
+    {
+      candidate.extended = true;
+      candidate.accepted = false;
+      candidate.gathered_idx.clear();
+      candidate.queried_idx.clear();
 
-        if (peak_visited[spec_offsets[apex_scan_idx] + apex_peak_idx])
-        {
-          continue;
-        }
+      Size apex_scan_idx(apex.scan_idx);
+      Size apex_peak_idx(apex.peak_idx);
 
-        Peak2D apex_peak;
-        apex_peak.setRT(work_exp[apex_scan_idx].getRT());
-        apex_peak.setMZ(work_exp[apex_scan_idx][apex_peak_idx].getMZ());
-        apex_peak.setIntensity(work_exp[apex_scan_idx][apex_peak_idx].getIntensity());
+      Peak2D apex_peak;
+      apex_peak.setRT(work_exp[apex_scan_idx].getRT());
+      apex_peak.setMZ(work_exp[apex_scan_idx][apex_peak_idx].getMZ());
+      apex_peak.setIntensity(work_exp[apex_scan_idx][apex_peak_idx].getIntensity());
 
-        Size trace_up_idx(apex_scan_idx);
-        Size trace_down_idx(apex_scan_idx);
+      Size trace_up_idx(apex_scan_idx);
+      Size trace_down_idx(apex_scan_idx);
 
-        std::list<PeakType> current_trace;
-        current_trace.push_back(apex_peak);
-        std::vector<double> fwhms_mz; // peak-FWHM meta values of collected peaks
+      // peaks are collected in contiguous buffers (down in reverse RT order) and joined at the end
+      std::vector<PeakType> trace_down, trace_up;
+      std::vector<double> fwhms_mz; // peak-FWHM meta values of collected peaks
 
-        // Initialization for the iterative version of weighted m/z mean calculation
-        double centroid_mz(apex_peak.getMZ());
-        double prev_counter(apex_peak.getIntensity() * apex_peak.getMZ());
-        double prev_denom(apex_peak.getIntensity());
+      // Initialization for the iterative version of weighted m/z mean calculation
+      double centroid_mz(apex_peak.getMZ());
+      double prev_counter(apex_peak.getIntensity() * apex_peak.getMZ());
+      double prev_denom(apex_peak.getIntensity());
 
-        updateIterativeWeightedMeanMZ(apex_peak.getMZ(), apex_peak.getIntensity(), centroid_mz, prev_counter, prev_denom);
+      updateIterativeWeightedMeanMZ(apex_peak.getMZ(), apex_peak.getIntensity(), centroid_mz, prev_counter, prev_denom);
 
-        std::vector<std::pair<Size, Size> > gathered_idx;
-        gathered_idx.emplace_back(apex_scan_idx, apex_peak_idx);
-        if (fwhm_meta_idx != -1)
-        {
-          fwhms_mz.push_back(work_exp[apex_scan_idx].getFloatDataArrays()[fwhm_meta_idx][apex_peak_idx]);
-        }
+      std::vector<Size>& gathered_idx = candidate.gathered_idx;
+      gathered_idx.push_back(spec_offsets[apex_scan_idx] + apex_peak_idx);
+      if (fwhm_meta_idx != -1)
+      {
+        fwhms_mz.push_back(work_exp[apex_scan_idx].getFloatDataArrays()[fwhm_meta_idx][apex_peak_idx]);
+      }
 
-        Size up_hitting_peak(0), down_hitting_peak(0);
-        Size up_scan_counter(0), down_scan_counter(0);
+      Size up_hitting_peak(0), down_hitting_peak(0);
+      Size up_scan_counter(0), down_scan_counter(0);
 
-        bool toggle_up = true, toggle_down = true;
+      bool toggle_up = true, toggle_down = true;
 
-        Size conseq_missed_peak_up(0), conseq_missed_peak_down(0);
-        Size max_consecutive_missing(trace_termination_outliers_);
+      Size conseq_missed_peak_up(0), conseq_missed_peak_down(0);
+      Size max_consecutive_missing(trace_termination_outliers_);
 
-        double current_sample_rate(1.0);
-        // Size min_scans_to_consider(std::floor((min_sample_rate_ /2)*10));
-        Size min_scans_to_consider(5);
+      double current_sample_rate(1.0);
+      // Size min_scans_to_consider(std::floor((min_sample_rate_ /2)*10));
+      Size min_scans_to_consider(5);
 
-        // double outlier_ratio(0.3);
+      const bool outlier_termination = (trace_termination_criterion_ == "outlier");
+      const bool sample_rate_termination = (trace_termination_criterion_ == "sample_rate");
 
-        // double ftl_mean(centroid_mz);
-        double ftl_sd((centroid_mz / 1e6) * mass_error_ppm_);
-        double intensity_so_far(apex_peak.getIntensity());
+      // double ftl_mean(centroid_mz);
+      double ftl_sd((centroid_mz / 1e6) * mass_error_ppm_);
+      double intensity_so_far(apex_peak.getIntensity());
 
-        while (((trace_down_idx > 0) && toggle_down) ||
-               ((trace_up_idx < work_exp.size() - 1) && toggle_up)
-                )
+      while (((trace_down_idx > 0) && toggle_down) ||
+             ((trace_up_idx < work_exp.size() - 1) && toggle_up)
+              )
+      {
+        // *********************************************************** //
+        // Step 2.1 MOVE DOWN in RT dim
+        // *********************************************************** //
+        if ((trace_down_idx > 0) && toggle_down)
         {
-          // *********************************************************** //
-          // Step 2.1 MOVE DOWN in RT dim
-          // *********************************************************** //
-          if ((trace_down_idx > 0) && toggle_down)
+          const MSSpectrum& spec_trace_down = work_exp[trace_down_idx - 1];
+          if (!spec_trace_down.empty())
           {
-            const MSSpectrum& spec_trace_down = work_exp[trace_down_idx - 1];
-            if (!spec_trace_down.empty())
+            Size next_down_peak_idx = spec_trace_down.findNearest(centroid_mz);
+            double next_down_peak_mz = spec_trace_down[next_down_peak_idx].getMZ();
+            double next_down_peak_int = spec_trace_down[next_down_peak_idx].getIntensity();
+
+            double right_bound = centroid_mz + 3 * ftl_sd;
+            double left_bound = centroid_mz - 3 * ftl_sd;
+
+            Size next_down_visited_idx = spec_offsets[trace_down_idx - 1] + next_down_peak_idx;
+            if ((next_down_peak_mz <= right_bound) &&
+                (next_down_peak_mz >= left_bound) &&
+                !peak_visited[next_down_visited_idx]
+                    )
             {
-              Size next_down_peak_idx = spec_trace_down.findNearest(centroid_mz);
-              double next_down_peak_mz = spec_trace_down[next_down_peak_idx].getMZ();
-              double next_down_peak_int = spec_trace_down[next_down_peak_idx].getIntensity();
+              candidate.queried_idx.push_back(next_down_visited_idx);
 
-              double right_bound = centroid_mz + 3 * ftl_sd;
-              double left_bound = centroid_mz - 3 * ftl_sd;
+              Peak2D next_peak;
+              next_peak.setRT(spec_trace_down.getRT());
+              next_peak.setMZ(next_down_peak_mz);
+              next_peak.setIntensity(next_down_peak_int);
 
-              if ((next_down_peak_mz <= right_bound) &&
-                  (next_down_peak_mz >= left_bound) &&
-                  !peak_visited[spec_offsets[trace_down_idx - 1] + next_down_peak_idx]
-                      )
+              trace_down.push_back(next_peak);
+              // FWHM average
+              if (fwhm_meta_idx != -1)
               {
-                Peak2D next_peak;
-                next_peak.setRT(spec_trace_down.getRT());
-                next_peak.setMZ(next_down_peak_mz);
-                next_peak.setIntensity(next_down_peak_int);
-
-                current_trace.push_front(next_peak);
-                // FWHM average
-                if (fwhm_meta_idx != -1)
-                {
-                  fwhms_mz.push_back(spec_trace_down.getFloatDataArrays()[fwhm_meta_idx][next_down_peak_idx]);
-                }
-                // Update the m/z mean of the current trace as we added a new peak
-                updateIterativeWeightedMeanMZ(next_down_peak_mz, next_down_peak_int, centroid_mz, prev_counter, prev_denom);
-                gathered_idx.emplace_back(trace_down_idx - 1, next_down_peak_idx);
+                fwhms_mz.push_back(spec_trace_down.getFloatDataArrays()[fwhm_meta_idx][next_down_peak_idx]);
+              }
+              // Update the m/z mean of the current trace as we added a new peak
+              updateIterativeWeightedMeanMZ(next_down_peak_mz, next_down_peak_int, centroid_mz, prev_counter, prev_denom);
+              gathered_idx.push_back(next_down_visited_idx);
 
-                // Update the m/z variance dynamically
-                if (reestimate_mt_sd_)           //  && (down_hitting_peak+1 > min_flank_scans))
+              // Update the m/z variance dynamically
+              if (reestimate_mt_sd_)           //  && (down_hitting_peak+1 > min_flank_scans))
+              {
+                // if (ftl_t > min_fwhm_scans)
                 {
-                  // if (ftl_t > min_fwhm_scans)
-                  {
-                    updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
-                  }
+                  updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
                 }
-
-                ++down_hitting_peak;
-                conseq_missed_peak_down = 0;
-              }
-              else
-              {
-                ++conseq_missed_peak_down;
               }
 
+              ++down_hitting_peak;
+              conseq_missed_peak_down = 0;
+            }
+            else
+            {
+              ++conseq_missed_peak_down;
             }
-            --trace_down_idx;
-            ++down_scan_counter;
 
-            // trace termination criterion: max allowed number of
-            // consecutive outliers reached OR cancel extension if
-            // sampling_rate falls below min_sample_rate_
-            if (trace_termination_criterion_ == "outlier")
+          }
+          --trace_down_idx;
+          ++down_scan_counter;
+
+          // trace termination criterion: max allowed number of
+          // consecutive outliers reached OR cancel extension if
+          // sampling_rate falls below min_sample_rate_
+          if (outlier_termination)
+          {
+            if (conseq_missed_peak_down > max_consecutive_missing)
             {
-              if (conseq_missed_peak_down > max_consecutive_missing)
-              {
-                toggle_down = false;
-              }
+              toggle_down = false;
             }
-            else if (trace_termination_criterion_ == "sample_rate")
+          }
+          else if (sample_rate_termination)
+          {
+            current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) /
+                                  (double)(down_scan_counter + up_scan_counter + 1);
+            if (down_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
             {
-              current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) /
-                                    (double)(down_scan_counter + up_scan_counter + 1);
-              if (down_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
-              {
-                // std::cout << "stopping down..." << std::endl;
-                toggle_down = false;
-              }
+              // std::cout << "stopping down..." << std::endl;
+              toggle_down = false;
             }
           }
+        }
 
-          // *********************************************************** //
-          // Step 2.2 MOVE UP in RT dim
-          // *********************************************************** //
-          if ((trace_up_idx < work_exp.size() - 1) && toggle_up)
+        // *********************************************************** //
+        // Step 2.2 MOVE UP in RT dim
+        // *********************************************************** //
+        if ((trace_up_idx < work_exp.size() - 1) && toggle_up)
+        {
+          const MSSpectrum& spec_trace_up = work_exp[trace_up_idx + 1];
+          if (!spec_trace_up.empty())
           {
-            const MSSpectrum& spec_trace_up = work_exp[trace_up_idx + 1];
-            if (!spec_trace_up.empty())
+            Size next_up_peak_idx = spec_trace_up.findNearest(centroid_mz);
+            double next_up_peak_mz = spec_trace_up[next_up_peak_idx].getMZ();
+            double next_up_peak_int = spec_trace_up[next_up_peak_idx].getIntensity();
+
+            double right_bound = centroid_mz + 3 * ftl_sd;
+            double left_bound = centroid_mz - 3 * ftl_sd;
+
+            Size next_up_visited_idx = spec_offsets[trace_up_idx + 1] + next_up_peak_idx;
+            if ((next_up_peak_mz <= right_bound) &&
+                (next_up_peak_mz >= left_bound) &&
+                !peak_visited[next_up_visited_idx])
             {
-              Size next_up_peak_idx = spec_trace_up.findNearest(centroid_mz);
-              double next_up_peak_mz = spec_trace_up[next_up_peak_idx].getMZ();
-              double next_up_peak_int = spec_trace_up[next_up_peak_idx].getIntensity();
+              candidate.queried_idx.push_back(next_up_visited_idx);
 
-              double right_bound = centroid_mz + 3 * ftl_sd;
-              double left_bound = centroid_mz - 3 * ftl_sd;
+              Peak2D next_peak;
+              next_peak.setRT(spec_trace_up.getRT());
+              next_peak.setMZ(next_up_peak_mz);
+              next_peak.setIntensity(next_up_peak_int);
 
-              if ((next_up_peak_mz <= right_bound) &&
-                  (next_up_peak_mz >= left_bound) &&
-                  !peak_visited[spec_offsets[trace_up_idx + 1] + next_up_peak_idx])
+              trace_up.push_back(next_peak);
+              if (fwhm_meta_idx != -1)
               {
-                Peak2D next_peak;
-                next_peak.setRT(spec_trace_up.getRT());
-                next_peak.setMZ(next_up_peak_mz);
-                next_peak.setIntensity(next_up_peak_int);
-
-                current_trace.push_back(next_peak);
-                if (fwhm_meta_idx != -1)
-                {
-                  fwhms_mz.push_back(spec_trace_up.getFloatDataArrays()[fwhm_meta_idx][next_up_peak_idx]);
-                }
-                // Update the m/z mean of the current trace as we added a new peak
-                updateIterativeWeightedMeanMZ(next_up_peak_mz, next_up_peak_int, centroid_mz, prev_counter, prev_denom);
-                gathered_idx.emplace_back(trace_up_idx + 1, next_up_peak_idx);
+                fwhms_mz.push_back(spec_trace_up.getFloatDataArrays()[fwhm_meta_idx][next_up_peak_idx]);
+              }
+              // Update the m/z mean of the current trace as we added a new peak
+              updateIterativeWeightedMeanMZ(next_up_peak_mz, next_up_peak_int, centroid_mz, prev_counter, prev_denom);
+              gathered_idx.push_back(next_up_visited_idx);
 
-                // Update the m/z variance dynamically
-                if (reestimate_mt_sd_)           //  && (up_hitting_peak+1 > min_flank_scans))
+              // Update the m/z variance dynamically
+              if (reestimate_mt_sd_)           //  && (up_hitting_peak+1 > min_flank_scans))
+              {
+                // if (ftl_t > min_fwhm_scans)
                 {
-                  // if (ftl_t > min_fwhm_scans)
-                  {
-                    updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
-                  }
+                  updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
                 }
-
-                ++up_hitting_peak;
-                conseq_missed_peak_up = 0;
-
-              }
-              else
-              {
-                ++conseq_missed_peak_up;
               }
 
+              ++up_hitting_peak;
+              conseq_missed_peak_up = 0;
+
             }
+            else
+            {
+              ++conseq_missed_peak_up;
+            }
+
+          }
 
-            ++trace_up_idx;
-            ++up_scan_counter;
+          ++trace_up_idx;
+          ++up_scan_counter;
 
-            if (trace_termination_criterion_ == "outlier")
+          if (outlier_termination)
+          {
+            if (conseq_missed_peak_up > max_consecutive_missing)
             {
-              if (conseq_missed_peak_up > max_consecutive_missing)
-              {
-                toggle_up = false;
-              }
+              toggle_up = false;
             }
-            else if (trace_termination_criterion_ == "sample_rate")
-            {
-              current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) / (double)(down_scan_counter + up_scan_counter + 1);
+          }
+          else if (sample_rate_termination)
+          {
+            current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) / (double)(down_scan_counter + up_scan_counter + 1);
 
-              if (up_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
-              {
-                // std::cout << "stopping up" << std::endl;
-                toggle_up = false;
-              }
+            if (up_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
+            {
+              // std::cout << "stopping up" << std::endl;
+              toggle_up = false;
             }
+          }
 
 
-          }
+        }
+
+      }
+
+      // std::cout << "current sr: " << current_sample_rate << std::endl;
+      double num_scans(down_scan_counter + up_scan_counter + 1 - conseq_missed_peak_down - conseq_missed_peak_up);
+
+      Size trace_size = trace_down.size() + 1 + trace_up.size();
+      double mt_quality((double)trace_size / (double)num_scans);
+      // std::cout << "mt quality: " << mt_quality << std::endl;
+      double first_rt = trace_down.empty() ? apex_peak.getRT() : trace_down.back().getRT();
+      double last_rt = trace_up.empty() ? apex_peak.getRT() : trace_up.back().getRT();
+      double rt_range(std::fabs(last_rt - first_rt));
+
+      // *********************************************************** //
+      // Step 2.3 check if minimum length and quality of mass trace criteria are met
+      // *********************************************************** //
+      bool max_trace_criteria = (max_trace_length_ < 0.0 || rt_range < max_trace_length_);
+      if (rt_range >= min_trace_length_ && max_trace_criteria && mt_quality >= min_sample_rate_)
+      {
+        candidate.accepted = true;
 
+        // create new MassTrace object from the collected peaks (in RT order)
+        std::vector<PeakType> current_trace;
+        current_trace.reserve(trace_size);
+        current_trace.insert(current_trace.end(), trace_down.rbegin(), trace_down.rend());
+        current_trace.push_back(apex_peak);
+        current_trace.insert(current_trace.end(), trace_up.begin(), trace_up.end());
+
+        MassTrace new_trace(current_trace);
+        new_trace.updateWeightedMeanRT();
+        new_trace.updateWeightedMeanMZ();
+        if (!fwhms_mz.empty())
+        {
+          new_trace.fwhm_mz_avg = Math::median(fwhms_mz.begin(), fwhms_mz.end());
         }
+        new_trace.setQuantMethod(quant_method_);
+        //new_trace.setCentroidSD(ftl_sd);
+        new_trace.updateWeightedMZsd();
+        candidate.trace = std::move(new_trace);
+      }
+    }
 
-        // std::cout << "current sr: " << current_sample_rate << std::endl;
-        double num_scans(down_scan_counter + up_scan_counter + 1 - conseq_missed_peak_down - conseq_missed_peak_up);
+    void MassTraceDetection::run_(const std::vector<Apex>& chrom_apices,
+                                  const Size total_peak_count,
+                                  const PeakMap& work_exp,
+                                  const std::vector<Size>& spec_offsets,
+                                  std::vector<MassTrace>& found_masstraces,
+                                  const Size max_traces)
+    {
+      boost::dynamic_bitset<> peak_visited(total_peak_count);
+      Size trace_number(1);
 
-        double mt_quality((double)current_trace.size() / (double)num_scans);
-        // std::cout << "mt quality: " << mt_quality << std::endl;
-        double rt_range(std::fabs(current_trace.rbegin()->getRT() - current_trace.begin()->getRT()));
+      // check presence of FWHM meta data
+      int fwhm_meta_idx(-1);
+      Size fwhm_meta_count(0);
+      for (Size i = 0; i < work_exp.size(); ++i)
+      {
+        if (!work_exp[i].getFloatDataArrays().empty() &&
+            work_exp[i].getFloatDataArrays()[0].getName() == "FWHM_ppm")
+        {
+          if (work_exp[i].getFloatDataArrays()[0].size() != work_exp[i].size())
+          { // float data should always have the same size as the corresponding array
+            throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, work_exp[i].size());
+          }
+          fwhm_meta_idx = 0;
+          ++fwhm_meta_count;
+        }
+      }
+      if (fwhm_meta_count > 0 && fwhm_meta_count != work_exp.size())
+      {
+        throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                      String("FWHM meta arrays are expected to be missing or present for all MS spectra [") + fwhm_meta_count + "/" + work_exp.size() + "].");
+      }
 
-        // *********************************************************** //
-        // Step 2.3 check if minimum length and quality of mass trace criteria are met
-        // *********************************************************** //
-        bool max_trace_criteria = (max_trace_length_ < 0.0 || rt_range < max_trace_length_);
-        if (rt_range >= min_trace_length_ && max_trace_criteria && mt_quality >= min_sample_rate_)
+
+      this->startProgress(0, total_peak_count, "mass trace detection");
+      Size peaks_detected(0);
+
+      // Apices are processed in batches (in order of decreasing intensity):
+      // all traces of a batch are first extended in parallel based on the
+      // peaks visited before the batch, then accepted one by one in order.
+      // A trace is extended again if any of the peaks it considered was taken
+      // by a previously accepted trace of the same batch, which makes the
+      // result identical to extending the traces one after another.
+      Size batch_size(1);
+#ifdef _OPENMP
+      batch_size = 64 * omp_get_max_threads();
+#endif
+      std::vector<TraceCandidate> candidates(std::min(batch_size, chrom_apices.size()));
+
+      bool max_traces_reached(false);
+      for (Size batch_start = 0; batch_start < chrom_apices.size() && !max_traces_reached; batch_start += batch_size)
+      {
+        const Size batch_end = std::min(batch_start + batch_size, chrom_apices.size());
+
+        // apices are stored in increasing order of intensity
+        auto apex_at = [&chrom_apices](Size k) -> const Apex& { return chrom_apices[chrom_apices.size() - 1 - k]; };
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+        for (SignedSize k = batch_start; k < (SignedSize)batch_end; ++k)
         {
-          // std::cout << "T" << trace_number << "\t" << mt_quality << std::endl;
+          const Apex& apex = apex_at(k);
+          TraceCandidate& candidate = candidates[k - batch_start];
+          if (peak_visited[spec_offsets[apex.scan_idx] + apex.peak_idx])
+          {
+            candidate.extended = false;
+            continue;
+          }
+          extendTrace_(apex, work_exp, spec_offsets, peak_visited, fwhm_meta_idx, candidate);
+        }
 
-          // mark all peaks as visited
-          for (Size i = 0; i < gathered_idx.size(); ++i)
+        for (Size k = batch_start; k < batch_end; ++k)
+        {
+          const Apex& apex = apex_at(k);
+          if (peak_visited[spec_offsets[apex.scan_idx] + apex.peak_idx])
           {
-            peak_visited[spec_offsets[gathered_idx[i].first] +  gathered_idx[i].second] = true;
+            continue;
           }
 
-          // create new MassTrace object and store collected peaks from list current_trace
-          MassTrace new_trace(current_trace);
-          new_trace.updateWeightedMeanRT();
-          new_trace.updateWeightedMeanMZ();
-          if (!fwhms_mz.empty())
+          TraceCandidate& candidate = candidates[k - batch_start];
+          bool still_valid = candidate.extended;
+          for (Size i = 0; still_valid && i < candidate.queried_idx.size(); ++i)
           {
-            new_trace.fwhm_mz_avg = Math::median(fwhms_mz.begin(), fwhms_mz.end());
+            still_valid = !peak_visited[candidate.queried_idx[i]];
           }
-          new_trace.setQuantMethod(quant_method_);
-          //new_trace.setCentroidSD(ftl_sd);
-          new_trace.updateWeightedMZsd();
-          new_trace.setLabel("T" + String(trace_number));
+          if (!still_valid)
+          {
+            extendTrace_(apex, work_exp, spec_offsets, peak_visited, fwhm_meta_idx, candidate);
+          }
+
+          if (!candidate.accepted)
+          {
+            continue;
+          }
+
+          // mark all peaks as visited
+          for (Size idx : candidate.gathered_idx)
+          {
+            peak_visited[idx] = true;
+          }
+
+          candidate.trace.setLabel("T" + String(trace_number));
           ++trace_number;
 
-          found_masstraces.push_back(new_trace);
+          peaks_detected += candidate.trace.getSize();
+          found_masstraces.push_back(std::move(candidate.trace));
+          candidate.accepted = false;
 
-          peaks_detected += new_trace.getSize();
           this->setProgress(peaks_detected);
 
           // check if we already reached the (optional) maximum number of traces
           if (max_traces > 0 && found_masstraces.size() == max_traces)
           {
+            max_traces_reached = true;
             break;
           }
         }
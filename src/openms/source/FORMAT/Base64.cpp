@@ -37,10 +37,166 @@
 #include <QtCore/QList>
 #include <QtCore/QString>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define OPENMS_BASE64_X86_SIMD
+#include <immintrin.h>
+#ifdef OPENMS_COMPILER_MSVC
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and clang need to be told which functions may use instructions beyond the baseline ISA
+#if defined(OPENMS_BASE64_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+#define OPENMS_BASE64_TARGET(isa) __attribute__((target(isa)))
+#else
+#define OPENMS_BASE64_TARGET(isa)
+#endif
+
 using namespace std;
 
 namespace OpenMS
 {
+#ifdef OPENMS_BASE64_X86_SIMD
+  namespace
+  {
+    /*
+      Vectorized decoding following W. Mula and D. Lemire, "Faster Base64
+      Encoding and Decoding Using AVX2 Instructions" (2018):
+
+      1. the characters are translated to their 6 bit values by adding an
+         offset looked up (pshufb) by the high nibble of each character. The
+         same lookup on both nibbles flags invalid characters, in which case
+         the remaining input is left to the scalar decoder.
+      2. four 6 bit values are merged into 24 bit using two multiply-add
+         instructions and the three bytes of each group are packed together.
+
+      Each step writes a full register, so the loops stop as long as the
+      register does not fit into the output anymore.
+    */
+
+    OPENMS_BASE64_TARGET("sse4.1")
+    void decodeSSE41(const char* in, Size in_size, Byte* out, Size out_size, Size& consumed, Size& written)
+    {
+      const __m128i lut_lo = _mm_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+      const __m128i lut_hi = _mm_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+      const __m128i lut_roll = _mm_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71,
+        0, 0, 0, 0, 0, 0, 0, 0);
+      const __m128i mask_2F = _mm_set1_epi8(0x2F);
+      const __m128i pack_shuffle = _mm_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+      while (consumed + 16 <= in_size && written + 16 <= out_size)
+      {
+        __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + consumed));
+
+        const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask_2F);
+        const __m128i lo_nibbles = _mm_and_si128(str, mask_2F);
+        const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+        if (!_mm_testz_si128(lo, hi))
+        {
+          return; // invalid character
+        }
+
+        const __m128i eq_2F = _mm_cmpeq_epi8(str, mask_2F);
+        const __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2F, hi_nibbles));
+        str = _mm_add_epi8(str, roll);
+
+        const __m128i merged = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+        str = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        str = _mm_shuffle_epi8(str, pack_shuffle);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + written), str);
+        consumed += 16;
+        written += 12;
+      }
+    }
+
+    OPENMS_BASE64_TARGET("avx2")
+    void decodeAVX2(const char* in, Size in_size, Byte* out, Size out_size, Size& consumed, Size& written)
+    {
+      const __m256i lut_lo = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+      const __m256i lut_hi = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+      const __m256i lut_roll = _mm256_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 16, 19, 4, -65, -65, -71, -71,
+        0, 0, 0, 0, 0, 0, 0, 0);
+      const __m256i mask_2F = _mm256_set1_epi8(0x2F);
+      const __m256i pack_shuffle = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+      // move the 12 bytes of the upper lane next to the ones of the lower lane
+      const __m256i pack_lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+      while (consumed + 32 <= in_size && written + 32 <= out_size)
+      {
+        __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + consumed));
+
+        const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2F);
+        const __m256i lo_nibbles = _mm256_and_si256(str, mask_2F);
+        const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+        const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+        if (!_mm256_testz_si256(lo, hi))
+        {
+          return; // invalid character
+        }
+
+        const __m256i eq_2F = _mm256_cmpeq_epi8(str, mask_2F);
+        const __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2F, hi_nibbles));
+        str = _mm256_add_epi8(str, roll);
+
+        const __m256i merged = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+        str = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        str = _mm256_shuffle_epi8(str, pack_shuffle);
+        str = _mm256_permutevar8x32_epi32(str, pack_lanes);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + written), str);
+        consumed += 32;
+        written += 24;
+      }
+    }
+
+    Base64::SIMDLevel detectSIMDLevel()
+    {
+#ifdef OPENMS_COMPILER_MSVC
+      int info[4];
+      __cpuid(info, 0);
+      const int max_leaf = info[0];
+      __cpuid(info, 1);
+      const bool sse41 = (info[2] & (1 << 19)) != 0;
+      const bool os_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+      bool avx2 = false;
+      if (max_leaf >= 7)
+      {
+        __cpuidex(info, 7, 0);
+        avx2 = os_avx && (info[1] & (1 << 5)) != 0;
+      }
+#else
+      __builtin_cpu_init();
+      const bool sse41 = __builtin_cpu_supports("sse4.1");
+      const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+      if (avx2) return Base64::SIMD_AVX2;
+      if (sse41) return Base64::SIMD_SSE41;
+      return Base64::SIMD_NONE;
+    }
+  }
+#endif
+
 
   /*
 
@@ -279,4 +435,66 @@ print s
     }
   }
 
+  Base64::SIMDLevel Base64::getSupportedSIMDLevel()
+  {
+#ifdef OPENMS_BASE64_X86_SIMD
+    static const SIMDLevel level = detectSIMDLevel();
+    return level;
+#else
+    return SIMD_NONE;
+#endif
+  }
+
+  Size Base64::decodeBytes(const char* in, Size in_size, Byte* out, Size out_size, SIMDLevel level)
+  {
+    Size consumed = 0;
+    Size written = 0;
+
+#ifdef OPENMS_BASE64_X86_SIMD
+    if (level >= SIMD_AVX2)
+    {
+      decodeAVX2(in, in_size, out, out_size, consumed, written);
+    }
+    if (level >= SIMD_SSE41)
+    {
+      decodeSSE41(in, in_size, out, out_size, consumed, written);
+    }
+#else
+    (void)level;
+#endif
+
+    // decode the remaining groups of 4 Base64 characters to 3 bytes
+    while (consumed + 4 <= in_size && written + 3 <= out_size)
+    {
+      const UInt32 int_24bit = (sextet_(in[consumed]) << 18) | (sextet_(in[consumed + 1]) << 12) |
+                               (sextet_(in[consumed + 2]) << 6) | sextet_(in[consumed + 3]);
+      out[written] = (Byte)(int_24bit >> 16);
+      out[written + 1] = (Byte)(int_24bit >> 8);
+      out[written + 2] = (Byte)int_24bit;
+      consumed += 4;
+      written += 3;
+    }
+
+    // last (incomplete) group: either less than 4 characters are left or the output is full
+    if (consumed < in_size && written < out_size)
+    {
+      UInt32 int_24bit = 0;
+      for (Size i = 0; i < 4; ++i)
+      {
+        int_24bit <<= 6;
+        if (consumed + i < in_size)
+        {
+          int_24bit |= sextet_(in[consumed + i]);
+        }
+      }
+      const Size available = (std::min(Size(4), in_size - consumed) * 3) / 4;
+      const Size count = std::min(available, out_size - written);
+      for (Size i = 0; i < count; ++i)
+      {
+        out[written++] = (Byte)(int_24bit >> (16 - 8 * i));
+      }
+    }
+    return written;
+  }
+
 } //end OpenMS
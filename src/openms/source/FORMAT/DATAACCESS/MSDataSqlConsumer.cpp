@@ -39,7 +39,7 @@
 namespace OpenMS
 {
 
-  MSDataSqlConsumer::MSDataSqlConsumer(const String& filename, UInt64 run_id, int flush_after, bool full_meta, bool lossy_compression, double linear_mass_acc) :
+  MSDataSqlConsumer::MSDataSqlConsumer(const String& filename, UInt64 run_id, int flush_after, bool full_meta, bool lossy_compression, double linear_mass_acc, Size chrom_block_size) :
         filename_(filename),
         handler_(new OpenMS::Internal::MzMLSqliteHandler(filename, run_id) ),
         flush_after_(flush_after),
@@ -49,6 +49,7 @@ namespace OpenMS
     chromatograms_.reserve(flush_after_);
 
     handler_->setConfig(full_meta, lossy_compression, linear_mass_acc, flush_after_);
+    handler_->setChromatogramBlockSize(chrom_block_size); // determines which tables get created
     handler_->createTables();
   }
 
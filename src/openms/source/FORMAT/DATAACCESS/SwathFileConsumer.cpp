@@ -34,7 +34,171 @@
 
 #include <OpenMS/FORMAT/DATAACCESS/SwathFileConsumer.h>
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 namespace OpenMS
 {
 
+  /**
+   * @brief Writes spectra to cached files on a set of background threads
+   *
+   * Each thread has its own queue ("lane"). Spectra of one file are always
+   * pushed to the same lane and are thus written in the order in which they
+   * were consumed. Queues are bounded so that memory usage stays limited
+   * when the disk is slower than the parser.
+   */
+  class CachedSwathFileConsumer::BackgroundWriter_
+  {
+public:
+    explicit BackgroundWriter_(Size nr_threads)
+    {
+      for (Size i = 0; i < nr_threads; ++i)
+      {
+        lanes_.emplace_back(new Lane_);
+        lanes_.back()->thread = std::thread(&BackgroundWriter_::work_, this, lanes_.back().get());
+      }
+    }
+
+    ~BackgroundWriter_()
+    {
+      stop_();
+    }
+
+    void push(MSDataCachedConsumer* consumer, Size lane_nr, SpectrumType&& s)
+    {
+      Lane_& lane = *lanes_[lane_nr % lanes_.size()];
+      {
+        std::unique_lock<std::mutex> lock(lane.mutex);
+        lane.space_available.wait(lock, [&lane] { return lane.queue.size() < capacity_; });
+        lane.queue.emplace_back(consumer, std::move(s));
+      }
+      lane.work_available.notify_one();
+      rethrowError_();
+    }
+
+    /// Waits until all queued spectra are written and stops the threads
+    void finish()
+    {
+      stop_();
+      rethrowError_();
+    }
+
+private:
+    struct Lane_
+    {
+      std::mutex mutex;
+      std::condition_variable work_available;
+      std::condition_variable space_available;
+      std::deque<std::pair<MSDataCachedConsumer*, SpectrumType> > queue;
+      bool stop = false;
+      std::thread thread;
+    };
+
+    void work_(Lane_* lane)
+    {
+      while (true)
+      {
+        std::pair<MSDataCachedConsumer*, SpectrumType> item;
+        {
+          std::unique_lock<std::mutex> lock(lane->mutex);
+          lane->work_available.wait(lock, [lane] { return lane->stop || !lane->queue.empty(); });
+          if (lane->queue.empty()) return; // stopped and all spectra written
+          item = std::move(lane->queue.front());
+          lane->queue.pop_front();
+        }
+        lane->space_available.notify_one();
+
+        try
+        {
+          item.first->consumeSpectrum(item.second);
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(error_mutex_);
+          if (!error_) error_ = std::current_exception();
+        }
+      }
+    }
+
+    void stop_()
+    {
+      for (auto& lane : lanes_)
+      {
+        {
+          std::lock_guard<std::mutex> lock(lane->mutex);
+          lane->stop = true;
+        }
+        lane->work_available.notify_all();
+      }
+      for (auto& lane : lanes_)
+      {
+        if (lane->thread.joinable()) lane->thread.join();
+      }
+    }
+
+    void rethrowError_()
+    {
+      std::exception_ptr error;
+      {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        std::swap(error, error_);
+      }
+      if (error) std::rethrow_exception(error);
+    }
+
+    static constexpr Size capacity_ = 256; ///< maximal number of queued spectra per lane
+
+    std::vector<std::unique_ptr<Lane_> > lanes_;
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+  };
+
+  void CachedSwathFileConsumer::setWriterThreads(Size nr_threads)
+  {
+    if (ms1_consumer_ != nullptr || !swath_consumers_.empty())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Writer threads need to be set before consuming any spectra");
+    }
+    background_writer_.reset(); // join previous threads first
+    if (nr_threads > 0)
+    {
+      background_writer_ = std::make_shared<BackgroundWriter_>(nr_threads);
+    }
+  }
+
+  void CachedSwathFileConsumer::writeSpectrum_(MSDataCachedConsumer* consumer, Size lane, MapType::SpectrumType& s)
+  {
+    if (!background_writer_)
+    {
+      consumer->consumeSpectrum(s); // writes data and clears it from s
+      return;
+    }
+
+    // move everything the cached file needs into a new spectrum, meta data stays in s
+    SpectrumType data;
+    data.setMSLevel(s.getMSLevel());
+    data.setRT(s.getRT());
+    std::vector<Peak1D> peaks;
+    s.swap(peaks);
+    data.swap(peaks);
+    data.getFloatDataArrays().swap(s.getFloatDataArrays());
+    data.getIntegerDataArrays().swap(s.getIntegerDataArrays());
+    background_writer_->push(consumer, lane, std::move(data));
+  }
+
+  void CachedSwathFileConsumer::finishWriting_()
+  {
+    if (background_writer_)
+    {
+      std::shared_ptr<BackgroundWriter_> writer;
+      writer.swap(background_writer_);
+      writer->finish();
+    }
+  }
+
 } // namespace OpenMS
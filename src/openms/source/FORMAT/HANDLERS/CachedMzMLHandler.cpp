@@ -313,9 +313,12 @@ namespace OpenMS::Internal
   std::vector<OpenSwath::BinaryDataArrayPtr> CachedMzMLHandler::readSpectrumFast(std::ifstream& ifs, int& ms_level, double& rt)
   {
     std::vector<OpenSwath::BinaryDataArrayPtr> data;
-    data.push_back(OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray));
-    data.push_back(OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray));
+    readSpectrumFast(ifs, ms_level, rt, data);
+    return data;
+  }
 
+  void CachedMzMLHandler::readSpectrumFast(std::ifstream& ifs, int& ms_level, double& rt, std::vector<OpenSwath::BinaryDataArrayPtr>& data)
+  {
     Size spec_size = -1;
     Size nr_float_arrays = -1;
     ifs.read((char*) &spec_size, sizeof(spec_size));
@@ -330,7 +333,6 @@ namespace OpenMS::Internal
     }
 
     readDataFast_(ifs, data, spec_size, nr_float_arrays);
-    return data;
   }
 
   void CachedMzMLHandler::readDataFast_(std::ifstream& ifs,
@@ -338,10 +340,17 @@ namespace OpenMS::Internal
                                         const Size& data_size,
                                         const Size& nr_float_arrays)
   {
-    OPENMS_PRECONDITION(data.size() == 2, "Input data needs to have 2 slots.")
+    // reuse the arrays (and their memory) already present in data
+    data.resize(2 + nr_float_arrays);
+    for (auto& array : data)
+    {
+      if (!array) array.reset(new OpenSwath::BinaryDataArray);
+    }
 
     data[0]->data.resize(data_size);
     data[1]->data.resize(data_size);
+    data[0]->description.clear();
+    data[1]->description.clear();
 
     if (data_size > 0)
     {
@@ -352,10 +361,10 @@ namespace OpenMS::Internal
     {
       return;
     }
-    char* buffer = new(std::nothrow) char[1024];
+    char buffer[1024] = {0};
     for (Size k = 0; k < nr_float_arrays; k++)
     {
-      data.push_back(OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray));
+      OpenSwath::BinaryDataArrayPtr& array = data[2 + k];
       Size len, len_name;
       ifs.read((char*)&len, sizeof(len));
       ifs.read((char*)&len_name, sizeof(len_name));
@@ -365,18 +374,17 @@ namespace OpenMS::Internal
       if (len_name > 1023)
       {
         ifs.seekg(len_name * sizeof(char), ifs.cur);
+        buffer[0] = '\0';
       }
       else
       {
         ifs.read(buffer, len_name);
         buffer[len_name] = '\0';
       }
-      data.back()->data.resize(len);
-      data.back()->description = buffer;
-      ifs.read((char*)&(data.back()->data)[0], len * sizeof(DatumSingleton));
+      array->data.resize(len);
+      array->description = buffer;
+      ifs.read((char*)array->data.data(), len * sizeof(DatumSingleton));
     }
-    delete[] buffer;
-    return;
   }
 
   std::vector<OpenSwath::BinaryDataArrayPtr> CachedMzMLHandler::readChromatogramFast(std::ifstream& ifs)
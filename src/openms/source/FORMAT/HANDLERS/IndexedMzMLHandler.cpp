@@ -37,12 +37,102 @@
 #include <OpenMS/FORMAT/HANDLERS/IndexedMzMLDecoder.h>
 #include <OpenMS/FORMAT/HANDLERS/MzMLSpectrumDecoder.h>
 
+#include <algorithm>
+
+#ifdef OPENMS_WINDOWSPLATFORM
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
 
 // #define DEBUG_READER
 
 namespace OpenMS::Internal
 {
 
+  /**
+    @brief Read-only file handle supporting concurrent positional reads
+
+    Reads never use or modify a shared file position, thus a single handle
+    can be used by multiple threads at the same time.
+  */
+  class IndexedMzMLHandler::PositionalFile_
+  {
+public:
+    explicit PositionalFile_(const String& filename)
+    {
+#ifdef OPENMS_WINDOWSPLATFORM
+      handle_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+#else
+      fd_ = ::open(filename.c_str(), O_RDONLY);
+#endif
+    }
+
+    ~PositionalFile_()
+    {
+#ifdef OPENMS_WINDOWSPLATFORM
+      if (handle_ != INVALID_HANDLE_VALUE) CloseHandle(handle_);
+#else
+      if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+
+    PositionalFile_(const PositionalFile_&) = delete;
+    PositionalFile_& operator=(const PositionalFile_&) = delete;
+
+    bool isOpen() const
+    {
+#ifdef OPENMS_WINDOWSPLATFORM
+      return handle_ != INVALID_HANDLE_VALUE;
+#else
+      return fd_ >= 0;
+#endif
+    }
+
+    /// Reads up to @p size bytes at @p offset into @p buffer, returns the number of bytes read
+    Size read(char* buffer, Size size, Int64 offset) const
+    {
+      Size total = 0;
+      while (total < size)
+      {
+#ifdef OPENMS_WINDOWSPLATFORM
+        OVERLAPPED overlapped = {};
+        UInt64 pos = static_cast<UInt64>(offset) + total;
+        overlapped.Offset = static_cast<DWORD>(pos & 0xFFFFFFFFull);
+        overlapped.OffsetHigh = static_cast<DWORD>(pos >> 32);
+        DWORD chunk = static_cast<DWORD>(std::min<Size>(size - total, 1u << 30));
+        DWORD nr_read = 0;
+        if (!ReadFile(handle_, buffer + total, chunk, &nr_read, &overlapped) || nr_read == 0)
+        {
+          break;
+        }
+#else
+        ssize_t nr_read = ::pread(fd_, buffer + total, size - total, static_cast<off_t>(offset + total));
+        if (nr_read < 0 && errno == EINTR) continue;
+        if (nr_read <= 0)
+        {
+          break;
+        }
+#endif
+        total += static_cast<Size>(nr_read);
+      }
+      return total;
+    }
+
+private:
+#ifdef OPENMS_WINDOWSPLATFORM
+    HANDLE handle_ = INVALID_HANDLE_VALUE;
+#else
+    int fd_ = -1;
+#endif
+  };
+
   void IndexedMzMLHandler::parseFooter_()
   {
     //-------------------------------------------------------------
@@ -102,12 +192,13 @@ namespace OpenMS::Internal
   IndexedMzMLHandler::IndexedMzMLHandler(const IndexedMzMLHandler& source) :
     filename_(source.filename_),
     spectra_offsets_(source.spectra_offsets_),
+    spectra_native_ids_(source.spectra_native_ids_),
     chromatograms_offsets_(source.chromatograms_offsets_),
+    chromatograms_native_ids_(source.chromatograms_native_ids_),
     index_offset_(source.index_offset_),
     spectra_before_chroms_(source.spectra_before_chroms_),
-    // do not copy the filestream itself but open a new filestream using the same file
-    // this is critical for parallel access to the same file!
-    filestream_(source.filename_.c_str()),
+    // positional reads do not move a file pointer, the handle can be shared
+    file_(source.file_),
     parsing_success_(source.parsing_success_),
     skip_xml_checks_(source.skip_xml_checks_)
   {
@@ -119,13 +210,17 @@ namespace OpenMS::Internal
 
   void IndexedMzMLHandler::openFile(const String& filename) 
   {
-    if (filestream_.is_open()) // important; otherwise opening again will fail
-    {
-      filestream_.close();
-    }
     filename_ = filename;
-    filestream_.open(filename);
+    spectra_offsets_.clear();
+    spectra_native_ids_.clear();
+    chromatograms_offsets_.clear();
+    chromatograms_native_ids_.clear();
+    file_.reset(new PositionalFile_(filename));
     parseFooter_();
+    if (!file_->isOpen())
+    {
+      parsing_success_ = false;
+    }
   }
 
   bool IndexedMzMLHandler::getParsingSuccess() const
@@ -143,7 +238,7 @@ namespace OpenMS::Internal
     return chromatograms_offsets_.size();
   }
 
-  std::string IndexedMzMLHandler::getChromatogramById_helper_(int id)
+  std::string IndexedMzMLHandler::getChromatogramById_helper_(int id) const
   {
     int chromToGet = id;
 
@@ -187,13 +282,7 @@ namespace OpenMS::Internal
       endidx = chromatograms_offsets_[chromToGet + 1];
     }
 
-    std::streampos readl = endidx - startidx;
-    char* buffer = new char[readl + std::streampos(1)];
-    filestream_.seekg(startidx, filestream_.beg);
-    filestream_.read(buffer, readl);
-    buffer[readl] = '\0';
-    std::string text(buffer);
-    delete[] buffer;
+    std::string text = readRange_(startidx, endidx);
 
 #ifdef DEBUG_READER
     // print the full text we just read
@@ -203,7 +292,7 @@ namespace OpenMS::Internal
     return text;
   }
 
-  std::string IndexedMzMLHandler::getSpectrumById_helper_(int id)
+  std::string IndexedMzMLHandler::getSpectrumById_helper_(int id) const
   {
     int spectrumToGet = id;
 
@@ -247,13 +336,7 @@ namespace OpenMS::Internal
       endidx = spectra_offsets_[spectrumToGet + 1];
     }
 
-    std::streampos readl = endidx - startidx;
-    char* buffer = new char[readl + std::streampos(1)];
-    filestream_.seekg(startidx, filestream_.beg);
-    filestream_.read(buffer, readl);
-    buffer[readl] = '\0';
-    std::string text(buffer);
-    delete[] buffer;
+    std::string text = readRange_(startidx, endidx);
 
 #ifdef DEBUG_READER
     // print the full text we just read
@@ -263,7 +346,16 @@ namespace OpenMS::Internal
     return text;
   }
 
-  OpenMS::Interfaces::SpectrumPtr IndexedMzMLHandler::getSpectrumById(int id)
+  std::string IndexedMzMLHandler::readRange_(std::streampos start, std::streampos end) const
+  {
+    Size length = static_cast<Size>(end - start);
+    std::string text(length, '\0');
+    Size nr_read = file_->read(&text[0], length, static_cast<Int64>(start));
+    text.resize(nr_read);
+    return text;
+  }
+
+  OpenMS::Interfaces::SpectrumPtr IndexedMzMLHandler::getSpectrumById(int id) const
   {
     OpenMS::Interfaces::SpectrumPtr sptr(new OpenMS::Interfaces::Spectrum);
     std::string text = IndexedMzMLHandler::getSpectrumById_helper_(id);
@@ -271,30 +363,31 @@ namespace OpenMS::Internal
     return sptr;
   }
 
-  const OpenMS::MSSpectrum IndexedMzMLHandler::getMSSpectrumById(int id)
+  const OpenMS::MSSpectrum IndexedMzMLHandler::getMSSpectrumById(int id) const
   {
     OpenMS::MSSpectrum s;
     getMSSpectrumById(id, s);
     return s;
   }
 
-  void IndexedMzMLHandler::getMSSpectrumByNativeId(std::string id, MSSpectrum& s)
+  void IndexedMzMLHandler::getMSSpectrumByNativeId(std::string id, MSSpectrum& s) const
   {
-    if (spectra_native_ids_.find(id) == spectra_native_ids_.end())
+    auto it = spectra_native_ids_.find(id);
+    if (it == spectra_native_ids_.end())
     {
       throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
           String( "Could not find spectrum id " + String(id) ));
     }
-    getMSSpectrumById(spectra_native_ids_[id], s);
+    getMSSpectrumById(int(it->second), s);
   }
 
-  void IndexedMzMLHandler::getMSSpectrumById(int id, MSSpectrum& s)
+  void IndexedMzMLHandler::getMSSpectrumById(int id, MSSpectrum& s) const
   {
     std::string text = IndexedMzMLHandler::getSpectrumById_helper_(id);
     MzMLSpectrumDecoder(skip_xml_checks_).domParseSpectrum(text, s);
   }
 
-  OpenMS::Interfaces::ChromatogramPtr IndexedMzMLHandler::getChromatogramById(int id)
+  OpenMS::Interfaces::ChromatogramPtr IndexedMzMLHandler::getChromatogramById(int id) const
   {
     OpenMS::Interfaces::ChromatogramPtr cptr(new OpenMS::Interfaces::Chromatogram);
     std::string text = IndexedMzMLHandler::getChromatogramById_helper_(id);
@@ -302,14 +395,14 @@ namespace OpenMS::Internal
     return cptr;
   }
 
-  const OpenMS::MSChromatogram IndexedMzMLHandler::getMSChromatogramById(int id)
+  const OpenMS::MSChromatogram IndexedMzMLHandler::getMSChromatogramById(int id) const
   {
     OpenMS::MSChromatogram c;
     getMSChromatogramById(id, c);
     return c;
   }
 
-  void IndexedMzMLHandler::getMSChromatogramByNativeId(const std::string& id, OpenMS::MSChromatogram& c)
+  void IndexedMzMLHandler::getMSChromatogramByNativeId(const std::string& id, OpenMS::MSChromatogram& c) const
   {
     auto it = chromatograms_native_ids_.find(id);
     if (it == chromatograms_native_ids_.end())
@@ -320,7 +413,7 @@ namespace OpenMS::Internal
     getMSChromatogramById(it->second, c);
   }
 
-  void IndexedMzMLHandler::getMSChromatogramById(int id, MSChromatogram& c)
+  void IndexedMzMLHandler::getMSChromatogramById(int id, MSChromatogram& c) const
   {
     std::string text = IndexedMzMLHandler::getChromatogramById_helper_(id);
     MzMLSpectrumDecoder(skip_xml_checks_).domParseChromatogram(text, c);
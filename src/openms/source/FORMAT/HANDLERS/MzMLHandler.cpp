@@ -44,11 +44,194 @@
 #include <OpenMS/INTERFACES/IMSDataConsumer.h>
 #include <OpenMS/SYSTEM/File.h>
 
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace OpenMS::Internal
 {
 
+    /**
+      @brief Pipeline which decodes binary data on worker threads while parsing continues
+
+      The parser thread pushes spectra and chromatograms (with their still
+      encoded binary data) into a window of at most @p capacity items. Worker
+      threads decode the items in any order, while the parser thread hands
+      them off to the experiment / consumer strictly in input order. Thus
+      XML parsing and decoding overlap, the consumer is only ever called from
+      the parser thread and memory usage is bounded by the window size.
+    */
+    class MzMLHandler::DecodeQueue_
+    {
+public:
+      DecodeQueue_(MzMLHandler& handler, Size nr_workers, Size capacity) :
+        handler_(handler),
+        capacity_(std::max(capacity, Size(1)))
+      {
+        for (Size i = 0; i < nr_workers; ++i)
+        {
+          workers_.emplace_back(&DecodeQueue_::work_, this);
+        }
+      }
+
+      ~DecodeQueue_()
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          stop_ = true;
+        }
+        work_available_.notify_all();
+        for (auto& worker : workers_)
+        {
+          worker.join();
+        }
+      }
+
+      void push(SpectrumData&& spectrum_data)
+      {
+        std::unique_ptr<Item_> item(new Item_);
+        item->is_spectrum = true;
+        item->spectrum = std::move(spectrum_data);
+        push_(std::move(item));
+      }
+
+      void push(ChromatogramData&& chromatogram_data)
+      {
+        std::unique_ptr<Item_> item(new Item_);
+        item->is_spectrum = false;
+        item->chromatogram = std::move(chromatogram_data);
+        push_(std::move(item));
+      }
+
+      /// Hand off all items (blocks until all are decoded)
+      void flush()
+      {
+        handOff_(true);
+      }
+
+private:
+      struct Item_
+      {
+        bool is_spectrum = true;
+        SpectrumData spectrum;
+        ChromatogramData chromatogram;
+        bool done = false;
+        bool failed = false;
+        String error_message;
+      };
+
+      void push_(std::unique_ptr<Item_>&& item)
+      {
+        // make room in the window first (this may block until the oldest item is decoded)
+        handOff_(false);
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          todo_.push_back(item.get());
+          window_.push_back(std::move(item));
+        }
+        work_available_.notify_one();
+      }
+
+      /// Hands off decoded items from the front of the window (on the parser thread)
+      void handOff_(bool all)
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!window_.empty())
+        {
+          if (!window_.front()->done)
+          {
+            if (!all && window_.size() < capacity_) break;
+            item_done_.wait(lock, [this] { return window_.front()->done; });
+          }
+          std::unique_ptr<Item_> item = std::move(window_.front());
+          window_.pop_front();
+
+          // do not hold the lock while the consumer is working
+          lock.unlock();
+          if (item->failed)
+          {
+            std::cerr << "  Parsing error: '" << item->error_message  << "'" << std::endl;
+            std::cerr << "  You could try to disable sorting spectra while loading." << std::endl;
+            throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, handler_.file_, "Error during parsing of binary data: '" + item->error_message + "'");
+          }
+          if (item->is_spectrum)
+          {
+            handler_.handOffSpectrum_(item->spectrum.spectrum);
+          }
+          else
+          {
+            handler_.handOffChromatogram_(item->chromatogram.chromatogram);
+          }
+          lock.lock();
+        }
+      }
+
+      void work_()
+      {
+        while (true)
+        {
+          Item_* item = nullptr;
+          {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [this] { return stop_ || !todo_.empty(); });
+            if (stop_) return;
+            item = todo_.front();
+            todo_.pop_front();
+          }
+
+          bool failed = false;
+          String error_message;
+          try
+          {
+            if (item->is_spectrum)
+            {
+              handler_.decodeSpectrum_(item->spectrum);
+            }
+            else
+            {
+              handler_.decodeChromatogram_(item->chromatogram);
+            }
+          }
+          catch (std::exception& e)
+          {
+            failed = true;
+            error_message = e.what();
+          }
+          catch (...)
+          {
+            failed = true;
+            error_message = "unknown error";
+          }
+
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            item->failed = failed;
+            item->error_message = error_message;
+            item->done = true;
+          }
+          item_done_.notify_one();
+        }
+      }
+
+      MzMLHandler& handler_;
+      const Size capacity_;
+      /// all items which have not been handed off yet (in input order)
+      std::deque<std::unique_ptr<Item_> > window_;
+      /// items which have not been picked up by a worker yet
+      std::deque<Item_*> todo_;
+      std::mutex mutex_;
+      std::condition_variable work_available_;
+      std::condition_variable item_done_;
+      bool stop_ = false;
+      std::vector<std::thread> workers_;
+    };
+
     /// Constructor for a read-only handler
     MzMLHandler::MzMLHandler(MapType& exp, const String& filename, const String& version, const ProgressLogger& logger)
       : MzMLHandler(filename, version, logger)
@@ -87,8 +270,6 @@ namespace OpenMS::Internal
     void MzMLHandler::setOptions(const PeakFileOptions& opt)
     {
       options_ = opt;
-      spectrum_data_.reserve(options_.getMaxDataPoolSize());
-      chromatogram_data_.reserve(options_.getMaxDataPoolSize());
     }
 
     /// Get the peak file options
@@ -133,145 +314,137 @@ namespace OpenMS::Internal
       consumer_ = consumer;
     }
 
-    void MzMLHandler::populateSpectraWithData_()
+    void MzMLHandler::queueSpectrum_(SpectrumData&& spectrum_data)
     {
+      if (!options_.getFillData())
+      {
+        handOffSpectrum_(spectrum_data.spectrum);
+        return;
+      }
 
-      // Whether spectrum should be populated with data
-      if (options_.getFillData())
+      if (!startDecodeQueue_())
       {
-        size_t errCount = 0;
-        String error_message;
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-        for (SignedSize i = 0; i < (SignedSize)spectrum_data_.size(); i++)
+        // decode directly on the parser thread
+        try
         {
-          // parallel exception catching and re-throwing business
-          if (!errCount) // no need to parse further if already an error was encountered
-          {
-            try
-            {
-              populateSpectraWithData_(spectrum_data_[i].data,
-                                       spectrum_data_[i].default_array_length,
-                                       options_,
-                                       spectrum_data_[i].spectrum);
-              if (options_.getSortSpectraByMZ() && !spectrum_data_[i].spectrum.isSorted())
-              {
-                spectrum_data_[i].spectrum.sortByPosition();
-              }
-            }
-
-            catch (OpenMS::Exception::BaseException& e)
-            {
-#pragma omp critical(MZMLErrorHandling)
-              {
-                ++errCount;
-                error_message = e.what();
-              }
-            }
-            catch (...)
-            {
-#pragma omp atomic
-              ++errCount;
-            }
-          }
+          decodeSpectrum_(spectrum_data);
         }
-        if (errCount != 0)
+        catch (OpenMS::Exception::BaseException& e)
         {
-          std::cerr << "  Parsing error: '" << error_message  << "'" << std::endl;
-          std::cerr << "  You could try to disable sorting spectra while loading." << std::endl;
-          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, file_, "Error during parsing of binary data: '" + error_message + "'");
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, file_, "Error during parsing of binary data: '" + String(e.what()) + "'");
         }
+        handOffSpectrum_(spectrum_data.spectrum);
+        return;
+      }
+      decode_queue_->push(std::move(spectrum_data));
+    }
+
+    void MzMLHandler::queueChromatogram_(ChromatogramData&& chromatogram_data)
+    {
+      if (!options_.getFillData())
+      {
+        handOffChromatogram_(chromatogram_data.chromatogram);
+        return;
       }
 
-      // Append all spectra to experiment / consumer
-      for (Size i = 0; i < spectrum_data_.size(); i++)
+      if (!startDecodeQueue_())
       {
-        if (consumer_ != nullptr)
+        // decode directly on the parser thread
+        try
         {
-          consumer_->consumeSpectrum(spectrum_data_[i].spectrum);
-          if (options_.getAlwaysAppendData())
-          {
-            exp_->addSpectrum(std::move(spectrum_data_[i].spectrum));
-          }
+          decodeChromatogram_(chromatogram_data);
         }
-        else
+        catch (OpenMS::Exception::BaseException& e)
         {
-          exp_->addSpectrum(std::move(spectrum_data_[i].spectrum));
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, file_, "Error during parsing of binary data: '" + String(e.what()) + "'");
         }
+        handOffChromatogram_(chromatogram_data.chromatogram);
+        return;
       }
-
-      // Delete batch
-      spectrum_data_.clear();
+      decode_queue_->push(std::move(chromatogram_data));
     }
 
-    void MzMLHandler::populateChromatogramsWithData_()
+    bool MzMLHandler::startDecodeQueue_()
     {
-      // Whether chromatogram should be populated with data
-      if (options_.getFillData())
-      {
-        size_t errCount = 0;
-        String error_message;
+      if (decode_queue_) return true;
+
 #ifdef _OPENMP
-#pragma omp parallel for
+      // when loading from within a parallel region (e.g. SwathFile::loadSplit), the caller's threads are
+      // already busy: decode inline instead of starting another set of workers per thread
+      if (omp_in_parallel()) return false;
+      // the parser thread takes one of the available threads
+      Size nr_workers = std::max(omp_get_max_threads(), 1) - 1;
+#else
+      Size nr_workers = 0;
 #endif
-        for (SignedSize i = 0; i < (SignedSize)chromatogram_data_.size(); i++)
-        {
-          // parallel exception catching and re-throwing business
-          try
-          {
-            populateChromatogramsWithData_(chromatogram_data_[i].data,
-                                           chromatogram_data_[i].default_array_length,
-                                           options_,
-                                           chromatogram_data_[i].chromatogram);
-            if (options_.getSortChromatogramsByRT() && !chromatogram_data_[i].chromatogram.isSorted())
-            {
-              chromatogram_data_[i].chromatogram.sortByPosition();
-            }
-          }
-          catch (OpenMS::Exception::BaseException& e)
-          {
-#pragma omp critical
-            {
-              ++errCount;
-              error_message = e.what();
-            }
-          }
-          catch (...)
-          {
-#pragma omp atomic
-            ++errCount;
-          }
-        }
-        if (errCount != 0)
-        {
-          // throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, file_, "Error during parsing of binary data.");
-          std::cerr << "  Parsing error: '" << error_message  << "'" << std::endl;
-          std::cerr << "  You could try to disable sorting spectra while loading." << std::endl;
-          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, file_, "Error during parsing of binary data: '" + error_message + "'");
-        }
+      if (nr_workers == 0) return false;
+
+      decode_queue_.reset(new DecodeQueue_(*this, nr_workers, options_.getMaxDataPoolSize()));
+      return true;
+    }
+
+    void MzMLHandler::flushDecodeQueue_()
+    {
+      if (decode_queue_)
+      {
+        decode_queue_->flush();
+      }
+    }
 
+    void MzMLHandler::decodeSpectrum_(SpectrumData& spectrum_data)
+    {
+      populateSpectraWithData_(spectrum_data.data,
+                               spectrum_data.default_array_length,
+                               options_,
+                               spectrum_data.spectrum);
+      if (options_.getSortSpectraByMZ() && !spectrum_data.spectrum.isSorted())
+      {
+        spectrum_data.spectrum.sortByPosition();
+      }
+    }
+
+    void MzMLHandler::decodeChromatogram_(ChromatogramData& chromatogram_data)
+    {
+      populateChromatogramsWithData_(chromatogram_data.data,
+                                     chromatogram_data.default_array_length,
+                                     options_,
+                                     chromatogram_data.chromatogram);
+      if (options_.getSortChromatogramsByRT() && !chromatogram_data.chromatogram.isSorted())
+      {
+        chromatogram_data.chromatogram.sortByPosition();
       }
+    }
 
-      // Append all chromatograms to experiment / consumer
-      for (Size i = 0; i < chromatogram_data_.size(); i++)
+    void MzMLHandler::handOffSpectrum_(SpectrumType& spectrum)
+    {
+      if (consumer_ != nullptr)
       {
-        if (consumer_ != nullptr)
+        consumer_->consumeSpectrum(spectrum);
+        if (options_.getAlwaysAppendData())
         {
-          consumer_->consumeChromatogram(chromatogram_data_[i].chromatogram);
-          if (options_.getAlwaysAppendData())
-          {
-            exp_->addChromatogram(std::move(chromatogram_data_[i].chromatogram));
-          }
+          exp_->addSpectrum(std::move(spectrum));
         }
-        else
+      }
+      else
+      {
+        exp_->addSpectrum(std::move(spectrum));
+      }
+    }
+
+    void MzMLHandler::handOffChromatogram_(ChromatogramType& chromatogram)
+    {
+      if (consumer_ != nullptr)
+      {
+        consumer_->consumeChromatogram(chromatogram);
+        if (options_.getAlwaysAppendData())
         {
-          exp_->addChromatogram(std::move(chromatogram_data_[i].chromatogram));
+          exp_->addChromatogram(std::move(chromatogram));
         }
       }
-
-      // Delete batch
-      chromatogram_data_.clear();
+      else
+      {
+        exp_->addChromatogram(std::move(chromatogram));
+      }
     }
 
     void MzMLHandler::addSpectrumMetaData_(const std::vector<MzMLHandlerHelper::BinaryData>& input_data,
@@ -1259,13 +1432,8 @@ namespace OpenMS::Internal
           {
             tmp.data = std::move(bin_data_);
           }
-          // append current spectral data to buffer
-          spectrum_data_.push_back(std::move(tmp));
-
-          if (spectrum_data_.size() >= options_.getMaxDataPoolSize())
-          {
-            populateSpectraWithData_();
-          }
+          // decode the data (asynchronously) and append it to the result
+          queueSpectrum_(std::move(tmp));
         }
 
         switch (load_detail_)
@@ -1297,13 +1465,8 @@ namespace OpenMS::Internal
           {
             tmp.data = std::move(bin_data_);
           }
-          // append current spectral data to buffer
-          chromatogram_data_.push_back(std::move(tmp));
-
-          if (chromatogram_data_.size() >= options_.getMaxDataPoolSize())
-          {
-            populateChromatogramsWithData_();
-          }
+          // decode the data (asynchronously) and append it to the result
+          queueChromatogram_(std::move(tmp));
         }
 
         switch (load_detail_)
@@ -1356,8 +1519,7 @@ namespace OpenMS::Internal
         processing_.clear();
 
         // Flush the remaining data
-        populateSpectraWithData_();
-        populateChromatogramsWithData_();
+        flushDecodeQueue_();
       }
     }
 
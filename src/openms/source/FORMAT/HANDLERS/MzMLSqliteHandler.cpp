@@ -53,6 +53,7 @@
 #endif
 
 #include <cmath>
+#include <cstring>
 
 namespace OpenMS::Internal
 {
@@ -247,6 +248,198 @@ namespace OpenMS::Internal
       }
     }
 
+    /*
+     * Helper functions for the block layout of chromatogram data
+     *
+     * A block stores the data of consecutive chromatograms (SQL ids
+     * FIRST_CHROMATOGRAM_ID to LAST_CHROMATOGRAM_ID) in a single zlib
+     * compressed blob. The uncompressed blob is organized column-wise:
+     *
+     *   UInt32 nr_chromatograms
+     *   nr_chromatograms x (UInt32 nr_points, UInt32 rt_bytes, UInt32 int_bytes)
+     *   all retention time arrays (concatenated)
+     *   all intensity arrays (concatenated)
+     *
+     * The retention time arrays within a block are very similar (e.g. all
+     * transitions of a peptide), storing them next to each other allows zlib
+     * to exploit this redundancy.
+     *
+     * Arrays are encoded using numpress (linear for RT, slof for intensity)
+     * for compression 8 or as raw doubles for compression 9.
+     */
+    namespace
+    {
+      void appendUInt32_(std::string& buffer, UInt32 value)
+      {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(UInt32));
+      }
+
+      UInt32 readUInt32_(const std::string& buffer, Size& pos)
+      {
+        if (pos + sizeof(UInt32) > buffer.size())
+        {
+          throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Truncated chromatogram block header");
+        }
+        UInt32 value;
+        std::memcpy(&value, buffer.data() + pos, sizeof(UInt32));
+        pos += sizeof(UInt32);
+        return value;
+      }
+
+      void encodeChromatogramBlock_(const std::vector<MSChromatogram>& chroms, Size first, Size last,
+                                    bool lossy, std::string& result)
+      {
+        // Encoding options (identical to the per-chromatogram layout)
+        MSNumpressCoder::NumpressConfig npconfig_rt;
+        npconfig_rt.estimate_fixed_point = true; // critical
+        npconfig_rt.numpressErrorTolerance = -1.0; // skip check, faster
+        npconfig_rt.setCompression("linear");
+        npconfig_rt.linear_fp_mass_acc = 0.05; // set the desired RT accuracy (0.05 seconds)
+        MSNumpressCoder::NumpressConfig npconfig_int;
+        npconfig_int.estimate_fixed_point = true; // critical
+        npconfig_int.numpressErrorTolerance = -1.0; // skip check, faster
+        npconfig_int.setCompression("slof");
+
+        std::string header, rt_column, int_column;
+        appendUInt32_(header, UInt32(last - first));
+
+        std::vector<double> data_to_encode;
+        String encoded;
+        for (Size k = first; k < last; ++k)
+        {
+          const MSChromatogram& chrom = chroms[k];
+          appendUInt32_(header, UInt32(chrom.size()));
+
+          data_to_encode.resize(chrom.size());
+          for (Size p = 0; p < chrom.size(); ++p)
+          {
+            data_to_encode[p] = chrom[p].getRT();
+          }
+          Size rt_start = rt_column.size();
+          if (lossy)
+          {
+            encoded.clear();
+            MSNumpressCoder().encodeNPRaw(data_to_encode, encoded, npconfig_rt);
+            rt_column += encoded;
+          }
+          else
+          {
+            rt_column.append(reinterpret_cast<const char*>(data_to_encode.data()), data_to_encode.size() * sizeof(double));
+          }
+          appendUInt32_(header, UInt32(rt_column.size() - rt_start));
+
+          for (Size p = 0; p < chrom.size(); ++p)
+          {
+            data_to_encode[p] = chrom[p].getIntensity();
+          }
+          Size int_start = int_column.size();
+          if (lossy)
+          {
+            encoded.clear();
+            MSNumpressCoder().encodeNPRaw(data_to_encode, encoded, npconfig_int);
+            int_column += encoded;
+          }
+          else
+          {
+            int_column.append(reinterpret_cast<const char*>(data_to_encode.data()), data_to_encode.size() * sizeof(double));
+          }
+          appendUInt32_(header, UInt32(int_column.size() - int_start));
+        }
+
+        std::string uncompressed;
+        uncompressed.reserve(header.size() + rt_column.size() + int_column.size());
+        uncompressed += header;
+        uncompressed += rt_column;
+        uncompressed += int_column;
+        OpenMS::ZlibCompression::compressString(uncompressed, result);
+      }
+
+      /*
+       * Decode a chromatogram block and fill the chromatograms listed in
+       * targets (pairs of position within the block and index in
+       * chromatograms).
+       */
+      void decodeChromatogramBlock_(const std::string& blob, int compression,
+                                    const std::vector<std::pair<Size, Size> >& targets,
+                                    std::vector<MSChromatogram>& chromatograms)
+      {
+        if (compression != 8 && compression != 9)
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              "Compression not supported for chromatogram blocks");
+        }
+
+        std::string uncompressed;
+        OpenMS::ZlibCompression::uncompressString(blob.data(), blob.size(), uncompressed);
+
+        Size pos = 0;
+        Size nr_chroms = readUInt32_(uncompressed, pos);
+        std::vector<Size> nr_points(nr_chroms), rt_offset(nr_chroms + 1, 0), int_offset(nr_chroms + 1, 0);
+        for (Size k = 0; k < nr_chroms; ++k)
+        {
+          nr_points[k] = readUInt32_(uncompressed, pos);
+          rt_offset[k + 1] = rt_offset[k] + readUInt32_(uncompressed, pos);
+          int_offset[k + 1] = int_offset[k] + readUInt32_(uncompressed, pos);
+        }
+        const Size rt_start = pos;
+        const Size int_start = rt_start + rt_offset[nr_chroms];
+        if (int_start + int_offset[nr_chroms] != uncompressed.size())
+        {
+          throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Chromatogram block has unexpected size");
+        }
+
+        MSNumpressCoder::NumpressConfig npconfig_rt;
+        npconfig_rt.setCompression("linear");
+        MSNumpressCoder::NumpressConfig npconfig_int;
+        npconfig_int.setCompression("slof");
+
+        std::vector<double> rt, intensity;
+        for (const auto& target : targets)
+        {
+          const Size k = target.first;
+          if (k >= nr_chroms)
+          {
+            throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Chromatogram not found in block");
+          }
+          const char* rt_data = uncompressed.data() + rt_start + rt_offset[k];
+          const char* int_data = uncompressed.data() + int_start + int_offset[k];
+          const Size rt_bytes = rt_offset[k + 1] - rt_offset[k];
+          const Size int_bytes = int_offset[k + 1] - int_offset[k];
+          if (compression == 8)
+          {
+            rt.clear();
+            intensity.clear();
+            MSNumpressCoder().decodeNPRaw(std::string(rt_data, rt_bytes), rt, npconfig_rt);
+            MSNumpressCoder().decodeNPRaw(std::string(int_data, int_bytes), intensity, npconfig_int);
+          }
+          else
+          {
+            if (rt_bytes % sizeof(double) != 0 || int_bytes % sizeof(double) != 0)
+            {
+              throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bad BufferCount?");
+            }
+            rt.resize(rt_bytes / sizeof(double));
+            intensity.resize(int_bytes / sizeof(double));
+            std::memcpy(rt.data(), rt_data, rt_bytes);
+            std::memcpy(intensity.data(), int_data, int_bytes);
+          }
+          if (rt.size() != nr_points[k] || intensity.size() != nr_points[k])
+          {
+            throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                "Number of decoded data points does not match chromatogram size");
+          }
+
+          MSChromatogram& chrom = chromatograms[target.second];
+          chrom.resize(nr_points[k]);
+          for (Size p = 0; p < nr_points[k]; ++p)
+          {
+            chrom[p].setRT(rt[p]);
+            chrom[p].setIntensity(intensity[p]);
+          }
+        }
+      }
+    }
+
     // the cost for initialization and copy should be minimal
     //  - a single C string is created
     //  - two ints
@@ -254,10 +447,12 @@ namespace OpenMS::Internal
       filename_(filename),
       spec_id_(0),
       chrom_id_(0),
+      chrom_block_id_(0),
       run_id_(Internal::SqliteHelper::clearSignBit(run_id)),
       use_lossy_compression_(true),
       linear_abs_mass_acc_(0.0001), // set the desired mass accuracy = 1ppm at 100 m/z
-      write_full_meta_(true)
+      write_full_meta_(true),
+      chrom_block_size_(0)
     {
     }
 
@@ -495,6 +690,12 @@ namespace OpenMS::Internal
 
     void MzMLSqliteHandler::populateChromatogramsWithData_(sqlite3* db, std::vector<MSChromatogram>& chromatograms) const
     {
+      if (SqliteConnector::tableExists(db, "CHROMATOGRAM_BLOCK"))
+      {
+        populateChromatogramsFromBlocks_(db, chromatograms);
+        return;
+      }
+
       std::string select_sql;
       select_sql = "SELECT " \
                     "CHROMATOGRAM.ID as chrom_id," \
@@ -521,6 +722,12 @@ namespace OpenMS::Internal
       OPENMS_PRECONDITION(!indices.empty(), "Need to select at least one index.")
       OPENMS_PRECONDITION(indices.size() == chromatograms.size(), "Chromatograms and indices need to have the same length.")
 
+      if (SqliteConnector::tableExists(db, "CHROMATOGRAM_BLOCK"))
+      {
+        populateChromatogramsFromBlocks_(db, chromatograms, indices);
+        return;
+      }
+
       String select_sql = "SELECT " \
                           "CHROMATOGRAM.ID as chrom_id," \
                           "CHROMATOGRAM.NATIVE_ID as chrom_native_id," \
@@ -539,6 +746,132 @@ namespace OpenMS::Internal
       sqlite3_finalize(stmt);
     }
 
+    void MzMLSqliteHandler::populateChromatogramsFromBlocks_(sqlite3* db,
+                                                             std::vector<MSChromatogram>& chromatograms,
+                                                             const std::vector<int>& indices) const
+    {
+      // map the SQL ids to the chromatograms (same order as in prepareChroms_)
+      String select_sql = "SELECT " \
+                          "CHROMATOGRAM.ID as chrom_id," \
+                          "CHROMATOGRAM.NATIVE_ID as chrom_native_id " \
+                          "FROM CHROMATOGRAM " \
+                          "INNER JOIN PRECURSOR ON CHROMATOGRAM.ID = PRECURSOR.CHROMATOGRAM_ID " \
+                          "INNER JOIN PRODUCT ON CHROMATOGRAM.ID = PRODUCT.CHROMATOGRAM_ID ";
+      if (!indices.empty())
+      {
+        select_sql += String("WHERE CHROMATOGRAM.ID IN (") + integerConcatenateHelper(indices) + ")";
+      }
+      select_sql += ";";
+
+      sqlite3_stmt* stmt;
+      SqliteConnector::prepareStatement(db, &stmt, select_sql);
+      sqlite3_step(stmt);
+      std::vector<std::pair<int, Size> > sql_container_map; // (SQL id, index in chromatograms)
+      sql_container_map.reserve(chromatograms.size());
+      String native_id;
+      while (sqlite3_column_type(stmt, 0) != SQLITE_NULL)
+      {
+        Size curr_id = sql_container_map.size();
+        if (curr_id >= chromatograms.size())
+        {
+          sqlite3_finalize(stmt);
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              "Data for non-existent spectrum / chromatogram found");
+        }
+        Sql::extractValue(&native_id, stmt, 1);
+        if (native_id != chromatograms[curr_id].getNativeID())
+        {
+          sqlite3_finalize(stmt);
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              String("Native id for spectrum / chromatogram does not match: ") + native_id + " != " +  chromatograms[curr_id].getNativeID() );
+        }
+        sql_container_map.emplace_back(sqlite3_column_int(stmt, 0), curr_id);
+        sqlite3_step(stmt);
+      }
+      sqlite3_finalize(stmt);
+
+      // read the block index (the blobs themselves are only read for blocks which are needed)
+      std::vector<int> block_first, block_last, block_id;
+      SqliteConnector::prepareStatement(db, &stmt, "SELECT ID, FIRST_CHROMATOGRAM_ID, LAST_CHROMATOGRAM_ID " \
+                                                   "FROM CHROMATOGRAM_BLOCK ORDER BY FIRST_CHROMATOGRAM_ID;");
+      sqlite3_step(stmt);
+      while (sqlite3_column_type(stmt, 0) != SQLITE_NULL)
+      {
+        block_id.push_back(sqlite3_column_int(stmt, 0));
+        block_first.push_back(sqlite3_column_int(stmt, 1));
+        block_last.push_back(sqlite3_column_int(stmt, 2));
+        sqlite3_step(stmt);
+      }
+      sqlite3_finalize(stmt);
+
+      // assign each chromatogram to its block
+      std::map<int, std::vector<std::pair<Size, Size> > > block_targets; // block id -> (position in block, index in chromatograms)
+      for (const auto& sql_container : sql_container_map)
+      {
+        auto it = std::upper_bound(block_first.begin(), block_first.end(), sql_container.first);
+        Size b = std::distance(block_first.begin(), it);
+        if (b == 0 || sql_container.first > block_last[b - 1])
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              String("Chromatogram ") + sql_container.second + " does not have any data.");
+        }
+        --b;
+        block_targets[block_id[b]].emplace_back(sql_container.first - block_first[b], sql_container.second);
+      }
+      if (block_targets.empty())
+      {
+        return;
+      }
+
+      // fetch all required blocks with a single statement
+      std::vector<int> required_blocks;
+      required_blocks.reserve(block_targets.size());
+      for (const auto& bt : block_targets)
+      {
+        required_blocks.push_back(bt.first);
+      }
+      select_sql = String("SELECT ID, COMPRESSION, DATA FROM CHROMATOGRAM_BLOCK WHERE ID IN (") +
+                   integerConcatenateHelper(required_blocks) + ");";
+      std::vector<std::string> blobs;
+      std::vector<int> compression;
+      std::vector<const std::vector<std::pair<Size, Size> >* > targets;
+      SqliteConnector::prepareStatement(db, &stmt, select_sql);
+      sqlite3_step(stmt);
+      while (sqlite3_column_type(stmt, 0) != SQLITE_NULL)
+      {
+        const char* raw_data = reinterpret_cast<const char*>(sqlite3_column_blob(stmt, 2));
+        blobs.emplace_back(raw_data, sqlite3_column_bytes(stmt, 2));
+        compression.push_back(sqlite3_column_int(stmt, 1));
+        targets.push_back(&block_targets[sqlite3_column_int(stmt, 0)]);
+        sqlite3_step(stmt);
+      }
+      sqlite3_finalize(stmt);
+
+      // decode blocks in parallel, each chromatogram is part of exactly one block
+      String error_message;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (SignedSize k = 0; k < (SignedSize)blobs.size(); ++k)
+      {
+        try
+        {
+          decodeChromatogramBlock_(blobs[k], compression[k], *targets[k], chromatograms);
+        }
+        catch (Exception::BaseException& e)
+        {
+#ifdef _OPENMP
+#pragma omp critical (sqmass_decode_block)
+#endif
+          error_message = e.what();
+        }
+      }
+      if (!error_message.empty())
+      {
+        throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, error_message);
+      }
+    }
+
     void MzMLSqliteHandler::populateSpectraWithData_(sqlite3* db, std::vector<MSSpectrum>& spectra) const
     {
       std::string select_sql;
@@ -959,6 +1292,23 @@ namespace OpenMS::Internal
 
       // Execute SQL statement
       conn.executeStatement(create_sql);
+
+      if (chrom_block_size_ > 0)
+      {
+        // chromatogram block table (replaces the DATA table for chromatograms)
+        //  - compression is one of 8 = np-linear (rt) / np-slof (int) + zlib, 9 = zlib
+        //  - data contains the data of all chromatograms from FIRST_CHROMATOGRAM_ID to LAST_CHROMATOGRAM_ID
+        conn.executeStatement(
+          "CREATE TABLE CHROMATOGRAM_BLOCK(" \
+          "ID INT PRIMARY KEY NOT NULL," \
+          "FIRST_CHROMATOGRAM_ID INT NOT NULL," \
+          "LAST_CHROMATOGRAM_ID INT NOT NULL," \
+          "COMPRESSION INT," \
+          "DATA BLOB NOT NULL" \
+          ");" \
+          "CREATE INDEX chrom_block_range_idx ON CHROMATOGRAM_BLOCK(FIRST_CHROMATOGRAM_ID, LAST_CHROMATOGRAM_ID);" \
+          "CREATE INDEX chrom_native_idx ON CHROMATOGRAM(NATIVE_ID);");
+      }
       createIndices_();
     }
 
@@ -1253,13 +1603,20 @@ namespace OpenMS::Internal
       String prepare_statement = "INSERT INTO DATA (CHROMATOGRAM_ID, DATA_TYPE, COMPRESSION, DATA) VALUES ";
       int sql_it = 1;
 
+      // Block layout: data is stored in CHROMATOGRAM_BLOCK instead of DATA
+      const bool write_blocks = chrom_block_size_ > 0;
+      if (write_blocks)
+      {
+        writeChromatogramBlocks_(conn.getDB(), chroms, chrom_id_);
+      }
+
       // Perform encoding in parallel
-      std::vector<String> encoded_strings_rt(chroms.size());
-      std::vector<String> encoded_strings_int(chroms.size());
+      std::vector<String> encoded_strings_rt(write_blocks ? 0 : chroms.size());
+      std::vector<String> encoded_strings_int(write_blocks ? 0 : chroms.size());
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
-      for (SignedSize k = 0; k < (SignedSize)chroms.size(); k++)
+      for (SignedSize k = 0; k < (SignedSize)encoded_strings_rt.size(); k++)
       {
         const MSChromatogram& chrom = chroms[k];
         // encode retention time data (zlib or np-linear + zlib)
@@ -1356,6 +1713,12 @@ namespace OpenMS::Internal
           chrom_id_ << "," << 0 << "," << prod.getMZ() << 
           "," << prod.getIsolationWindowLowerOffset() << "," << prod.getIsolationWindowUpperOffset() << "); ";
 
+        if (write_blocks)
+        {
+          chrom_id_++;
+          continue;
+        }
+
         //  data_type is one of 0 = mz, 1 = int, 2 = rt
         //  compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
 
@@ -1416,5 +1779,58 @@ namespace OpenMS::Internal
       conn.executeStatement("END TRANSACTION");
     }
 
+    void MzMLSqliteHandler::writeChromatogramBlocks_(sqlite3* db, const std::vector<MSChromatogram>& chroms, Int first_chrom_id)
+    {
+      const Size nr_blocks = (chroms.size() + chrom_block_size_ - 1) / chrom_block_size_;
+
+      // Perform encoding in parallel
+      std::vector<String> encoded_blocks(nr_blocks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (SignedSize b = 0; b < (SignedSize)nr_blocks; b++)
+      {
+        Size first = b * chrom_block_size_;
+        Size last = std::min(first + chrom_block_size_, chroms.size());
+        encodeChromatogramBlock_(chroms, first, last, use_lossy_compression_, encoded_blocks[b]);
+      }
+
+      //  compression is one of 8 = np-linear (rt) / np-slof (int) + zlib, 9 = zlib
+      const int compression = use_lossy_compression_ ? 8 : 9;
+      const String insert_block_sql = "INSERT INTO CHROMATOGRAM_BLOCK (ID, FIRST_CHROMATOGRAM_ID, LAST_CHROMATOGRAM_ID, " \
+                                       "COMPRESSION, DATA) VALUES ";
+      String prepare_statement = insert_block_sql;
+      std::vector<String> data;
+      int sql_it = 1;
+      for (Size b = 0; b < nr_blocks; b++)
+      {
+        Size first = b * chrom_block_size_;
+        Size last = std::min(first + chrom_block_size_, chroms.size());
+
+        std::stringstream values;
+        values << "(" << chrom_block_id_ << "," << first_chrom_id + first << "," << first_chrom_id + last - 1 <<
+          "," << compression << ", ?" << sql_it++ << " ),";
+        prepare_statement += values.str();
+        data.push_back(encoded_blocks[b]);
+        chrom_block_id_++;
+
+        if (sql_it > sql_batch_size_) // flush as sqlite can only handle so many bind_blob statements
+        {
+          prepare_statement.resize(prepare_statement.size() - 1); // remove last ","
+          SqliteConnector::executeBindStatement(db, prepare_statement, data);
+          data.clear();
+          prepare_statement = insert_block_sql;
+          sql_it = 1;
+        }
+      }
+
+      // prevent writing of empty data which would throw an SQL exception
+      if (!data.empty())
+      {
+        prepare_statement.resize(prepare_statement.size() - 1); // remove last ","
+        SqliteConnector::executeBindStatement(db, prepare_statement, data);
+      }
+    }
+
 } // namespace OpenMS  // namespace Internal
 
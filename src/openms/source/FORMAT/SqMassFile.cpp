@@ -54,6 +54,7 @@ namespace OpenMS
   {
     OpenMS::Internal::MzMLSqliteHandler sql_mass(filename, map.getSqlRunID());
     sql_mass.setConfig(config_.write_full_meta, config_.use_lossy_numpress, config_.linear_fp_mass_acc);
+    sql_mass.setChromatogramBlockSize(config_.chrom_block_size);
     sql_mass.createTables();
     sql_mass.writeExperiment(map);
   }
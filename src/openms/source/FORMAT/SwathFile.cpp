@@ -48,6 +48,10 @@
 
 #include <memory> // for make_shared
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
 
@@ -174,7 +178,15 @@ namespace OpenMS
     }
     else if (readoptions == "cache")
     {
-      dataConsumer = std::make_shared<CachedSwathFileConsumer>(known_window_boundaries, tmp, tmp_fname, nr_ms1_spectra, swath_counter);
+      auto cachedConsumer = std::make_shared<CachedSwathFileConsumer>(known_window_boundaries, tmp, tmp_fname, nr_ms1_spectra, swath_counter);
+#ifdef _OPENMP
+      // write the cached files on background threads while the mzML is parsed and decoded
+      if (omp_get_max_threads() > 1)
+      {
+        cachedConsumer->setWriterThreads(std::min<Size>(std::max(1, omp_get_max_threads() / 4), known_window_boundaries.size() + 1));
+      }
+#endif
+      dataConsumer = cachedConsumer;
     }
     else if (readoptions == "split")
     {
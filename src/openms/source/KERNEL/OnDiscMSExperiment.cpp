@@ -54,7 +54,7 @@ namespace OpenMS
     indexed_mzml_file_.setSkipXMLChecks(skip);
   }
 
-  OpenMS::Interfaces::ChromatogramPtr OnDiscMSExperiment::getChromatogramById(Size id)
+  OpenMS::Interfaces::ChromatogramPtr OnDiscMSExperiment::getChromatogramById(Size id) const
   {
     return indexed_mzml_file_.getChromatogramById(id);
   }
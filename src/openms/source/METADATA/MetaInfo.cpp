@@ -34,6 +34,10 @@
 
 #include <OpenMS/METADATA/MetaInfo.h>
 
+#include <OpenMS/CONCEPT/Constants.h> // initializes the user parameter names used by registry_ first
+
+#include <algorithm>
+
 using namespace std;
 
 namespace OpenMS
@@ -41,13 +45,161 @@ namespace OpenMS
 
   MetaInfoRegistry MetaInfo::registry_ = MetaInfoRegistry();
 
+  MetaInfo::MetaInfo(const MetaInfo& rhs)
+  {
+    *this = rhs;
+  }
+
+  MetaInfo::MetaInfo(MetaInfo&& rhs) noexcept :
+    size_(rhs.size_),
+    capacity_(rhs.capacity_),
+    data_(rhs.data_)
+  {
+    rhs.size_ = 0;
+    rhs.capacity_ = 0;
+    rhs.data_ = nullptr;
+  }
+
   MetaInfo::~MetaInfo()
   {
+    release_();
+  }
+
+  MetaInfo& MetaInfo::operator=(const MetaInfo& rhs)
+  {
+    if (this == &rhs)
+    {
+      return *this;
+    }
+    release_();
+    if (rhs.size_ == 0)
+    {
+      return *this;
+    }
+    // copies are sized exactly
+    data_ = ::operator new(keyBytes_(rhs.size_) + rhs.size_ * sizeof(DataValue));
+    capacity_ = rhs.size_;
+    std::copy(rhs.keys_(), rhs.keys_() + rhs.size_, keys_());
+    DataValue* values = values_();
+    const DataValue* rhs_values = rhs.values_();
+    try
+    {
+      for (; size_ < rhs.size_; ++size_)
+      {
+        new (values + size_) DataValue(rhs_values[size_]);
+      }
+    }
+    catch (...)
+    {
+      release_();
+      throw;
+    }
+    return *this;
+  }
+
+  MetaInfo& MetaInfo::operator=(MetaInfo&& rhs) & noexcept
+  {
+    if (this == &rhs)
+    {
+      return *this;
+    }
+    release_();
+    std::swap(size_, rhs.size_);
+    std::swap(capacity_, rhs.capacity_);
+    std::swap(data_, rhs.data_);
+    return *this;
+  }
+
+  Size MetaInfo::keyBytes_(UInt capacity)
+  {
+    const Size align = alignof(DataValue);
+    return (capacity * sizeof(UInt) + align - 1) / align * align;
+  }
+
+  UInt MetaInfo::lowerBound_(UInt index) const
+  {
+    return UInt(std::lower_bound(keys_(), keys_() + size_, index) - keys_());
+  }
+
+  Int MetaInfo::find_(UInt index) const
+  {
+    UInt pos = lowerBound_(index);
+    if (pos < size_ && keys_()[pos] == index)
+    {
+      return Int(pos);
+    }
+    return -1;
+  }
+
+  void MetaInfo::insertAt_(UInt pos, UInt index, DataValue&& value)
+  {
+    if (size_ < capacity_)
+    {
+      UInt* keys = keys_();
+      DataValue* values = values_();
+      std::copy_backward(keys + pos, keys + size_, keys + size_ + 1);
+      if (pos == size_)
+      {
+        new (values + size_) DataValue(std::move(value));
+      }
+      else
+      {
+        new (values + size_) DataValue(std::move(values[size_ - 1]));
+        std::move_backward(values + pos, values + size_ - 1, values + size_);
+        values[pos] = std::move(value);
+      }
+      keys[pos] = index;
+      ++size_;
+      return;
+    }
+
+    // grow exactly for small objects (the common case), geometrically for larger ones
+    UInt new_capacity = (size_ < 8) ? size_ + 1 : size_ + size_ / 2;
+    void* new_data = ::operator new(keyBytes_(new_capacity) + new_capacity * sizeof(DataValue));
+    UInt* new_keys = static_cast<UInt*>(new_data);
+    DataValue* new_values = reinterpret_cast<DataValue*>(static_cast<char*>(new_data) + keyBytes_(new_capacity));
+
+    UInt* keys = keys_();
+    DataValue* values = values_();
+    std::copy(keys, keys + pos, new_keys);
+    new_keys[pos] = index;
+    std::copy(keys + pos, keys + size_, new_keys + pos + 1);
+    // moving DataValues does not throw
+    for (UInt i = 0; i < pos; ++i)
+    {
+      new (new_values + i) DataValue(std::move(values[i]));
+    }
+    new (new_values + pos) DataValue(std::move(value));
+    for (UInt i = pos; i < size_; ++i)
+    {
+      new (new_values + i + 1) DataValue(std::move(values[i]));
+    }
+
+    UInt new_size = size_ + 1;
+    release_();
+    data_ = new_data;
+    capacity_ = new_capacity;
+    size_ = new_size;
+  }
+
+  void MetaInfo::release_() noexcept
+  {
+    DataValue* values = values_();
+    for (UInt i = 0; i < size_; ++i)
+    {
+      values[i].~DataValue();
+    }
+    ::operator delete(data_);
+    data_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
   }
 
   bool MetaInfo::operator==(const MetaInfo& rhs) const
   {
-    return index_to_value_ == rhs.index_to_value_;
+    return size_ == rhs.size_ &&
+           std::equal(keys_(), keys_() + size_, rhs.keys_()) &&
+           std::equal(values_(), values_() + size_, rhs.values_());
   }
 
   bool MetaInfo::operator!=(const MetaInfo& rhs) const
@@ -57,20 +209,15 @@ namespace OpenMS
 
   const DataValue& MetaInfo::getValue(const String& name, const DataValue& default_value) const
   {
-    MapType::const_iterator it = index_to_value_.find(registry_.getIndex(name));
-    if (it != index_to_value_.end())
-    {
-      return it->second;
-    }
-    return default_value;
+    return getValue(registry_.getIndex(name), default_value);
   }
 
   const DataValue& MetaInfo::getValue(UInt index, const DataValue& default_value) const
   {
-    MapType::const_iterator it = index_to_value_.find(index);
-    if (it != index_to_value_.end())
+    Int pos = find_(index);
+    if (pos != -1)
     {
-      return it->second;
+      return values_()[pos];
     }
     return default_value;
   }
@@ -84,18 +231,17 @@ namespace OpenMS
   void MetaInfo::setValue(UInt index, const DataValue& value)
   {
     // @TODO: check if that index is registered in MetaInfoRegistry?
-    auto it = index_to_value_.find(index);
-    if (it != index_to_value_.end())
+    UInt pos = lowerBound_(index);
+    if (pos < size_ && keys_()[pos] == index)
     {
-      it->second = value;
+      values_()[pos] = value;
     }
     else
     {
       // Note; we need to create a copy of data value here and can't use the const &
-      // The underlying flat_map invalidates references to it if inserting
-      // an element leads to relocation (e.g, in constructs like: m.insert(1, m[2]));)
-      DataValue tmp = value;
-      index_to_value_.insert(std::make_pair(index, tmp));
+      // The storage is relocated if inserting an element requires more
+      // capacity (e.g, in constructs like: m.setValue(1, m.getValue(2)))
+      insertAt_(pos, index, DataValue(value));
     }
   }
 
@@ -109,63 +255,63 @@ namespace OpenMS
     UInt index = registry_.getIndex(name);
     if (index != UInt(-1))
     {
-      return (index_to_value_.find(index) != index_to_value_.end());
+      return find_(index) != -1;
     }
     return false;
   }
 
   bool MetaInfo::exists(UInt index) const
   {
-    return (index_to_value_.find(index) != index_to_value_.end());
+    return find_(index) != -1;
   }
 
   void MetaInfo::removeValue(const String& name)
   {
-    MapType::iterator it = index_to_value_.find(registry_.getIndex(name));
-    if (it != index_to_value_.end())
-    {
-      index_to_value_.erase(it);
-    }
+    removeValue(registry_.getIndex(name));
   }
 
   void MetaInfo::removeValue(UInt index)
   {
-    MapType::iterator it = index_to_value_.find(index);
-    if (it != index_to_value_.end())
+    Int pos = find_(index);
+    if (pos == -1)
     {
-      index_to_value_.erase(it);
+      return;
     }
+    UInt* keys = keys_();
+    DataValue* values = values_();
+    std::copy(keys + pos + 1, keys + size_, keys + pos);
+    std::move(values + pos + 1, values + size_, values + pos);
+    values[size_ - 1].~DataValue();
+    --size_;
   }
 
   void MetaInfo::getKeys(vector<String>& keys) const
   {
-    keys.resize(index_to_value_.size());
-    UInt i = 0;
-    for (MapType::const_iterator it = index_to_value_.begin(); it != index_to_value_.end(); ++it)
+    keys.resize(size_);
+    for (UInt i = 0; i < size_; ++i)
     {
-      keys[i++] = registry_.getName(it->first);
+      keys[i] = registry_.getName(keys_()[i]);
     }
   }
 
   void MetaInfo::getKeys(vector<UInt>& keys) const
   {
-    keys.resize(index_to_value_.size());
-    UInt i = 0;
-    for (MapType::const_iterator it = index_to_value_.begin(); it != index_to_value_.end(); ++it)
-    {
-      keys[i++] = it->first;
-    }
+    keys.assign(keys_(), keys_() + size_);
   }
 
   bool MetaInfo::empty() const
   {
-    return index_to_value_.empty();
+    return size_ == 0;
   }
 
   void MetaInfo::clear()
   {
-    index_to_value_.clear();
+    release_();
   }
 
-} //namespace
+  Size MetaInfo::allocatedBytes() const
+  {
+    return capacity_ == 0 ? 0 : keyBytes_(capacity_) + capacity_ * sizeof(DataValue);
+  }
 
+} //namespace
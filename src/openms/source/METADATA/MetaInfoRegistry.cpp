@@ -32,89 +32,140 @@
 // $Authors: Marc Sturm, Hendrik Weisser $
 // -------------------------------------------------------------------------
 
-#include <sstream>
-
 #include <OpenMS/METADATA/MetaInfoRegistry.h>
 
+#include <OpenMS/CONCEPT/Constants.h>
+
+#include <functional>
+#include <unordered_map>
+
 using namespace std;
 
 namespace OpenMS
 {
 
+  struct MetaInfoRegistry::Entry_
+  {
+    Entry_(UInt index, const std::string& name, const std::string& description, const std::string& unit) :
+      index(index), name(name), description(description), unit(unit)
+    {
+    }
+
+    const UInt index;
+    const std::string name;
+    /// description and unit may change after registration and are only accessed while holding the lock
+    std::string description;
+    std::string unit;
+  };
+
+  /**
+    @brief Open-addressing hash table (name -> entry) plus a direct lookup array (index -> entry).
+
+    Slots are only ever filled (never changed or emptied), so readers can probe without locking.
+    Once it is full, a larger copy is built and published instead.
+  */
+  struct MetaInfoRegistry::Table_
+  {
+    explicit Table_(Size name_capacity) :
+      mask(name_capacity - 1),
+      index_capacity(1024 + name_capacity / 2), // at most name_capacity / 2 dynamic indices
+      size(0),
+      by_name(new std::atomic<Entry_*>[name_capacity]),
+      by_index(new std::atomic<Entry_*>[index_capacity])
+    {
+      for (Size i = 0; i < name_capacity; ++i) by_name[i].store(nullptr, std::memory_order_relaxed);
+      for (Size i = 0; i < index_capacity; ++i) by_index[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    /// true if another entry can be added without exceeding a load factor of 0.5
+    bool hasRoom() const
+    {
+      return (size + 1) * 2 <= mask + 1;
+    }
+
+    /// adds an entry (lock must be held)
+    void add(Entry_* e)
+    {
+      Size i = std::hash<std::string>()(e->name) & mask;
+      while (by_name[i].load(std::memory_order_relaxed) != nullptr)
+      {
+        i = (i + 1) & mask;
+      }
+      by_index[e->index].store(e, std::memory_order_release);
+      by_name[i].store(e, std::memory_order_release);
+      ++size;
+    }
+
+    Entry_* find(const std::string& name) const
+    {
+      Size i = std::hash<std::string>()(name) & mask;
+      Entry_* e;
+      while ((e = by_name[i].load(std::memory_order_acquire)) != nullptr)
+      {
+        if (e->name == name) return e;
+        i = (i + 1) & mask;
+      }
+      return nullptr;
+    }
+
+    Entry_* find(UInt index) const
+    {
+      if (index >= index_capacity) return nullptr;
+      return by_index[index].load(std::memory_order_acquire);
+    }
+
+    const Size mask;
+    const Size index_capacity;
+    Size size; ///< only accessed by writers
+    std::unique_ptr<std::atomic<Entry_*>[]> by_name;
+    std::unique_ptr<std::atomic<Entry_*>[]> by_index;
+  };
+
   MetaInfoRegistry::MetaInfoRegistry() :
-    next_index_(1024), 
-    name_to_index_(), 
-    index_to_name_(), 
-    index_to_description_(), 
-    index_to_unit_()
+    next_index_(1024),
+    entries_(),
+    tables_(),
+    table_(nullptr)
   {
-    name_to_index_["isotopic_range"] = 1;
-    index_to_name_[1] = "isotopic_range";
-    index_to_description_[1] = "consecutive numbering of the peaks in an isotope pattern. 0 is the monoisotopic peak";
-    index_to_unit_[1] = "";
-
-    name_to_index_["cluster_id"] = 2;
-    index_to_name_[2] = "cluster_id";
-    index_to_description_[2] = "consecutive numbering of isotope clusters in a spectrum";
-    index_to_unit_[2] = "";
-
-    name_to_index_["label"] = 3;
-    index_to_name_[3] = "label";
-    index_to_description_[3] = "label e.g. shown in visualization";
-    index_to_unit_[3] = "";
-
-    name_to_index_["icon"] = 4;
-    index_to_name_[4] = "icon";
-    index_to_description_[4] = "icon shown in visualization";
-    index_to_unit_[4] = "";
-
-    name_to_index_["color"] = 5;
-    index_to_name_[5] = "color";
-    index_to_description_[5] = "color used for visualization e.g. #FF00FF for purple";
-    index_to_unit_[5] = "";
-
-    name_to_index_["RT"] = 6;
-    index_to_name_[6] = "RT";
-    index_to_description_[6] = "the retention time of an identification";
-    index_to_unit_[6] = "";
-
-    name_to_index_["MZ"] = 7;
-    index_to_name_[7] = "MZ";
-    index_to_description_[7] = "the MZ of an identification";
-    index_to_unit_[7] = "";
-
-    name_to_index_["predicted_RT"] = 8;
-    index_to_name_[8] = "predicted_RT";
-    index_to_description_[8] = "the predicted retention time of a peptide hit";
-    index_to_unit_[8] = "";
-
-    name_to_index_["predicted_RT_p_value"] = 9;
-    index_to_name_[9] = "predicted_RT_p_value";
-    index_to_description_[9] = "the predicted RT p-value of a peptide hit";
-    index_to_unit_[9] = "";
-
-    name_to_index_["spectrum_reference"] = 10;
-    index_to_name_[10] = "spectrum_reference";
-    index_to_description_[10] = "Reference to a spectrum or feature number";
-    index_to_unit_[10] = "";
-
-    name_to_index_["ID"] = 11;
-    index_to_name_[11] = "ID";
-    index_to_description_[11] = "Some type of identifier";
-    index_to_unit_[11] = "";
-
-    name_to_index_["low_quality"] = 12;
-    index_to_name_[12] = "low_quality";
-    index_to_description_[12] = "Flag which indicates that some entity has a low quality (e.g. a feature pair)";
-    index_to_unit_[12] = "";
-
-    name_to_index_["charge"] = 13;
-    index_to_name_[13] = "charge";
-    index_to_description_[13] = "Charge of a feature or peak";
-    index_to_unit_[13] = "";
+    tables_.emplace_back(new Table_(64));
+    table_.store(tables_.back().get(), std::memory_order_release);
+
+    insert_(ISOTOPIC_RANGE, "isotopic_range", "consecutive numbering of the peaks in an isotope pattern. 0 is the monoisotopic peak", "");
+    insert_(CLUSTER_ID, "cluster_id", "consecutive numbering of isotope clusters in a spectrum", "");
+    insert_(LABEL, "label", "label e.g. shown in visualization", "");
+    insert_(ICON, "icon", "icon shown in visualization", "");
+    insert_(COLOR, "color", "color used for visualization e.g. #FF00FF for purple", "");
+    insert_(RT, "RT", "the retention time of an identification", "");
+    insert_(MZ, "MZ", "the MZ of an identification", "");
+    insert_(PREDICTED_RT, "predicted_RT", "the predicted retention time of a peptide hit", "");
+    insert_(PREDICTED_RT_P_VALUE, "predicted_RT_p_value", "the predicted RT p-value of a peptide hit", "");
+    insert_(SPECTRUM_REFERENCE, "spectrum_reference", "Reference to a spectrum or feature number", "");
+    insert_(ID, "ID", "Some type of identifier", "");
+    insert_(LOW_QUALITY, "low_quality", "Flag which indicates that some entity has a low quality (e.g. a feature pair)", "");
+    insert_(CHARGE, "charge", "Charge of a feature or peak", "");
+
+    // names of Constants::UserParam (MetaInfo.cpp includes Constants.h, so they are initialized before MetaInfo::registry_)
+    insert_(CONCAT_PEPTIDE, Constants::UserParam::CONCAT_PEPTIDE, "identifier of concatenated peptides", "");
+    insert_(LOCALIZED_MODIFICATIONS_USERPARAM, Constants::UserParam::LOCALIZED_MODIFICATIONS_USERPARAM, "unimod modifications used in site localization", "");
+    insert_(MERGED_CHROMATOGRAM_MZS, Constants::UserParam::MERGED_CHROMATOGRAM_MZS, "m/z of other chromatograms which have been merged into this one", "");
+    insert_(PRECURSOR_ERROR_PPM_USERPARAM, Constants::UserParam::PRECURSOR_ERROR_PPM_USERPARAM, "precursor m/z error", "ppm");
+    insert_(FRAGMENT_ERROR_MEDIAN_PPM_USERPARAM, Constants::UserParam::FRAGMENT_ERROR_MEDIAN_PPM_USERPARAM, "median of the fragment m/z errors", "ppm");
+    insert_(FRAGMENT_ERROR_PPM_USERPARAM, Constants::UserParam::FRAGMENT_ERROR_PPM_USERPARAM, "fragment m/z errors", "ppm");
+    insert_(FRAGMENT_ERROR_DA_USERPARAM, Constants::UserParam::FRAGMENT_ERROR_DA_USERPARAM, "fragment m/z errors", "Da");
+    insert_(FRAGMENT_ANNOTATION_USERPARAM, Constants::UserParam::FRAGMENT_ANNOTATION_USERPARAM, "fragment annotations", "");
+    insert_(PSM_EXPLAINED_ION_CURRENT_USERPARAM, Constants::UserParam::PSM_EXPLAINED_ION_CURRENT_USERPARAM, "fraction of the ion current explained by a PSM", "");
+    insert_(MATCHED_PREFIX_IONS_FRACTION, Constants::UserParam::MATCHED_PREFIX_IONS_FRACTION, "fraction of prefix ions that have been matched", "");
+    insert_(MATCHED_SUFFIX_IONS_FRACTION, Constants::UserParam::MATCHED_SUFFIX_IONS_FRACTION, "fraction of suffix ions that have been matched", "");
+    insert_(TARGET_DECOY, Constants::UserParam::TARGET_DECOY, "target/decoy annotation (target, decoy or target+decoy)", "");
+    insert_(DELTA_SCORE, Constants::UserParam::DELTA_SCORE, "score ratio between a rank x hit and the rank x+1 hit", "");
+    insert_(ISOTOPE_ERROR, Constants::UserParam::ISOTOPE_ERROR, "monoisotopic peak misassignment (in multiples of the C13-C12 mass difference)", "");
   }
 
-  MetaInfoRegistry::MetaInfoRegistry(const MetaInfoRegistry& rhs)
+  MetaInfoRegistry::MetaInfoRegistry(const MetaInfoRegistry& rhs) :
+    next_index_(1024),
+    entries_(),
+    tables_(),
+    table_(nullptr)
   {
     *this = rhs;
   }
@@ -131,32 +182,126 @@ namespace OpenMS
     }
 #pragma omp critical (MetaInfoRegistry)
     {
+      const Table_* source = rhs.table_.load(std::memory_order_acquire);
+
+      // Tables and entries are never freed while this registry exists (concurrent
+      // readers may still access them). To keep repeated assignments from piling
+      // up copies, continue with the largest of our tables that only holds names
+      // of rhs (under the same index) and add the missing names to it. Only if
+      // there is none, a new table is started.
+      Table_* target = nullptr;
+      for (const auto& table : tables_)
+      {
+        if (table->size > source->size || (target != nullptr && table->size <= target->size)) continue;
+        bool compatible = true;
+        for (Size i = 0; i < table->index_capacity && compatible; ++i)
+        {
+          const Entry_* e = table->find(UInt(i));
+          if (e == nullptr) continue;
+          const Entry_* r = source->find(e->index);
+          compatible = (r != nullptr && r->name == e->name);
+        }
+        if (compatible) target = table.get();
+      }
+      if (target == nullptr)
+      {
+        Size capacity = 64;
+        while (capacity < 2 * (source->size + 1)) capacity *= 2;
+        tables_.emplace_back(new Table_(capacity));
+        target = tables_.back().get();
+      }
+      table_.store(target, std::memory_order_release);
+
+      // entries created before (e.g. for an earlier assignment) are reused as well
+      std::unordered_map<UInt, Entry_*> known;
+      for (const auto& e : entries_)
+      {
+        known[e->index] = e.get(); // later entries of the same index replace earlier ones
+      }
+      for (Size i = 0; i < source->index_capacity; ++i)
+      {
+        const Entry_* r = source->find(UInt(i));
+        if (r == nullptr) continue;
+        Entry_* e = table_.load(std::memory_order_relaxed)->find(r->index);
+        if (e == nullptr)
+        {
+          auto it = known.find(r->index);
+          if (it != known.end() && it->second->name == r->name)
+          {
+            e = it->second;
+          }
+          else
+          {
+            entries_.emplace_back(new Entry_(r->index, r->name, r->description, r->unit));
+            e = entries_.back().get();
+          }
+          add_(e);
+        }
+        e->description = r->description;
+        e->unit = r->unit;
+      }
       next_index_ = rhs.next_index_;
-      name_to_index_ = rhs.name_to_index_;
-      index_to_name_ = rhs.index_to_name_;
-      index_to_description_ = rhs.index_to_description_;
-      index_to_unit_ = rhs.index_to_unit_;
     }
     return *this;
   }
 
+  UInt MetaInfoRegistry::insert_(UInt index, const std::string& name, const std::string& description, const std::string& unit)
+  {
+    entries_.emplace_back(new Entry_(index, name, description, unit));
+    add_(entries_.back().get());
+    return index;
+  }
+
+  void MetaInfoRegistry::add_(Entry_* e)
+  {
+    // the current table is one of tables_, which we own
+    Table_* current = const_cast<Table_*>(table_.load(std::memory_order_relaxed));
+    if (current->hasRoom())
+    {
+      current->add(e);
+      return;
+    }
+    // grow: copy all entries into a table of twice the size, then publish it
+    tables_.emplace_back(new Table_(2 * (current->mask + 1)));
+    Table_* grown = tables_.back().get();
+    for (Size i = 0; i < current->index_capacity; ++i)
+    {
+      Entry_* old = current->by_index[i].load(std::memory_order_relaxed);
+      if (old != nullptr) grown->add(old);
+    }
+    grown->add(e);
+    table_.store(grown, std::memory_order_release);
+  }
+
+  const MetaInfoRegistry::Entry_* MetaInfoRegistry::find_(UInt index) const
+  {
+    return table_.load(std::memory_order_acquire)->find(index);
+  }
+
+  const MetaInfoRegistry::Entry_* MetaInfoRegistry::find_(const std::string& name) const
+  {
+    return table_.load(std::memory_order_acquire)->find(name);
+  }
+
   UInt MetaInfoRegistry::registerName(const String& name, const String& description, const String& unit)
   {
+    // lock-free fast path for names that are already registered
+    const Entry_* e = find_(name);
+    if (e != nullptr)
+    {
+      return e->index;
+    }
     UInt rv;
 #pragma omp critical (MetaInfoRegistry)
     {
-      MapString2IndexType::iterator it = name_to_index_.find(name);
-      if (it == name_to_index_.end())
+      e = find_(name); // may have been registered concurrently
+      if (e == nullptr)
       {
-        name_to_index_[name] = next_index_;
-        index_to_name_[next_index_] = name;
-        index_to_description_[next_index_] = description;
-        index_to_unit_[next_index_] = unit;
-        rv = next_index_++;
+        rv = insert_(next_index_++, name, description, unit);
       }
       else
       {
-        rv = it->second;
+        rv = e->index;
       }
     }
     return rv;
@@ -164,169 +309,131 @@ namespace OpenMS
 
   void MetaInfoRegistry::setDescription(UInt index, const String& description)
   {
-    MapIndex2StringType::iterator pos;
+    const Entry_* e = find_(index);
+    if (e == nullptr)
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
+    }
 #pragma omp critical (MetaInfoRegistry)
     {
-      pos = index_to_description_.find(index);
-      if (pos != index_to_description_.end())
-      {
-        pos->second = description;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
-      }
+      const_cast<Entry_*>(e)->description = description;
     }
   }
 
   void MetaInfoRegistry::setDescription(const String& name, const String& description)
   {
-    MapString2IndexType::iterator pos;
+    const Entry_* e = find_(name);
+    if (e == nullptr)
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered name!", name);
+    }
 #pragma omp critical (MetaInfoRegistry)
     {
-      pos = name_to_index_.find(name);
-      if (pos != name_to_index_.end())
-      {
-        index_to_description_[pos->second] = description;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered name!", name);
-      }
+      const_cast<Entry_*>(e)->description = description;
     }
   }
 
   void MetaInfoRegistry::setUnit(UInt index, const String& unit)
   {
-    MapIndex2StringType::iterator pos;
+    const Entry_* e = find_(index);
+    if (e == nullptr)
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
+    }
 #pragma omp critical (MetaInfoRegistry)
     {
-      pos = index_to_unit_.find(index);
-      if (pos != index_to_unit_.end())
-      {
-        pos->second = unit;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
-      }
+      const_cast<Entry_*>(e)->unit = unit;
     }
   }
 
   void MetaInfoRegistry::setUnit(const String& name, const String& unit)
   {
-    MapString2IndexType::iterator pos;
+    const Entry_* e = find_(name);
+    if (e == nullptr)
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered name!", name);
+    }
 #pragma omp critical (MetaInfoRegistry)
     {
-      pos = name_to_index_.find(name);
-      if (pos != name_to_index_.end())
-      {
-        index_to_unit_[pos->second] = unit;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered name!", name);
-      }
+      const_cast<Entry_*>(e)->unit = unit;
     }
   }
 
   UInt MetaInfoRegistry::getIndex(const String& name) const
   {
-    UInt rv = UInt(-1);
-#pragma omp critical (MetaInfoRegistry)
-    {
-      MapString2IndexType::const_iterator it = name_to_index_.find(name);
-      if (it != name_to_index_.end())
-      {
-        rv = it->second;
-      }
-    }
-    return rv;
+    const Entry_* e = find_(name);
+    return e == nullptr ? UInt(-1) : e->index;
   }
 
   String MetaInfoRegistry::getDescription(UInt index) const
   {
-    String result;
+    const Entry_* e = find_(index);
+    if (e == nullptr)
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
+    }
+    String rv;
 #pragma omp critical (MetaInfoRegistry)
     {
-      MapIndex2StringType::const_iterator it = index_to_description_.find(index);
-      if (it == index_to_description_.end())
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
-      }
-      result = it->second;
+      rv = e->description;
     }
-    return result;
+    return rv;
   }
 
   String MetaInfoRegistry::getDescription(const String& name) const
   {
-    String rv;
-    UInt index = getIndex(name); // this has to be outside the OpenMP "critical" block!
-    if (index == UInt(-1)) // not found
+    const Entry_* e = find_(name);
+    if (e == nullptr)
     {
       throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered Name!", name);
     }
-    else
-    {
+    String rv;
 #pragma omp critical (MetaInfoRegistry)
-      {
-        rv = (index_to_description_.find(index))->second;
-      }
+    {
+      rv = e->description;
     }
     return rv;
   }
 
   String MetaInfoRegistry::getUnit(UInt index) const
   {
-    String result;
+    const Entry_* e = find_(index);
+    if (e == nullptr)
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
+    }
+    String rv;
 #pragma omp critical (MetaInfoRegistry)
     {
-      MapIndex2StringType::const_iterator it = index_to_unit_.find(index);
-      if (it == index_to_unit_.end())
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
-      }
-      result = it->second;
+      rv = e->unit;
     }
-    return result;
+    return rv;
   }
 
   String MetaInfoRegistry::getUnit(const String& name) const
   {
-    String rv;
-    UInt index = getIndex(name); // this has to be outside the OpenMP "critical" block!
-    if (index == UInt(-1)) // not found
+    const Entry_* e = find_(name);
+    if (e == nullptr)
     {
       throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered Name!", name);
     }
-    else
-    {
+    String rv;
 #pragma omp critical (MetaInfoRegistry)
-      {
-        rv = (index_to_unit_.find(index))->second;
-      }
+    {
+      rv = e->unit;
     }
     return rv;
   }
 
   String MetaInfoRegistry::getName(UInt index) const
   {
-    String rv;
-#pragma omp critical (MetaInfoRegistry)
+    // names never change after registration: no lock required
+    const Entry_* e = find_(index);
+    if (e == nullptr)
     {
-      MapIndex2StringType::const_iterator it = index_to_name_.find(index);
-      if (it != index_to_name_.end())
-      {
-        rv = it->second;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
-      }
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
     }
-    return rv;
+    return e->name;
   }
 
 } //namespace
-
@@ -40,6 +40,7 @@
 
 #include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/ChromatogramExtractor.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
 #include <OpenMS/ANALYSIS/SVM/SimpleSVM.h>
 #include <OpenMS/ANALYSIS/MAPMATCHING/MapAlignmentAlgorithmIdentification.h>
@@ -54,6 +55,7 @@
 #include <fstream>
 #include <algorithm>
 #include <random>
+#include <exception>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -75,7 +77,7 @@ namespace OpenMS
     defaults_.setMinInt("debug", 0);
 
     defaults_.setValue("extract:batch_size", 5000, "Nr of peptides used in each batch of chromatogram extraction."
-                         " Smaller values decrease memory usage but increase runtime.");
+                         " Smaller values decrease memory usage but increase runtime. If there are several batches, they are processed in parallel (one per thread).");
     defaults_.setMinInt("extract:batch_size", 1);
     defaults_.setValue("extract:mz_window", 10.0, "m/z window size for chromatogram extraction (unit: ppm if 1 or greater, else Da/Th)");
     defaults_.setMinFloat("extract:mz_window", 0.0);
@@ -305,8 +307,6 @@ namespace OpenMS
     feat_finder_.setParameters(params);
     feat_finder_.setLogType(ProgressLogger::NONE);
     feat_finder_.setStrictFlag(false);
-    // to use MS1 Swath scores:
-    feat_finder_.setMS1Map(SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(boost::make_shared<MSExperiment>(ms_data_)));
 
     double rt_uncertainty(0);
     bool with_external_ids = !peptides_ext.empty();
@@ -450,9 +450,6 @@ namespace OpenMS
     }
     n_external_peps_ = peptide_map_.size() - n_internal_peps_;
 
-    boost::shared_ptr<PeakMap> shared = boost::make_shared<PeakMap>(ms_data_);
-    OpenSwath::SpectrumAccessPtr spec_temp =
-        SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(shared);
     auto chunks = chunk_(peptide_map_.begin(), peptide_map_.end(), batch_size_);
 
     PeptideRefRTMap ref_rt_map;
@@ -461,72 +458,167 @@ namespace OpenMS
       OPENMS_LOG_INFO << "Creating full assay library for debugging." << endl;
       // Warning: this step is pretty inefficient, since it does the whole library generation twice
       // Really use for debug only
-      createAssayLibrary_(peptide_map_.begin(), peptide_map_.end(), ref_rt_map, false);
+      createAssayLibrary_(peptide_map_.begin(), peptide_map_.end(), ref_rt_map, library_, isotope_probs_, false);
       cout << "Writing debug.traml file." << endl;
       FileHandler().storeTransitions("debug.traml", library_);
       ref_rt_map.clear();
       library_.clear(true);
     }
 
+    // All chunks share a single (read-only) spectrum access to the MS1 data,
+    // which is used for chromatogram extraction as well as for the MS1 scores.
+    // The data is moved there instead of being copied, as it is not needed
+    // anymore after feature detection.
+    boost::shared_ptr<PeakMap> shared = boost::make_shared<PeakMap>(std::move(ms_data_));
+    ms_data_.reset();
+    OpenSwath::SpectrumAccessPtr spec_temp =
+        SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(shared);
+    OpenSwath::SwathMap swath_map;
+    swath_map.sptr = spec_temp;
+    const vector<OpenSwath::SwathMap> swath_maps(1, swath_map);
+
     //-------------------------------------------------------------
     // run feature detection
     //-------------------------------------------------------------
-    //Note: progress only works in non-debug when no logs come in-between
-    getProgressLogger().startProgress(0, chunks.size(), "Creating assay library and extracting chromatograms");
-    Size chunk_count = 0;
-    for (auto& chunk : chunks)
+    // Chunks are independent of each other: each one gets its own assay
+    // library, chromatograms and feature finder. With more than one chunk,
+    // the chunks are processed in parallel (OpenSWATH then scores each chunk
+    // single-threaded); the results are merged in chunk order afterwards, so
+    // the output does not depend on the number of threads.
+    vector<FeatureMap> chunk_features(chunks.size());
+    vector<PeptideRefRTMap> chunk_ref_rt_maps(chunks.size());
+    vector<map<String, double> > chunk_isotope_probs(chunks.size());
+    vector<Size> chunk_nr_chromatograms(chunks.size(), 0);
+    std::exception_ptr first_error;
+
+    // first create the assay libraries (status output stays visible here):
+    vector<TargetedExperiment> chunk_libraries(chunks.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) if (chunks.size() > 1)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)chunks.size(); ++i)
     {
-      //TODO since ref_rt_map is only used after chunking, we could create
-      // maps per chunk and merge them in the end. Would help in parallelizing as well.
-      createAssayLibrary_(chunk.first, chunk.second, ref_rt_map);
-      OPENMS_LOG_DEBUG << "#Transitions: " << library_.getTransitions().size() << endl;
-
-      ChromatogramExtractor extractor;
-      // extractor.setLogType(ProgressLogger::NONE);
+      try
       {
-        vector<OpenSwath::ChromatogramPtr> chrom_temp;
-        vector<ChromatogramExtractor::ExtractionCoordinates> coords;
-        // take entries in library_ and put to chrom_temp and coords
-        extractor.prepare_coordinates(chrom_temp, coords, library_,
-                                      numeric_limits<double>::quiet_NaN(), false);
-
-
-        extractor.extractChromatograms(spec_temp, chrom_temp, coords, mz_window_,
-                                       mz_window_ppm_, "tophat");
-        extractor.return_chromatogram(chrom_temp, coords, library_, (*shared)[0],
-                                      chrom_data_.getChromatograms(), false);
+        createAssayLibrary_(chunks[i].first, chunks[i].second, chunk_ref_rt_maps[i], chunk_libraries[i], chunk_isotope_probs[i]);
       }
+      catch (...)
+      {
+#ifdef _OPENMP
+#pragma omp critical (FeatureFinderIdentificationAlgorithm_error)
+#endif
+        if (!first_error) first_error = std::current_exception();
+      }
+    }
+    if (first_error)
+    {
+      std::rethrow_exception(first_error);
+    }
+    for (const TargetedExperiment& library : chunk_libraries)
+    {
+      OPENMS_LOG_DEBUG << "#Transitions: " << library.getTransitions().size() << endl;
+    }
 
-      OPENMS_LOG_DEBUG << "Extracted " << chrom_data_.getNrChromatograms()
-                       << " chromatogram(s)." << endl;
-
-      OPENMS_LOG_DEBUG << "Detecting chromatographic peaks..." << endl;
-      // suppress status output from OpenSWATH, unless in debug mode:
-      if (debug_level_ < 1)
+    // suppress status output from OpenSWATH, unless in debug mode:
+    if (debug_level_ < 1)
+    {
+      OpenMS_Log_info.remove(cout);
+    }
+    OPENMS_LOG_DEBUG << "Extracting chromatograms and detecting chromatographic peaks..." << endl;
+    //Note: progress only works in non-debug when no logs come in-between
+    getProgressLogger().startProgress(0, chunks.size(), "Extracting chromatograms and detecting peaks");
+    Size chunk_count = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) if (chunks.size() > 1)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)chunks.size(); ++i)
+    {
+      try
       {
-        OpenMS_Log_info.remove(cout);
+        TargetedExperiment library = std::move(chunk_libraries[i]);
+
+        // a light clone shares the spectra, but not the state of the access:
+        OpenSwath::SpectrumAccessPtr chunk_access = spec_temp->lightClone();
+        boost::shared_ptr<PeakMap> chrom_data = boost::make_shared<PeakMap>();
+        {
+          ChromatogramExtractor extractor;
+          vector<OpenSwath::ChromatogramPtr> chrom_temp;
+          vector<ChromatogramExtractor::ExtractionCoordinates> coords;
+          // take entries in library and put to chrom_temp and coords
+          extractor.prepare_coordinates(chrom_temp, coords, library,
+                                        numeric_limits<double>::quiet_NaN(), false);
+
+          extractor.extractChromatograms(chunk_access, chrom_temp, coords, mz_window_,
+                                         mz_window_ppm_, "tophat");
+          extractor.return_chromatogram(chrom_temp, coords, library, (*shared)[0],
+                                        chrom_data->getChromatograms(), false);
+        }
+        chunk_nr_chromatograms[i] = chrom_data->getNrChromatograms();
+
+        OpenSwath::LightTargetedExperiment light_library;
+        OpenSwathDataAccessHelper::convertTargetedExp(library, light_library);
+        library.clear(true);
+        MRMFeatureFinderScoring::TransitionGroupMapType transition_group_map;
+        MRMFeatureFinderScoring chunk_feat_finder;
+        chunk_feat_finder.setParameters(feat_finder_.getParameters());
+        chunk_feat_finder.setLogType(ProgressLogger::NONE);
+        chunk_feat_finder.setStrictFlag(false);
+        // to use MS1 Swath scores:
+        chunk_feat_finder.setMS1Map(spec_temp);
+        chunk_feat_finder.pickExperiment(SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(chrom_data),
+                                         chunk_features[i], light_library, TransformationDescription(),
+                                         swath_maps, transition_group_map);
+        // since the chromatograms here are just a container and identifications will be empty,
+        // pickExperiment above will only add an empty ProteinIdentification run. Usually we could
+        // sanitize the identifiers or merge the runs, but since they are empty and we add the
+        // "real" proteins later -> just clear them
+        chunk_features[i].getProteinIdentifications().clear();
       }
-      feat_finder_.pickExperiment(chrom_data_, features, library_,
-                                  TransformationDescription(), ms_data_);
-      if (debug_level_ < 1)
+      catch (...)
       {
-        OpenMS_Log_info.insert(cout); // revert logging change
+#ifdef _OPENMP
+#pragma omp critical (FeatureFinderIdentificationAlgorithm_error)
+#endif
+        if (!first_error) first_error = std::current_exception();
       }
-      chrom_data_.clear(true);
-      library_.clear(true);
-      // since chrom_data_ here is just a container for the chromatograms and identifications will be empty,
-      // pickExperiment above will only add empty ProteinIdentification runs with colliding identifiers.
-      // Usually we could sanitize the identifiers or merge the runs, but since they are empty and we add the
-      // "real" proteins later -> just clear them
-      features.getProteinIdentifications().clear();
+#ifdef _OPENMP
+#pragma omp critical (FeatureFinderIdentificationAlgorithm_progress)
+#endif
       getProgressLogger().setProgress(++chunk_count);
     }
     getProgressLogger().endProgress();
+    if (debug_level_ < 1)
+    {
+      OpenMS_Log_info.insert(cout); // revert logging change
+    }
+    if (first_error)
+    {
+      std::rethrow_exception(first_error);
+    }
+    for (Size nr_chromatograms : chunk_nr_chromatograms)
+    {
+      OPENMS_LOG_DEBUG << "Extracted " << nr_chromatograms << " chromatogram(s)." << endl;
+    }
+
+    // merge the per-chunk results in chunk order (peptide refs of different
+    // chunks are disjoint):
+    for (Size i = 0; i < chunks.size(); ++i)
+    {
+      ref_rt_map.insert(chunk_ref_rt_maps[i].begin(), chunk_ref_rt_maps[i].end());
+      isotope_probs_.insert(chunk_isotope_probs[i].begin(), chunk_isotope_probs[i].end());
+      for (Feature& feature : chunk_features[i])
+      {
+        features.push_back(std::move(feature));
+      }
+      chunk_features[i].clear(true);
+    }
 
     OPENMS_LOG_INFO << "Found " << features.size() << " feature candidates in total."
                     << endl;
 
-    ms_data_.reset(); // not needed anymore, free up the memory
+    // not needed anymore, free up the memory:
+    spec_temp.reset();
+    shared.reset();
     // complete feature annotation:
     annotateFeatures_(features, ref_rt_map);
 
@@ -746,7 +838,8 @@ namespace OpenMS
 
   }
 
-  void FeatureFinderIdentificationAlgorithm::createAssayLibrary_(const PeptideMap::iterator& begin, const PeptideMap::iterator& end, PeptideRefRTMap& ref_rt_map, bool clear_IDs)
+  void FeatureFinderIdentificationAlgorithm::createAssayLibrary_(const PeptideMap::iterator& begin, const PeptideMap::iterator& end, PeptideRefRTMap& ref_rt_map,
+                                                                 TargetedExperiment& library, std::map<String, double>& isotope_probs, bool clear_IDs) const
   {
     std::set<String> protein_accessions;
 
@@ -821,8 +914,8 @@ namespace OpenMS
             peptide.rts.clear();
             addPeptideRT_(peptide, rt - rt_tolerance);
             addPeptideRT_(peptide, rt + rt_tolerance);
-            library_.addPeptide(peptide);
-            generateTransitions_(peptide.id, mz, charge, iso_dist);
+            library.addPeptide(peptide);
+            generateTransitions_(peptide.id, mz, charge, iso_dist, library, isotope_probs);
             internal_ids.emplace(rt_pep);
           }
         }
@@ -872,6 +965,9 @@ namespace OpenMS
           Int charge = cm_it->first;
 
           double mz = seq.getMZ(charge);
+#ifdef _OPENMP
+#pragma omp critical (LOG_DEBUG_access)
+#endif
           OPENMS_LOG_DEBUG << "\nPeptide " << peptide.sequence << "/" << charge << " (m/z: " << mz << "):" << endl;
           peptide.setChargeState(charge);
           String peptide_id = peptide.sequence + "/" + String(charge);
@@ -888,6 +984,9 @@ namespace OpenMS
           {
             if (reg.ids.count(charge))
             {
+#ifdef _OPENMP
+#pragma omp critical (LOG_DEBUG_access)
+#endif
               OPENMS_LOG_DEBUG_NOFILE << "Charge " << charge << ", Region# " << counter + 1 << " (RT: "
                                << float(reg.start) << "-" << float(reg.end)
                                << ", size " << float(reg.end - reg.start) << ")"
@@ -901,8 +1000,8 @@ namespace OpenMS
               peptide.rts.clear();
               addPeptideRT_(peptide, reg.start);
               addPeptideRT_(peptide, reg.end);
-              library_.addPeptide(peptide);
-              generateTransitions_(peptide.id, mz, charge, iso_dist);
+              library.addPeptide(peptide);
+              generateTransitions_(peptide.id, mz, charge, iso_dist, library, isotope_probs);
             }
             internal_ids.insert(reg.ids[charge].first.begin(),
                                 reg.ids[charge].first.end());
@@ -917,7 +1016,7 @@ namespace OpenMS
     {
       TargetedExperiment::Protein protein;
       protein.id = acc;
-      library_.addProtein(protein);
+      library.addProtein(protein);
     }
   }
 
@@ -1004,7 +1103,9 @@ namespace OpenMS
     const String& peptide_id, 
     double mz, 
     Int charge,
-    const IsotopeDistribution& iso_dist)
+    const IsotopeDistribution& iso_dist,
+    TargetedExperiment& library,
+    std::map<String, double>& isotope_probs) const
   {
     // go through different isotopes:
     Size counter = 0;
@@ -1022,8 +1123,8 @@ namespace OpenMS
       transition.setPeptideRef(peptide_id);
 
       //TODO what about transition charge? A lot of DIA scores depend on it and default to charge 1 otherwise.
-      library_.addTransition(transition);
-      isotope_probs_[transition_name] = iso.getIntensity();
+      library.addTransition(transition);
+      isotope_probs[transition_name] = iso.getIntensity();
       ++counter;
     }
   }
@@ -41,7 +41,14 @@
 #include <OpenMS/MATH/MISC/SplineBisection.h>
 #include <OpenMS/MATH/MISC/CubicSpline2d.h>
 #include <OpenMS/KERNEL/SpectrumHelper.h>
+#include <OpenMS/KERNEL/SpectrumArrays.h>
+#include <OpenMS/IONMOBILITY/IMDataConverter.h>
 
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace std;
 
@@ -124,6 +131,36 @@ namespace OpenMS
     pick_(input, output, boundaries, check_spacings);
   }
 
+  namespace
+  {
+    /// index of the ion mobility float data array of a SpectrumArrays (or -1 if there is none)
+    template <typename MZType>
+    int getIMIndex(const SpectrumArrays<MZType>& input)
+    {
+      DriftTimeUnit unit;
+      for (Size i = 0; i < input.getFloatDataArrays().size(); ++i)
+      {
+        if (IMDataConverter::getIMUnit(input.getFloatDataArrays()[i], unit))
+        {
+          return int(i);
+        }
+      }
+      return -1;
+    }
+  }
+
+  void PeakPickerHiRes::pick(const SpectrumArrays<double>& input, SpectrumArrays<double>& output, std::vector<PeakBoundary>& boundaries, bool check_spacings) const
+  {
+    output.clear();
+    pick_(input, output, boundaries, check_spacings, getIMIndex(input));
+  }
+
+  void PeakPickerHiRes::pick(const SpectrumArrays<float>& input, SpectrumArrays<float>& output, std::vector<PeakBoundary>& boundaries, bool check_spacings) const
+  {
+    output.clear();
+    pick_(input, output, boundaries, check_spacings, getIMIndex(input));
+  }
+
   template <typename ContainerType>
   void PeakPickerHiRes::pick_(const ContainerType& input,
                               ContainerType& output,
@@ -547,7 +584,7 @@ namespace OpenMS
     return;
   }
 
-  void PeakPickerHiRes::pickExperiment(/* const */ OnDiscMSExperiment& input, PeakMap& output, const bool check_spectrum_type) const
+  void PeakPickerHiRes::pickExperiment(const OnDiscMSExperiment& input, PeakMap& output, const bool check_spectrum_type) const
   {
     // make sure that output is clear
     output.clear(true);
@@ -561,56 +598,103 @@ namespace OpenMS
     // resize output with respect to input
     output.resize(input.size());
 
-    if (input.getNrSpectra() > 0)
+    // Each spectrum is read, decoded and picked independently. Concurrent
+    // access by index is safe on OnDiscMSExperiment, so only one spectrum per
+    // thread is kept in memory at any time.
+    // exceptions must not escape the parallel regions: the first one is kept and rethrown afterwards
+    Size err_count = 0;
+    std::exception_ptr exception;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (SignedSize scan_idx = 0; scan_idx < (SignedSize)input.size(); ++scan_idx)
     {
-      for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+      // parallel exception catching and re-throwing business
+      if (err_count) continue; // no need to continue if an error was encountered
+
+      try
       {
-        if (ms_levels_.empty()) //auto mode
+        MSSpectrum s = input.getSpectrum(scan_idx);
+        if (!ms_levels_.empty() && !ListUtils::contains(ms_levels_, s.getMSLevel())) // manual mode
         {
-          MSSpectrum s = input[scan_idx];
+          output[scan_idx] = std::move(s);
+        }
+        else
+        {
+          bool was_sorted = s.isSorted();
           s.sortByPosition();
 
           // determine type of spectral data (profile or centroided)
-          SpectrumSettings::SpectrumType spectrumType = s.getType();
-          if (spectrumType == SpectrumSettings::CENTROID)
+          SpectrumSettings::SpectrumType spectrum_type = s.getType();
+          if (spectrum_type == SpectrumSettings::CENTROID && ms_levels_.empty()) // auto mode
           {
-            output[scan_idx] = input[scan_idx];
+            // centroided spectra are passed through unchanged
+            output[scan_idx] = was_sorted ? std::move(s) : input.getSpectrum(scan_idx);
           }
           else
           {
+            if (spectrum_type == SpectrumSettings::CENTROID && check_spectrum_type)
+            {
+              throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
+            }
             pick(s, output[scan_idx]);
           }
         }
-        else if (!ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel())) // manual mode
+      }
+      catch (...)
+      {
+#ifdef _OPENMP
+#pragma omp critical (PeakPickerHiResErrorHandling)
+#endif
         {
-          output[scan_idx] = input[scan_idx];
+          if (err_count++ == 0) exception = std::current_exception();
         }
-        else
-        {
-          MSSpectrum s = input[scan_idx];
-          s.sortByPosition();
+      }
 
-          // determine type of spectral data (profile or centroided)
-          SpectrumSettings::SpectrumType spectrum_type = s.getType();
+      IF_MASTERTHREAD setProgress(progress);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+      ++progress;
+    }
+    if (exception)
+    {
+      std::rethrow_exception(exception);
+    }
 
-          if (spectrum_type == SpectrumSettings::CENTROID && check_spectrum_type)
-          {
-            throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
-          }
+    std::vector<MSChromatogram> chromatograms(input.getNrChromatograms());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)chromatograms.size(); ++i)
+    {
+      if (err_count) continue; // no need to continue if an error was encountered
 
-          pick(s, output[scan_idx]);
+      try
+      {
+        pick(input.getChromatogram(i), chromatograms[i]);
+      }
+      catch (...)
+      {
+#ifdef _OPENMP
+#pragma omp critical (PeakPickerHiResErrorHandling)
+#endif
+        {
+          if (err_count++ == 0) exception = std::current_exception();
         }
-        setProgress(++progress);
       }
-    }
 
-    for (Size i = 0; i < input.getNrChromatograms(); ++i)
+      IF_MASTERTHREAD setProgress(progress);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+      ++progress;
+    }
+    if (exception)
     {
-      MSChromatogram chromatogram;
-      pick(input.getChromatogram(i), chromatogram);
-      output.addChromatogram(chromatogram);
-      setProgress(++progress);
+      std::rethrow_exception(exception);
     }
+    output.setChromatograms(std::move(chromatograms));
     endProgress();
 
     return;
@@ -69,6 +69,30 @@ public:
 
     /// Return a pointer to a spectrum at the given id
     virtual SpectrumPtr getSpectrumById(int id) = 0;
+
+    /**
+      @brief Fill the given spectrum with the data of the spectrum at the given id
+
+      In contrast to getSpectrumById, the data arrays already present in
+      @p spectrum (and the memory they hold) are reused. Repeatedly filling
+      the same spectrum does therefore not allocate once its arrays have
+      grown large enough, which makes this the preferred method for loops
+      over many spectra. The data arrays of @p spectrum must not be shared
+      with other spectra.
+
+      The default implementation copies the data returned by getSpectrumById.
+    */
+    virtual void fillSpectrumById(int id, Spectrum& spectrum);
+
+    /**
+      @brief Whether getSpectrumById hands out spectra held by this object
+
+      If true, getSpectrumById neither reads nor copies any data and is
+      cheaper than fillSpectrumById, which would have to copy the spectrum.
+      The default implementation returns false.
+    */
+    virtual bool hasStableSpectra() const;
+
     /// Return a vector of ids of spectra that are within RT +/- deltaRT
     virtual std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const = 0;
     /// Returns the number of spectra available
@@ -82,6 +106,10 @@ public:
     virtual std::size_t getNrChromatograms() const = 0;
     /// Returns the native id of the chromatogram at the given id
     virtual std::string getChromatogramNativeID(int id) const = 0;
+
+protected:
+    /// Resize the data arrays of @p spectrum to @p nr_arrays, keeping existing arrays and allocating missing ones
+    static void prepareDataArrays_(Spectrum& spectrum, std::size_t nr_arrays);
   };
 
   typedef boost::shared_ptr<ISpectrumAccess> SpectrumAccessPtr;
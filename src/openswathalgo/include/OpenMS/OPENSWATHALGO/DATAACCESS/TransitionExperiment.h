@@ -37,6 +37,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 #include <OpenMS/OPENSWATHALGO/OpenSwathAlgoConfig.h>
 
@@ -276,6 +277,7 @@ public:
 
     void createPeptideReferenceMap_()
     {
+      compound_reference_map_.reserve(getCompounds().size());
       for (size_t i = 0; i < getCompounds().size(); i++)
       {
         compound_reference_map_[getCompounds()[i].id] = &getCompounds()[i];
@@ -285,7 +287,7 @@ public:
 
     // Map of compounds (peptides or metabolites)
     bool compound_reference_map_dirty_;
-    std::map<std::string, LightCompound*> compound_reference_map_;
+    std::unordered_map<std::string, LightCompound*> compound_reference_map_;
 
   };
 
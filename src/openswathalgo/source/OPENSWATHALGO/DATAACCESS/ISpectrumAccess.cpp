@@ -41,4 +41,43 @@ namespace OpenSwath
   {
   }
 
+  void ISpectrumAccess::fillSpectrumById(int id, Spectrum& spectrum)
+  {
+    SpectrumPtr s = getSpectrumById(id);
+    const std::vector<BinaryDataArrayPtr>& arrays = s->getDataArrays();
+    prepareDataArrays_(spectrum, arrays.size());
+    for (std::size_t k = 0; k < arrays.size(); ++k)
+    {
+      BinaryDataArray& target = *spectrum.getDataArrays()[k];
+      if (arrays[k])
+      {
+        target.data.assign(arrays[k]->data.begin(), arrays[k]->data.end());
+        target.description = arrays[k]->description;
+      }
+      else
+      {
+        target.data.clear();
+        target.description.clear();
+      }
+    }
+  }
+
+  bool ISpectrumAccess::hasStableSpectra() const
+  {
+    return false;
+  }
+
+  void ISpectrumAccess::prepareDataArrays_(Spectrum& spectrum, std::size_t nr_arrays)
+  {
+    std::vector<BinaryDataArrayPtr>& arrays = spectrum.getDataArrays();
+    arrays.resize(nr_arrays);
+    for (BinaryDataArrayPtr& array : arrays)
+    {
+      if (!array)
+      {
+        array.reset(new BinaryDataArray);
+      }
+    }
+  }
+
 }
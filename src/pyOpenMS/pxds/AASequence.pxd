@@ -135,3 +135,12 @@ cdef extern from "<OpenMS/CHEMISTRY/AASequence.h>" namespace "OpenMS::AASequence
         
         # static members
         AASequence fromString(String s) nogil except +  # wrap-attach:AASequence
+
+        # static members
+        void setParseCacheSize(Size max_entries) nogil except +  # wrap-attach:AASequence wrap-doc:Set the maximal number of parsed sequences kept by fromString (0 disables the cache)
+
+        # static members
+        Size getParseCacheSize() nogil except +  # wrap-attach:AASequence
+
+        # static members
+        void clearParseCache() nogil except +  # wrap-attach:AASequence
@@ -1,4 +1,5 @@
 from libcpp cimport bool
+from libcpp.vector cimport vector as libcpp_vector
 from Types cimport *
 from String cimport *
 from Peak1D cimport *
@@ -119,6 +120,8 @@ cdef extern from "<OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/CoarseIsotopePatternGene
         #   "Determination of Monoisotopic Masses and Ion Populations for Large Biomolecules from Resolved Isotopic Distributions"
         IsotopeDistribution estimateFromPeptideWeight(double average_weight) nogil except + # wrap-doc:Estimate Peptide Isotopedistribution from weight and number of isotopes that should be reported
 
+        libcpp_vector[IsotopeDistribution] estimateFromPeptideWeight(libcpp_vector[double] average_weights) nogil except + # wrap-doc:Estimate Peptide Isotopedistributions for a batch of weights (same results as calling estimateFromPeptideWeight for each weight)
+
         IsotopeDistribution estimateFromPeptideWeightAndS(double average_weight, UInt S) nogil except + # wrap-doc:Estimate peptide IsotopeDistribution from average weight and exact number of sulfurs
 
         IsotopeDistribution estimateFromRNAWeight(double average_weight) nogil except + # wrap-doc:Estimate Nucleotide Isotopedistribution from weight
@@ -8,6 +8,7 @@ cdef extern from "<OpenMS/FORMAT/DATAACCESS/MSDataSqlConsumer.h>" namespace "Ope
     cdef cppclass MSDataSqlConsumer:
 
         MSDataSqlConsumer(String filename, UInt64 run_id, int buffer_size, bool full_meta, bool lossy_compression, double linear_mass_acc) nogil except +
+        MSDataSqlConsumer(String filename, UInt64 run_id, int buffer_size, bool full_meta, bool lossy_compression, double linear_mass_acc, Size chrom_block_size) nogil except +
         MSDataSqlConsumer(MSDataSqlConsumer &) nogil except + # compiler
 
         void flush() nogil except +
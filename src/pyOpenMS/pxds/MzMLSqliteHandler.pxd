@@ -52,7 +52,9 @@ cdef extern from "<OpenMS/FORMAT/HANDLERS/MzMLSqliteHandler.h>" namespace "OpenM
                 #   :param write_full_meta: Whether to write a complete mzML meta data structure into the RUN_EXTRA field (allows complete recovery of the input file)
                 #   :param use_lossy_compression: Whether to use lossy compression (ms numpress)
                 #   :param linear_abs_mass_acc: Accepted loss in mass accuracy (absolute m/z, in Th)
-  
+
+        void setChromatogramBlockSize(Size block_size) nogil except + # wrap-doc:Sets the number of chromatograms compressed together into one data block (0 stores each chromatogram individually)
+
         libcpp_vector[size_t] getSpectraIndicesbyRT(double RT, double deltaRT, libcpp_vector[int] indices) nogil except +
             # wrap-doc:
                 #   Returns spectral indices around a specific retention time
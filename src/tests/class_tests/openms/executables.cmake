@@ -168,6 +168,7 @@ set(kernel_executables_list
   RangeUtils_test
   RichPeak2D_test
   StandardTypes_test
+  SpectrumArrays_test
   SpectrumHelper_test
 )
 
@@ -277,7 +278,9 @@ set(format_executables_list
   MSDataChainingConsumer_test
   MSDataStoringConsumer_test
   MSDataAggregatingConsumer_test
+  MSDataSqlConsumer_test
   SpectrumAccessQuadMZTransforming_test
+  SpectrumAccessLRUCache_test
   SpectrumAccessSqMass_test
   SiriusFragmentAnnotation_test
 )
@@ -491,6 +494,7 @@ set(analysis_executables_list
   FeatureHandle_test
   FIAMSDataProcessor_test
   FIAMSScheduler_test
+  FragmentIndex_test
   HiddenMarkovModel_test
   IDBoostGraph_test
   IDMapper_test
@@ -681,6 +685,7 @@ if(NOT DISABLE_OPENSWATH)
     OpenSwathHelper_test
     OpenSwathScoring_test
     OpenSwathScores_test
+    OpenSwathOSWWriter_test
     PeakIntegrator_test
     PeakPickerMRM_test
     MRMTransitionGroupPicker_test
@@ -705,6 +710,7 @@ if(NOT DISABLE_OPENSWATH)
     IonMobilityScoring_test
     CachedMzML_test
     CachedMzMLHandler_test
+    SpectrumAccessOpenMSCachedMapped_test
     HDF5_test
   )
 endif(NOT DISABLE_OPENSWATH)
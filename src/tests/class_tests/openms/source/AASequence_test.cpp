@@ -322,6 +322,59 @@ START_SECTION(([EXTRA]Test modifications with brackets))
   TEST_EQUAL(seq2.isModified(), true)
 END_SECTION
 
+START_SECTION(([EXTRA]Parse cache of fromString))
+  // repeated parsing is served from the cache and yields equal, independent copies
+  AASequence seq1 = AASequence::fromString("PEPM(Oxidation)TIDE");
+  AASequence seq2 = AASequence::fromString("PEPM(Oxidation)TIDE");
+  TEST_EQUAL(seq1, seq2)
+  seq1.setModification(0, "Phospho");
+  TEST_EQUAL(AASequence::fromString("PEPM(Oxidation)TIDE"), seq2)
+  TEST_EQUAL(AASequence::fromString("PEPM(Oxidation)TIDE").toString(), "PEPM(Oxidation)TIDE")
+
+  // the 'permissive' flag is part of the key
+  TEST_EQUAL(AASequence::fromString("PEP*TIDE", true).toString(), "PEPXTIDE")
+  TEST_EXCEPTION(Exception::ParseError, AASequence::fromString("PEP*TIDE", false))
+  TEST_EQUAL(AASequence::fromString("PEP*TIDE", true).toString(), "PEPXTIDE")
+
+  // unknown mass deltas add a modification to ModificationsDB, which invalidates the cache
+  AASequence seq3 = AASequence::fromString("PEPT[+1234.5678]IDE");
+  AASequence seq4 = AASequence::fromString("PEPT[+1234.5678]IDE");
+  TEST_EQUAL(seq3, seq4)
+  TEST_REAL_SIMILAR(seq3.getMonoWeight(), seq4.getMonoWeight())
+END_SECTION
+
+START_SECTION(static void setParseCacheSize(Size max_entries))
+  TEST_EQUAL(AASequence::getParseCacheSize(), 100000)
+  // least recently used sequences are evicted, results stay the same
+  AASequence::setParseCacheSize(16);
+  TEST_EQUAL(AASequence::getParseCacheSize(), 16)
+  String residues = "ACDEFGHIKLMNPQRSTVWY";
+  for (Size round = 0; round < 2; ++round)
+  {
+    for (Size i = 0; i < residues.size(); ++i)
+    {
+      String peptide = "PEP" + residues.substr(i) + "M(Oxidation)K";
+      TEST_EQUAL(AASequence::fromString(peptide).toString(), peptide)
+    }
+  }
+  // disabled cache
+  AASequence::setParseCacheSize(0);
+  TEST_EQUAL(AASequence::getParseCacheSize(), 0)
+  TEST_EQUAL(AASequence::fromString("PEPM(Oxidation)TIDE").toString(), "PEPM(Oxidation)TIDE")
+  TEST_EQUAL(AASequence::fromString("PEPM(Oxidation)TIDE").toString(), "PEPM(Oxidation)TIDE")
+  AASequence::setParseCacheSize(100000);
+END_SECTION
+
+START_SECTION(static Size getParseCacheSize())
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION(static void clearParseCache())
+  AASequence seq = AASequence::fromString("PEPTIDEK");
+  AASequence::clearParseCache();
+  TEST_EQUAL(AASequence::fromString("PEPTIDEK"), seq)
+END_SECTION
+
 START_SECTION(bool operator==(const AASequence& rhs) const)
   AASequence seq1 = AASequence::fromString("(Acetyl)DFPIANGER");
   AASequence seq2 = AASequence::fromString("DFPIANGER");
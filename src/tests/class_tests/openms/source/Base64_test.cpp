@@ -502,6 +502,78 @@ END_SECTION
 
 ptr = new Base64;
 
+START_SECTION((static SIMDLevel getSupportedSIMDLevel()))
+{
+  Base64::SIMDLevel level = Base64::getSupportedSIMDLevel();
+  TEST_EQUAL(level >= Base64::SIMD_NONE && level <= Base64::SIMD_AVX2, true)
+  // detected once
+  TEST_EQUAL(Base64::getSupportedSIMDLevel(), level)
+}
+END_SECTION
+
+START_SECTION((static Size decodeBytes(const char* in, Size in_size, Byte* out, Size out_size, SIMDLevel level)))
+{
+  // "Hello Base64" (12 bytes, no padding)
+  String src = "SGVsbG8gQmFzZTY0";
+  std::vector<Byte> out(12);
+  TEST_EQUAL(Base64::decodeBytes(src.c_str(), src.size(), &out[0], out.size(), Base64::SIMD_NONE), 12)
+  TEST_EQUAL(String(out.begin(), out.end()), "Hello Base64")
+
+  // output smaller than input
+  TEST_EQUAL(Base64::decodeBytes(src.c_str(), src.size(), &out[0], 5, Base64::SIMD_NONE), 5)
+  TEST_EQUAL(String(out.begin(), out.begin() + 5), "Hello")
+
+  // "Hi!!!" without the padding
+  src = "SGkhISE";
+  TEST_EQUAL(Base64::decodeBytes(src.c_str(), src.size(), &out[0], out.size(), Base64::SIMD_NONE), 5)
+  TEST_EQUAL(String(out.begin(), out.begin() + 5), "Hi!!!")
+
+  // all vectorized decoders need to produce the same result as the scalar one
+  // (different lengths to test remainders of 16 / 32 character blocks)
+  for (Size n : {1, 17, 100, 1000, 10001})
+  {
+    std::vector<double> data(n);
+    for (Size i = 0; i < n; ++i)
+    {
+      data[i] = i * 1.0001 + (double)UniqueIdGenerator::getUniqueId();
+    }
+    std::vector<double> tmp = data;
+    String encoded;
+    Base64::encode(tmp, Base64::BYTEORDER_LITTLEENDIAN, encoded);
+
+    std::vector<Byte> expected(n * sizeof(double));
+    Size written = Base64::decodeBytes(encoded.c_str(), encoded.size() - (encoded.hasSuffix("==") ? 2 : (encoded.hasSuffix("=") ? 1 : 0)),
+                                       &expected[0], expected.size(), Base64::SIMD_NONE);
+    TEST_EQUAL(written, n * sizeof(double))
+
+    for (int level = Base64::SIMD_NONE; level <= Base64::getSupportedSIMDLevel(); ++level)
+    {
+      std::vector<double> decoded;
+      Base64::decode(encoded, Base64::BYTEORDER_LITTLEENDIAN, decoded);
+      TEST_EQUAL(decoded == data, true)
+
+      std::vector<Byte> bytes(n * sizeof(double));
+      written = Base64::decodeBytes(encoded.c_str(), encoded.size(), &bytes[0], bytes.size(), (Base64::SIMDLevel)level);
+      TEST_EQUAL(written, n * sizeof(double))
+      TEST_EQUAL(bytes == expected, true)
+    }
+  }
+
+//  // for quick benchmarking of the decoders (compare the runtime of the different levels)
+//  std::vector<double> bench(1e6, 1234.5678);
+//  String bench_encoded;
+//  Base64::encode(bench, Base64::BYTEORDER_LITTLEENDIAN, bench_encoded);
+//  std::vector<Byte> bench_out(1e6 * sizeof(double));
+//  for (int level = Base64::SIMD_NONE; level <= Base64::getSupportedSIMDLevel(); ++level)
+//  {
+//    for (Size i = 0; i != 1e3; ++i)
+//    {
+//      Base64::decodeBytes(bench_encoded.c_str(), bench_encoded.size(), &bench_out[0], bench_out.size(), (Base64::SIMDLevel)level);
+//    }
+//  }
+}
+END_SECTION
+
 START_SECTION(inline UInt32 endianize32(const UInt32& n))
   TEST_EQUAL(0, endianize32(0))  // swapping 0 should do nothing
   TEST_EQUAL(std::numeric_limits<UInt32>::max(), endianize32(std::numeric_limits<UInt32>::max()))  // swapping MAX should do nothing
@@ -540,6 +540,64 @@ START_SECTION([EXTRA]void extract_value_tophat(const std::vector< double >::cons
 }
 END_SECTION
 
+START_SECTION(void extract_values_tophat(const std::vector<double>& mz_array, const std::vector<double>& int_array, const std::vector<double>& im_array, const std::vector<double>& mz, const std::vector<double>& im, std::vector<double>& integrated_intensities, const double mz_extraction_window, const double im_extraction_window, const bool ppm))
+{
+  std::vector<double> mz (mz_arr, mz_arr + sizeof(mz_arr) / sizeof(mz_arr[0]) );
+  std::vector<double> intensities (int_arr, int_arr + sizeof(int_arr) / sizeof(int_arr[0]) );
+  std::vector<double> ion_mobility (im_arr, im_arr + sizeof(im_arr) / sizeof(im_arr[0]) );
+
+  ChromatogramExtractorAlgorithm extractor;
+  std::vector<double> targets = {399.805, 399.91, 400.0, 400.05, 400.1, 400.28, 500.0, 600.0};
+  std::vector<double> result;
+
+  // the SIMD summation may round differently than the sequential walker
+  TOLERANCE_RELATIVE(1 + 1e-12)
+
+  // same as repeated calls of extract_value_tophat (m/z only)
+  for (bool ppm : {false, true})
+  {
+    double extract_window = ppm ? 500 : 0.2;
+    extractor.extract_values_tophat(mz, intensities, std::vector<double>(), targets, std::vector<double>(), result, extract_window, -1, ppm);
+    TEST_EQUAL(result.size(), targets.size())
+
+    std::vector<double>::const_iterator mz_it = mz.begin();
+    std::vector<double>::const_iterator int_it = intensities.begin();
+    for (Size k = 0; k < targets.size(); ++k)
+    {
+      double integrated_intensity = 0;
+      extractor.extract_value_tophat(mz.begin(), mz_it, mz.end(), int_it, targets[k], integrated_intensity, extract_window, ppm);
+      TEST_REAL_SIMILAR(result[k], integrated_intensity)
+    }
+  }
+
+  // same as repeated calls of extract_value_tophat (m/z and ion mobility)
+  {
+    std::vector<double> targets_im(targets.size(), 100.0);
+    targets_im[6] = 300.1;
+    targets_im[7] = 300.1;
+    extractor.extract_values_tophat(mz, intensities, ion_mobility, targets, targets_im, result, 0.2, 0.3, false);
+    TEST_EQUAL(result.size(), targets.size())
+
+    std::vector<double>::const_iterator mz_it = mz.begin();
+    std::vector<double>::const_iterator int_it = intensities.begin();
+    std::vector<double>::const_iterator im_it = ion_mobility.begin();
+    for (Size k = 0; k < targets.size(); ++k)
+    {
+      double integrated_intensity = 0;
+      extractor.extract_value_tophat(mz.begin(), mz_it, mz.end(), int_it, im_it, targets[k], targets_im[k], integrated_intensity, 0.2, 0.3, false);
+      TEST_REAL_SIMILAR(result[k], integrated_intensity)
+    }
+    TEST_REAL_SIMILAR(result[3], 4100.0)
+    TEST_REAL_SIMILAR(result[6], 10.0)
+  }
+  TOLERANCE_RELATIVE(1 + 1e-5)
+
+  // unsorted targets
+  std::vector<double> unsorted = {400.1, 400.0};
+  TEST_EXCEPTION(Exception::IllegalArgument, extractor.extract_values_tophat(mz, intensities, std::vector<double>(), unsorted, std::vector<double>(), result, 0.2, -1, false))
+}
+END_SECTION
+
 START_SECTION( [ChromatogramExtractorAlgorithm::ExtractionCoordinates] static bool SortExtractionCoordinatesByMZ(const ChromatogramExtractorAlgorithm::ExtractionCoordinates &left, const ChromatogramExtractorAlgorithm::ExtractionCoordinates &right))    
 {
   NOT_TESTABLE
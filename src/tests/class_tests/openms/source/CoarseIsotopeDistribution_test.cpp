@@ -291,6 +291,28 @@ START_SECTION(IsotopeDitribution CoarseIsotopePatternGenerator::estimateFromPept
 }
 END_SECTION
 
+START_SECTION(std::vector<IsotopeDistribution> estimateFromPeptideWeight(const std::vector<double>& average_weights))
+{
+  // repeated weights and weights mapping to the same averagine formula are served from the cache
+  std::vector<double> weights = {100.0, 1000.0, 1000.0, 1000.2, 2500.0, 10000.0, 100.0};
+  for (bool round_masses : {false, true})
+  {
+    CoarseIsotopePatternGenerator gen(5, round_masses);
+    std::vector<IsotopeDistribution> batch = gen.estimateFromPeptideWeight(weights);
+    TEST_EQUAL(batch.size(), weights.size())
+    for (Size i = 0; i < weights.size(); ++i)
+    {
+      // must be identical to the uncached computation
+      EmpiricalFormula ef;
+      ef.estimateFromWeightAndComp(weights[i], 4.9384, 7.7583, 1.3577, 1.4773, 0.0417, 0);
+      IsotopeDistribution uncached = ef.getIsotopeDistribution(gen);
+      TEST_EQUAL(batch[i] == uncached, true)
+      TEST_EQUAL(gen.estimateFromPeptideWeight(weights[i]) == uncached, true)
+    }
+  }
+}
+END_SECTION
+
 START_SECTION(IsotopeDitribution CoarseIsotopePatternGenerator::approximateFromPeptideWeight(double mass, int num_peaks))
 {
   std::vector<float> masses_to_test = {20, 300, 1000, 2500};
@@ -33,11 +33,15 @@
 // --------------------------------------------------------------------------
 
 #include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
 
 ///////////////////////////
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderIdentificationAlgorithm.h>
 ///////////////////////////
 
+#include <OpenMS/FORMAT/IdXMLFile.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+
 using namespace OpenMS;
 using namespace std;
 
@@ -61,6 +65,52 @@ START_SECTION(~FeatureFinderIdentificationAlgorithm())
 }
 END_SECTION
 
+START_SECTION((void run(std::vector<PeptideIdentification> peptides, const std::vector<ProteinIdentification>& proteins, std::vector<PeptideIdentification> peptides_ext, std::vector<ProteinIdentification> proteins_ext, FeatureMap& features, const FeatureMap& seeds = FeatureMap(), const String& spectra_file = "")))
+{
+  // same input and settings as TOPP_FeatureFinderIdentification_1
+  const String in = OPENMS_GET_TEST_DATA_PATH("../../../topp/FeatureFinderIdentification_1_input.mzML");
+  PeakMap ms_data;
+  MzMLFile mzml;
+  mzml.getOptions().addMSLevel(1);
+  mzml.load(in, ms_data);
+  vector<PeptideIdentification> peptides;
+  vector<ProteinIdentification> proteins;
+  IdXMLFile().load(OPENMS_GET_TEST_DATA_PATH("../../../topp/FeatureFinderIdentification_1_input.idXML"), proteins, peptides);
+
+  // the peptides are processed in chunks of "extract:batch_size" (in parallel
+  // if there is more than one chunk): the result must not depend on the chunking
+  auto runWithBatchSize = [&](int batch_size)
+  {
+    FeatureFinderIdentificationAlgorithm ffid;
+    Param params = ffid.getParameters();
+    params.setValue("extract:mz_window", 0.1);
+    params.setValue("extract:batch_size", batch_size);
+    params.setValue("detect:peak_width", 60.0);
+    params.setValue("model:type", "none");
+    ffid.setParameters(params);
+    ffid.setMSData(ms_data);
+    FeatureMap features;
+    ffid.run(peptides, proteins, vector<PeptideIdentification>(), vector<ProteinIdentification>(), features, FeatureMap(), in);
+    return features;
+  };
+  FeatureMap single_chunk = runWithBatchSize(5000);
+  FeatureMap several_chunks = runWithBatchSize(2);
+
+  TEST_NOT_EQUAL(single_chunk.size(), 0)
+  TEST_EQUAL(several_chunks.size(), single_chunk.size())
+  ABORT_IF(several_chunks.size() != single_chunk.size())
+  for (Size i = 0; i < single_chunk.size(); ++i)
+  {
+    TEST_EQUAL(several_chunks[i].getMetaValue("PeptideRef"), single_chunk[i].getMetaValue("PeptideRef"))
+    TEST_EQUAL(several_chunks[i].getCharge(), single_chunk[i].getCharge())
+    TEST_REAL_SIMILAR(several_chunks[i].getRT(), single_chunk[i].getRT())
+    TEST_REAL_SIMILAR(several_chunks[i].getMZ(), single_chunk[i].getMZ())
+    TEST_REAL_SIMILAR(several_chunks[i].getIntensity(), single_chunk[i].getIntensity())
+    TEST_EQUAL(several_chunks[i].getSubordinates().size(), single_chunk[i].getSubordinates().size())
+  }
+}
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
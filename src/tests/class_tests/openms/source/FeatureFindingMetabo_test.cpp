@@ -45,6 +45,10 @@
 #include <OpenMS/FILTERING/DATAREDUCTION/FeatureFindingMetabo.h>
 ///////////////////////////
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace OpenMS;
 using namespace std;
 
@@ -129,6 +133,49 @@ START_SECTION((void run(std::vector< MassTrace > &, FeatureMap &, chromatograms
 }
 END_SECTION
 
+START_SECTION([EXTRA] run output does not depend on the number of threads)
+{
+#ifdef _OPENMP
+  const int max_threads = omp_get_max_threads();
+#endif
+  // the SVM isotope models use the batched (parallel) isotope filter, "none" the sequential path
+  for (const String& model : {"metabolites (5% RMS)", "metabolites (2% RMS)", "none"})
+  {
+    std::vector<FeatureMap> results;
+    for (int nr_threads : {1, 4})
+    {
+#ifdef _OPENMP
+      omp_set_num_threads(nr_threads);
+#endif
+      FeatureFindingMetabo ffm;
+      Param p = ffm.getParameters();
+      p.setValue("isotope_filtering_model", model);
+      ffm.setParameters(p);
+      std::vector<MassTrace> traces = splitted_mt;
+      FeatureMap features;
+      std::vector<std::vector< OpenMS::MSChromatogram > > chroms;
+      ffm.run(traces, features, chroms);
+      results.push_back(features);
+    }
+
+    TEST_NOT_EQUAL(results[0].size(), 0)
+    TEST_EQUAL(results[0].size(), results[1].size())
+    ABORT_IF(results[0].size() != results[1].size())
+    for (Size i = 0; i < results[0].size(); ++i)
+    {
+      TEST_EQUAL(results[0][i].getCharge(), results[1][i].getCharge())
+      TEST_REAL_SIMILAR(results[0][i].getRT(), results[1][i].getRT())
+      TEST_REAL_SIMILAR(results[0][i].getMZ(), results[1][i].getMZ())
+      TEST_REAL_SIMILAR(results[0][i].getIntensity(), results[1][i].getIntensity())
+      TEST_EQUAL(results[0][i].getMetaValue(3), results[1][i].getMetaValue(3)) // trace labels
+    }
+  }
+#ifdef _OPENMP
+  omp_set_num_threads(max_threads);
+#endif
+}
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
@@ -0,0 +1,241 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
+///////////////////////////
+
+#include <fstream>
+#include <iterator>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(FragmentIndex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+FragmentIndex* ptr = nullptr;
+FragmentIndex* null_ptr = nullptr;
+START_SECTION(FragmentIndex(Size bucket_size = 512))
+{
+  ptr = new FragmentIndex();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->isBuilt(), false)
+}
+END_SECTION
+
+START_SECTION(~FragmentIndex())
+{
+  delete ptr;
+}
+END_SECTION
+
+// small bucket size so queries need to span several buckets
+FragmentIndex index(2);
+index.addPeptide("PEPTIDEK", 0, "PEPTIDEK", 1000.0, {200.0, 300.0, 400.0, 500.0});
+index.addPeptide("PEPK", 0, "PEPK", 500.0, {200.0, 250.0});
+index.addPeptide("PEPTIDEM", 1, "PEPTIDEM(Oxidation)", 800.0, {300.0, 400.0, 450.0});
+
+START_SECTION((void addPeptide(const String& sequence, Size modification_index, const String& modified_sequence, double mass, const std::vector<double>& fragment_mz)))
+{
+  TEST_EQUAL(index.size(), 3)
+  TEST_EQUAL(index.fragmentCount(), 9)
+  TEST_EQUAL(index.isBuilt(), false)
+}
+END_SECTION
+
+START_SECTION((void query(const MSSpectrum& spectrum, double min_mass, double max_mass, double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, Size min_matched, std::vector<Candidate>& candidates) const))
+{
+  MSSpectrum spec;
+  vector<FragmentIndex::Candidate> candidates;
+  TEST_EXCEPTION(Exception::IllegalArgument, index.query(spec, 0.0, 2000.0, 0.01, false, 1, candidates))
+}
+END_SECTION
+
+START_SECTION(void build())
+{
+  index.build();
+  TEST_EQUAL(index.isBuilt(), true)
+  TEST_EQUAL(index.size(), 3)
+  TEST_EQUAL(index.fragmentCount(), 9)
+}
+END_SECTION
+
+START_SECTION((const Peptide& getPeptide(Size index) const))
+{
+  // sorted by mass
+  TEST_EQUAL(index.getPeptide(0).sequence, "PEPK")
+  TEST_EQUAL(index.getPeptide(1).sequence, "PEPTIDEM")
+  TEST_EQUAL(index.getPeptide(1).modification_index, 1)
+  TEST_EQUAL(index.getPeptide(1).modified_sequence, "PEPTIDEM(Oxidation)")
+  TEST_REAL_SIMILAR(index.getPeptide(2).mass, 1000.0)
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> getPeptideRange(double min_mass, double max_mass) const))
+{
+  pair<Size, Size> range = index.getPeptideRange(600.0, 1100.0);
+  TEST_EQUAL(range.first, 1)
+  TEST_EQUAL(range.second, 3)
+  range = index.getPeptideRange(1100.0, 1200.0);
+  TEST_EQUAL(range.first, range.second)
+}
+END_SECTION
+
+START_SECTION((void query(const MSSpectrum& spectrum, double min_mass, double max_mass, double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, Size min_matched, std::vector<Candidate>& candidates) const))
+{
+  MSSpectrum spec;
+  spec.push_back(Peak1D(200.001, 1.0));
+  spec.push_back(Peak1D(300.001, 1.0));
+  spec.push_back(Peak1D(400.001, 1.0));
+  spec.push_back(Peak1D(700.0, 1.0));
+
+  vector<FragmentIndex::Candidate> candidates;
+  index.query(spec, 0.0, 2000.0, 0.01, false, 1, candidates);
+  TEST_EQUAL(candidates.size(), 3)
+  ABORT_IF(candidates.size() != 3)
+  TEST_EQUAL(candidates[0].peptide_index, 0) // PEPK
+  TEST_EQUAL(candidates[0].matched_fragments, 1)
+  TEST_EQUAL(candidates[1].matched_fragments, 2) // PEPTIDEM
+  TEST_EQUAL(candidates[2].matched_fragments, 3) // PEPTIDEK
+
+  // precursor mass window
+  candidates.clear();
+  index.query(spec, 900.0, 1100.0, 0.01, false, 1, candidates);
+  TEST_EQUAL(candidates.size(), 1)
+  TEST_EQUAL(candidates[0].peptide_index, 2)
+
+  // minimum number of matches
+  candidates.clear();
+  index.query(spec, 0.0, 2000.0, 0.01, false, 2, candidates);
+  TEST_EQUAL(candidates.size(), 2)
+
+  // ppm tolerance (1 ppm of 200 Da is 0.0002 Da)
+  candidates.clear();
+  index.query(spec, 0.0, 2000.0, 1.0, true, 1, candidates);
+  TEST_EQUAL(candidates.size(), 0)
+
+  // fragments with equal m/z straddling a bucket boundary: buckets are [90 (A), 100 (A)] and [100 (B), 110 (B)]
+  FragmentIndex boundary(2);
+  boundary.addPeptide("A", 0, "A", 500.0, {90.0, 100.0});
+  boundary.addPeptide("B", 0, "B", 600.0, {100.0, 110.0});
+  boundary.build();
+  MSSpectrum boundary_spec;
+  boundary_spec.push_back(Peak1D(100.0, 1.0));
+  candidates.clear();
+  boundary.query(boundary_spec, 0.0, 2000.0, 0.0, false, 1, candidates);
+  TEST_EQUAL(candidates.size(), 2)
+}
+END_SECTION
+
+START_SECTION((void store(const String& filename, const String& settings) const))
+{
+  FragmentIndex empty;
+  String tmp_file;
+  NEW_TMP_FILE(tmp_file)
+  TEST_EXCEPTION(Exception::IllegalArgument, empty.store(tmp_file, "settings"))
+}
+END_SECTION
+
+START_SECTION((bool load(const String& filename, const String& settings)))
+{
+  String tmp_file;
+  NEW_TMP_FILE(tmp_file)
+  index.store(tmp_file, "enzyme=Trypsin");
+
+  FragmentIndex loaded;
+  TEST_EQUAL(loaded.load(tmp_file, "enzyme=Lys-C"), false)
+  TEST_EQUAL(loaded.size(), 0)
+
+  TEST_EQUAL(loaded.load(tmp_file, "enzyme=Trypsin"), true)
+  TEST_EQUAL(loaded.isBuilt(), true)
+  TEST_EQUAL(loaded.size(), index.size())
+  TEST_EQUAL(loaded.fragmentCount(), index.fragmentCount())
+  TEST_EQUAL(loaded.getPeptide(1).sequence, "PEPTIDEM")
+  TEST_EQUAL(loaded.getPeptide(1).modification_index, 1)
+  TEST_EQUAL(loaded.getPeptide(1).modified_sequence, "PEPTIDEM(Oxidation)")
+
+  MSSpectrum spec;
+  spec.push_back(Peak1D(300.001, 1.0));
+  spec.push_back(Peak1D(450.001, 1.0));
+  vector<FragmentIndex::Candidate> candidates;
+  loaded.query(spec, 0.0, 2000.0, 0.01, false, 2, candidates);
+  TEST_EQUAL(candidates.size(), 1)
+  TEST_EQUAL(candidates[0].peptide_index, 1)
+
+  TEST_EXCEPTION(Exception::FileNotFound, loaded.load("this_file_does_not_exist.idx", "enzyme=Trypsin"))
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"), "enzyme=Trypsin"))
+
+  // truncated files
+  std::ifstream ifs(tmp_file.c_str(), std::ios::binary);
+  const std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  ifs.close();
+  String corrupt_file;
+  NEW_TMP_FILE(corrupt_file)
+  Size parse_errors = 0;
+  for (Size length = 0; length < content.size(); ++length)
+  {
+    std::ofstream(corrupt_file.c_str(), std::ios::binary).write(content.data(), length);
+    try
+    {
+      loaded.load(corrupt_file, "enzyme=Trypsin");
+    }
+    catch (Exception::ParseError&)
+    {
+      ++parse_errors;
+    }
+    TEST_EQUAL(loaded.size(), 0)
+  }
+  TEST_EQUAL(parse_errors, content.size())
+
+  // peptide index of the last fragment out of range (file ends with the fragments, the bucket count and 5 bucket m/z values)
+  std::string corrupt = content;
+  const Size offset = corrupt.size() - 5 * sizeof(float) - sizeof(Size) - sizeof(UInt32);
+  const UInt32 invalid_index = 3;
+  corrupt.replace(offset, sizeof(UInt32), (const char*)&invalid_index, sizeof(UInt32));
+  std::ofstream(corrupt_file.c_str(), std::ios::binary).write(corrupt.data(), corrupt.size());
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(corrupt_file, "enzyme=Trypsin"))
+  TEST_EQUAL(loaded.size(), 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -45,6 +45,10 @@
 
 ///////////////////////////
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace OpenMS;
 using namespace std;
 
@@ -381,6 +385,52 @@ START_SECTION(void mapExperimentToTransitionList(OpenSwath::SpectrumAccessPtr in
 }
 END_SECTION
 
+START_SECTION([EXTRA] pickExperiment output does not depend on the number of threads)
+{
+  boost::shared_ptr<PeakMap> exp (new PeakMap);
+  OpenSwath::LightTargetedExperiment transitions;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("OpenSwath_generic_input.mzML"), *exp);
+  {
+    TargetedExperiment transition_exp_;
+    TraMLFile().load(OPENMS_GET_TEST_DATA_PATH("OpenSwath_generic_input.TraML"), transition_exp_);
+    OpenSwathDataAccessHelper::convertTargetedExp(transition_exp_, transitions);
+  }
+  OpenSwath::SpectrumAccessPtr chromatogram_ptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+  std::vector< OpenSwath::SwathMap > swath_maps(1);
+  swath_maps[0].sptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(boost::shared_ptr<PeakMap>(new PeakMap));
+  TransformationDescription trafo;
+
+#ifdef _OPENMP
+  const int max_threads = omp_get_max_threads();
+#endif
+  std::vector<FeatureMap> results;
+  for (int nr_threads : {1, 4})
+  {
+#ifdef _OPENMP
+    omp_set_num_threads(nr_threads);
+#endif
+    MRMFeatureFinderScoring ff;
+    FeatureMap featureFile;
+    TransitionGroupMapType transition_group_map;
+    ff.pickExperiment(chromatogram_ptr, featureFile, transitions, trafo, swath_maps, transition_group_map);
+    results.push_back(featureFile);
+  }
+#ifdef _OPENMP
+  omp_set_num_threads(max_threads);
+#endif
+
+  TEST_EQUAL(results[0].size(), results[1].size())
+  ABORT_IF(results[0].size() != results[1].size())
+  for (Size i = 0; i < results[0].size(); ++i)
+  {
+    TEST_EQUAL(results[0][i].getMetaValue("PeptideRef"), results[1][i].getMetaValue("PeptideRef"))
+    TEST_REAL_SIMILAR(results[0][i].getRT(), results[1][i].getRT())
+    TEST_REAL_SIMILAR(results[0][i].getIntensity(), results[1][i].getIntensity())
+    TEST_REAL_SIMILAR(results[0][i].getOverallQuality(), results[1][i].getOverallQuality())
+  }
+}
+END_SECTION
+
 START_SECTION( void scorePeakgroups(MRMTransitionGroupType& transition_group, TransformationDescription & trafo, OpenSwath::SpectrumAccessPtr swath_map, FeatureMap& output) ) 
 {
   NOT_TESTABLE // tested above
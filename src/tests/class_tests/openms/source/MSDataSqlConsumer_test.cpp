@@ -0,0 +1,111 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/DATAACCESS/MSDataSqlConsumer.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/SqMassFile.h>
+
+START_TEST(MSDataSqlConsumer, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+
+MSDataSqlConsumer* sql_consumer_ptr = nullptr;
+MSDataSqlConsumer* sql_consumer_nullPointer = nullptr;
+
+START_SECTION((MSDataSqlConsumer(const String& sql_filename, UInt64 run_id, int buffer_size = 500, bool full_meta = true, bool lossy_compression=false, double linear_mass_acc=1e-4, Size chrom_block_size = 0)))
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  sql_consumer_ptr = new MSDataSqlConsumer(tmp_filename, 12345);
+  TEST_NOT_EQUAL(sql_consumer_ptr, sql_consumer_nullPointer)
+END_SECTION
+
+START_SECTION((~MSDataSqlConsumer()))
+  delete sql_consumer_ptr;
+END_SECTION
+
+START_SECTION((void consumeChromatogram(ChromatogramType & c)))
+{
+  PeakMap exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLSqliteHandler_1.mzML"), exp);
+  TEST_EQUAL(exp.getNrChromatograms() > 0, true)
+
+  std::vector<MSChromatogram> chroms;
+  for (Size k = 0; k < 5; ++k)
+  {
+    MSChromatogram chrom = exp.getChromatograms()[0];
+    chrom.setNativeID(String("chrom_") + k);
+    chroms.push_back(chrom);
+  }
+
+  // individual chromatograms and blocks of two (buffer of four, so the last
+  // flush only holds a single chromatogram)
+  for (Size block_size : {0, 2})
+  {
+    std::string tmp_filename;
+    NEW_TMP_FILE(tmp_filename);
+    {
+      MSDataSqlConsumer consumer(tmp_filename, 12345, 4, false, false, 1e-4, block_size);
+      for (MSChromatogram chrom : chroms)
+      {
+        consumer.consumeChromatogram(chrom);
+      }
+    }
+
+    PeakMap tmp;
+    SqMassFile().load(tmp_filename, tmp);
+    TEST_EQUAL(tmp.getNrChromatograms(), 5)
+    ABORT_IF(tmp.getNrChromatograms() != 5)
+    for (Size k = 0; k < 5; ++k)
+    {
+      TEST_EQUAL(tmp.getChromatograms()[k].getNativeID(), chroms[k].getNativeID())
+      TEST_EQUAL(tmp.getChromatograms()[k].size(), chroms[k].size())
+    }
+    TEST_REAL_SIMILAR(tmp.getChromatograms()[4][20].getRT(), chroms[4][20].getRT())
+    TEST_REAL_SIMILAR(tmp.getChromatograms()[4][20].getIntensity(), chroms[4][20].getIntensity())
+  }
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
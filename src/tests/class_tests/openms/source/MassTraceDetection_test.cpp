@@ -36,6 +36,10 @@
 #include <OpenMS/test_config.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 ///////////////////////////
 #include <OpenMS/FILTERING/DATAREDUCTION/MassTraceDetection.h>
 ///////////////////////////
@@ -175,6 +179,76 @@ START_SECTION((void run(const PeakMap &, std::vector< MassTrace > &)))
 }
 END_SECTION
 
+START_SECTION((void run(const PeakMap &, std::vector< MassTrace > &, const Size max_traces)))
+{
+    // traces are reported in order of decreasing apex intensity, limiting
+    // the number of traces has to give the first traces of the full result
+    std::vector<MassTrace> all_mt, limited_mt;
+    test_mtd.setParameters(p_mtd);
+    test_mtd.run(input, all_mt);
+    test_mtd.run(input, limited_mt, 2);
+
+    TEST_EQUAL(all_mt.size(), 3);
+    TEST_EQUAL(limited_mt.size(), 2);
+    for (Size i = 0; i < limited_mt.size(); ++i)
+    {
+        TEST_EQUAL(limited_mt[i].getLabel(), String("T") + (i + 1));
+        TEST_EQUAL(limited_mt[i].getSize(), all_mt[i].getSize());
+        TEST_REAL_SIMILAR(limited_mt[i].getCentroidRT(), all_mt[i].getCentroidRT());
+        TEST_REAL_SIMILAR(limited_mt[i].getCentroidMZ(), all_mt[i].getCentroidMZ());
+        TEST_REAL_SIMILAR(limited_mt[i].getCentroidSD(), all_mt[i].getCentroidSD());
+    }
+}
+END_SECTION
+
+START_SECTION([EXTRA] run output does not depend on the number of threads)
+{
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+#endif
+    // the number of threads determines the batch size of the parallel trace
+    // extension, i.e. which traces are invalidated and re-extended
+    PeakMap ffm_input;
+    MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("FeatureFindingMetabo_input1.mzML"), ffm_input);
+    for (const PeakMap* map : {&input, &ffm_input})
+    {
+        std::vector<std::vector<MassTrace> > results;
+        for (int nr_threads : {1, 4})
+        {
+#ifdef _OPENMP
+            omp_set_num_threads(nr_threads);
+#endif
+            MassTraceDetection mtd;
+            mtd.setParameters(p_mtd);
+            std::vector<MassTrace> traces;
+            mtd.run(*map, traces);
+            results.push_back(traces);
+        }
+
+        TEST_NOT_EQUAL(results[0].size(), 0)
+        TEST_EQUAL(results[0].size(), results[1].size())
+        ABORT_IF(results[0].size() != results[1].size())
+        for (Size i = 0; i < results[0].size(); ++i)
+        {
+            TEST_EQUAL(results[0][i].getLabel(), results[1][i].getLabel())
+            TEST_EQUAL(results[0][i].getSize(), results[1][i].getSize())
+            ABORT_IF(results[0][i].getSize() != results[1][i].getSize())
+            for (Size j = 0; j < results[0][i].getSize(); ++j)
+            {
+                TEST_EQUAL(results[0][i][j].getRT(), results[1][i][j].getRT())
+                TEST_EQUAL(results[0][i][j].getMZ(), results[1][i][j].getMZ())
+                TEST_EQUAL(results[0][i][j].getIntensity(), results[1][i][j].getIntensity())
+            }
+            TEST_REAL_SIMILAR(results[0][i].getCentroidMZ(), results[1][i].getCentroidMZ())
+            TEST_REAL_SIMILAR(results[0][i].getCentroidSD(), results[1][i].getCentroidSD())
+        }
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+}
+END_SECTION
+
 std::vector<MassTrace> filt;
 
 //START_SECTION((void filterByPeakWidth(std::vector< MassTrace > &, std::vector< MassTrace > &)))
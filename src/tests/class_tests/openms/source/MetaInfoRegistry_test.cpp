@@ -42,6 +42,9 @@
 #endif
 
 #include <OpenMS/METADATA/MetaInfoRegistry.h>
+#include <OpenMS/CONCEPT/Constants.h>
+
+#include <algorithm>
 
 ///////////////////////////
 
@@ -176,6 +179,90 @@ START_SECTION((MetaInfoRegistry& operator=(const MetaInfoRegistry& rhs)))
 	TEST_STRING_EQUAL(mir2.getUnit(1025), "sec")
 	TEST_STRING_EQUAL(mir2.getUnit("testname"), "")
 	TEST_STRING_EQUAL(mir2.getUnit("retention time"), "sec")
+
+	// repeated assignment of diverging registries (existing tables and entries are reused)
+	MetaInfoRegistry other;
+	other.registerName("other name", "other description");
+	for (Size i = 0; i < 100; ++i)
+	{
+		mir2 = other;
+		TEST_EQUAL(mir2.getIndex("other name"), 1024)
+		TEST_EQUAL(mir2.getIndex("testname"), UInt(-1))
+		TEST_STRING_EQUAL(mir2.getName(1024), "other name")
+		TEST_STRING_EQUAL(mir2.getDescription(1024), "other description")
+		mir2 = mir;
+		TEST_EQUAL(mir2.getIndex("testname"), 1024)
+		TEST_EQUAL(mir2.getIndex("other name"), UInt(-1))
+		TEST_STRING_EQUAL(mir2.getDescription(1024), "this is just a test")
+		TEST_STRING_EQUAL(mir2.getUnit("retention time"), "sec")
+	}
+	// assigning a superset adds the missing names
+	MetaInfoRegistry larger(mir);
+	larger.registerName("another name");
+	mir2 = larger;
+	TEST_EQUAL(mir2.getIndex("another name"), 1026)
+	TEST_EQUAL(mir2.getIndex("testname"), 1024)
+	TEST_EQUAL(mir2.registerName("yet another name"), 1027)
+END_SECTION
+
+START_SECTION([EXTRA] enum ReservedIndex)
+{
+  MetaInfoRegistry reg;
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::ISOTOPIC_RANGE), "isotopic_range")
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::CHARGE), "charge")
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::SPECTRUM_REFERENCE), Constants::UserParam::SPECTRUM_REFERENCE)
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::CONCAT_PEPTIDE), Constants::UserParam::CONCAT_PEPTIDE)
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::LOCALIZED_MODIFICATIONS_USERPARAM), Constants::UserParam::LOCALIZED_MODIFICATIONS_USERPARAM)
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::MERGED_CHROMATOGRAM_MZS), Constants::UserParam::MERGED_CHROMATOGRAM_MZS)
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::PRECURSOR_ERROR_PPM_USERPARAM), Constants::UserParam::PRECURSOR_ERROR_PPM_USERPARAM)
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::FRAGMENT_ERROR_MEDIAN_PPM_USERPARAM), Constants::UserParam::FRAGMENT_ERROR_MEDIAN_PPM_USERPARAM)
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::FRAGMENT_ERROR_PPM_USERPARAM), Constants::UserParam::FRAGMENT_ERROR_PPM_USERPARAM)
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::FRAGMENT_ERROR_DA_USERPARAM), Constants::UserParam::FRAGMENT_ERROR_DA_USERPARAM)
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::FRAGMENT_ANNOTATION_USERPARAM), Constants::UserParam::FRAGMENT_ANNOTATION_USERPARAM)
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::PSM_EXPLAINED_ION_CURRENT_USERPARAM), Constants::UserParam::PSM_EXPLAINED_ION_CURRENT_USERPARAM)
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::MATCHED_PREFIX_IONS_FRACTION), Constants::UserParam::MATCHED_PREFIX_IONS_FRACTION)
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::MATCHED_SUFFIX_IONS_FRACTION), Constants::UserParam::MATCHED_SUFFIX_IONS_FRACTION)
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::TARGET_DECOY), Constants::UserParam::TARGET_DECOY)
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::DELTA_SCORE), Constants::UserParam::DELTA_SCORE)
+  TEST_STRING_EQUAL(reg.getName(MetaInfoRegistry::ISOTOPE_ERROR), Constants::UserParam::ISOTOPE_ERROR)
+  TEST_EQUAL(reg.getIndex(Constants::UserParam::TARGET_DECOY), MetaInfoRegistry::TARGET_DECOY)
+  TEST_EQUAL(reg.registerName(Constants::UserParam::DELTA_SCORE), MetaInfoRegistry::DELTA_SCORE)
+  TEST_EQUAL(MetaInfoRegistry::SIZE_OF_RESERVEDINDEX < 1024, true)
+  TEST_EXCEPTION(Exception::InvalidValue, reg.getName(MetaInfoRegistry::SIZE_OF_RESERVEDINDEX))
+}
+END_SECTION
+
+START_SECTION([EXTRA] growing the registry while reading concurrently)
+{
+  MetaInfoRegistry reg;
+  int nr_names(5000);
+  int errors = 0;
+#pragma omp parallel for reduction(+: errors)
+  for (int k = 0; k < nr_names; ++k)
+  {
+    String name = "name" + String(k);
+    UInt index = reg.registerName(name);
+    if (reg.getIndex(name) != index) ++errors;
+    if (reg.getName(index) != name) ++errors;
+    // names registered before are still found while the table grows
+    if (reg.getIndex("charge") != MetaInfoRegistry::CHARGE) ++errors;
+  }
+  TEST_EQUAL(errors, 0)
+
+  // indices are dense and unique
+  std::vector<bool> seen(nr_names, false);
+  for (int k = 0; k < nr_names; ++k)
+  {
+    UInt index = reg.getIndex("name" + String(k));
+    TEST_EQUAL(index >= 1024 && index < 1024 + UInt(nr_names), true)
+    seen[index - 1024] = true;
+  }
+  TEST_EQUAL(std::count(seen.begin(), seen.end(), true), nr_names)
+
+  MetaInfoRegistry reg2(reg);
+  TEST_EQUAL(reg2.getIndex("name4999"), reg.getIndex("name4999"))
+  TEST_EQUAL(reg2.registerName("one more"), 1024 + UInt(nr_names))
+}
 END_SECTION
 
 START_SECTION([EXTRA] multithreaded example)
@@ -39,6 +39,8 @@
 
 #include <OpenMS/METADATA/MetaInfo.h>
 
+#include <algorithm>
+
 ///////////////////////////
 
 START_TEST(Example, "$Id$")
@@ -251,7 +253,83 @@ START_SECTION((void removeValue(const String& name)))
 	i.removeValue("icon");
 END_SECTION
 
+START_SECTION((Size allocatedBytes() const))
+{
+  MetaInfo i;
+  TEST_EQUAL(i.allocatedBytes(), 0)
+  // small objects are sized exactly
+  for (UInt k = 1; k <= 8; ++k)
+  {
+    i.setValue(1030 - k, DataValue(double(k)));
+    TEST_EQUAL(i.allocatedBytes() >= k * (sizeof(UInt) + sizeof(DataValue)), true)
+    TEST_EQUAL(i.allocatedBytes() < (k + 1) * (sizeof(UInt) + sizeof(DataValue)), true)
+  }
+  // larger ones grow geometrically, keys stay sorted
+  for (UInt k = 0; k < 100; ++k)
+  {
+    i.setValue(2000 + (k * 37) % 100, DataValue(Int(k)));
+  }
+  TEST_EQUAL(i.allocatedBytes() >= 108 * (sizeof(UInt) + sizeof(DataValue)), true)
+  vector<UInt> keys;
+  i.getKeys(keys);
+  TEST_EQUAL(keys.size(), 108)
+  TEST_EQUAL(std::is_sorted(keys.begin(), keys.end()), true)
+  TEST_EQUAL(Int(i.getValue(2000 + (5 * 37) % 100)), 5)
+  TEST_REAL_SIMILAR(double(i.getValue(1022)), 8.0)
+
+  // copies are sized exactly
+  MetaInfo copy(i);
+  TEST_EQUAL(copy == i, true)
+  TEST_EQUAL(copy.allocatedBytes() < 109 * (sizeof(UInt) + sizeof(DataValue)), true)
+
+  // inserting a value of the same object (storage is relocated)
+  MetaInfo j;
+  j.setValue(1, String("first"));
+  j.setValue(2, j.getValue(1));
+  TEST_STRING_EQUAL(j.getValue(2), "first")
+
+  i.clear();
+  TEST_EQUAL(i.allocatedBytes(), 0)
+}
+END_SECTION
+
+/*
+  // Benchmark: memory per peptide hit and per feature after loading large files.
+  // Requires OpenMS/FORMAT/IdXMLFile.h, OpenMS/FORMAT/FeatureXMLFile.h and OpenMS/SYSTEM/SysInfo.h.
+  START_SECTION([EXTRA] memory benchmark)
+  {
+    const Size copies = 100000;
+    vector<ProteinIdentification> proteins;
+    vector<PeptideIdentification> peptides, many_peptides;
+    IdXMLFile().load(OPENMS_GET_TEST_DATA_PATH("IdXMLFile_whole.idXML"), proteins, peptides);
+    Size nr_hits = 0;
+    SysInfo::MemUsage mem_ids;
+    for (Size c = 0; c < copies; ++c)
+    {
+      for (const auto& pep : peptides)
+      {
+        many_peptides.push_back(pep);
+        nr_hits += pep.getHits().size();
+      }
+    }
+    mem_ids.after();
+    std::cout << "idXML: " << nr_hits << " hits, " << mem_ids.delta("loading") << ", "
+              << (mem_ids.mem_after - mem_ids.mem_before) * 1024.0 / nr_hits << " bytes per hit" << std::endl;
+
+    FeatureMap features, many_features;
+    FeatureXMLFile().load(OPENMS_GET_TEST_DATA_PATH("FeatureXMLFile_1.featureXML"), features);
+    SysInfo::MemUsage mem_features;
+    for (Size c = 0; c < copies; ++c)
+    {
+      many_features.insert(many_features.end(), features.begin(), features.end());
+    }
+    mem_features.after();
+    std::cout << "featureXML: " << many_features.size() << " features, " << mem_features.delta("loading") << ", "
+              << (mem_features.mem_after - mem_features.mem_before) * 1024.0 / many_features.size() << " bytes per feature" << std::endl;
+  }
+  END_SECTION
+*/
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
-
@@ -37,6 +37,9 @@
 
 ///////////////////////////
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
+#include <OpenMS/CHEMISTRY/ResidueDB.h>
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/FORMAT/TextFile.h>
 #include <limits>
 #include <algorithm>
 ///////////////////////////
@@ -350,6 +353,121 @@ START_SECTION([EXTRA] multithreaded example)
  }
 END_SECTION
 
+// these sections change the state of the singleton, so keep them last
+START_SECTION(void freeze())
+{
+  TEST_EQUAL(ptr->isFrozen(), false)
+  Size nr_mods = ptr->getNumberOfModifications();
+  ptr->freeze();
+  TEST_EQUAL(ptr->isFrozen(), true)
+  TEST_EQUAL(ptr->getNumberOfModifications(), nr_mods)
+
+  // lookups in the frozen snapshot
+  TEST_EQUAL(ptr->has("Phospho (A)"), true)
+  TEST_STRING_EQUAL(ptr->getModification("Oxidation", "M", ResidueModification::ANYWHERE)->getFullId(), "Oxidation (M)")
+  TEST_EQUAL(ptr->getModification(ptr->findModificationIndex("Oxidation (M)")), ptr->getModification("Oxidation (M)"))
+
+  // modifications can still be added after freezing
+  TEST_EQUAL(ptr->has("Frozen (A)"), false)
+  std::unique_ptr<ResidueModification> modification(new ResidueModification());
+  modification->setFullId("Frozen (A)");
+  modification->setAverageMass(3.0);
+  const ResidueModification* added = ptr->addModification(std::move(modification));
+  TEST_EQUAL(ptr->has("Frozen (A)"), true)
+  TEST_EQUAL(ptr->getModification("Frozen (A)"), added)
+  TEST_EQUAL(ptr->getNumberOfModifications(), nr_mods + 1)
+  TEST_EQUAL(ptr->getModification(ptr->findModificationIndex("Frozen (A)")), added)
+  TEST_REAL_SIMILAR(ptr->getModification(nr_mods)->getAverageMass(), 3.0)
+
+  // adding the same modification again returns the registered one
+  std::unique_ptr<ResidueModification> duplicate(new ResidueModification());
+  duplicate->setFullId("Frozen (A)");
+  TEST_EQUAL(ptr->addModification(std::move(duplicate)), added)
+  TEST_EQUAL(ptr->getNumberOfModifications(), nr_mods + 1)
+}
+END_SECTION
+
+START_SECTION(bool isFrozen() const)
+{
+  TEST_EQUAL(ptr->isFrozen(), true)
+}
+END_SECTION
+
+START_SECTION(void writeTSV(const String& filename))
+{
+  // modifications added after freezing are written as well
+  TEST_EQUAL(ptr->isFrozen(), true)
+  String filename;
+  NEW_TMP_FILE(filename)
+  ptr->writeTSV(filename);
+  TextFile tsv(filename, false, -1, true);
+  TEST_EQUAL(tsv.end() - tsv.begin(), static_cast<std::ptrdiff_t>(ptr->getNumberOfModifications() + 1))
+  bool found = false;
+  for (const String& line : tsv)
+  {
+    if (line.hasPrefix("Frozen (A)\t")) found = true;
+  }
+  TEST_EQUAL(found, true)
+}
+END_SECTION
+
+START_SECTION(void unfreeze())
+{
+  Size nr_mods = ptr->getNumberOfModifications();
+  ptr->unfreeze();
+  TEST_EQUAL(ptr->isFrozen(), false)
+  TEST_EQUAL(ptr->getNumberOfModifications(), nr_mods)
+  // modifications added while frozen are still found
+  const ResidueModification* added = ptr->getModification("Frozen (A)");
+  TEST_EQUAL(ptr->getModification(ptr->findModificationIndex("Frozen (A)")), added)
+  TEST_EQUAL(ptr->getModification(nr_mods - 1), added)
+
+  // freeze() calls are counted
+  ptr->freeze();
+  ptr->freeze();
+  ptr->unfreeze();
+  TEST_EQUAL(ptr->isFrozen(), true)
+  ptr->unfreeze();
+  TEST_EQUAL(ptr->isFrozen(), false)
+  ptr->unfreeze(); // unbalanced calls are ignored
+  TEST_EQUAL(ptr->isFrozen(), false)
+}
+END_SECTION
+
+START_SECTION(FreezeGuard())
+{
+  TEST_EQUAL(ptr->isFrozen(), false)
+  TEST_EQUAL(ResidueDB::getInstance()->isFrozen(), false)
+  {
+    ModificationsDB::FreezeGuard guard;
+    TEST_EQUAL(ptr->isFrozen(), true)
+    TEST_EQUAL(ResidueDB::getInstance()->isFrozen(), true)
+    {
+      // nested guards leave the databases frozen
+      ModificationsDB::FreezeGuard inner_guard;
+    }
+    TEST_EQUAL(ptr->isFrozen(), true)
+    TEST_EQUAL(ResidueDB::getInstance()->isFrozen(), true)
+  }
+  TEST_EQUAL(ptr->isFrozen(), false)
+  TEST_EQUAL(ResidueDB::getInstance()->isFrozen(), false)
+
+  // concurrent guards (e.g. from independent searches) while other threads look up and add modifications
+  Size nr_found = 0;
+#pragma omp parallel for reduction(+: nr_found)
+  for (int i = 0; i < 100; ++i)
+  {
+    ModificationsDB::FreezeGuard guard;
+    if (ptr->getModification("Oxidation (M)") != nullptr) ++nr_found;
+    AASequence seq = AASequence::fromString(String("PEPTM[+") + (100 + i) + "]IDE");
+    if (seq[4].isModified()) ++nr_found;
+  }
+  TEST_EQUAL(nr_found, 200)
+  TEST_EQUAL(ptr->isFrozen(), false)
+  TEST_EQUAL(ResidueDB::getInstance()->isFrozen(), false)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -1233,6 +1233,38 @@ START_SECTION(void transform(const String& filename_in, Interfaces::IMSDataConsu
 }
 END_SECTION
 
+START_SECTION([EXTRA] decoding keeps the input order independent of the data pool size)
+{
+  MzMLFile mzml;
+  PeakMap reference;
+  mzml.load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), reference);
+
+  for (Size pool_size : {1, 2, 3, 100})
+  {
+    MzMLFile mzml_pool;
+    PeakFileOptions opt = mzml_pool.getOptions();
+    opt.setMaxDataPoolSize(pool_size);
+    mzml_pool.setOptions(opt);
+    PeakMap map;
+    mzml_pool.load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), map);
+
+    TEST_EQUAL(map.size(), reference.size())
+    TEST_EQUAL(map.getNrChromatograms(), reference.getNrChromatograms())
+    ABORT_IF(map.size() != reference.size() || map.getNrChromatograms() != reference.getNrChromatograms())
+    for (Size i = 0; i < map.size(); ++i)
+    {
+      TEST_EQUAL(map[i].getNativeID(), reference[i].getNativeID())
+      TEST_EQUAL(map[i] == reference[i], true)
+    }
+    for (Size i = 0; i < map.getNrChromatograms(); ++i)
+    {
+      TEST_EQUAL(map.getChromatogram(i).getNativeID(), reference.getChromatogram(i).getNativeID())
+      TEST_EQUAL(map.getChromatogram(i) == reference.getChromatogram(i), true)
+    }
+  }
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -665,6 +665,80 @@ START_SECTION(void writeChromatograms(const std::vector<MSChromatogram>& chroms)
 }
 END_SECTION
 
+START_SECTION(void setChromatogramBlockSize(Size block_size))
+{
+  MSExperiment exp_orig;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLSqliteHandler_1.mzML"), exp_orig);
+
+  // five chromatograms with distinct native ids and precursors
+  std::vector<MSChromatogram> chroms;
+  for (Size k = 0; k < 5; ++k)
+  {
+    MSChromatogram chrom = exp_orig.getChromatograms()[0];
+    chrom.setNativeID(String("chrom_") + k);
+    chrom.getPrecursor().setMZ(400.0 + k);
+    for (auto& p : chrom) p.setIntensity(p.getIntensity() + k);
+    chroms.push_back(chrom);
+  }
+  chroms[3].clear(false); // empty chromatogram
+
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+
+  for (bool lossy : {false, true})
+  {
+    QFile file (String(tmp_filename).toQString());
+    file.remove();
+
+    MzMLSqliteHandler handler(tmp_filename, 12345);
+    handler.setConfig(true, lossy, 0.0001);
+    handler.setChromatogramBlockSize(2);
+    handler.createTables();
+    // two calls: blocks of {0,1}, {2} and {3,4}
+    handler.writeChromatograms(std::vector<MSChromatogram>(chroms.begin(), chroms.begin() + 3));
+    handler.writeChromatograms(std::vector<MSChromatogram>(chroms.begin() + 3, chroms.end()));
+    handler.writeRunLevelInformation(exp_orig, false);
+    TEST_EQUAL(handler.getNrChromatograms(), 5)
+
+    MSExperiment tmp;
+    handler.readExperiment(tmp, false);
+    TEST_EQUAL(tmp.getNrChromatograms(), 5)
+    ABORT_IF(tmp.getNrChromatograms() != 5)
+
+    std::vector<MSChromatogram> subset;
+    handler.readChromatograms(subset, {1, 4}, false);
+    TEST_EQUAL(subset.size(), 2)
+    ABORT_IF(subset.size() != 2)
+    TEST_EQUAL(subset[0].getNativeID(), "chrom_1")
+    TEST_EQUAL(subset[1].getNativeID(), "chrom_4")
+
+    if (lossy)
+    {
+      TOLERANCE_RELATIVE(1+2e-4)
+    }
+    for (Size k = 0; k < 5; ++k)
+    {
+      TEST_EQUAL(tmp.getChromatograms()[k].getNativeID(), chroms[k].getNativeID())
+      TEST_EQUAL(tmp.getChromatograms()[k].size(), chroms[k].size())
+      TEST_REAL_SIMILAR(tmp.getChromatograms()[k].getPrecursor().getMZ(), 400.0 + k)
+    }
+    TEST_REAL_SIMILAR(tmp.getChromatograms()[0][20].getRT(), 0.200695)
+    TEST_REAL_SIMILAR(tmp.getChromatograms()[0][20].getIntensity(), 147414.578125)
+    TEST_REAL_SIMILAR(tmp.getChromatograms()[2][20].getIntensity(), 147416.578125)
+    TEST_REAL_SIMILAR(subset[0][20].getRT(), 0.200695)
+    TEST_REAL_SIMILAR(subset[0][20].getIntensity(), 147415.578125)
+    TEST_REAL_SIMILAR(subset[1][20].getIntensity(), 147418.578125)
+    if (!lossy)
+    {
+      // without numpress the data is stored losslessly
+      TEST_EQUAL(tmp.getChromatograms()[4][20].getRT(), chroms[4][20].getRT())
+      TEST_EQUAL(tmp.getChromatograms()[4][20].getIntensity(), chroms[4][20].getIntensity())
+    }
+    TOLERANCE_RELATIVE(1+1e-5)
+  }
+}
+END_SECTION
+
 // reset error tolerances to default values
 TOLERANCE_ABSOLUTE(1e-5)
 TOLERANCE_RELATIVE(1+1e-5)
@@ -218,7 +218,7 @@ START_SECTION((MSSpectrum operator[] (Size n) const))
 }
 END_SECTION
 
-START_SECTION((MSSpectrum getSpectrum(Size id)))
+START_SECTION((MSSpectrum getSpectrum(Size id) const))
 {
   OnDiscPeakMap tmp; tmp.openFile(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
   TEST_EQUAL(tmp.empty(), false);
@@ -237,7 +237,28 @@ START_SECTION((MSSpectrum getSpectrum(Size id)))
 }
 END_SECTION
 
-START_SECTION(OpenMS::Interfaces::SpectrumPtr getSpectrumById(Size id))
+START_SECTION([EXTRA] concurrent access to a single OnDiscMSExperiment)
+{
+  OnDiscPeakMap tmp; tmp.openFile(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+  TEST_EQUAL(tmp.getNrSpectra(), 2)
+  std::vector<Size> expected_sizes = {19914, 19800};
+
+  // all threads share the same object (and thus the same file handle)
+  Size nr_errors = 0;
+#pragma omp parallel for reduction(+: nr_errors)
+  for (int k = 0; k < 100; k++)
+  {
+    Size id = k % 2;
+    MSSpectrum s = tmp.getSpectrum(id);
+    OpenMS::Interfaces::SpectrumPtr sptr = tmp.getSpectrumById(id);
+    if (s.size() != expected_sizes[id]) ++nr_errors;
+    if (sptr->getMZArray()->data.size() != expected_sizes[id]) ++nr_errors;
+  }
+  TEST_EQUAL(nr_errors, 0)
+}
+END_SECTION
+
+START_SECTION(OpenMS::Interfaces::SpectrumPtr getSpectrumById(Size id) const)
 {
   OnDiscPeakMap tmp; tmp.openFile(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
   TEST_EQUAL(tmp.empty(), false);
@@ -257,7 +278,7 @@ START_SECTION(OpenMS::Interfaces::SpectrumPtr getSpectrumById(Size id))
 }
 END_SECTION
 
-START_SECTION((MSChromatogram getChromatogram(Size id)))
+START_SECTION((MSChromatogram getChromatogram(Size id) const))
 {
   OnDiscPeakMap tmp; tmp.openFile(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
   TEST_EQUAL(tmp.getNrChromatograms(), 1);
@@ -275,7 +296,7 @@ START_SECTION((MSChromatogram getChromatogram(Size id)))
 }
 END_SECTION
 
-START_SECTION(OpenMS::Interfaces::ChromatogramPtr getChromatogramById(Size id))
+START_SECTION(OpenMS::Interfaces::ChromatogramPtr getChromatogramById(Size id) const)
 {
   OnDiscPeakMap tmp; tmp.openFile(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
   TEST_EQUAL(tmp.empty(), false);
@@ -0,0 +1,239 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathOSWWriter.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/SqliteConnector.h>
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <limits>
+
+using namespace OpenMS;
+using namespace std;
+
+namespace
+{
+  // all rows of a table as strings (sorted, as the insertion order may differ)
+  vector<String> dumpTable(const String& filename, const String& table)
+  {
+    SqliteConnector conn(filename, SqliteConnector::SqlOpenMode::READONLY);
+    sqlite3_stmt* stmt;
+    conn.prepareStatement(&stmt, "SELECT * FROM " + table + ";");
+    vector<String> rows;
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+      String row;
+      for (int i = 0; i < sqlite3_column_count(stmt); ++i)
+      {
+        if (sqlite3_column_type(stmt, i) == SQLITE_NULL)
+        {
+          row += "NULL|";
+        }
+        else
+        {
+          row += String(reinterpret_cast<const char*>(sqlite3_column_text(stmt, i))) + "|";
+        }
+      }
+      rows.push_back(row);
+    }
+    sqlite3_finalize(stmt);
+    sort(rows.begin(), rows.end());
+    return rows;
+  }
+
+  // features with MS1 and MS2 subordinates (values are exactly representable with 6 digits, as used by prepareLine)
+  FeatureMap createFeatures(UInt64 first_id)
+  {
+    FeatureMap features;
+    for (UInt64 i = 0; i < 3; ++i)
+    {
+      Feature f;
+      f.setUniqueId(first_id + i);
+      f.setRT(100.5 + i);
+      f.setIntensity(1000.0f + i);
+      f.setMetaValue("leftWidth", 99.5 + i);
+      f.setMetaValue("rightWidth", 102.5 + i);
+      f.setMetaValue("norm_RT", 25.25);
+      f.setMetaValue("delta_rt", 0.5);
+      f.setMetaValue("total_xic", 5000.0);
+      f.setMetaValue("peak_apices_sum", 250.0);
+      f.setMetaValue("var_library_corr", 0.75);
+      f.setMetaValue("var_xcorr_coelution", 1.5);
+      f.setMetaValue("var_xcorr_shape", std::numeric_limits<double>::quiet_NaN()); // written as NULL
+      f.setMetaValue("var_sonar_lag", 2.0);
+      f.setMetaValue("ms1_area_intensity", 300.0);
+      f.setMetaValue("ms1_apex_intensity", 30.0);
+      f.setMetaValue("var_ms1_ppm_diff", 1.25);
+
+      std::vector<Feature> subordinates;
+      for (Int t = 1; t <= 2; ++t)
+      {
+        Feature sub;
+        sub.setMetaValue("FeatureLevel", "MS2");
+        sub.setMetaValue("native_id", String(t + 10 * i));
+        sub.setIntensity(100.0f * t);
+        sub.setMetaValue("total_xic", 200.0 * t);
+        sub.setMetaValue("peak_apex_int", 20.0 * t);
+        subordinates.push_back(sub);
+      }
+      Feature precursor;
+      precursor.setMetaValue("FeatureLevel", "MS1");
+      precursor.setMetaValue("native_id", "Precursor_i0");
+      precursor.setIntensity(400.0f);
+      precursor.setMetaValue("peak_apex_int", 40.0);
+      subordinates.push_back(precursor);
+      f.setSubordinates(subordinates);
+      features.push_back(f);
+    }
+    return features;
+  }
+
+  const vector<String> tables = {"RUN", "FEATURE", "FEATURE_MS1", "FEATURE_MS2", "FEATURE_PRECURSOR", "FEATURE_TRANSITION"};
+}
+
+START_TEST(OpenSwathOSWWriter, "$Id$")
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+OpenSwathOSWWriter* ptr = nullptr;
+OpenSwathOSWWriter* nullPointer = nullptr;
+
+START_SECTION(OpenSwathOSWWriter(const String& output_filename, const UInt64 run_id, const String& input_filename = "inputfile", bool ms1_scores = false, bool sonar = false, bool uis_scores = false))
+{
+  ptr = new OpenSwathOSWWriter("", 1);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isActive(), false)
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(void prepareRows(const FeatureMap& output, const String& id, FeatureRows& rows) const)
+{
+  OpenSwathOSWWriter writer("dummy.osw", 1);
+  OpenSwathOSWWriter::FeatureRows rows;
+  TEST_EQUAL(rows.empty(), true)
+  writer.prepareRows(createFeatures(1), "5", rows);
+  TEST_EQUAL(rows.empty(), false)
+  TEST_EQUAL(rows.feature.int_values.size(), 3 * 3)
+  TEST_EQUAL(rows.feature_transition.int_values.size(), 3 * 2 * 2)
+  TEST_EQUAL(rows.feature_precursor.int_values.size(), 3 * 2)
+  TEST_EQUAL(rows.feature_ms1.int_values.size(), 0) // no MS1 scores requested
+
+  // identifiers must be integers
+  OpenSwathOSWWriter::FeatureRows invalid;
+  TEST_EXCEPTION(Exception::ConversionError, writer.prepareRows(createFeatures(1), "PEPTIDE", invalid))
+}
+END_SECTION
+
+START_SECTION((void queueRows(FeatureRows&& rows)) and (void flush()))
+{
+  // writing through the background thread gives the same tables as prepareLine / writeLines
+  String text_file, queued_file;
+  NEW_TMP_FILE(text_file)
+  NEW_TMP_FILE(queued_file)
+
+  OpenSwathOSWWriter text_writer(text_file, 7, "run.mzML", true, true);
+  OpenSwathOSWWriter queued_writer(queued_file, 7, "run.mzML", true, true);
+  text_writer.writeHeader();
+  queued_writer.writeHeader();
+
+  std::vector<String> lines;
+  for (Int batch = 0; batch < 4; ++batch)
+  {
+    FeatureMap features = createFeatures(100 * batch + 1);
+    String id(batch + 1);
+    lines.push_back(text_writer.prepareLine(OpenSwath::LightCompound(), nullptr, features, id));
+
+    OpenSwathOSWWriter::FeatureRows rows;
+    queued_writer.prepareRows(features, id, rows);
+    queued_writer.queueRows(std::move(rows));
+  }
+  text_writer.writeLines(lines);
+  queued_writer.flush();
+
+  for (const String& table : tables)
+  {
+    vector<String> expected = dumpTable(text_file, table);
+    vector<String> queued = dumpTable(queued_file, table);
+    TEST_EQUAL(queued.size(), expected.size())
+    TEST_EQUAL(queued == expected, true)
+  }
+  TEST_EQUAL(dumpTable(queued_file, "FEATURE").size(), 4 * 3)
+
+  // writeRows (synchronous) gives the same result
+  String rows_file;
+  NEW_TMP_FILE(rows_file)
+  OpenSwathOSWWriter rows_writer(rows_file, 7, "run.mzML", true, true);
+  rows_writer.writeHeader();
+  OpenSwathOSWWriter::FeatureRows all_rows;
+  for (Int batch = 0; batch < 4; ++batch)
+  {
+    rows_writer.prepareRows(createFeatures(100 * batch + 1), String(batch + 1), all_rows);
+  }
+  rows_writer.writeRows(all_rows);
+  for (const String& table : tables)
+  {
+    TEST_EQUAL(dumpTable(rows_file, table) == dumpTable(text_file, table), true)
+  }
+}
+END_SECTION
+
+START_SECTION([EXTRA] flush() rethrows errors of the writer thread)
+{
+  // no tables were created (writeHeader was not called), so the writer thread fails
+  String filename;
+  NEW_TMP_FILE(filename)
+  OpenSwathOSWWriter writer(filename, 7);
+  auto queue_and_flush = [&writer]()
+  {
+    OpenSwathOSWWriter::FeatureRows rows;
+    writer.prepareRows(createFeatures(1), "1", rows);
+    writer.queueRows(std::move(rows));
+    writer.flush();
+  };
+  TEST_EXCEPTION(Exception::SqlOperationFailed, queue_and_flush())
+  // the error is reported again
+  TEST_EXCEPTION(Exception::SqlOperationFailed, writer.flush())
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -35,10 +35,12 @@
 #include <OpenMS/CONCEPT/ClassTest.h>
 #include <OpenMS/test_config.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/KERNEL/OnDiscMSExperiment.h>
 
 ///////////////////////////
 #include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiRes.h>
 ///////////////////////////
+#include <OpenMS/KERNEL/SpectrumArrays.h>
 
 using namespace OpenMS;
 using namespace std;
@@ -207,6 +209,66 @@ START_SECTION((template <typename PeakType> void pick(const MSSpectrum& input, M
 }
 END_SECTION
 
+START_SECTION((void pick(const SpectrumArrays<double>& input, SpectrumArrays<double>& output, std::vector<PeakBoundary>& boundaries, bool check_spacings = true) const))
+{
+  // identical result to the MSSpectrum version
+  MSSpectrum ref_spec;
+  std::vector<PeakPickerHiRes::PeakBoundary> ref_boundaries, tmp_boundaries;
+  pp_hires.pick(input[0], ref_spec, ref_boundaries);
+
+  SpectrumArrays<double> soa_in(input[0]), soa_out;
+  pp_hires.pick(soa_in, soa_out, tmp_boundaries);
+  TEST_EQUAL(soa_out.size(), ref_spec.size())
+  TEST_EQUAL(tmp_boundaries.size(), ref_boundaries.size())
+  ABORT_IF(soa_out.size() != ref_spec.size())
+  for (Size peak_idx = 0; peak_idx < soa_out.size(); ++peak_idx)
+  {
+    TEST_EQUAL(soa_out[peak_idx].getMZ(), ref_spec[peak_idx].getMZ())
+    TEST_EQUAL(soa_out[peak_idx].getIntensity(), ref_spec[peak_idx].getIntensity())
+    TEST_EQUAL(tmp_boundaries[peak_idx].mz_min, ref_boundaries[peak_idx].mz_min)
+  }
+
+  // ion mobility
+  PeakPickerHiRes pp_im;
+  Param p_im;
+  p_im.setValue("signal_to_noise", 0.0);
+  pp_im.setParameters(p_im);
+  SpectrumArrays<double> im_in, im_out;
+  im_in.push_back(100.0, 200);
+  im_in.push_back(100.01, 250);
+  im_in.push_back(100.02, 450);
+  im_in.push_back(100.03, 250);
+  im_in.push_back(100.04, 200);
+  im_in.getFloatDataArrays().resize(1);
+  im_in.getFloatDataArrays()[0].setName("Ion Mobility");
+  im_in.getFloatDataArrays()[0].assign({100.0, 150.0, 150.0, 150.0, 100.0});
+  tmp_boundaries.clear();
+  pp_im.pick(im_in, im_out, tmp_boundaries);
+  TEST_EQUAL(im_out.size(), 1)
+  TEST_REAL_SIMILAR(im_out[0].getMZ(), 100.02)
+  TEST_EQUAL(im_out.getFloatDataArrays().size(), 1)
+  TEST_REAL_SIMILAR(im_out.getFloatDataArrays()[0][0], 135.1852)
+}
+END_SECTION
+
+START_SECTION((void pick(const SpectrumArrays<float>& input, SpectrumArrays<float>& output, std::vector<PeakBoundary>& boundaries, bool check_spacings = true) const))
+{
+  MSSpectrum ref_spec;
+  std::vector<PeakPickerHiRes::PeakBoundary> ref_boundaries, tmp_boundaries;
+  pp_hires.pick(input[0], ref_spec, ref_boundaries);
+
+  // single precision m/z: same peaks, m/z within float precision
+  SpectrumArrays<float> soa_in(input[0]), soa_out;
+  pp_hires.pick(soa_in, soa_out, tmp_boundaries);
+  TEST_EQUAL(soa_out.size(), ref_spec.size())
+  ABORT_IF(soa_out.size() != ref_spec.size())
+  for (Size peak_idx = 0; peak_idx < soa_out.size(); ++peak_idx)
+  {
+    TEST_REAL_SIMILAR(soa_out[peak_idx].getMZ(), ref_spec[peak_idx].getMZ())
+  }
+}
+END_SECTION
+
 START_SECTION([EXTRA](template <typename PeakType> void pickExperiment(const MSExperiment<PeakType>& input, MSExperiment<PeakType>& output)))
   // does the same as pick method for spectra
   NOT_TESTABLE
@@ -574,4 +636,35 @@ START_SECTION(void pick(const MSSpectrum& input, MSSpectrum& output, std::vector
 }
 END_SECTION
 
+START_SECTION(void pickExperiment(const OnDiscMSExperiment& input, PeakMap& output, const bool check_spectrum_type = true) const)
+{
+  // store the profile data as indexed mzML and pick it from disk
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  MzMLFile mzml;
+  mzml.getOptions().setWriteIndex(true);
+  mzml.store(tmp_filename, input);
+
+  OnDiscMSExperiment ondisc;
+  TEST_EQUAL(ondisc.openFile(tmp_filename), true)
+
+  PeakMap picked_memory, picked_disk;
+  pp_hires.pickExperiment(input, picked_memory);
+  pp_hires.pickExperiment(ondisc, picked_disk);
+
+  TEST_EQUAL(picked_disk.size(), picked_memory.size())
+  TEST_EQUAL(picked_disk.getNrChromatograms(), picked_memory.getNrChromatograms())
+  for (Size i = 0; i < picked_disk.size(); ++i)
+  {
+    TEST_EQUAL(picked_disk[i].size(), picked_memory[i].size())
+    ABORT_IF(picked_disk[i].size() != picked_memory[i].size())
+    for (Size k = 0; k < picked_disk[i].size(); ++k)
+    {
+      TEST_REAL_SIMILAR(picked_disk[i][k].getMZ(), picked_memory[i][k].getMZ())
+      TEST_REAL_SIMILAR(picked_disk[i][k].getIntensity(), picked_memory[i][k].getIntensity())
+    }
+  }
+}
+END_SECTION
+
 END_TEST
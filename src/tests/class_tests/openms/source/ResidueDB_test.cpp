@@ -128,6 +128,42 @@ START_SECTION(Size getNumberOfModifiedResidues() const)
 	TEST_EQUAL(ptr->getNumberOfModifiedResidues(), 2)
 END_SECTION
 
+// these sections change the state of the singleton, so keep them last
+START_SECTION(void freeze())
+	TEST_EQUAL(ptr->isFrozen(), false)
+	ptr->freeze();
+	TEST_EQUAL(ptr->isFrozen(), true)
+	TEST_EQUAL(ptr->getNumberOfModifiedResidues(), 2)
+
+	// modified residues of the frozen snapshot
+	const Residue* mod_res = ptr->getModifiedResidue(ptr->getResidue("M"), "Oxidation (M)");
+	TEST_STRING_EQUAL(mod_res->getModificationName(), "Oxidation")
+	TEST_EQUAL(ptr->hasResidue(mod_res), true)
+	TEST_EQUAL(ptr->getNumberOfModifiedResidues(), 2)
+
+	// new modified residues can still be created after freezing
+	const Residue* new_res = ptr->getModifiedResidue(ptr->getResidue("S"), "Phospho (S)");
+	TEST_STRING_EQUAL(new_res->getModificationName(), "Phospho")
+	TEST_EQUAL(ptr->hasResidue(new_res), true)
+	TEST_EQUAL(ptr->getNumberOfModifiedResidues(), 3)
+	TEST_EQUAL(ptr->getModifiedResidue(ptr->getResidue("S"), "Phospho (S)"), new_res)
+	TEST_EQUAL(ptr->getNumberOfModifiedResidues(), 3)
+END_SECTION
+
+START_SECTION(bool isFrozen() const)
+	TEST_EQUAL(ptr->isFrozen(), true)
+END_SECTION
+
+START_SECTION(void unfreeze())
+	ptr->unfreeze();
+	TEST_EQUAL(ptr->isFrozen(), false)
+	TEST_EQUAL(ptr->getNumberOfModifiedResidues(), 3)
+	// residues created while frozen are still found
+	const Residue* phospho = ptr->getModifiedResidue(ptr->getResidue("S"), "Phospho (S)");
+	TEST_EQUAL(ptr->hasResidue(phospho), true)
+	TEST_EQUAL(ptr->getNumberOfModifiedResidues(), 3)
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
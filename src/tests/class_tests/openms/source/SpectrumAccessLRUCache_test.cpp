@@ -0,0 +1,174 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSInMemory.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessLRUCache.h>
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+boost::shared_ptr<PeakMap > getData()
+{
+  boost::shared_ptr<PeakMap > exp2(new PeakMap);
+  for (Size i = 0; i < 3; ++i)
+  {
+    MSSpectrum spec;
+    spec.setRT(10.0 * i);
+    Peak1D p;
+    p.setMZ(100 + i);
+    p.setIntensity(50);
+    spec.push_back(p);
+    exp2->addSpectrum(spec);
+  }
+  return exp2;
+}
+
+START_TEST(SpectrumAccessLRUCache, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+SpectrumAccessLRUCache* ptr = nullptr;
+SpectrumAccessLRUCache* nullPointer = nullptr;
+
+boost::shared_ptr<PeakMap > exp = getData();
+OpenSwath::SpectrumAccessPtr expptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+
+START_SECTION(SpectrumAccessLRUCache(OpenSwath::SpectrumAccessPtr sptr, Size capacity))
+{
+  ptr = new SpectrumAccessLRUCache(expptr, 2);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getNrSpectra(), 3)
+  TEST_EQUAL(ptr->getNrHits(), 0)
+  TEST_EQUAL(ptr->getNrMisses(), 0)
+}
+END_SECTION
+
+START_SECTION(~SpectrumAccessLRUCache())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(static OpenSwath::SpectrumAccessPtr create(OpenSwath::SpectrumAccessPtr sptr, Size capacity))
+{
+  OpenSwath::SpectrumAccessPtr cached = SpectrumAccessLRUCache::create(expptr, 2);
+  TEST_NOT_EQUAL(dynamic_cast<SpectrumAccessLRUCache*>(cached.get()), nullPointer)
+  TEST_EQUAL(cached->getNrSpectra(), 3)
+
+  // nothing to gain from wrapping twice, wrapping in-memory data or disabled caching
+  TEST_EQUAL(SpectrumAccessLRUCache::create(cached, 2).get(), cached.get())
+  TEST_EQUAL(SpectrumAccessLRUCache::create(expptr, 0).get(), expptr.get())
+  OpenSwath::SpectrumAccessPtr in_memory(new SpectrumAccessOpenMSInMemory(*expptr));
+  TEST_EQUAL(SpectrumAccessLRUCache::create(in_memory, 2).get(), in_memory.get())
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumPtr getSpectrumById(int id))
+{
+  SpectrumAccessLRUCache cache(expptr, 2);
+  OpenSwath::SpectrumPtr s0 = cache.getSpectrumById(0);
+  TEST_EQUAL(s0->getMZArray()->data.size(), 1)
+  TEST_REAL_SIMILAR(s0->getMZArray()->data[0], 100)
+  TEST_EQUAL(cache.getNrMisses(), 1)
+
+  // second access is served from the cache
+  TEST_EQUAL(cache.getSpectrumById(0).get(), s0.get())
+  TEST_EQUAL(cache.getNrHits(), 1)
+
+  // fetching two more spectra evicts the least recently used one (id 0)
+  cache.getSpectrumById(1);
+  cache.getSpectrumById(2);
+  TEST_EQUAL(cache.getNrMisses(), 3)
+  TEST_REAL_SIMILAR(cache.getSpectrumById(2)->getMZArray()->data[0], 102)
+  TEST_EQUAL(cache.getNrHits(), 2)
+  TEST_REAL_SIMILAR(cache.getSpectrumById(0)->getMZArray()->data[0], 100)
+  TEST_EQUAL(cache.getNrMisses(), 4)
+
+  // id 1 was least recently used and got evicted by id 0
+  cache.getSpectrumById(1);
+  TEST_EQUAL(cache.getNrMisses(), 5)
+  TEST_EQUAL(cache.getNrHits(), 2)
+
+  // no caching
+  SpectrumAccessLRUCache no_cache(expptr, 0);
+  no_cache.getSpectrumById(0);
+  no_cache.getSpectrumById(0);
+  TEST_EQUAL(no_cache.getNrHits(), 0)
+  TEST_EQUAL(no_cache.getNrMisses(), 2)
+}
+END_SECTION
+
+START_SECTION(Size getNrHits() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(Size getNrMisses() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const)
+{
+  SpectrumAccessLRUCache cache(expptr, 2);
+  cache.getSpectrumById(1);
+
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> clone_ptr = cache.lightClone();
+  TEST_EQUAL(clone_ptr->getNrSpectra(), cache.getNrSpectra())
+  TEST_REAL_SIMILAR(clone_ptr->getSpectrumMetaById(2).RT, 20.0)
+  TEST_REAL_SIMILAR(clone_ptr->getSpectrumById(1)->getMZArray()->data[0], 101)
+
+  // the clone has its own cache
+  SpectrumAccessLRUCache* clone = dynamic_cast<SpectrumAccessLRUCache*>(clone_ptr.get());
+  TEST_NOT_EQUAL(clone, nullPointer)
+  TEST_EQUAL(clone->getNrHits(), 0)
+  TEST_EQUAL(clone->getNrMisses(), 1)
+  TEST_EQUAL(cache.getNrMisses(), 1)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
+
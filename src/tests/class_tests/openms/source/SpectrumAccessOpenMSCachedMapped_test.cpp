@@ -0,0 +1,250 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedMapped.h>
+///////////////////////////
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMS.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCached.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSInMemory.h>
+#include <OpenMS/FORMAT/CachedMzML.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(SpectrumAccessOpenMSCachedMapped, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+// Cache the experiment to a temporary file
+PeakMap exp;
+MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+std::string tmpf;
+NEW_TMP_FILE(tmpf);
+CachedmzML::store(tmpf, exp);
+
+SpectrumAccessOpenMSCachedMapped* ptr = nullptr;
+SpectrumAccessOpenMSCachedMapped* nullPointer = nullptr;
+
+START_SECTION(SpectrumAccessOpenMSCachedMapped(const String& filename))
+{
+  ptr = new SpectrumAccessOpenMSCachedMapped(tmpf);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EXCEPTION(Exception::FileNotFound, SpectrumAccessOpenMSCachedMapped(tmpf + "_does_not_exist"))
+}
+END_SECTION
+
+START_SECTION(~SpectrumAccessOpenMSCachedMapped())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(size_t getNrSpectra() const)
+{
+  SpectrumAccessOpenMSCachedMapped mapped(tmpf);
+  TEST_EQUAL(mapped.getNrSpectra(), 4)
+}
+END_SECTION
+
+START_SECTION(size_t getNrChromatograms() const)
+{
+  SpectrumAccessOpenMSCachedMapped mapped(tmpf);
+  TEST_EQUAL(mapped.getNrChromatograms(), 2)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumPtr getSpectrumById(int id))
+{
+  SpectrumAccessOpenMSCachedMapped mapped(tmpf);
+  SpectrumAccessOpenMSCached cached(tmpf);
+  for (int i = 0; i < 4; i++)
+  {
+    OpenSwath::SpectrumPtr s1 = mapped.getSpectrumById(i);
+    OpenSwath::SpectrumPtr s2 = cached.getSpectrumById(i);
+    TEST_EQUAL(s1->getDataArrays().size(), s2->getDataArrays().size())
+    ABORT_IF(s1->getDataArrays().size() != s2->getDataArrays().size())
+    for (Size k = 0; k < s1->getDataArrays().size(); k++)
+    {
+      TEST_EQUAL(s1->getDataArrays()[k]->description, s2->getDataArrays()[k]->description)
+      TEST_EQUAL(s1->getDataArrays()[k]->data == s2->getDataArrays()[k]->data, true)
+    }
+  }
+
+  // spectrum 1 carries two additional float data arrays
+  OpenSwath::SpectrumPtr s = mapped.getSpectrumById(1);
+  TEST_EQUAL(s->getDataArrays().size(), 4)
+  TEST_EQUAL(s->getDataArrays()[2]->description, "signal to noise array")
+  TEST_EQUAL(s->getDataArrays()[3]->description, "user-defined name")
+  TEST_EQUAL(s->getMZArray()->data.size(), exp[1].size())
+  for (Size k = 0; k < exp[1].size(); k++)
+  {
+    TEST_REAL_SIMILAR(s->getMZArray()->data[k], exp[1][k].getMZ())
+    TEST_REAL_SIMILAR(s->getIntensityArray()->data[k], exp[1][k].getIntensity())
+  }
+}
+END_SECTION
+
+START_SECTION(void fillSpectrumById(int id, OpenSwath::Spectrum& spectrum))
+{
+  // all implementations need to fill the same data into a reused spectrum
+  boost::shared_ptr<PeakMap> exp_ptr(new PeakMap(exp));
+  std::vector<OpenSwath::SpectrumAccessPtr> accessors;
+  accessors.push_back(OpenSwath::SpectrumAccessPtr(new SpectrumAccessOpenMSCachedMapped(tmpf)));
+  accessors.push_back(OpenSwath::SpectrumAccessPtr(new SpectrumAccessOpenMSCached(tmpf)));
+  accessors.push_back(OpenSwath::SpectrumAccessPtr(new SpectrumAccessOpenMS(exp_ptr)));
+  accessors.push_back(OpenSwath::SpectrumAccessPtr(new SpectrumAccessOpenMSInMemory(*accessors[0]))); // default implementation
+
+  for (const auto& acc : accessors)
+  {
+    OpenSwath::Spectrum buffer;
+    OpenSwath::BinaryDataArrayPtr mz_array = buffer.getMZArray();
+    for (int i : {1, 0, 2, 1, 3})
+    {
+      acc->fillSpectrumById(i, buffer);
+      OpenSwath::SpectrumPtr s = acc->getSpectrumById(i);
+      TEST_EQUAL(buffer.getDataArrays().size(), s->getDataArrays().size())
+      ABORT_IF(buffer.getDataArrays().size() != s->getDataArrays().size())
+      for (Size k = 0; k < s->getDataArrays().size(); k++)
+      {
+        TEST_EQUAL(buffer.getDataArrays()[k]->description, s->getDataArrays()[k]->description)
+        TEST_EQUAL(buffer.getDataArrays()[k]->data == s->getDataArrays()[k]->data, true)
+      }
+      // the arrays of the buffer are reused
+      TEST_EQUAL(buffer.getMZArray().get(), mz_array.get())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(OpenSwath::ChromatogramPtr getChromatogramById(int id))
+{
+  SpectrumAccessOpenMSCachedMapped mapped(tmpf);
+  SpectrumAccessOpenMSCached cached(tmpf);
+  for (int i = 0; i < 2; i++)
+  {
+    OpenSwath::ChromatogramPtr c1 = mapped.getChromatogramById(i);
+    OpenSwath::ChromatogramPtr c2 = cached.getChromatogramById(i);
+    TEST_EQUAL(c1->getDataArrays().size(), c2->getDataArrays().size())
+    TEST_EQUAL(c1->getTimeArray()->data == c2->getTimeArray()->data, true)
+    TEST_EQUAL(c1->getIntensityArray()->data == c2->getIntensityArray()->data, true)
+    TEST_EQUAL(mapped.getChromatogramNativeID(i), exp.getChromatogram(i).getNativeID())
+  }
+}
+END_SECTION
+
+START_SECTION(DataView getSpectrumViewById(int id) const)
+{
+  SpectrumAccessOpenMSCachedMapped mapped(tmpf);
+  for (int i = 0; i < 4; i++)
+  {
+    SpectrumAccessOpenMSCachedMapped::DataView view = mapped.getSpectrumViewById(i);
+    TEST_EQUAL(view.size(), exp[i].size())
+    TEST_EQUAL(view.ms_level, (int)exp[i].getMSLevel())
+    TEST_REAL_SIMILAR(view.rt, exp[i].getRT())
+    TEST_EQUAL(view.nr_arrays, 2 + exp[i].getFloatDataArrays().size() + exp[i].getIntegerDataArrays().size())
+    for (Size k = 0; k < view.size(); k++)
+    {
+      TEST_REAL_SIMILAR(view.getPositionArray()[k], exp[i][k].getMZ())
+      TEST_REAL_SIMILAR(view.getIntensityArray()[k], exp[i][k].getIntensity())
+    }
+  }
+
+  SpectrumAccessOpenMSCachedMapped::DataView view = mapped.getSpectrumViewById(1);
+  TEST_EQUAL(view.arrays[2].getDescription(), "signal to noise array")
+  TEST_EQUAL(view.arrays[2].size, exp[1].getFloatDataArrays()[0].size())
+  for (Size k = 0; k < view.arrays[2].size; k++)
+  {
+    TEST_REAL_SIMILAR(view.arrays[2][k], exp[1].getFloatDataArrays()[0][k])
+  }
+}
+END_SECTION
+
+START_SECTION(DataView getChromatogramViewById(int id) const)
+{
+  SpectrumAccessOpenMSCachedMapped mapped(tmpf);
+  for (int i = 0; i < 2; i++)
+  {
+    SpectrumAccessOpenMSCachedMapped::DataView view = mapped.getChromatogramViewById(i);
+    TEST_EQUAL(view.size(), exp.getChromatogram(i).size())
+    for (Size k = 0; k < view.size(); k++)
+    {
+      TEST_REAL_SIMILAR(view.getPositionArray()[k], exp.getChromatogram(i)[k].getRT())
+      TEST_REAL_SIMILAR(view.getIntensityArray()[k], exp.getChromatogram(i)[k].getIntensity())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const)
+{
+  SpectrumAccessOpenMSCachedMapped mapped(tmpf);
+  OpenSwath::SpectrumAccessPtr clone = mapped.lightClone();
+  TEST_EQUAL(clone->getNrSpectra(), mapped.getNrSpectra())
+
+  // the clone shares the mapping: views point to the same memory
+  boost::shared_ptr<SpectrumAccessOpenMSCachedMapped> mapped_clone = boost::dynamic_pointer_cast<SpectrumAccessOpenMSCachedMapped>(clone);
+  TEST_EQUAL(mapped_clone->getSpectrumViewById(0).arrays[0].data == mapped.getSpectrumViewById(0).arrays[0].data, true)
+
+  // concurrent access from multiple threads on a single instance
+  Size nr_errors = 0;
+#pragma omp parallel for reduction(+: nr_errors)
+  for (int k = 0; k < 400; k++)
+  {
+    int i = k % 4;
+    OpenSwath::SpectrumPtr s = mapped.getSpectrumById(i);
+    if (s->getMZArray()->data.size() != exp[i].size()) ++nr_errors;
+  }
+  TEST_EQUAL(nr_errors, 0)
+}
+END_SECTION
+
+START_SECTION(std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const)
+{
+  SpectrumAccessOpenMSCachedMapped mapped(tmpf);
+  SpectrumAccessOpenMSCached cached(tmpf);
+  TEST_EQUAL(mapped.getSpectraByRT(exp[1].getRT(), 10.0) == cached.getSpectraByRT(exp[1].getRT(), 10.0), true)
+  TEST_EQUAL(mapped.getSpectrumMetaById(2).RT, cached.getSpectrumMetaById(2).RT)
+  TEST_EQUAL(mapped.getSpectrumMetaById(2).ms_level, cached.getSpectrumMetaById(2).ms_level)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,298 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/KERNEL/SpectrumArrays.h>
+///////////////////////////
+
+#include <OpenMS/ANALYSIS/OPENSWATH/ChromatogramExtractor.h>
+#include <OpenMS/FILTERING/NOISEESTIMATION/SignalToNoiseEstimatorMedian.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(SpectrumArrays, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+MSSpectrum spec;
+spec.setRT(10.0);
+spec.emplace_back(400.0, 10.0f);
+spec.emplace_back(400.1, 20.0f);
+spec.emplace_back(400.2, 30.0f);
+spec.emplace_back(400.3, 5.0f);
+spec.getFloatDataArrays().resize(1);
+spec.getFloatDataArrays()[0].setName("Ion Mobility");
+spec.getFloatDataArrays()[0].assign({1.0f, 2.0f, 3.0f, 4.0f});
+
+SpectrumArrays<double>* ptr = nullptr;
+SpectrumArrays<double>* nullPointer = nullptr;
+START_SECTION((SpectrumArrays()))
+{
+  ptr = new SpectrumArrays<double>();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->empty(), true)
+}
+END_SECTION
+
+START_SECTION((~SpectrumArrays()))
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((static constexpr Size bytesPerPeak()))
+{
+  TEST_EQUAL(SpectrumArrays<double>::bytesPerPeak(), 12)
+  TEST_EQUAL(SpectrumArrays<float>::bytesPerPeak(), 8)
+  TEST_EQUAL(sizeof(Peak1D), 16)
+}
+END_SECTION
+
+START_SECTION((explicit SpectrumArrays(const MSSpectrum& spectrum)))
+{
+  SpectrumArrays<double> s(spec);
+  TEST_EQUAL(s.size(), 4)
+  TEST_EQUAL(s[1].getMZ(), 400.1)
+  TEST_EQUAL(s[1].getIntensity(), 20.0f)
+  TEST_EQUAL(s.getMZArray()[2], 400.2)
+  TEST_EQUAL(s.getIntensityArray()[3], 5.0f)
+  TEST_EQUAL(s.getFloatDataArrays().size(), 1)
+  TEST_EQUAL(s.getFloatDataArrays()[0].getName(), "Ion Mobility")
+
+  SpectrumArrays<float> s_float(spec);
+  TEST_EQUAL(s_float.size(), 4)
+  TEST_REAL_SIMILAR(s_float[1].getMZ(), 400.1)
+  TEST_EQUAL(s_float[1].getMZ() == 400.1, false) // single precision
+}
+END_SECTION
+
+START_SECTION((void assign(const MSSpectrum& spectrum)))
+{
+  SpectrumArrays<double> s;
+  s.push_back(1.0, 1.0f);
+  s.assign(spec);
+  TEST_EQUAL(s.size(), 4)
+  TEST_EQUAL(s[0].getMZ(), 400.0)
+}
+END_SECTION
+
+START_SECTION((void toSpectrum(MSSpectrum& spectrum) const))
+{
+  SpectrumArrays<double> s(spec);
+  MSSpectrum out;
+  out.setRT(42.0);
+  s.toSpectrum(out);
+  TEST_EQUAL(out.getRT(), 42.0)
+  TEST_EQUAL(out.size(), spec.size())
+  for (Size i = 0; i < out.size(); ++i)
+  {
+    TEST_EQUAL(out[i] == spec[i], true)
+  }
+  TEST_EQUAL(out.getFloatDataArrays() == spec.getFloatDataArrays(), true)
+}
+END_SECTION
+
+START_SECTION((void push_back(const PeakType& peak)))
+{
+  SpectrumArrays<double> s;
+  s.push_back(Peak1D(100.0, 2.0f));
+  s.push_back(101.0, 3.0f);
+  TEST_EQUAL(s.size(), 2)
+  TEST_EQUAL(s[0].getMZ(), 100.0)
+  TEST_EQUAL(s[1].getIntensity(), 3.0f)
+  Peak1D p = s[1];
+  TEST_EQUAL(p.getMZ(), 101.0)
+  s.clear();
+  TEST_EQUAL(s.empty(), true)
+}
+END_SECTION
+
+START_SECTION((ConstIterator begin() const))
+{
+  SpectrumArrays<double> s(spec);
+  double sum = 0;
+  for (const auto& p : s)
+  {
+    sum += p.getIntensity();
+  }
+  TEST_REAL_SIMILAR(sum, 65.0)
+  TEST_EQUAL(s.end() - s.begin(), 4)
+  auto max_it = std::max_element(s.begin(), s.end(),
+    [](const SpectrumArrays<double>::ConstPeak& a, const SpectrumArrays<double>::ConstPeak& b) { return a.getIntensity() < b.getIntensity(); });
+  TEST_EQUAL(max_it->getMZ(), 400.2)
+  TEST_EQUAL(max_it.getIndex(), 2)
+}
+END_SECTION
+
+START_SECTION((void sortByPosition()))
+{
+  SpectrumArrays<double> s;
+  s.push_back(300.0, 3.0f);
+  s.push_back(100.0, 1.0f);
+  s.push_back(200.0, 2.0f);
+  s.getFloatDataArrays().resize(1);
+  s.getFloatDataArrays()[0].assign({30.0f, 10.0f, 20.0f});
+  TEST_EQUAL(s.isSorted(), false)
+  s.sortByPosition();
+  TEST_EQUAL(s.isSorted(), true)
+  TEST_EQUAL(s[0].getMZ(), 100.0)
+  TEST_EQUAL(s[0].getIntensity(), 1.0f)
+  TEST_EQUAL(s[2].getIntensity(), 3.0f)
+  TEST_EQUAL(s.getFloatDataArrays()[0][0], 10.0f)
+  TEST_EQUAL(s.getFloatDataArrays()[0][2], 30.0f)
+}
+END_SECTION
+
+START_SECTION((Size MZBegin(CoordinateType mz) const))
+{
+  SpectrumArrays<double> s(spec);
+  TEST_EQUAL(s.MZBegin(399.0), 0)
+  TEST_EQUAL(s.MZBegin(400.15), 2)
+  TEST_EQUAL(s.MZBegin(400.2), 2)
+  TEST_EQUAL(s.MZBegin(500.0), 4)
+  TEST_EQUAL(s.MZEnd(400.2), 3)
+}
+END_SECTION
+
+START_SECTION([EXTRA] SignalToNoiseEstimatorMedian on SpectrumArrays)
+{
+  MSSpectrum raw;
+  for (Size i = 0; i < 200; ++i)
+  {
+    raw.emplace_back(400.0 + i * 0.01, float((i * 7) % 13 + (i == 100 ? 500 : 0)));
+  }
+  SignalToNoiseEstimatorMedian<MSSpectrum> sn_aos;
+  sn_aos.init(raw);
+  SignalToNoiseEstimatorMedian<SpectrumArrays<double>> sn_soa;
+  SpectrumArrays<double> soa(raw);
+  sn_soa.init(soa);
+  for (Size i = 0; i < raw.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(sn_soa.getSignalToNoise(i), sn_aos.getSignalToNoise(i))
+  }
+}
+END_SECTION
+
+START_SECTION([EXTRA] ChromatogramExtractor::extract_value_tophat on SpectrumArrays)
+{
+  ChromatogramExtractor extractor;
+  SpectrumArrays<float> soa(spec);
+  Size peak_idx = 0, peak_idx_ref = 0;
+  double integrated_intensity = 0, integrated_intensity_ref = 0;
+  for (double mz : {399.9, 400.05, 400.2, 400.35})
+  {
+    extractor.extract_value_tophat(soa, mz, peak_idx, integrated_intensity, 0.25, false);
+    extractor.extract_value_tophat(spec, mz, peak_idx_ref, integrated_intensity_ref, 0.25, false);
+    TEST_EQUAL(peak_idx, peak_idx_ref)
+    TEST_REAL_SIMILAR(integrated_intensity, integrated_intensity_ref)
+  }
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+// ExperimentArrays
+
+PeakMap exp_in;
+exp_in.addSpectrum(spec);
+exp_in.addSpectrum(MSSpectrum());
+exp_in.addSpectrum(spec);
+exp_in[1].setMSLevel(2);
+exp_in[1].setRT(11.0);
+exp_in[2].setRT(12.0);
+exp_in[2].pop_back();
+
+START_SECTION((explicit ExperimentArrays(const PeakMap& exp)))
+{
+  ExperimentArrays<double> e(exp_in);
+  TEST_EQUAL(e.size(), 3)
+  TEST_EQUAL(e.getNrPeaks(), 7)
+  TEST_EQUAL(e.getSpectrumSize(0), 4)
+  TEST_EQUAL(e.getSpectrumSize(1), 0)
+  TEST_EQUAL(e.getSpectrumSize(2), 3)
+  TEST_EQUAL(e.getOffset(2), 4)
+  TEST_EQUAL(e.getOffset(3), 7)
+  TEST_EQUAL(e.getMZ(2)[1], 400.1)
+  TEST_EQUAL(e.getIntensity(2)[2], 30.0f)
+  TEST_EQUAL(e.getRT(1), 11.0)
+  TEST_EQUAL(e.getMSLevel(1), 2)
+  TEST_EQUAL(e.getSpectrum(2).size(), 3)
+  TEST_EQUAL(e.getSpectrum(2)[0].getMZ(), 400.0)
+}
+END_SECTION
+
+START_SECTION((void toExperiment(PeakMap& exp) const))
+{
+  ExperimentArrays<double> e(exp_in);
+  PeakMap out;
+  e.toExperiment(out);
+  TEST_EQUAL(out.size(), 3)
+  for (Size i = 0; i < out.size(); ++i)
+  {
+    TEST_EQUAL(out[i].getRT(), exp_in[i].getRT())
+    TEST_EQUAL(out[i].getMSLevel(), exp_in[i].getMSLevel())
+    TEST_EQUAL(out[i].size(), exp_in[i].size())
+    for (Size k = 0; k < out[i].size(); ++k)
+    {
+      TEST_EQUAL(out[i][k] == exp_in[i][k], true)
+    }
+  }
+  out.resize(1);
+  TEST_EXCEPTION(Exception::IllegalArgument, e.toExperiment(out))
+}
+END_SECTION
+
+START_SECTION((void push_back(const MSSpectrum& spectrum)))
+{
+  ExperimentArrays<float> e;
+  TEST_EQUAL(e.empty(), true)
+  e.push_back(spec);
+  e.push_back(spec);
+  TEST_EQUAL(e.size(), 2)
+  TEST_EQUAL(e.getNrPeaks(), 8)
+  TEST_EQUAL(e.getOffset(1), 4)
+  TEST_REAL_SIMILAR(e.getMZ(1)[3], 400.3)
+  e.clear();
+  TEST_EQUAL(e.size(), 0)
+  TEST_EQUAL(e.getNrPeaks(), 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
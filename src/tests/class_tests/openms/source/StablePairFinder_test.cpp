@@ -37,6 +37,10 @@
 #include <OpenMS/KERNEL/StandardTypes.h>
 #include <OpenMS/KERNEL/ConsensusMap.h>
 #include <OpenMS/KERNEL/Feature.h>
+#include <OpenMS/ANALYSIS/MAPMATCHING/FeatureDistance.h>
+
+#include <map>
+#include <random>
 
 ///////////////////////////
 #include <OpenMS/ANALYSIS/MAPMATCHING/StablePairFinder.h>
@@ -253,6 +257,132 @@ START_SECTION(([EXTRA] void run(const std::vector<ConsensusMap>& input_maps, Con
 }
 END_SECTION
 
+START_SECTION(([EXTRA] run() gives the same result as comparing all pairs))
+{
+  // random, dense maps (many near and invalid neighbors, different charges):
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> rt_dist(0.0, 2000.0), mz_dist(400.0, 420.0),
+    int_dist(1.0, 1e6), shift_dist(-50.0, 50.0), mz_shift_dist(-0.2, 0.2);
+  std::uniform_int_distribution<Int> charge_dist(0, 3);
+  std::vector<ConsensusMap> input(2);
+  UInt64 uid = 0;
+  for (Size i = 0; i < 400; ++i)
+  {
+    Feature feat;
+    feat.setRT(rt_dist(rng));
+    feat.setMZ(mz_dist(rng));
+    feat.setIntensity(int_dist(rng));
+    feat.setCharge(charge_dist(rng));
+    feat.setUniqueId(uid++);
+    input[0].push_back(ConsensusFeature(0, feat));
+    if (i % 4 != 0) // shifted counterpart
+    {
+      feat.setRT(feat.getRT() + shift_dist(rng));
+      feat.setMZ(feat.getMZ() + mz_shift_dist(rng));
+      feat.setUniqueId(uid++);
+      input[1].push_back(ConsensusFeature(1, feat));
+    }
+  }
+  input[0].updateRanges();
+  input[1].updateRanges();
+
+  for (Size setting = 0; setting < 3; ++setting)
+  {
+    StablePairFinder spf;
+    Param param = spf.getDefaults();
+    if (setting == 1)
+    {
+      param.setValue("distance_MZ:max_difference", 100.0);
+      param.setValue("distance_MZ:unit", "ppm");
+      param.setValue("distance_intensity:weight", 1.0);
+    }
+    else if (setting == 2)
+    {
+      param.setValue("distance_RT:exponent", 2.0);
+      param.setValue("distance_MZ:exponent", 1.0);
+      param.setValue("second_nearest_gap", 1.2);
+    }
+    spf.setParameters(param);
+    ConsensusMap result;
+    spf.run(input, result);
+
+    // reference: compare all pairs of features
+    Param distance_params = param.copy("");
+    distance_params.remove("use_identifications");
+    distance_params.remove("second_nearest_gap");
+    FeatureDistance feature_distance(max(input[0].getMaxIntensity(), input[1].getMaxIntensity()), false);
+    feature_distance.setParameters(distance_params);
+    double gap = param.getValue("second_nearest_gap");
+    const double inf = FeatureDistance::infinity;
+    std::vector<Size> nn0(input[0].size(), Size(-1)), nn1(input[1].size(), Size(-1));
+    std::vector<std::pair<double, double> > d0(input[0].size(), std::make_pair(inf, inf)), d1(input[1].size(), std::make_pair(inf, inf));
+    for (Size i = 0; i < input[0].size(); ++i)
+    {
+      for (Size j = 0; j < input[1].size(); ++j)
+      {
+        std::pair<bool, double> res = feature_distance(input[0][i], input[1][j]);
+        if (res.second < d0[i].second)
+        {
+          if (res.first && res.second < d0[i].first)
+          {
+            d0[i].second = d0[i].first; d0[i].first = res.second; nn0[i] = j;
+          }
+          else d0[i].second = res.second;
+        }
+        if (res.second < d1[j].second)
+        {
+          if (res.first && res.second < d1[j].first)
+          {
+            d1[j].second = d1[j].first; d1[j].first = res.second; nn1[j] = i;
+          }
+          else d1[j].second = res.second;
+        }
+      }
+    }
+    std::map<UInt64, std::pair<UInt64, double> > expected; // unique ID in map 0 -> (unique ID in map 1, quality)
+    for (Size i = 0; i < input[0].size(); ++i)
+    {
+      Size j = nn0[i];
+      if ((d0[i].first < inf) && (d0[i].first * gap <= d0[i].second) &&
+          (nn1[j] == i) && (d1[j].first * gap <= d1[j].second))
+      {
+        double quality = (1.0 - d0[i].first) * (1.0 - d0[i].first * gap / d0[i].second) *
+                         (1.0 - d1[j].first * gap / d1[j].second);
+        expected[input[0][i].begin()->getUniqueId()] = std::make_pair(input[1][j].begin()->getUniqueId(), quality);
+      }
+    }
+
+    std::map<UInt64, std::pair<UInt64, double> > found;
+    Size n_singletons = 0;
+    for (const ConsensusFeature& cf : result)
+    {
+      if (cf.size() == 1)
+      {
+        ++n_singletons;
+        continue;
+      }
+      UInt64 id0 = 0, id1 = 0;
+      for (const FeatureHandle& fh : cf)
+      {
+        (fh.getMapIndex() == 0 ? id0 : id1) = fh.getUniqueId();
+      }
+      found[id0] = std::make_pair(id1, cf.getQuality());
+    }
+    TEST_EQUAL(expected.empty(), false)
+    TEST_EQUAL(found.size(), expected.size())
+    TEST_EQUAL(n_singletons, input[0].size() + input[1].size() - 2 * expected.size())
+    for (const auto& entry : expected)
+    {
+      auto pos = found.find(entry.first);
+      TEST_EQUAL(pos != found.end(), true)
+      if (pos == found.end()) continue;
+      TEST_EQUAL(pos->second.first, entry.second.first)
+      TEST_REAL_SIMILAR(pos->second.second, entry.second.second)
+    }
+  }
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
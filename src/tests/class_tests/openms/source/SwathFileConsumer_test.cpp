@@ -555,6 +555,48 @@ START_SECTION(([EXTRA] consumeAndRetrieve_noMS2))
 }
 END_SECTION
 
+START_SECTION(([EXTRA] void setWriterThreads(Size nr_threads)))
+{
+  int nr_swath = 5;
+  int nr_cycles = 20;
+  std::vector<int> nr_ms2_spectra(nr_swath, nr_cycles);
+  cached_sfc_ptr = new CachedSwathFileConsumer("./", "tmp_osw_cached_threads", nr_cycles, nr_ms2_spectra);
+  cached_sfc_ptr->setWriterThreads(2);
+
+  // several cycles of MS1 + MS2 spectra (RT encodes the cycle)
+  for (int cycle = 0; cycle < nr_cycles; cycle++)
+  {
+    PeakMap exp;
+    getSwathFile(exp, nr_swath);
+    for (Size i = 0; i < exp.getSpectra().size(); i++)
+    {
+      MSSpectrum s = exp.getSpectra()[i];
+      s.setRT(cycle);
+      s[0].setIntensity(s[0].getIntensity() + cycle);
+      cached_sfc_ptr->consumeSpectrum(s);
+      TEST_EQUAL(s.empty(), true) // data was handed off, meta data is kept
+    }
+  }
+  // cannot change the number of threads after consuming spectra
+  TEST_EXCEPTION(Exception::IllegalArgument, cached_sfc_ptr->setWriterThreads(1))
+
+  std::vector< OpenSwath::SwathMap > maps;
+  cached_sfc_ptr->retrieveSwathMaps(maps);
+
+  TEST_EQUAL(maps.size(), nr_swath+1) // Swath number + MS1
+  for (int i = 0; i < nr_swath + 1; i++)
+  {
+    TEST_EQUAL(maps[i].sptr->getNrSpectra(), nr_cycles)
+    for (int cycle = 0; cycle < nr_cycles; cycle++)
+    {
+      TEST_REAL_SIMILAR(maps[i].sptr->getSpectrumById(cycle)->getMZArray()->data[0], 100.0 + i)
+      TEST_REAL_SIMILAR(maps[i].sptr->getSpectrumById(cycle)->getIntensityArray()->data[0], 200.0 + i + cycle)
+    }
+  }
+  delete cached_sfc_ptr;
+}
+END_SECTION
+
 START_SECTION(([EXTRA] void retrieveSwathMaps(std::vector< OpenSwath::SwathMap > & maps))) 
 {
   NOT_TESTABLE // already tested consumeAndRetrieve
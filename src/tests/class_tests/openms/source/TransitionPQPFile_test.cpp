@@ -35,6 +35,7 @@
 #include <OpenMS/CONCEPT/ClassTest.h>
 #include <OpenMS/test_config.h>
 #include <OpenMS/FORMAT/TraMLFile.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
 
 #include <boost/assign/std/vector.hpp>
 
@@ -80,6 +81,65 @@ START_SECTION( void convertPQPToTargetedExperiment(const char * filename, OpenMS
 }
 END_SECTION
 
+START_SECTION( void convertPQPToTargetedExperiment(const char * filename, OpenSwath::LightTargetedExperiment & targeted_exp, bool legacy_traml_id))
+{
+  TargetedExperiment traml_exp;
+  TraMLFile().load(OPENMS_GET_TEST_DATA_PATH("MRMAssay_detectingTransitions_input.TraML"), traml_exp);
+
+  String pqp_file;
+  NEW_TMP_FILE(pqp_file)
+  TransitionPQPFile pqp;
+  pqp.convertTargetedExperimentToPQP(pqp_file.c_str(), traml_exp);
+
+  // the direct path has to produce the same result as going through the full TargetedExperiment
+  TargetedExperiment heavy_exp;
+  pqp.convertPQPToTargetedExperiment(pqp_file.c_str(), heavy_exp, true);
+  OpenSwath::LightTargetedExperiment expected;
+  OpenSwathDataAccessHelper::convertTargetedExp(heavy_exp, expected);
+
+  OpenSwath::LightTargetedExperiment light_exp;
+  pqp.convertPQPToTargetedExperiment(pqp_file.c_str(), light_exp, true);
+
+  TEST_EQUAL(light_exp.getTransitions().size(), traml_exp.getTransitions().size())
+  TEST_EQUAL(light_exp.getTransitions().size(), expected.getTransitions().size())
+  TEST_EQUAL(light_exp.getCompounds().size(), expected.getCompounds().size())
+  TEST_EQUAL(light_exp.getProteins().size(), expected.getProteins().size())
+
+  for (Size i = 0; i < light_exp.getTransitions().size(); ++i)
+  {
+    const OpenSwath::LightTransition& tr = light_exp.getTransitions()[i];
+    const OpenSwath::LightTransition& ref = expected.getTransitions()[i];
+    TEST_EQUAL(tr.transition_name, ref.transition_name)
+    TEST_EQUAL(tr.peptide_ref, ref.peptide_ref)
+    TEST_REAL_SIMILAR(tr.precursor_mz, ref.precursor_mz)
+    TEST_REAL_SIMILAR(tr.product_mz, ref.product_mz)
+    TEST_REAL_SIMILAR(tr.library_intensity, ref.library_intensity)
+    TEST_EQUAL(tr.fragment_charge, ref.fragment_charge)
+    TEST_EQUAL(tr.decoy, ref.decoy)
+    TEST_EQUAL(tr.detecting_transition, ref.detecting_transition)
+    TEST_EQUAL(tr.identifying_transition, ref.identifying_transition)
+    TEST_EQUAL(tr.quantifying_transition, ref.quantifying_transition)
+  }
+
+  for (Size i = 0; i < light_exp.getCompounds().size(); ++i)
+  {
+    const OpenSwath::LightCompound& c = light_exp.getCompounds()[i];
+    const OpenSwath::LightCompound& ref = expected.getCompounds()[i];
+    TEST_EQUAL(c.id, ref.id)
+    TEST_EQUAL(c.sequence, ref.sequence)
+    TEST_EQUAL(c.charge, ref.charge)
+    TEST_REAL_SIMILAR(c.rt, ref.rt)
+    TEST_EQUAL(c.peptide_group_label, ref.peptide_group_label)
+    TEST_EQUAL(c.protein_refs.size(), ref.protein_refs.size())
+    TEST_EQUAL(c.modifications.size(), ref.modifications.size())
+  }
+
+  // compounds can be found by their reference
+  const OpenSwath::LightTransition& first = light_exp.getTransitions()[0];
+  TEST_EQUAL(light_exp.getCompoundByRef(first.peptide_ref).id, first.peptide_ref)
+}
+END_SECTION
+
 START_SECTION( void validateTargetedExperiment(OpenMS::TargetedExperiment & targeted_exp))
 {
   NOT_TESTABLE
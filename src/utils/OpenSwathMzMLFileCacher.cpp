@@ -40,6 +40,7 @@
 #include <OpenMS/FORMAT/FileTypes.h>
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
+#include <OpenMS/CONCEPT/UniqueIdGenerator.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
 
 #include <fstream>
@@ -120,6 +121,9 @@ class TOPPOpenSwathMzMLFileCacher
     registerStringOption_("full_meta", "<type>", "true", "Write full meta information into sqMass file (may require large amounts of memory)", false);
     setValidStrings_("full_meta", ListUtils::create<String>("true,false"));
 
+    registerIntOption_("chrom_block_size", "<number>", 0, "Number of chromatograms compressed together into one data block of the sqMass output (0 stores each chromatogram individually; only for sqMass output)", false, true);
+    setMinInt_("chrom_block_size", 0);
+
     registerDoubleOption_("lossy_mass_accuracy", "<error>", -1.0, "Desired (absolute) m/z accuracy for lossy compression (e.g. use 0.0001 for a mass accuracy of 0.2 ppm at 500 m/z, default uses -1.0 for maximal accuracy).", false, true);
 
     registerFlag_("process_lowmemory", "Whether to process the file on the fly without loading the whole file into memory first (only for conversions of mzXML/mzML to mzML).\nNote: this flag will prevent conversion from spectra to chromatograms.", true);
@@ -138,6 +142,7 @@ class TOPPOpenSwathMzMLFileCacher
     bool full_meta = (getStringOption_("full_meta") == "true");
     bool lossy_compression = (getStringOption_("lossy_compression") == "true");
     double mass_acc = getDoubleOption_("lossy_mass_accuracy");
+    Size chrom_block_size = (Size)getIntOption_("chrom_block_size");
 
     FileHandler fh;
 
@@ -184,7 +189,7 @@ class TOPPOpenSwathMzMLFileCacher
     }
     else if (in_type == FileTypes::MZML && out_type == FileTypes::SQMASS && process_lowmemory)
     {
-      MSDataSqlConsumer consumer(out, batchSize, full_meta, lossy_compression, mass_acc);
+      MSDataSqlConsumer consumer(out, UniqueIdGenerator::getUniqueId(), batchSize, full_meta, lossy_compression, mass_acc, chrom_block_size);
       MzMLFile f;
       PeakFileOptions opt = f.getOptions();
       opt.setMaxDataPoolSize(batchSize); 
@@ -208,6 +213,7 @@ class TOPPOpenSwathMzMLFileCacher
       config.write_full_meta = full_meta;
       config.use_lossy_numpress = lossy_compression;
       config.linear_fp_mass_acc = mass_acc;
+      config.chrom_block_size = chrom_block_size;
 
       SqMassFile sqfile;
       sqfile.setConfig(config);
@@ -470,6 +470,8 @@ protected:
 
     registerOutputFile_("out_chrom", "<file>", "", "Also output all computed chromatograms output in mzML (chrom.mzML) or sqMass (SQLite format)", false, true);
     setValidFormats_("out_chrom", ListUtils::create<String>("mzML,sqMass"));
+    registerIntOption_("out_chrom_block_size", "<number>", 0, "Number of chromatograms compressed together into one data block of the sqMass output (0 stores each chromatogram individually; only for -out_chrom in sqMass format)", false, true);
+    setMinInt_("out_chrom_block_size", 0);
 
     // additional QC data
     registerOutputFile_("out_qc", "<file>", "", "Optional QC meta data (charge distribution in MS1). Only works with mzML input files.", false, true);
@@ -530,7 +532,7 @@ protected:
 
     registerIntOption_("batchSize", "<number>", 1000, "The batch size of chromatograms to process (0 means to only have one batch, sensible values are around 250-1000)", false, true);
     setMinInt_("batchSize", 0);
-    registerIntOption_("outer_loop_threads", "<number>", -1, "How many threads should be used for the outer loop (-1 use all threads, use 4 to analyze 4 SWATH windows in memory at once).", false, true);
+    registerIntOption_("outer_loop_threads", "<number>", -1, "How many SWATH windows should be processed at once (-1 does not limit the number of windows, use 4 to have at most 4 SWATH windows in memory at once). Batches of all windows in flight are processed on all threads.", false, true);
 
     registerIntOption_("ms1_isotopes", "<number>", 3, "The number of MS1 isotopes used for extraction", false, true);
     setMinInt_("ms1_isotopes", 0);
@@ -683,6 +685,7 @@ protected:
     String swath_windows_file = getStringOption_("swath_windows_file");
 
     String out_chrom = getStringOption_("out_chrom");
+    Size out_chrom_block_size = (Size)getIntOption_("out_chrom_block_size");
     bool split_file = getFlag_("split_file_input");
     bool use_emg_score = getFlag_("use_elution_model_score");
     bool force = getFlag_("force");
@@ -930,7 +933,7 @@ protected:
     ///////////////////////////////////
     Interfaces::IMSDataConsumer* chromatogramConsumer;
     UInt64 run_id = OpenMS::UniqueIdGenerator::getUniqueId();
-    prepareChromOutput(&chromatogramConsumer, exp_meta, transition_exp, out_chrom, run_id);
+    prepareChromOutput(&chromatogramConsumer, exp_meta, transition_exp, out_chrom, run_id, out_chrom_block_size);
 
     ///////////////////////////////////
     // Set up peakgroup file output (.tsv or .osw file)